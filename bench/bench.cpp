@@ -0,0 +1,481 @@
+#include "bench.hpp"
+
+#include <COOImpl.hpp>
+#include <COOhashImpl.hpp>
+#include <COOmapImpl.hpp>
+#include <COOvecImpl.hpp>
+#include <MatrixImpl.hpp>
+#include <YALEImpl.hpp>
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Matrix.hpp"
+
+using namespace algebra;
+
+namespace {
+
+/// @brief Number of random positions read by the lookup benchmarks.
+constexpr std::size_t num_lookups = 1024;
+
+/// @brief Number of elements inserted and removed in dynamic state.
+constexpr std::size_t num_dynamic_updates = 1024;
+
+/// @brief Number of elements inserted and removed in compressed state, where
+/// every update moves the following elements.
+constexpr std::size_t num_compressed_updates = 16;
+
+/// @brief Measures the duration of a callable.
+/// @tparam F The type of the callable.
+/// @param f The callable.
+/// @return The duration in nanoseconds.
+template <typename F>
+double time_ns(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+/// @brief Runs a benchmark.
+/// @tparam F The type of the benchmark.
+/// @param options The options of the run.
+/// @param f A callable performing one run and returning its duration in
+/// nanoseconds, so that it can restore its state untimed.
+/// @return The sorted durations of the timed runs.
+template <typename F>
+std::vector<double> bench_samples(BenchOptions const& options, F&& f) {
+    for (std::size_t r = 0; r < options.warmup; ++r) f();
+
+    std::vector<double> samples(options.repetitions);
+    for (auto& sample : samples) sample = f();
+    std::sort(samples.begin(), samples.end());
+    return samples;
+}
+
+/// @brief Escapes a string to be written in JSON.
+/// @param text The string.
+/// @return The string with quotes and backslashes escaped.
+std::string json_escape(std::string const& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') escaped.push_back('\\');
+        escaped.push_back(c);
+    }
+    return escaped;
+}
+
+/// @brief Runs the benchmarks of a combination of formats on a matrix.
+/// @details Every benchmark is registered with the number of operations,
+/// floating point operations and bytes of one run; the bytes count every
+/// byte of the data structures and of the vectors once, so that the
+/// bandwidth is a lower bound of the real traffic.
+/// @tparam C The compressed format.
+/// @tparam D The dynamic format.
+/// @tparam S The storage order (row-major or column-major).
+template <template <typename, StorageOrder> class C,
+          template <typename, StorageOrder> class D, StorageOrder S>
+class Suite {
+    using MatrixType = Matrix<double, C, D, S>;
+
+   public:
+    /// @brief Loads the matrix.
+    /// @param format The name of the combination of formats.
+    /// @param file The Matrix Market file.
+    /// @param options The options of the run.
+    /// @param results The vector the results are appended to.
+    Suite(std::string format, std::string file, BenchOptions const& options,
+          std::vector<BenchResult>& results)
+        : format(std::move(format)),
+          file(std::move(file)),
+          options(options),
+          results(results),
+          m(UseCompressed{}, this->file) {}
+
+    /// @brief Runs all the benchmarks.
+    void run() {
+        rows = m.get_rows();
+        columns = m.get_columns();
+        nnz = m.get_num_elements();
+        compressed_bytes = m.get_values().size_bytes() +
+                           m.get_outer_indexes().size_bytes() +
+                           m.get_inner_indexes().size_bytes();
+        dynamic_bytes = nnz * (sizeof(double) + 2 * sizeof(std::size_t));
+        choose_positions();
+
+        double file_bytes =
+            static_cast<double>(std::filesystem::file_size(file));
+        add("load/compressed", 1, 0, file_bytes, [&] {
+            return time_ns([&] { MatrixType loaded(UseCompressed{}, file); });
+        });
+        add("load/dynamic", 1, 0, file_bytes, [&] {
+            return time_ns([&] { MatrixType loaded(file); });
+        });
+
+        run_state("compressed", compressed_bytes, num_compressed_updates);
+        add("uncompress", 1, 0, compressed_bytes + dynamic_bytes, [&] {
+            double ns = time_ns([&] { m.uncompress(); });
+            m.compress();
+            return ns;
+        });
+
+        m.uncompress();
+        run_state("dynamic", dynamic_bytes, num_dynamic_updates);
+        add("compress", 1, 0, compressed_bytes + dynamic_bytes, [&] {
+            double ns = time_ns([&] { m.compress(); });
+            m.uncompress();
+            return ns;
+        });
+    }
+
+   private:
+    /// @brief Runs the benchmarks that depend on the state of the matrix.
+    /// @param state The name of the state.
+    /// @param bytes The size of the data structures.
+    /// @param updates The number of elements to insert and remove.
+    void run_state(std::string const& state, double bytes,
+                   std::size_t updates) {
+        auto const& cm = m;
+        std::vector<double> x(columns, 1.0);
+        std::vector<double> y(rows);
+        double vector_bytes =
+            sizeof(double) * static_cast<double>(rows + columns);
+
+        add("spmv/" + state, 1, 2.0 * nnz, bytes + vector_bytes, [&] {
+            return time_ns([&] { cm.multiply_into(x, y); });
+        });
+        add("spmv-transpose/" + state, 1, 2.0 * nnz, bytes + vector_bytes,
+            [&] {
+                std::vector<double> xt(rows, 1.0), yt(columns);
+                return time_ns([&] { cm.multiply_transpose(xt, yt); });
+            });
+        add("transpose/" + state, 1, 0, 2.0 * bytes, [&] {
+            return time_ns([&] { MatrixType t = cm.transpose(); });
+        });
+
+        add("lookup/" + state, lookups.size(), 0, 0, [&] {
+            double sum = 0;
+            double ns = time_ns([&] {
+                for (auto [i, j] : lookups) sum += cm(i, j);
+            });
+            y[0] = sum;
+            return ns;
+        });
+
+        add("insert/" + state, updates, 0, 0, [&] {
+            double ns = time_ns([&] {
+                for (std::size_t k = 0; k < updates; ++k) {
+                    m.insert(missing[k].first, missing[k].second, 1.0);
+                }
+            });
+            for (std::size_t k = 0; k < updates; ++k) {
+                m.remove(missing[k].first, missing[k].second);
+            }
+            return ns;
+        });
+
+        add("remove/" + state, updates, 0, 0, [&] {
+            for (std::size_t k = 0; k < updates; ++k) {
+                m.insert(missing[k].first, missing[k].second, 1.0);
+            }
+            return time_ns([&] {
+                for (std::size_t k = 0; k < updates; ++k) {
+                    m.remove(missing[k].first, missing[k].second);
+                }
+            });
+        });
+
+        // Matrix::norm caches its result, so the computation is timed
+        // through the format and the cache hits are reported apart.
+        const bool compressed = (state == "compressed");
+        double result = 0;
+        add("norm/One/" + state, 1, nnz, bytes, [&] {
+            return time_ns(
+                [&] { result += compute_norm<One>(compressed); });
+        });
+        add("norm/Infinity/" + state, 1, nnz, bytes, [&] {
+            return time_ns(
+                [&] { result += compute_norm<Infinity>(compressed); });
+        });
+        add("norm/Frobenius/" + state, 1, 2.0 * nnz, bytes, [&] {
+            return time_ns(
+                [&] { result += compute_norm<Frobenius>(compressed); });
+        });
+        add("norm-cached/" + state, 1, 0, 0, [&] {
+            result += cm.template norm<Frobenius>();
+            return time_ns([&] { result += cm.template norm<Frobenius>(); });
+        });
+        y[0] = result;
+    }
+
+    /// @brief Computes a norm without going through the cache of `Matrix`.
+    /// @tparam N The type of norm to compute (Infinity, One, or Frobenius).
+    /// @param compressed True if the matrix is in compressed state.
+    /// @return The norm.
+    template <NormType N>
+    double compute_norm(bool compressed) const {
+        return compressed ? m.template norm_compressed<N>()
+                          : m.template norm_dynamic<N>();
+    }
+
+    /// @brief Chooses the positions read by the lookups, half of them are
+    /// stored elements, and the empty positions used by the updates.
+    void choose_positions() {
+        std::mt19937_64 gen(42);
+        auto const& cm = m;
+
+        lookups.clear();
+        missing.clear();
+        if (rows == 0 || columns == 0) return;
+
+        std::uniform_int_distribution<std::size_t> row(0, rows - 1);
+        std::uniform_int_distribution<std::size_t> column(0, columns - 1);
+        auto inner = m.get_inner_indexes();
+        auto outer = m.get_outer_indexes();
+
+        while (nnz > 0 && lookups.size() < num_lookups / 2) {
+            std::size_t line = (S == rowMajor) ? row(gen) : column(gen);
+            if (inner[line] == inner[line + 1]) continue;
+
+            std::size_t k =
+                inner[line] + gen() % (inner[line + 1] - inner[line]);
+            std::size_t other = outer[k];
+            lookups.emplace_back(S == rowMajor ? line : other,
+                                 S == rowMajor ? other : line);
+        }
+        while (lookups.size() < num_lookups) {
+            lookups.emplace_back(row(gen), column(gen));
+        }
+        std::shuffle(lookups.begin(), lookups.end(), gen);
+
+        std::size_t attempts = 0;
+        while (missing.size() < num_dynamic_updates &&
+               attempts++ < 100 * num_dynamic_updates) {
+            std::pair<std::size_t, std::size_t> position{row(gen), column(gen)};
+            if (cm(position.first, position.second) == 0.0 &&
+                std::find(missing.begin(), missing.end(), position) ==
+                    missing.end()) {
+                missing.push_back(position);
+            }
+        }
+    }
+
+    /// @brief Runs a benchmark and stores its result.
+    /// @tparam F The type of the benchmark.
+    /// @param name The name of the benchmark.
+    /// @param items The number of operations of a run.
+    /// @param flops The number of floating point operations of a run.
+    /// @param bytes The number of bytes of a run.
+    /// @param f A callable performing one run and returning its duration.
+    template <typename F>
+    void add(std::string const& name, std::size_t items, double flops,
+             double bytes, F&& f) {
+        if (name.find(options.filter) == std::string::npos) return;
+        if (name.starts_with("insert/") || name.starts_with("remove/")) {
+            if (items > missing.size()) return;
+        }
+
+        BenchResult result;
+        result.name = name;
+        result.format = format;
+        result.matrix = file;
+        result.items = items;
+        result.flops = flops;
+        result.bytes = bytes;
+        bench_statistics(bench_samples(options, f), result);
+
+        print_bench_result(result);
+        results.push_back(result);
+    }
+
+    std::string format;                   ///< Name of the formats.
+    std::string file;                     ///< The Matrix Market file.
+    BenchOptions const& options;          ///< The options of the run.
+    std::vector<BenchResult>& results;    ///< The results of the run.
+    MatrixType m;                         ///< The matrix.
+    std::size_t rows = 0;                 ///< Number of rows.
+    std::size_t columns = 0;              ///< Number of columns.
+    std::size_t nnz = 0;                  ///< Number of non-zero elements.
+    double compressed_bytes = 0;          ///< Size of the compressed arrays.
+    double dynamic_bytes = 0;             ///< Size of the dynamic triplets.
+    std::vector<std::pair<std::size_t, std::size_t>>
+        lookups;  ///< Positions read by the lookups.
+    std::vector<std::pair<std::size_t, std::size_t>>
+        missing;  ///< Empty positions used by the updates.
+};
+
+/// @brief Runs the suite of a combination of formats on a matrix.
+/// @tparam C The compressed format.
+/// @tparam D The dynamic format.
+/// @tparam S The storage order (row-major or column-major).
+/// @param format The name of the combination of formats.
+/// @param file The Matrix Market file.
+/// @param options The options of the run.
+/// @param results The vector the results are appended to.
+template <template <typename, StorageOrder> class C,
+          template <typename, StorageOrder> class D, StorageOrder S>
+void run_suite(std::string const& format, std::string const& file,
+               BenchOptions const& options,
+               std::vector<BenchResult>& results) {
+    Suite<C, D, S>(format, file, options, results).run();
+}
+
+}  // namespace
+
+BenchOptions parse_bench_options(int argc, char** argv) {
+    BenchOptions options;
+
+    for (int a = 1; a < argc; ++a) {
+        std::string argument{argv[a]};
+        auto value = [&](std::string const& flag) {
+            return argument.substr(flag.size());
+        };
+
+        if (argument.starts_with("--warmup=")) {
+            options.warmup = std::stoul(value("--warmup="));
+        }
+        else if (argument.starts_with("--repetitions=")) {
+            options.repetitions =
+                std::max<std::size_t>(1, std::stoul(value("--repetitions=")));
+        }
+        else if (argument.starts_with("--filter=")) {
+            options.filter = value("--filter=");
+        }
+        else if (argument.starts_with("--json=")) {
+            options.json = value("--json=");
+        }
+        else {
+            options.matrices.push_back(argument);
+        }
+    }
+
+    if (options.matrices.empty()) options.matrices.push_back("matrix.mtx");
+    return options;
+}
+
+void bench_statistics(std::vector<double> const& samples, BenchResult& result) {
+    auto percentile = [&](double q) {
+        std::size_t rank = static_cast<std::size_t>(
+            q * static_cast<double>(samples.size() - 1) + 0.5);
+        return samples[rank];
+    };
+
+    result.repetitions = samples.size();
+    result.min_ns = samples.front();
+    result.median_ns = percentile(0.5);
+    result.p90_ns = percentile(0.9);
+    result.max_ns = samples.back();
+}
+
+void print_bench_result(BenchResult const& result) {
+    std::ostringstream name;
+    name << result.matrix << " " << result.format << " " << result.name;
+
+    std::cout << std::left << std::setw(60) << name.str() << std::right
+              << std::fixed << std::setprecision(3) << std::setw(14)
+              << result.median_ns / 1000 << " us" << std::setw(14)
+              << result.p90_ns / 1000 << " us";
+    if (result.flops > 0) {
+        std::cout << std::setw(10) << result.flops / result.median_ns
+                  << " GFLOP/s";
+    }
+    if (result.bytes > 0) {
+        std::cout << std::setw(10) << result.bytes / result.median_ns
+                  << " GB/s";
+    }
+    if (result.items > 1) {
+        std::cout << std::setw(10) << result.median_ns / result.items
+                  << " ns/op";
+    }
+    std::cout << std::defaultfloat << std::endl;
+}
+
+void write_bench_json(BenchOptions const& options,
+                      std::vector<BenchResult> const& results) {
+    std::ofstream out(options.json);
+    if (!out) {
+        std::cerr << "Cannot write " << options.json << std::endl;
+        return;
+    }
+
+    std::time_t now = std::time(nullptr);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::gmtime(&now));
+
+    out << std::setprecision(17);
+    out << "{\n  \"context\": {\n";
+    out << "    \"date\": \"" << date << "\",\n";
+    out << "    \"compiler\": \"" << json_escape(__VERSION__) << "\",\n";
+    out << "    \"hardware_threads\": " << std::thread::hardware_concurrency()
+        << ",\n";
+    out << "    \"warmup\": " << options.warmup << ",\n";
+    out << "    \"repetitions\": " << options.repetitions << "\n  },\n";
+    out << "  \"benchmarks\": [";
+
+    for (std::size_t r = 0; r < results.size(); ++r) {
+        auto const& result = results[r];
+        out << (r == 0 ? "\n" : ",\n") << "    {";
+        out << "\"name\": \"" << json_escape(result.name) << "\", ";
+        out << "\"format\": \"" << json_escape(result.format) << "\", ";
+        out << "\"matrix\": \"" << json_escape(result.matrix) << "\", ";
+        out << "\"repetitions\": " << result.repetitions << ", ";
+        out << "\"items\": " << result.items << ", ";
+        out << "\"min_ns\": " << result.min_ns << ", ";
+        out << "\"median_ns\": " << result.median_ns << ", ";
+        out << "\"p90_ns\": " << result.p90_ns << ", ";
+        out << "\"max_ns\": " << result.max_ns << ", ";
+        out << "\"gflops\": " << result.flops / result.median_ns << ", ";
+        out << "\"gbytes_per_second\": " << result.bytes / result.median_ns
+            << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+int run_benchmarks(int argc, char** argv) {
+    BenchOptions options = parse_bench_options(argc, argv);
+    std::vector<BenchResult> results;
+
+    std::cout << std::left << std::setw(60) << "Benchmark" << std::right
+              << std::setw(17) << "Median" << std::setw(17) << "p90"
+              << std::endl;
+
+    for (auto const& file : options.matrices) {
+        if (!std::filesystem::exists(file)) {
+            std::cerr << "Cannot read " << file << std::endl;
+            return 1;
+        }
+
+        run_suite<YALE, COO, rowMajor>("YALE/COO/rowMajor", file, options,
+                                       results);
+        run_suite<YALE, COO, columnMajor>("YALE/COO/columnMajor", file,
+                                          options, results);
+        run_suite<YALE, COOmap, rowMajor>("YALE/COOmap/rowMajor", file,
+                                          options, results);
+        run_suite<YALE, COOmap, columnMajor>("YALE/COOmap/columnMajor", file,
+                                             options, results);
+        run_suite<YALE, COOvec, rowMajor>("YALE/COOvec/rowMajor", file,
+                                          options, results);
+        run_suite<YALE, COOvec, columnMajor>("YALE/COOvec/columnMajor", file,
+                                             options, results);
+        run_suite<YALE, COOhash, rowMajor>("YALE/COOhash/rowMajor", file,
+                                           options, results);
+        run_suite<YALE, COOhash, columnMajor>("YALE/COOhash/columnMajor",
+                                              file, options, results);
+        run_suite<YALE32, COOvec, rowMajor>("YALE32/COOvec/rowMajor", file,
+                                            options, results);
+    }
+
+    if (!options.json.empty()) write_bench_json(options, results);
+    return 0;
+}
@@ -0,0 +1,60 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/// @brief Options of a benchmark run, read from the command line.
+struct BenchOptions {
+    std::vector<std::string> matrices;  ///< Matrix Market files to load.
+    std::size_t warmup = 2;             ///< Untimed runs of every benchmark.
+    std::size_t repetitions = 10;       ///< Timed runs of every benchmark.
+    std::string filter;  ///< Only benchmarks containing it are run.
+    std::string json;    ///< File of the JSON report, none if empty.
+};
+
+/// @brief Statistics of a benchmark over its repetitions.
+struct BenchResult {
+    std::string name;         ///< The operation, e.g. "spmv/compressed".
+    std::string format;       ///< The formats and the storage order.
+    std::string matrix;       ///< The file the matrix was read from.
+    std::size_t repetitions;  ///< Number of timed runs.
+    std::size_t items;        ///< Operations performed by every run.
+    double flops;             ///< Floating point operations of every run.
+    double bytes;             ///< Bytes of every run, each one counted once.
+    double min_ns;            ///< Fastest run.
+    double median_ns;         ///< Median run.
+    double p90_ns;            ///< 90th percentile.
+    double max_ns;            ///< Slowest run.
+};
+
+/// @brief Parses the command line.
+/// @param argc The number of arguments.
+/// @param argv The arguments: `--warmup=N`, `--repetitions=N`,
+/// `--filter=TEXT`, `--json=FILE` and the Matrix Market files.
+/// @return The options, `matrix.mtx` is used if no file is given.
+BenchOptions parse_bench_options(int argc, char** argv);
+
+/// @brief Computes the statistics of a benchmark.
+/// @param samples The sorted durations in nanoseconds.
+/// @param result The result to fill, name and format excluded.
+void bench_statistics(std::vector<double> const& samples, BenchResult& result);
+
+/// @brief Prints a result as a line of the table on the standard output.
+/// @param result The result to print.
+void print_bench_result(BenchResult const& result);
+
+/// @brief Writes the results in JSON format.
+/// @param options The options of the run.
+/// @param results The results to write.
+void write_bench_json(BenchOptions const& options,
+                      std::vector<BenchResult> const& results);
+
+/// @brief Runs all the benchmarks on all the matrices and format combinations.
+/// @param argc The number of arguments.
+/// @param argv The arguments, see `parse_bench_options`.
+/// @return The exit code of the program.
+int run_benchmarks(int argc, char** argv);
+
+#endif
@@ -0,0 +1,291 @@
+#ifndef BSR_HPP
+#define BSR_HPP
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "BSRKernels.hpp"
+#include "Comparators.hpp"
+#include "Concepts.hpp"
+#include "Dimensions.hpp"
+
+using namespace comparators;
+namespace algebra {
+
+/// @brief Represents a matrix in Block Compressed Sparse Row format (BSR),
+/// made of dense blocks of `R` rows and `C` columns.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam R The number of rows of a block.
+/// @tparam C The number of columns of a block.
+template <NumericOrComplex T, StorageOrder S, size_t R, size_t C>
+class BSR;
+
+/// @brief Performs matrix-vector product.
+/// @param m An object of type BSR representing the matrix, i.e. the lhs.
+/// @param v The vector, i.e. the rhs.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam R The number of rows of a block.
+/// @tparam C The number of columns of a block.
+template <NumericOrComplex T, StorageOrder S, size_t R, size_t C>
+std::vector<T> by_vector_compressed(class BSR<T, S, R, C> const& m,
+                                    std::vector<T> const& v);
+
+/// @brief Performs the matrix-vector product `result = alpha * m * v + beta *
+/// result` writing into a buffer owned by the caller.
+/// @param m An object of type BSR representing the matrix, i.e. the lhs.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer, it must hold `m.get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam R The number of rows of a block.
+/// @tparam C The number of columns of a block.
+template <NumericOrComplex T, StorageOrder S, size_t R, size_t C>
+void by_vector_compressed(class BSR<T, S, R, C> const& m,
+                          std::span<T const> v, std::span<T> result, T alpha,
+                          T beta);
+
+/// @brief Performs the matrix-vector product `result = alpha * m * v + beta *
+/// result` on multiple threads.
+/// @param m An object of type BSR representing the matrix, i.e. the lhs.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer, it must hold `m.get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam R The number of rows of a block.
+/// @tparam C The number of columns of a block.
+template <NumericOrComplex T, StorageOrder S, size_t R, size_t C>
+void by_vector_compressed_parallel(class BSR<T, S, R, C> const& m,
+                                   std::span<T const> v, std::span<T> result,
+                                   T alpha, T beta, unsigned num_threads);
+
+/// @brief Performs the transpose product `result = alpha * m^T * v + beta *
+/// result` writing into a buffer owned by the caller.
+/// @param m An object of type BSR representing the matrix, i.e. the lhs.
+/// @param v The vector, it must hold `m.get_rows()` elements.
+/// @param result The output buffer, it must hold `m.get_columns()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam R The number of rows of a block.
+/// @tparam C The number of columns of a block.
+template <NumericOrComplex T, StorageOrder S, size_t R, size_t C>
+void by_vector_transpose_compressed(class BSR<T, S, R, C> const& m,
+                                    std::span<T const> v, std::span<T> result,
+                                    T alpha, T beta);
+
+/// @brief Performs the transpose product `result = alpha * m^T * v + beta *
+/// result` on multiple threads.
+/// @param m An object of type BSR representing the matrix, i.e. the lhs.
+/// @param v The vector, it must hold `m.get_rows()` elements.
+/// @param result The output buffer, it must hold `m.get_columns()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam R The number of rows of a block.
+/// @tparam C The number of columns of a block.
+template <NumericOrComplex T, StorageOrder S, size_t R, size_t C>
+void by_vector_transpose_compressed_parallel(class BSR<T, S, R, C> const& m,
+                                             std::span<T const> v,
+                                             std::span<T> result, T alpha,
+                                             T beta, unsigned num_threads);
+
+/// @details The matrix is split in blocks of `R x C` elements and the blocks
+/// holding at least one element are stored whole, padded with zeros, and
+/// indexed as the elements of `YALE`: in row-major order the lines are the
+/// block rows, each listing its blocks by block column, and the values of a
+/// block are stored row by row; in column-major order everything is
+/// transposed. Compared to `YALE`, there is one index every `R * C` values
+/// and the product reads a whole block of the rhs at a time, with loops
+/// unrolled at compile time. A bit mask per block tells the stored elements
+/// from the padding, so conversions and element counts are the same as with
+/// the other formats. The number of rows must be a multiple of `R` and the
+/// number of columns a multiple of `C`.
+template <NumericOrComplex T, StorageOrder S, size_t R, size_t C>
+class BSR : virtual public Dimensions {
+    static_assert(R > 0 && C > 0 && R * C <= 64,
+                  "The blocks of BSR must have between 1 and 64 elements.");
+
+    using indexvec = std::vector<size_t>;        ///< Vector of indices.
+    using valuesvec = std::vector<T>;            ///< Vector of matrix values.
+    using masksvec = std::vector<std::uint64_t>;  ///< Vector of block masks.
+
+   public:
+    static constexpr size_t block_lines =
+        (S == rowMajor) ? R : C;  ///< Number of lines of a block.
+    static constexpr size_t block_indexes =
+        (S == rowMajor) ? C : R;  ///< Number of indexes of a block line.
+    static constexpr size_t block_size = R * C;  ///< Elements of a block.
+
+   protected:
+    /// @brief Default constructor for the BSR class.
+    BSR() = default;
+
+    /// @brief Constructs a BSR matrix from the block compressed format data.
+    /// @tparam B Boolean constant to indicate wether the matrix' size was given
+    /// as input.
+    /// @param out The block index of each block.
+    /// @param in The first block of each block line, plus the number of
+    /// blocks.
+    /// @param val The container of the values of the blocks.
+    template <bool B>
+    BSR(std::bool_constant<B>, SizetContainer auto const& out,
+        SizetContainer auto const& in, NumericContainer auto const& val);
+
+    /// @brief In the process of uncompressing the matrix sends all the
+    /// triplets, coherently with the storage order.
+    /// @tparam F The type of the receiver.
+    /// @param receiver A callable taking the row index, the column index and
+    /// the value of each element.
+    template <typename F>
+    void uncompress_from_compressed(F&& receiver) const;
+
+    /// @brief Builds the data structure from the triplets sent by another
+    /// format.
+    /// @tparam F The type of the sender.
+    /// @param num_elements The number of triplets that will be sent.
+    /// @param sender A callable taking a receiver and calling it on every
+    /// triplet, coherently with the storage order.
+    template <typename F>
+    void compress_from_triplets(size_t num_elements, F&& sender);
+
+    /// @brief Gets the number of non-zero elements.
+    /// @return The number of non-zero elements.
+    size_t get_num_elements_compressed() const;
+
+    /// @brief Releases the compressed storage format.
+    void release_compressed();
+
+    /// @brief Computes the block line, the block index and the position
+    /// inside the block of an element.
+    /// @param i The row index.
+    /// @param j The column index.
+    /// @return The block line, the block index and the offset of the element
+    /// inside its block.
+    std::array<size_t, 3> locate(size_t i, size_t j) const;
+
+    /// @brief Finds a block.
+    /// @param line The block line.
+    /// @param index The block index.
+    /// @return The position of the block, or of the first block after it if
+    /// it's not stored.
+    size_t find_block(size_t line, size_t index) const;
+
+    /// @brief Checks that the dimensions are multiples of the block ones.
+    void check_dimensions() const;
+
+    std::unique_ptr<indexvec>
+        outerindex_ptr;  ///< Pointer to the block index vector.
+    std::unique_ptr<indexvec>
+        innerindex_ptr;  ///< Pointer to the first block of each block line.
+    std::unique_ptr<valuesvec> values_ptr;  ///< Pointer to the block values.
+    std::unique_ptr<masksvec>
+        masks_ptr;  ///< Pointer to the stored elements of each block.
+    size_t num_elements = 0;  ///< Number of stored elements.
+
+   public:
+    /// @brief Finds the value at the specified position (read-only).
+    /// @param i The row index.
+    /// @param j The column index.
+    /// @return The value at the specified position.
+    T find_compressed_const(size_t i, size_t j) const;
+
+    /// @brief Finds the value at the specified position (read-write).
+    /// @param i The row index.
+    /// @param j The column index.
+    /// @return A reference to the value at the specified position.
+    T& find_compressed(size_t i, size_t j);
+
+    /// @brief Removes the element at the specified position.
+    /// @param i The row index.
+    /// @param j The column index.
+    /// @return True if the element was removed, false otherwise.
+    bool remove_compressed(size_t i, size_t j);
+
+    /// @brief Removes all the elements satisfying a predicate.
+    /// @tparam F The type of the predicate.
+    /// @param pred A callable taking the row index, the column index and the
+    /// value of each element, and returning true if it has to be removed.
+    /// @return The number of removed elements.
+    template <typename F>
+    size_t remove_if_compressed(F&& pred);
+
+    /// @brief Prints the matrix in compressed format to the standard output.
+    void print_compressed() const;
+
+    /// @brief Computes the norm of the matrix.
+    /// @tparam N The type of norm to compute (Infinity, One, or Frobenius).
+    /// @return The computed norm value.
+    template <NormType N>
+    double norm_compressed() const;
+
+    /// @brief Gets the number of stored blocks.
+    /// @return The number of blocks.
+    size_t get_num_blocks() const;
+
+    /// @brief Gets the fraction of the stored block values which are elements
+    /// of the matrix, the rest being padding.
+    /// @return The fill ratio, 1 if every block is full.
+    double get_fill_ratio() const;
+
+    /// @brief Gets the inner index vector.
+    /// @return A read-only view of the first block of each block line.
+    std::span<size_t const> get_inner_indexes() const;
+
+    /// @brief Gets the outer index vector.
+    /// @return A read-only view of the block index of each block.
+    std::span<size_t const> get_outer_indexes() const;
+
+    /// @brief Gets the values vector.
+    /// @return A read-only view of the values of the blocks.
+    std::span<T const> get_values() const;
+
+    friend std::vector<T> by_vector_compressed<>(BSR<T, S, R, C> const& m,
+                                                 std::vector<T> const& v);
+
+    friend void by_vector_compressed<>(BSR<T, S, R, C> const& m,
+                                       std::span<T const> v,
+                                       std::span<T> result, T alpha, T beta);
+
+    friend void by_vector_compressed_parallel<>(BSR<T, S, R, C> const& m,
+                                                std::span<T const> v,
+                                                std::span<T> result, T alpha,
+                                                T beta, unsigned num_threads);
+};
+
+/// @brief BSR format with 2x2 blocks.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+using BSR2 = BSR<T, S, 2, 2>;
+
+/// @brief BSR format with 3x3 blocks, e.g. for three degrees of freedom per
+/// node.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+using BSR3 = BSR<T, S, 3, 3>;
+
+/// @brief BSR format with 6x6 blocks, e.g. for six degrees of freedom per
+/// node.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+using BSR6 = BSR<T, S, 6, 6>;
+
+}  // namespace algebra
+#endif
@@ -0,0 +1,108 @@
+#ifndef MAPPEDYALE_HPP
+#define MAPPEDYALE_HPP
+
+#include <span>
+#include <string>
+#include <vector>
+
+#include "Comparators.hpp"
+#include "Concepts.hpp"
+#include "Dimensions.hpp"
+#include "MappedFile.hpp"
+
+using namespace comparators;
+namespace algebra {
+
+/// @brief Represents a read-only YALE matrix used in place from a binary
+/// snapshot mapped in memory.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+template <NumericOrComplex T, StorageOrder S, IndexType I = size_t,
+          IndexType P = I>
+class MappedYALE;
+
+/// @brief Performs matrix-vector product.
+/// @param m An object of type MappedYALE representing the matrix, i.e. the
+/// lhs.
+/// @param v The vector, i.e. the rhs.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+std::vector<T> operator*(MappedYALE<T, S, I, P> const& m,
+                         std::vector<T> const& v);
+
+/// @details The snapshot written by `YALE::save_snapshot` is mapped and its
+/// arrays are used where they are, so loading takes the same time whatever
+/// the number of non-zero elements and processes mapping the same file share
+/// one copy of it in the page cache. A snapshot that doesn't match the
+/// template arguments, index types included, or that is truncated, gives an
+/// empty matrix.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+class MappedYALE : public Dimensions {
+   public:
+    /// @brief Maps a binary snapshot.
+    /// @param file_name The name of the file written by `save_snapshot`.
+    explicit MappedYALE(std::string const& file_name);
+
+    /// @brief Checks if the snapshot was mapped successfully.
+    /// @return True if the snapshot matched the template arguments.
+    bool is_valid() const;
+
+    /// @brief Accesses the element at the specified position.
+    /// @param i The row index.
+    /// @param j The column index.
+    /// @return The value at the specified position.
+    T operator()(std::size_t i, std::size_t j) const;
+
+    /// @brief Gets the number of non-zero elements in the matrix.
+    /// @return The number of non-zero elements.
+    size_t get_num_elements() const;
+
+    /// @brief Computes the norm of the matrix.
+    /// @tparam N The type of norm to compute (Infinity, One, or Frobenius).
+    /// @return The computed norm value.
+    template <NormType N>
+    double norm() const;
+
+    /// @brief Performs the matrix-vector product `y = alpha * A * x + beta *
+    /// y` writing into a buffer owned by the caller.
+    /// @param x The vector, i.e. the rhs.
+    /// @param y The output buffer, it must hold `get_rows()` elements.
+    /// @param alpha The scaling factor of the product.
+    /// @param beta The scaling factor of the previous content of `y`.
+    /// @param num_threads The number of threads, zero means as many as the
+    /// hardware supports.
+    void multiply_into(std::span<T const> x, std::span<T> y, T alpha = T{1},
+                       T beta = T{0}, unsigned num_threads = 1) const;
+
+    /// @brief Gets the inner index array.
+    /// @return A read-only view of the beginning of each line.
+    std::span<P const> get_inner_indexes() const;
+
+    /// @brief Gets the outer index array.
+    /// @return A read-only view of the outer index of each element.
+    std::span<I const> get_outer_indexes() const;
+
+    /// @brief Gets the values array.
+    /// @return A read-only view of the value of each element.
+    std::span<T const> get_values() const;
+
+    /// @brief Prints the matrix in compressed format to the standard output.
+    void print() const;
+
+    friend std::vector<T> operator*
+        <>(MappedYALE<T, S, I, P> const&, std::vector<T> const&);
+
+   private:
+    MappedFile file;            ///< The mapped snapshot.
+    std::span<P const> inner;   ///< The inner index array.
+    std::span<I const> outer;   ///< The outer index array.
+    std::span<T const> values;  ///< The values array.
+};
+
+}  // namespace algebra
+#endif
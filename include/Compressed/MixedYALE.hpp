@@ -0,0 +1,370 @@
+#ifndef MIXEDYALE_HPP
+#define MIXEDYALE_HPP
+
+#include <complex>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "BFloat16.hpp"
+#include "Comparators.hpp"
+#include "CompressedKernels.hpp"
+#include "Concepts.hpp"
+#include "Dimensions.hpp"
+#include "LineView.hpp"
+#include "MatrixMarket.hpp"
+#include "Parallel.hpp"
+
+using namespace comparators;
+namespace algebra {
+
+/// @brief Represents a matrix in YALE (compressed) format whose values are
+/// stored with a type different from the one of the elements, e.g. `float`
+/// values of a `double` matrix.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam I The type of the outer indexes, i.e. the column indexes in
+/// row-major order.
+/// @tparam P The type of the inner indexes, i.e. the beginning of each line.
+template <NumericOrComplex T, StorageOrder S, StorageFor<T> V,
+          IndexType I = size_t, IndexType P = I>
+class MixedYALE;
+
+/// @brief Performs matrix-vector product.
+/// @param m An object of type MixedYALE representing the matrix, i.e. the
+/// lhs.
+/// @param v The vector, i.e. the rhs.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+template <NumericOrComplex T, StorageOrder S, StorageFor<T> V, IndexType I,
+          IndexType P>
+std::vector<T> by_vector_compressed(class MixedYALE<T, S, V, I, P> const& m,
+                                    std::vector<T> const& v);
+
+/// @brief Performs the matrix-vector product `result = alpha * m * v + beta *
+/// result` writing into a buffer owned by the caller.
+/// @param m An object of type MixedYALE representing the matrix, i.e. the
+/// lhs.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer, it must hold `m.get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+template <NumericOrComplex T, StorageOrder S, StorageFor<T> V, IndexType I,
+          IndexType P>
+void by_vector_compressed(class MixedYALE<T, S, V, I, P> const& m,
+                          std::span<T const> v, std::span<T> result, T alpha,
+                          T beta);
+
+/// @brief Performs the matrix-vector product `result = alpha * m * v + beta *
+/// result` on multiple threads.
+/// @param m An object of type MixedYALE representing the matrix, i.e. the
+/// lhs.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer, it must hold `m.get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+template <NumericOrComplex T, StorageOrder S, StorageFor<T> V, IndexType I,
+          IndexType P>
+void by_vector_compressed_parallel(class MixedYALE<T, S, V, I, P> const& m,
+                                   std::span<T const> v, std::span<T> result,
+                                   T alpha, T beta, unsigned num_threads);
+
+/// @brief Performs the transpose product `result = alpha * m^T * v + beta *
+/// result` writing into a buffer owned by the caller.
+/// @param m An object of type MixedYALE representing the matrix, i.e. the
+/// lhs.
+/// @param v The vector, it must hold `m.get_rows()` elements.
+/// @param result The output buffer, it must hold `m.get_columns()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+template <NumericOrComplex T, StorageOrder S, StorageFor<T> V, IndexType I,
+          IndexType P>
+void by_vector_transpose_compressed(class MixedYALE<T, S, V, I, P> const& m,
+                                    std::span<T const> v, std::span<T> result,
+                                    T alpha, T beta);
+
+/// @brief Performs the transpose product `result = alpha * m^T * v + beta *
+/// result` on multiple threads.
+/// @param m An object of type MixedYALE representing the matrix, i.e. the
+/// lhs.
+/// @param v The vector, it must hold `m.get_rows()` elements.
+/// @param result The output buffer, it must hold `m.get_columns()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+template <NumericOrComplex T, StorageOrder S, StorageFor<T> V, IndexType I,
+          IndexType P>
+void by_vector_transpose_compressed_parallel(
+    class MixedYALE<T, S, V, I, P> const& m, std::span<T const> v,
+    std::span<T> result, T alpha, T beta, unsigned num_threads);
+
+/// @brief Performs the matrix-vector product `y = m * x` and computes `x^H *
+/// y` in the same sweep.
+/// @param m An object of type MixedYALE representing a square matrix.
+/// @param x The vector, i.e. the rhs.
+/// @param y The output buffer, as long as `x`.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @return The dot product `x^H * y`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+template <NumericOrComplex T, StorageOrder S, StorageFor<T> V, IndexType I,
+          IndexType P>
+T by_vector_dot_compressed(class MixedYALE<T, S, V, I, P> const& m,
+                           std::span<T const> x, std::span<T> y,
+                           unsigned num_threads);
+
+/// @brief Updates a residual, `r -= alpha * m * p`, and computes its squared
+/// norm in the same sweep.
+/// @param m An object of type MixedYALE representing the matrix, i.e. the
+/// lhs.
+/// @param p The vector, i.e. the rhs.
+/// @param r The residual, it must hold `m.get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @return The squared euclidean norm of the updated `r`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+template <NumericOrComplex T, StorageOrder S, StorageFor<T> V, IndexType I,
+          IndexType P>
+double residual_compressed(class MixedYALE<T, S, V, I, P> const& m,
+                           std::span<T const> p, std::span<T> r, T alpha,
+                           unsigned num_threads);
+
+/// @brief Finds the positions of the diagonal elements in the values array.
+/// @param m An object of type MixedYALE.
+/// @return The position of each element `(i, i)`, or `no_position` if it's
+/// not stored.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+template <NumericOrComplex T, StorageOrder S, StorageFor<T> V, IndexType I,
+          IndexType P>
+std::vector<size_t> diagonal_positions_compressed(
+    class MixedYALE<T, S, V, I, P> const& m);
+
+/// @brief Gets the range of the lines and of the elements of the matrix.
+/// @param m An object of type MixedYALE.
+/// @return The range, holding spans into the arrays of `m`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+template <NumericOrComplex T, StorageOrder S, StorageFor<T> V, IndexType I,
+          IndexType P>
+CompressedLines<T, S, V, P, I> lines_compressed(
+    class MixedYALE<T, S, V, I, P> const& m);
+
+/// @details The arrays are laid out as in `YALE`, but the values are
+/// converted to `V` when the matrix is compressed and back to `T` when they
+/// are read: the products accumulate in `T`, so the only error is the
+/// rounding of each element, and they move `sizeof(V)` bytes per value
+/// instead of `sizeof(T)`. With `float` values and 32-bit indexes an element
+/// takes 8 bytes instead of the 16 of `YALE`, which suits matrices whose
+/// elements don't need the full precision, e.g. preconditioners. A rounded
+/// value can't be referenced as a `T`, so the elements can't be written in
+/// compressed state: `m(i, j) = value` doesn't compile, the matrix must be
+/// uncompressed, changed and compressed again.
+template <NumericOrComplex T, StorageOrder S, StorageFor<T> V, IndexType I,
+          IndexType P>
+class MixedYALE : virtual public Dimensions {
+    using innervec = std::vector<P>;   ///< Vector of inner indices.
+    using outervec = std::vector<I>;   ///< Vector of outer indices.
+    using valuesvec = std::vector<V>;  ///< Vector of stored values.
+
+   protected:
+    /// @brief Default constructor for the MixedYALE class.
+    MixedYALE() = default;
+
+    /// @brief Constructs a MixedYALE matrix by reading a Matrix Market file.
+    /// @tparam B Boolean constant to indicate wether the matrix' size was given
+    /// as input.
+    /// @param file_name The name of the file to read the data from.
+    /// @param num_threads The number of threads, zero means as many as the
+    /// hardware supports.
+    template <bool B>
+    MixedYALE(std::bool_constant<B>, std::string const& file_name,
+              unsigned num_threads = 0);
+
+    /// @brief In the process of uncompressing the matrix sends all the
+    /// triplets, coherently with the storage order.
+    /// @tparam F The type of the receiver.
+    /// @param receiver A callable taking the row index, the column index and
+    /// the value of each element.
+    template <typename F>
+    void uncompress_from_compressed(F&& receiver) const;
+
+    /// @brief Builds the data structure from the triplets sent by another
+    /// format, rounding the values.
+    /// @tparam F The type of the sender.
+    /// @param num_elements The number of triplets that will be sent.
+    /// @param sender A callable taking a receiver and calling it on every
+    /// triplet, coherently with the storage order.
+    template <typename F>
+    void compress_from_triplets(size_t num_elements, F&& sender);
+
+    /// @brief Gets the number of non-zero elements.
+    /// @return The number of non-zero elements.
+    size_t get_num_elements_compressed() const;
+
+    /// @brief Releases the compressed storage format.
+    void release_compressed();
+
+    /// @brief Computes the inner and outer indexes for a given position.
+    /// @param i The row index.
+    /// @param j The column index.
+    /// @return A pair representing the inner and outer indexes.
+    std::pair<size_t, size_t> inner_outer(size_t i, size_t j) const;
+
+    /// @brief Checks if the indexes of a matrix can be stored in the index
+    /// types.
+    /// @param outer_extent The number of columns in row-major order, of rows
+    /// in column-major order.
+    /// @param num_elements The number of non-zero elements.
+    /// @return True if no index would overflow.
+    static bool fits_indexes(size_t outer_extent, size_t num_elements);
+
+    std::unique_ptr<outervec>
+        outerindex_ptr;  ///< Pointer to the outer index vector.
+    std::unique_ptr<innervec>
+        innerindex_ptr;  ///< Pointer to the inner index vector.
+    std::unique_ptr<valuesvec> values_ptr;  ///< Pointer to the values vector.
+
+   public:
+    /// @brief Finds the value at the specified position (read-only).
+    /// @param i The row index.
+    /// @param j The column index.
+    /// @return The value at the specified position, converted to `T`.
+    T find_compressed_const(size_t i, size_t j) const;
+
+    /// @brief Removes the element at the specified position.
+    /// @param i The row index.
+    /// @param j The column index.
+    /// @return True if the element was removed, false otherwise.
+    bool remove_compressed(size_t i, size_t j);
+
+    /// @brief Removes all the elements satisfying a predicate.
+    /// @tparam F The type of the predicate.
+    /// @param pred A callable taking the row index, the column index and the
+    /// value of each element, converted to `T`, and returning true if it has
+    /// to be removed.
+    /// @return The number of removed elements.
+    template <typename F>
+    size_t remove_if_compressed(F&& pred);
+
+    /// @brief Prints the matrix in compressed format to the standard output.
+    void print_compressed() const;
+
+    /// @brief Computes the norm of the matrix.
+    /// @tparam N The type of norm to compute (Infinity, One, or Frobenius).
+    /// @return The computed norm value.
+    template <NormType N>
+    double norm_compressed() const;
+
+    /// @brief Gets the inner index vector.
+    /// @return A read-only view of the beginning of each line.
+    std::span<P const> get_inner_indexes() const;
+
+    /// @brief Gets the outer index vector.
+    /// @return A read-only view of the outer index of each element.
+    std::span<I const> get_outer_indexes() const;
+
+    /// @brief Gets the stored values vector.
+    /// @return A read-only view of the stored value of each element.
+    std::span<V const> get_values() const;
+
+    friend std::vector<T> by_vector_compressed<>(
+        MixedYALE<T, S, V, I, P> const& m, std::vector<T> const& v);
+
+    friend void by_vector_compressed<>(MixedYALE<T, S, V, I, P> const& m,
+                                       std::span<T const> v,
+                                       std::span<T> result, T alpha, T beta);
+
+    friend void by_vector_compressed_parallel<>(
+        MixedYALE<T, S, V, I, P> const& m, std::span<T const> v,
+        std::span<T> result, T alpha, T beta, unsigned num_threads);
+};
+
+/// @brief Maps a type of matrix elements to the one with the same kind and
+/// single precision, e.g. `double` to `float`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+template <NumericOrComplex T>
+struct single_precision {
+    using type = float;  ///< The single precision type.
+};
+
+/// @brief Maps a complex type to the complex type with single precision
+/// parts.
+/// @tparam T The type of the real and imaginary parts.
+template <typename T>
+struct single_precision<std::complex<T>> {
+    using type = std::complex<float>;  ///< The single precision type.
+};
+
+/// @brief The single precision type of a type of matrix elements.
+/// @tparam T The type of the matrix elements (numeric or complex).
+template <NumericOrComplex T>
+using single_precision_t = typename single_precision<T>::type;
+
+/// @brief YALE format with single precision values, i.e. `float` or
+/// `std::complex<float>`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+using FloatYALE = MixedYALE<T, S, single_precision_t<T>>;
+
+/// @brief YALE format with single precision values and 32-bit indexes, for
+/// matrices with less than 2^32 columns (rows in column-major order) and
+/// non-zero elements.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+using FloatYALE32 = MixedYALE<T, S, single_precision_t<T>, std::uint32_t>;
+
+/// @brief YALE format with `bfloat16` values, for real matrices.
+/// @tparam T The type of the matrix elements (numeric).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+using BF16YALE = MixedYALE<T, S, bfloat16>;
+
+}  // namespace algebra
+#endif
@@ -0,0 +1,210 @@
+#ifndef SELL_HPP
+#define SELL_HPP
+
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "Comparators.hpp"
+#include "Concepts.hpp"
+#include "Dimensions.hpp"
+#include "Parallel.hpp"
+
+using namespace comparators;
+namespace algebra {
+
+/// @brief Represents a matrix in SELL-C-sigma (compressed) format.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+class SELL;
+
+/// @brief Performs matrix-vector product.
+/// @param m An object of type SELL representing the matrix, i.e. the lhs.
+/// @param v The vector, i.e. the rhs.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+std::vector<T> by_vector_compressed(class SELL<T, S> const& m,
+                                    std::vector<T> const& v);
+
+/// @brief Performs the matrix-vector product `result = alpha * m * v + beta *
+/// result` writing into a buffer owned by the caller.
+/// @param m An object of type SELL representing the matrix, i.e. the lhs.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer, it must hold `m.get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+void by_vector_compressed(class SELL<T, S> const& m, std::span<T const> v,
+                          std::span<T> result, T alpha, T beta);
+
+/// @brief Performs the matrix-vector product `result = alpha * m * v + beta *
+/// result` on multiple threads.
+/// @param m An object of type SELL representing the matrix, i.e. the lhs.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer, it must hold `m.get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+void by_vector_compressed_parallel(class SELL<T, S> const& m,
+                                   std::span<T const> v, std::span<T> result,
+                                   T alpha, T beta, unsigned num_threads);
+
+/// @brief Performs the row-major product on a range of chunks.
+/// @param m An object of type SELL representing the matrix, i.e. the lhs.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @param first The first chunk.
+/// @param last One past the last chunk.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+void multiply_chunks(class SELL<T, S> const& m, std::span<T const> v,
+                     std::span<T> result, T alpha, T beta, size_t first,
+                     size_t last);
+
+/// @details Lines (rows in row-major order, columns in column-major order) are
+/// sorted by decreasing length inside windows of `sigma` lines and grouped in
+/// chunks of `chunk` consecutive lines. Each chunk is padded to the length of
+/// its longest line and stored slot by slot, so that the k-th elements of the
+/// lines of a chunk are contiguous in memory and can be processed with a
+/// single SIMD instruction. Padding slots hold a zero value and the outer
+/// index 0, and are masked out by the products using the line lengths.
+template <NumericOrComplex T, StorageOrder S>
+class SELL : virtual public Dimensions {
+    using indexvec = std::vector<size_t>;  ///< Vector of indices.
+    using valuesvec = std::vector<T>;      ///< Vector of matrix values.
+
+   public:
+    static constexpr size_t chunk = 8;  ///< Number of lines in a chunk.
+    static constexpr size_t sigma =
+        32 * chunk;  ///< Number of lines in a sorting window.
+
+   protected:
+    /// @brief Default constructor for the SELL class.
+    SELL() = default;
+
+    /// @brief Constructs a SELL matrix from YALE-like compressed data.
+    /// @tparam B Boolean constant to indicate wether the matrix' size was given
+    /// as input.
+    /// @param out The outer index container.
+    /// @param in The inner index container.
+    /// @param val The container of matrix values.
+    template <bool B>
+    SELL(std::bool_constant<B>, SizetContainer auto const& out,
+         SizetContainer auto const& in, NumericContainer auto const& val);
+
+    /// @brief In the process of uncompressing the matrix sends all the
+    /// triplets, coherently with the storage order.
+    /// @tparam F The type of the receiver.
+    /// @param receiver A callable taking the row index, the column index and
+    /// the value of each element.
+    template <typename F>
+    void uncompress_from_compressed(F&& receiver) const;
+
+    /// @brief Builds the data structure from the triplets sent by another
+    /// format.
+    /// @tparam F The type of the sender.
+    /// @param num_elements The number of triplets that will be sent.
+    /// @param sender A callable taking a receiver and calling it on every
+    /// triplet, coherently with the storage order.
+    template <typename F>
+    void compress_from_triplets(size_t num_elements, F&& sender);
+
+    /// @brief Gets the number of non-zero elements.
+    /// @return The number of non-zero elements.
+    size_t get_num_elements_compressed() const;
+
+    /// @brief Releases the compressed storage format.
+    void release_compressed();
+
+    /// @brief Computes the inner and outer indexes for a given position.
+    /// @param i The row index.
+    /// @param j The column index.
+    /// @return A pair representing the inner and outer indexes.
+    std::pair<size_t, size_t> inner_outer(size_t i, size_t j) const;
+
+    /// @brief Builds the sliced layout from lines stored contiguously.
+    /// @param lengths The length of each line.
+    /// @param outer The outer indexes, line after line.
+    /// @param vals The values, line after line.
+    void build_slices(indexvec const& lengths, indexvec const& outer,
+                      valuesvec const& vals);
+
+    /// @brief Gets the position of the k-th element of a sorted line.
+    /// @param r The position of the line after sorting.
+    /// @param k The position of the element in the line.
+    /// @return The position in the outer index and values vectors.
+    size_t slot(size_t r, size_t k) const;
+
+    std::unique_ptr<indexvec>
+        chunkptr_ptr;  ///< Pointer to the first slot of each chunk.
+    std::unique_ptr<indexvec>
+        chunklen_ptr;  ///< Pointer to the length of each chunk.
+    std::unique_ptr<indexvec>
+        linelen_ptr;  ///< Pointer to the length of each sorted line.
+    std::unique_ptr<indexvec>
+        permutation_ptr;  ///< Pointer to the line stored at each position.
+    std::unique_ptr<indexvec>
+        position_ptr;  ///< Pointer to the position of each line.
+    std::unique_ptr<indexvec>
+        outerindex_ptr;  ///< Pointer to the outer index vector.
+    std::unique_ptr<valuesvec> values_ptr;  ///< Pointer to the values vector.
+    size_t num_elements = 0;  ///< Number of non-zero elements.
+
+   public:
+    /// @brief Finds the value at the specified position (read-only).
+    /// @param i The row index.
+    /// @param j The column index.
+    /// @return The value at the specified position.
+    T find_compressed_const(size_t i, size_t j) const;
+
+    /// @brief Finds the value at the specified position (read-write).
+    /// @param i The row index.
+    /// @param j The column index.
+    /// @return A reference to the value at the specified position.
+    T& find_compressed(size_t i, size_t j);
+
+    /// @brief Removes the element at the specified position.
+    /// @param i The row index.
+    /// @param j The column index.
+    /// @return True if the element was removed, false otherwise.
+    bool remove_compressed(size_t i, size_t j);
+
+    /// @brief Prints the matrix in compressed format to the standard output.
+    void print_compressed() const;
+
+    /// @brief Computes the norm of the matrix.
+    /// @tparam N The type of norm to compute (Infinity, One, or Frobenius).
+    /// @return The computed norm value.
+    template <NormType N>
+    double norm_compressed() const;
+
+    friend std::vector<T> by_vector_compressed<>(SELL<T, S> const& m,
+                                                 std::vector<T> const& v);
+
+    friend void by_vector_compressed<>(SELL<T, S> const& m,
+                                       std::span<T const> v,
+                                       std::span<T> result, T alpha, T beta);
+
+    friend void multiply_chunks<>(SELL<T, S> const& m, std::span<T const> v,
+                                  std::span<T> result, T alpha, T beta,
+                                  size_t first, size_t last);
+
+    friend void by_vector_compressed_parallel<>(SELL<T, S> const& m,
+                                                std::span<T const> v,
+                                                std::span<T> result, T alpha,
+                                                T beta, unsigned num_threads);
+};
+
+}  // namespace algebra
+#endif
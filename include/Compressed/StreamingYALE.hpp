@@ -0,0 +1,97 @@
+#ifndef STREAMINGYALE_HPP
+#define STREAMINGYALE_HPP
+
+#include <array>
+#include <fstream>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "Comparators.hpp"
+#include "Concepts.hpp"
+#include "Dimensions.hpp"
+#include "Snapshot.hpp"
+
+using namespace comparators;
+namespace algebra {
+
+/// @brief Represents a read-only row-major YALE matrix whose products read a
+/// binary snapshot from the disk one panel of rows at a time, e.g. for
+/// matrices larger than the memory.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @details Only the header of the snapshot written by `YALE::save_snapshot`
+/// is read by the constructor. A product reads the panels in order into two
+/// buffers: while the rows of one panel are multiplied, the next panel is
+/// read into the other buffer by a background task, so the memory used is
+/// the one of the two largest panels, whatever the size of the matrix. A
+/// snapshot that doesn't match the template arguments, index types included,
+/// or that is truncated, gives an empty matrix. The arrays are checked as
+/// the panels are read: a product reaching a corrupted panel throws
+/// `std::runtime_error` and leaves the matrix invalid.
+template <NumericOrComplex T, IndexType I = size_t, IndexType P = I>
+class StreamingYALE : public Dimensions {
+   public:
+    /// @brief Opens a binary snapshot.
+    /// @param file_name The name of the file written by `save_snapshot`.
+    /// @param panel_rows The number of rows read at a time.
+    explicit StreamingYALE(std::string const& file_name,
+                           size_t panel_rows = 4096);
+
+    StreamingYALE(StreamingYALE const&) = delete;
+    StreamingYALE& operator=(StreamingYALE const&) = delete;
+
+    /// @brief Checks if the snapshot was opened successfully.
+    /// @return True if the snapshot matched the template arguments.
+    bool is_valid() const;
+
+    /// @brief Gets the number of non-zero elements in the matrix.
+    /// @return The number of non-zero elements.
+    size_t get_num_elements() const;
+
+    /// @brief Gets the number of rows read at a time.
+    /// @return The number of rows of a panel.
+    size_t get_panel_rows() const;
+
+    /// @brief Gets the number of panels read by a product.
+    /// @return The number of panels.
+    size_t get_num_panels() const;
+
+    /// @brief Gets the memory held by the panel buffers.
+    /// @return The number of bytes, zero before the first product.
+    size_t get_resident_bytes() const;
+
+    /// @brief Performs the matrix-vector product `y = alpha * A * x + beta *
+    /// y` writing into a buffer owned by the caller.
+    /// @param x The vector, i.e. the rhs.
+    /// @param y The output buffer, it must hold `get_rows()` elements.
+    /// @param alpha The scaling factor of the product.
+    /// @param beta The scaling factor of the previous content of `y`.
+    /// @param num_threads The number of threads of the product of each
+    /// panel, zero means as many as the hardware supports.
+    void multiply_into(std::span<T const> x, std::span<T> y, T alpha = T{1},
+                       T beta = T{0}, unsigned num_threads = 1);
+
+   private:
+    /// @brief The compressed arrays of a panel of rows.
+    struct Panel {
+        std::vector<P> inner;   ///< The beginning of each row in the panel.
+        std::vector<I> outer;   ///< The column of each element.
+        std::vector<T> values;  ///< The value of each element.
+    };
+
+    /// @brief Reads a panel of rows from the snapshot.
+    /// @param k The index of the panel.
+    /// @param panel The buffer to fill, reused from the previous panels.
+    void load_panel(size_t k, Panel& panel);
+
+    std::ifstream file;              ///< The snapshot.
+    SnapshotHeader header{};         ///< The header of the snapshot.
+    size_t panel_rows;               ///< The number of rows of a panel.
+    bool valid = false;              ///< True if the snapshot was opened.
+    std::array<Panel, 2> panels;     ///< The double buffer of panels.
+};
+
+}  // namespace algebra
+#endif
@@ -0,0 +1,264 @@
+#ifndef SYMYALE_HPP
+#define SYMYALE_HPP
+
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "Comparators.hpp"
+#include "CompressedKernels.hpp"
+#include "Concepts.hpp"
+#include "Dimensions.hpp"
+#include "MatrixMarket.hpp"
+#include "Parallel.hpp"
+
+using namespace comparators;
+namespace algebra {
+
+/// @brief Represents a symmetric matrix in YALE (compressed) format, storing
+/// only its lower triangle.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+class SymYALE;
+
+/// @brief Performs matrix-vector product.
+/// @param m An object of type SymYALE representing the matrix, i.e. the lhs.
+/// @param v The vector, i.e. the rhs.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+std::vector<T> by_vector_compressed(class SymYALE<T, S> const& m,
+                                    std::vector<T> const& v);
+
+/// @brief Performs the matrix-vector product `result = alpha * m * v + beta *
+/// result` writing into a buffer owned by the caller.
+/// @param m An object of type SymYALE representing the matrix, i.e. the lhs.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer, it must hold `m.get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+void by_vector_compressed(class SymYALE<T, S> const& m, std::span<T const> v,
+                          std::span<T> result, T alpha, T beta);
+
+/// @brief Performs the matrix-vector product `result = alpha * m * v + beta *
+/// result` on multiple threads.
+/// @param m An object of type SymYALE representing the matrix, i.e. the lhs.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer, it must hold `m.get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+void by_vector_compressed_parallel(class SymYALE<T, S> const& m,
+                                   std::span<T const> v, std::span<T> result,
+                                   T alpha, T beta, unsigned num_threads);
+
+/// @brief Performs the transpose product `result = alpha * m^T * v + beta *
+/// result`, the same as the direct one.
+/// @param m An object of type SymYALE representing the matrix, i.e. the lhs.
+/// @param v The vector, it must hold `m.get_rows()` elements.
+/// @param result The output buffer, it must hold `m.get_columns()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+void by_vector_transpose_compressed(class SymYALE<T, S> const& m,
+                                    std::span<T const> v, std::span<T> result,
+                                    T alpha, T beta);
+
+/// @brief Performs the transpose product `result = alpha * m^T * v + beta *
+/// result` on multiple threads, the same as the direct one.
+/// @param m An object of type SymYALE representing the matrix, i.e. the lhs.
+/// @param v The vector, it must hold `m.get_rows()` elements.
+/// @param result The output buffer, it must hold `m.get_columns()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+void by_vector_transpose_compressed_parallel(class SymYALE<T, S> const& m,
+                                             std::span<T const> v,
+                                             std::span<T> result, T alpha,
+                                             T beta, unsigned num_threads);
+
+/// @brief Finds the positions of the diagonal elements in the values array.
+/// @param m An object of type SymYALE.
+/// @return The position of each element `(i, i)`, or `no_position` if it's
+/// not stored.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+std::vector<size_t> diagonal_positions_compressed(
+    class SymYALE<T, S> const& m);
+
+/// @details Only the elements on and below the diagonal are stored, laid out
+/// as in YALE: in row-major order each line holds the columns up to the
+/// diagonal, in column-major order the rows from the diagonal on. Every
+/// position above the diagonal reads, writes and removes its mirrored
+/// element, so the matrix is symmetric by construction and takes about half
+/// the memory and half the bandwidth of YALE, while `get_num_elements` still
+/// counts the elements of the whole matrix. Values are mirrored as they are,
+/// i.e. complex matrices are symmetric, not Hermitian.
+template <NumericOrComplex T, StorageOrder S>
+class SymYALE : virtual public Dimensions {
+    using indexvec = std::vector<size_t>;  ///< Vector of indices.
+    using valuesvec = std::vector<T>;      ///< Vector of matrix values.
+
+   protected:
+    /// @brief Default constructor for the SymYALE class.
+    SymYALE() = default;
+
+    /// @brief Constructs a SymYALE matrix from the compressed format data of
+    /// its lower triangle.
+    /// @tparam B Boolean constant to indicate wether the matrix' size was given
+    /// as input.
+    /// @param out The outer index container.
+    /// @param in The inner index container.
+    /// @param val The container of matrix values.
+    template <bool B>
+    SymYALE(std::bool_constant<B>, SizetContainer auto const& out,
+            SizetContainer auto const& in, NumericContainer auto const& val);
+
+    /// @brief Constructs a SymYALE matrix by reading a Matrix Market file.
+    /// @tparam B Boolean constant to indicate wether the matrix' size was given
+    /// as input.
+    /// @param file_name The name of the file to read the data from.
+    /// @param num_threads The number of threads, zero means as many as the
+    /// hardware supports.
+    template <bool B>
+    SymYALE(std::bool_constant<B>, std::string const& file_name,
+            unsigned num_threads = 0);
+
+    /// @brief In the process of uncompressing the matrix sends all the
+    /// triplets of the whole matrix, coherently with the storage order.
+    /// @tparam F The type of the receiver.
+    /// @param receiver A callable taking the row index, the column index and
+    /// the value of each element.
+    template <typename F>
+    void uncompress_from_compressed(F&& receiver) const;
+
+    /// @brief Builds the data structure from the triplets sent by another
+    /// format, keeping the lower triangle.
+    /// @tparam F The type of the sender.
+    /// @param num_elements The number of triplets that will be sent.
+    /// @param sender A callable taking a receiver and calling it on every
+    /// triplet, coherently with the storage order.
+    template <typename F>
+    void compress_from_triplets(size_t num_elements, F&& sender);
+
+    /// @brief Gets the number of non-zero elements of the whole matrix.
+    /// @return The number of non-zero elements.
+    size_t get_num_elements_compressed() const;
+
+    /// @brief Releases the compressed storage format.
+    void release_compressed();
+
+    /// @brief Computes the inner and outer indexes of the stored element for
+    /// a given position.
+    /// @param i The row index.
+    /// @param j The column index.
+    /// @return A pair representing the inner and outer indexes in the lower
+    /// triangle.
+    std::pair<size_t, size_t> inner_outer(size_t i, size_t j) const;
+
+    /// @brief Counts the stored elements on the diagonal.
+    void count_diagonal();
+
+    /// @brief Checks that the elements above the diagonal mirror the stored
+    /// ones.
+    /// @param upper The mirrored position of each element above the diagonal.
+    /// @param upper_values The value of each element above the diagonal.
+    /// @param num_lower The number of stored elements below the diagonal.
+    /// @return True if the two triangles are the mirror of each other.
+    bool mirrors_lower(std::vector<std::pair<size_t, size_t>> const& upper,
+                       std::vector<T> const& upper_values,
+                       size_t num_lower) const;
+
+    std::unique_ptr<indexvec>
+        outerindex_ptr;  ///< Pointer to the outer index vector.
+    std::unique_ptr<indexvec>
+        innerindex_ptr;  ///< Pointer to the inner index vector.
+    std::unique_ptr<valuesvec> values_ptr;  ///< Pointer to the values vector.
+    size_t num_diagonal = 0;  ///< Number of stored elements on the diagonal.
+
+   public:
+    /// @brief Finds the value at the specified position (read-only).
+    /// @param i The row index.
+    /// @param j The column index.
+    /// @return The value at the specified position.
+    T find_compressed_const(size_t i, size_t j) const;
+
+    /// @brief Finds the value at the specified position (read-write).
+    /// @param i The row index.
+    /// @param j The column index.
+    /// @return A reference to the value at the specified position, shared
+    /// with the mirrored position.
+    T& find_compressed(size_t i, size_t j);
+
+    /// @brief Removes the element at the specified position, together with
+    /// its mirrored element.
+    /// @param i The row index.
+    /// @param j The column index.
+    /// @return True if the element was removed, false otherwise.
+    bool remove_compressed(size_t i, size_t j);
+
+    /// @brief Removes all the elements satisfying a predicate.
+    /// @tparam F The type of the predicate.
+    /// @param pred A callable taking the row index, the column index and the
+    /// value of each stored element, i.e. of the lower triangle, and returning
+    /// true if it has to be removed together with its mirrored element.
+    /// @return The number of removed elements of the whole matrix.
+    template <typename F>
+    size_t remove_if_compressed(F&& pred);
+
+    /// @brief Prints the matrix in compressed format to the standard output.
+    void print_compressed() const;
+
+    /// @brief Computes the norm of the matrix.
+    /// @tparam N The type of norm to compute (Infinity, One, or Frobenius).
+    /// @return The computed norm value.
+    template <NormType N>
+    double norm_compressed() const;
+
+    /// @brief Gets the number of stored elements, i.e. the non-zero elements
+    /// of the lower triangle.
+    /// @return The number of stored elements.
+    size_t get_num_stored_elements() const;
+
+    /// @brief Gets the inner index vector of the lower triangle.
+    /// @return A read-only view of the beginning of each line.
+    std::span<size_t const> get_inner_indexes() const;
+
+    /// @brief Gets the outer index vector of the lower triangle.
+    /// @return A read-only view of the outer index of each element.
+    std::span<size_t const> get_outer_indexes() const;
+
+    /// @brief Gets the values vector of the lower triangle.
+    /// @return A read-only view of the value of each element.
+    std::span<T const> get_values() const;
+
+    friend std::vector<T> by_vector_compressed<>(SymYALE<T, S> const& m,
+                                                 std::vector<T> const& v);
+
+    friend void by_vector_compressed<>(SymYALE<T, S> const& m,
+                                       std::span<T const> v,
+                                       std::span<T> result, T alpha, T beta);
+
+    friend void by_vector_compressed_parallel<>(SymYALE<T, S> const& m,
+                                                std::span<T const> v,
+                                                std::span<T> result, T alpha,
+                                                T beta, unsigned num_threads);
+};
+
+}  // namespace algebra
+#endif
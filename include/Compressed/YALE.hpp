@@ -1,12 +1,21 @@
 #ifndef YALE_HPP
 #define YALE_HPP
 
+#include <cstdint>
+#include <limits>
 #include <memory>
+#include <span>
 #include <vector>
 
+#include "BlockKernels.hpp"
 #include "Comparators.hpp"
+#include "CompressedKernels.hpp"
 #include "Concepts.hpp"
 #include "Dimensions.hpp"
+#include "LineView.hpp"
+#include "MatrixMarket.hpp"
+#include "Parallel.hpp"
+#include "Snapshot.hpp"
 
 using namespace comparators;
 namespace algebra {
@@ -14,7 +23,11 @@ namespace algebra {
 /// @brief Represents a matrix in YALE (compressed) format.
 /// @tparam T The type of the matrix elements (numeric or complex).
 /// @tparam S The storage order (row-major or column-major).
-template <NumericOrComplex T, StorageOrder S>
+/// @tparam I The type of the outer indexes, i.e. the column indexes in
+/// row-major order.
+/// @tparam P The type of the inner indexes, i.e. the beginning of each line.
+template <NumericOrComplex T, StorageOrder S, IndexType I = size_t,
+          IndexType P = I>
 class YALE;
 
 /// @brief Performs matrix-vector product.
@@ -22,16 +35,167 @@ class YALE;
 /// @param v The vector, i.e. the rhs.
 /// @tparam T The type of the matrix elements (numeric or complex).
 /// @tparam S The storage order (row-major or column-major).
-template <NumericOrComplex T, StorageOrder S>
-std::vector<T> by_vector_compressed(class YALE<T, S> const& m,
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+std::vector<T> by_vector_compressed(class YALE<T, S, I, P> const& m,
                                     std::vector<T> const& v);
 
-template <NumericOrComplex T, StorageOrder S>
+/// @brief Performs the matrix-vector product `result = alpha * m * v + beta *
+/// result` writing into a buffer owned by the caller.
+/// @param m An object of type YALE representing the matrix, i.e. the lhs.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer, it must hold `m.get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+void by_vector_compressed(class YALE<T, S, I, P> const& m, std::span<T const> v,
+                          std::span<T> result, T alpha, T beta);
+
+/// @brief Performs the matrix-vector product `result = alpha * m * v + beta *
+/// result` on multiple threads.
+/// @param m An object of type YALE representing the matrix, i.e. the lhs.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer, it must hold `m.get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+void by_vector_compressed_parallel(class YALE<T, S, I, P> const& m,
+                                   std::span<T const> v, std::span<T> result,
+                                   T alpha, T beta, unsigned num_threads);
+
+/// @brief Performs the product `y = alpha * m * x + beta * y` with a dense
+/// block of `k` vectors.
+/// @param m An object of type YALE representing the matrix, i.e. the lhs.
+/// @param x The rhs block, row-major with `k` columns.
+/// @param y The output block, row-major with `k` columns, it must hold `k *
+/// m.get_rows()` elements.
+/// @param k The number of vectors in the blocks.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `y`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+void by_block_compressed(class YALE<T, S, I, P> const& m, std::span<T const> x,
+                         std::span<T> y, size_t k, T alpha, T beta);
+
+/// @brief Performs the transpose product `result = alpha * m^T * v + beta *
+/// result` writing into a buffer owned by the caller.
+/// @param m An object of type YALE representing the matrix, i.e. the lhs.
+/// @param v The vector, it must hold `m.get_rows()` elements.
+/// @param result The output buffer, it must hold `m.get_columns()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+void by_vector_transpose_compressed(class YALE<T, S, I, P> const& m,
+                                    std::span<T const> v, std::span<T> result,
+                                    T alpha, T beta);
+
+/// @brief Performs the transpose product `result = alpha * m^T * v + beta *
+/// result` on multiple threads.
+/// @param m An object of type YALE representing the matrix, i.e. the lhs.
+/// @param v The vector, it must hold `m.get_rows()` elements.
+/// @param result The output buffer, it must hold `m.get_columns()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+void by_vector_transpose_compressed_parallel(class YALE<T, S, I, P> const& m,
+                                             std::span<T const> v,
+                                             std::span<T> result, T alpha,
+                                             T beta, unsigned num_threads);
+
+/// @brief Performs the matrix-vector product `y = m * x` and computes `x^H *
+/// y` in the same sweep.
+/// @param m An object of type YALE representing a square matrix.
+/// @param x The vector, i.e. the rhs.
+/// @param y The output buffer, as long as `x`.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @return The dot product `x^H * y`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+T by_vector_dot_compressed(class YALE<T, S, I, P> const& m,
+                           std::span<T const> x, std::span<T> y,
+                           unsigned num_threads);
+
+/// @brief Updates a residual, `r -= alpha * m * p`, and computes its squared
+/// norm in the same sweep.
+/// @param m An object of type YALE representing the matrix, i.e. the lhs.
+/// @param p The vector, i.e. the rhs.
+/// @param r The residual, it must hold `m.get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @return The squared euclidean norm of the updated `r`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+double residual_compressed(class YALE<T, S, I, P> const& m,
+                           std::span<T const> p, std::span<T> r, T alpha,
+                           unsigned num_threads);
+
+/// @brief Finds the positions of the diagonal elements in the values array.
+/// @param m An object of type YALE.
+/// @return The position of each element `(i, i)`, or `no_position` if it's
+/// not stored.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+std::vector<size_t> diagonal_positions_compressed(
+    class YALE<T, S, I, P> const& m);
+
+/// @brief Gets the range of the lines and of the elements of the matrix.
+/// @param m An object of type YALE.
+/// @return The range, holding spans into the arrays of `m`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+CompressedLines<T, S, T, P, I> lines_compressed(
+    class YALE<T, S, I, P> const& m);
+
+/// @details The outer indexes are bounded by the number of columns (rows in
+/// column-major order) and the inner indexes by the number of non-zero
+/// elements, so they can be stored in types narrower than `size_t`: with
+/// 32-bit indexes the index arrays, that account for most of the memory
+/// traffic of a product, take half the space. The conversions are checked
+/// in every build when the matrix is built or grows, and indexes that don't
+/// fit throw `std::overflow_error` instead of being truncated.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
 class YALE : virtual public Dimensions {
-    using indexvec = std::vector<size_t>;  ///< Vector of indices.
-    using valuesvec = std::vector<T>;      ///< Vector of matrix values.
-    using ivtuple = std::tuple<size_t, size_t,
-                               T>;  ///< Tuple representing a matrix element.
+    using innervec = std::vector<P>;   ///< Vector of inner indices.
+    using outervec = std::vector<I>;   ///< Vector of outer indices.
+    using valuesvec = std::vector<T>;  ///< Vector of matrix values.
 
    protected:
     /// @brief Default constructor for the YALE class.
@@ -47,28 +211,45 @@ class YALE : virtual public Dimensions {
     YALE(std::bool_constant<B>, SizetContainer auto const& out,
          SizetContainer auto const& in, NumericContainer auto const& val);
 
-    /// @brief In the process of compressing the matrix sends the next tuple.
-    /// @param first_it Flags the first iteration.
-    /// @param tupleptr Pointer to a tuple representing a matrix element.
-    void uncompress_from_compressed(bool first_it,
-                                    std::unique_ptr<ivtuple> const& tupleptr);
+    /// @brief Constructs a YALE matrix by reading a Matrix Market file.
+    /// @tparam B Boolean constant to indicate wether the matrix' size was given
+    /// as input.
+    /// @param file_name The name of the file to read the data from.
+    /// @param num_threads The number of threads, zero means as many as the
+    /// hardware supports.
+    template <bool B>
+    YALE(std::bool_constant<B>, std::string const& file_name,
+         unsigned num_threads = 0);
+
+    /// @brief In the process of uncompressing the matrix sends all the
+    /// triplets, coherently with the storage order.
+    /// @tparam F The type of the receiver.
+    /// @param receiver A callable taking the row index, the column index and
+    /// the value of each element.
+    template <typename F>
+    void uncompress_from_compressed(F&& receiver) const;
+
+    /// @brief Builds the data structure from the triplets sent by another
+    /// format.
+    /// @tparam F The type of the sender.
+    /// @param num_elements The number of triplets that will be sent.
+    /// @param sender A callable taking a receiver and calling it on every
+    /// triplet, coherently with the storage order.
+    template <typename F>
+    void compress_from_triplets(size_t num_elements, F&& sender);
 
-    /// @brief Takes a triplet and inserts it into the data structure.
-    /// @param last_it Flags the last iteration.
-    /// @param tupleptr Pointer to a tuple representing a matrix element.
-    void compress_from_triplets(bool last_it,
-                                std::unique_ptr<ivtuple> const& tupleptr);
+    /// @brief Replaces the compressed arrays with the ones filled by a
+    /// builder.
+    /// @tparam F The type of the builder.
+    /// @param builder A callable taking the inner index, the outer index and
+    /// the values vectors, empty, and filling them.
+    template <typename F>
+    void build_compressed(F&& builder);
 
     /// @brief Gets the number of non-zero elements.
     /// @return The number of non-zero elements.
     size_t get_num_elements_compressed() const;
 
-    /// @brief Initializes the compressed storage format.
-    /// @param insize The size of the inner index vector.
-    /// @param outsize The size of the outer index vector.
-    /// @param valsize The size of the values vector.
-    void initialize_compressed(size_t insize, size_t outsize, size_t valsize);
-
     /// @brief Releases the compressed storage format.
     void release_compressed();
 
@@ -78,13 +259,29 @@ class YALE : virtual public Dimensions {
     /// @return A pair representing the inner and outer indexes.
     std::pair<size_t, size_t> inner_outer(size_t i, size_t j) const;
 
-    std::unique_ptr<indexvec>
+    /// @brief Checks if the indexes of a matrix can be stored in the index
+    /// types.
+    /// @param outer_extent The number of columns in row-major order, of rows
+    /// in column-major order.
+    /// @param num_elements The number of non-zero elements.
+    /// @return True if no index would overflow.
+    static bool fits_indexes(size_t outer_extent, size_t num_elements);
+
+    std::unique_ptr<outervec>
         outerindex_ptr;  ///< Pointer to the outer index vector.
-    std::unique_ptr<indexvec>
+    std::unique_ptr<innervec>
         innerindex_ptr;  ///< Pointer to the inner index vector.
     std::unique_ptr<valuesvec> values_ptr;  ///< Pointer to the values vector.
     Comparator<S> comparator;  ///< Comparator coherent with the storage order.
 
+    /// @brief Element waiting to be merged by `assemble_compressed`.
+    struct PendingElement {
+        size_t line;   ///< The inner index, i.e. the line of the element.
+        size_t index;  ///< The outer index.
+        T value;       ///< The value.
+    };
+    std::vector<PendingElement> pending;  ///< Elements waiting to be merged.
+
    public:
     /// @brief Finds the value at the specified position (read-only).
     /// @param i The row index.
@@ -104,6 +301,26 @@ class YALE : virtual public Dimensions {
     /// @return True if the element was removed, false otherwise.
     bool remove_compressed(size_t i, size_t j);
 
+    /// @brief Removes all the elements satisfying a predicate.
+    /// @tparam F The type of the predicate.
+    /// @param pred A callable taking the row index, the column index and the
+    /// value of each element, and returning true if it has to be removed.
+    /// @return The number of removed elements.
+    template <typename F>
+    size_t remove_if_compressed(F&& pred);
+
+    /// @brief Adds an element to the buffer of the elements waiting to be
+    /// merged into the compressed arrays by `assemble_compressed`.
+    /// @param i The row index.
+    /// @param j The column index.
+    /// @param value The value of the element.
+    void insert_compressed(size_t i, size_t j, T const& value);
+
+    /// @brief Merges the buffered elements into the compressed arrays.
+    /// @param mode How an element is combined with the ones at the same
+    /// position, either stored or buffered before it.
+    void assemble_compressed(InsertMode mode);
+
     /// @brief Prints the matrix in compressed format to the standard output.
     void print_compressed() const;
 
@@ -113,9 +330,71 @@ class YALE : virtual public Dimensions {
     template <NormType N>
     double norm_compressed() const;
 
-    friend std::vector<T> by_vector_compressed<>(YALE<T, S> const& m,
+    /// @brief Gets the inner index vector.
+    /// @return A read-only view of the beginning of each line.
+    std::span<P const> get_inner_indexes() const;
+
+    /// @brief Gets the outer index vector.
+    /// @return A read-only view of the outer index of each element.
+    std::span<I const> get_outer_indexes() const;
+
+    /// @brief Gets the values vector.
+    /// @return A read-only view of the value of each element.
+    std::span<T const> get_values() const;
+
+    /// @brief Finds the positions of elements in the values vector.
+    /// @param indexes The container of the positions, as pairs of row and
+    /// column indexes.
+    /// @return The position of each element, or `no_position` if it's not
+    /// stored.
+    std::vector<size_t> positions_compressed(
+        SizetPairContainer auto const& indexes) const;
+
+    /// @brief Sets all the values to zero, keeping the sparsity pattern.
+    void zero_values_compressed();
+
+    /// @brief Adds contributions to the values at known positions.
+    /// @param positions The position of each contribution in the values
+    /// vector.
+    /// @param contributions The contributions.
+    /// @param num_threads The number of threads, zero means as many as the
+    /// hardware supports.
+    void add_values_compressed(std::span<size_t const> positions,
+                               std::span<T const> contributions,
+                               unsigned num_threads);
+
+    /// @brief Writes a binary snapshot of the matrix that can be loaded
+    /// without parsing by `MappedYALE`.
+    /// @param file_name The name of the file to write.
+    void save_snapshot(std::string const& file_name) const;
+
+    friend std::vector<T> by_vector_compressed<>(YALE<T, S, I, P> const& m,
                                                  std::vector<T> const& v);
+
+    friend void by_vector_compressed<>(YALE<T, S, I, P> const& m,
+                                       std::span<T const> v,
+                                       std::span<T> result, T alpha, T beta);
+
+    friend void by_vector_compressed_parallel<>(YALE<T, S, I, P> const& m,
+                                                std::span<T const> v,
+                                                std::span<T> result, T alpha,
+                                                T beta, unsigned num_threads);
 };
 
+/// @brief YALE format with 32-bit indexes, for matrices with less than 2^32
+/// columns (rows in column-major order) and non-zero elements.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+using YALE32 = YALE<T, S, std::uint32_t>;
+
+/// @brief YALE format with 32-bit outer indexes and 64-bit inner indexes, for
+/// matrices with less than 2^32 columns (rows in column-major order) but
+/// possibly more non-zero elements.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+using YALE32x64 = YALE<T, S, std::uint32_t, std::uint64_t>;
+
 }  // namespace algebra
 #endif
@@ -0,0 +1,147 @@
+#ifndef DISTRIBUTEDMATRIX_HPP
+#define DISTRIBUTEDMATRIX_HPP
+
+#include <mpi.h>
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Matrix.hpp"
+#include "YALE.hpp"
+
+namespace algebra {
+
+/// @brief Matrix partitioned by blocks of rows over the processes of an MPI
+/// communicator, e.g. for problems too large for a single node.
+/// @tparam T The type of the matrix elements (e.g., numeric or complex).
+/// @tparam Dynamic The class template for dynamic storage of the local
+/// blocks.
+/// @details Each process owns a contiguous block of rows and the same block
+/// of the entries of the vectors, i.e. of the columns. Its rows are stored in
+/// two row-major YALE matrices: the diagonal block, holding the elements in
+/// the owned columns with indexes relative to the first of them, and the
+/// off-diagonal block, holding the other elements with their columns
+/// compacted to the ghost columns actually referenced, in increasing order.
+/// The product receives the ghost entries of the vector from their owners
+/// while multiplying the diagonal block, then multiplies the off-diagonal
+/// one. The communicator must outlive the matrix, and the constructors and
+/// `multiply_into` are collective: every process must call them.
+template <NumericOrComplex T, template <typename, StorageOrder> class Dynamic>
+class DistributedMatrix {
+   public:
+    /// @brief The type of the local blocks.
+    using LocalMatrix = Matrix<T, YALE, Dynamic, rowMajor>;
+
+    /// @brief Constructs a matrix from elements given by any process, each
+    /// one is sent to the owner of its row.
+    /// @param comm The communicator.
+    /// @param rows The number of rows.
+    /// @param columns The number of columns.
+    /// @param indexes The global row and column indexes of the elements
+    /// given by this process, each position given once by all the processes.
+    /// @param values The values of the elements.
+    DistributedMatrix(MPI_Comm comm, size_t rows, size_t columns,
+                      std::vector<std::pair<size_t, size_t>> const& indexes,
+                      std::vector<T> const& values);
+
+    /// @brief Constructs a matrix by reading a Matrix Market file, each
+    /// process parsing only its share of the entries.
+    /// @param comm The communicator.
+    /// @param file_name The name of the file, readable by every process.
+    DistributedMatrix(MPI_Comm comm, std::string const& file_name);
+
+    /// @brief Gets the number of rows of the whole matrix.
+    /// @return The number of rows.
+    size_t get_rows() const { return rows; }
+
+    /// @brief Gets the number of columns of the whole matrix.
+    /// @return The number of columns.
+    size_t get_columns() const { return columns; }
+
+    /// @brief Gets the first row owned by this process.
+    /// @return The global index of the row.
+    size_t get_row_begin() const { return row_offsets[rank]; }
+
+    /// @brief Gets the end of the rows owned by this process.
+    /// @return The global index following the last owned row.
+    size_t get_row_end() const { return row_offsets[rank + 1]; }
+
+    /// @brief Gets the first entry of the vectors owned by this process.
+    /// @return The global index of the column.
+    size_t get_column_begin() const { return column_offsets[rank]; }
+
+    /// @brief Gets the end of the entries of the vectors owned by this
+    /// process.
+    /// @return The global index following the last owned column.
+    size_t get_column_end() const { return column_offsets[rank + 1]; }
+
+    /// @brief Gets the columns owned by other processes and referenced by
+    /// this one.
+    /// @return The global indexes of the columns, in increasing order.
+    std::span<size_t const> get_ghost_columns() const { return ghosts; }
+
+    /// @brief Gets the block of the owned rows and the owned columns.
+    /// @return The block, with column indexes relative to the first owned
+    /// column.
+    LocalMatrix const& get_diagonal_block() const { return diagonal; }
+
+    /// @brief Gets the block of the owned rows and the ghost columns.
+    /// @return The block, whose column `k` is `get_ghost_columns()[k]`.
+    LocalMatrix const& get_off_diagonal_block() const { return off_diagonal; }
+
+    /// @brief Performs the distributed matrix-vector product `y = A * x`.
+    /// @param x The owned entries of the vector, i.e. the rhs, it must hold
+    /// `get_column_end() - get_column_begin()` elements.
+    /// @param y The owned entries of the result, it must hold
+    /// `get_row_end() - get_row_begin()` elements.
+    /// @param num_threads The number of threads of the local products, zero
+    /// means as many as the hardware supports.
+    void multiply_into(std::span<T const> x, std::span<T> y,
+                       unsigned num_threads = 1);
+
+   private:
+    /// @brief An element in global indexes, as exchanged between processes.
+    struct Entry {
+        size_t row;     ///< The row index.
+        size_t column;  ///< The column index.
+        T value;        ///< The value.
+    };
+
+    /// @brief Sends each element to the owner of its row, then builds the
+    /// local blocks and the plan of the halo exchange.
+    /// @param entries The elements given by this process.
+    void distribute(std::vector<Entry> const& entries);
+
+    /// @brief Builds the lists of the entries to send to and to receive from
+    /// each process in the product.
+    void plan_exchange();
+
+    MPI_Comm comm;  ///< The communicator.
+    int rank = 0;   ///< The index of this process.
+    int size = 1;   ///< The number of processes.
+
+    size_t rows = 0;                     ///< Rows of the whole matrix.
+    size_t columns = 0;                  ///< Columns of the whole matrix.
+    std::vector<size_t> row_offsets;     ///< First row of each process.
+    std::vector<size_t> column_offsets;  ///< First column of each process.
+
+    LocalMatrix diagonal;      ///< Block of the owned columns.
+    LocalMatrix off_diagonal;  ///< Block of the ghost columns.
+    std::vector<size_t> ghosts;  ///< Global index of each ghost column.
+
+    std::vector<int> recv_ranks;       ///< Processes sending ghost entries.
+    std::vector<size_t> recv_offsets;  ///< First ghost from each of them.
+    std::vector<int> send_ranks;       ///< Processes receiving entries.
+    std::vector<size_t> send_offsets;  ///< First entry sent to each of them.
+    std::vector<size_t> send_indexes;  ///< Owned entries to send, in order.
+
+    std::vector<T> ghost_values;  ///< Received ghost entries of `x`.
+    std::vector<T> send_values;   ///< Packed entries of `x` to send.
+    std::vector<MPI_Request> requests;  ///< Pending messages.
+};
+
+}  // namespace algebra
+#endif
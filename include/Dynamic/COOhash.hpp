@@ -0,0 +1,242 @@
+#ifndef COOHASH_HPP
+#define COOHASH_HPP
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "BlockKernels.hpp"
+#include "Comparators.hpp"
+#include "Concepts.hpp"
+#include "Dimensions.hpp"
+
+using namespace comparators;
+namespace algebra {
+
+/// @brief Represents a matrix in Coordinate format stored in an open
+/// addressing hash table (COOhash).
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+class COOhash;
+
+/// @brief Performs matrix-vector product.
+/// @param m An object of type COOhash representing the matrix, i.e. the lhs.
+/// @param v The vector, i.e. the rhs.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+std::vector<T> by_vector_dynamic(class COOhash<T, S> const& m,
+                                 std::vector<T> const& v);
+
+/// @brief Performs the matrix-vector product `result = alpha * m * v + beta *
+/// result` writing into a buffer owned by the caller.
+/// @param m An object of type COOhash representing the matrix, i.e. the lhs.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer, it must hold `m.get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+void by_vector_dynamic(class COOhash<T, S> const& m, std::span<T const> v,
+                       std::span<T> result, T alpha, T beta);
+
+/// @brief Performs the transpose product `result = alpha * m^T * v + beta *
+/// result` writing into a buffer owned by the caller.
+/// @param m An object of type COOhash representing the matrix, i.e. the lhs.
+/// @param v The vector, it must hold `m.get_rows()` elements.
+/// @param result The output buffer, it must hold `m.get_columns()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+void by_vector_transpose_dynamic(class COOhash<T, S> const& m,
+                                 std::span<T const> v, std::span<T> result,
+                                 T alpha, T beta);
+
+/// @brief Performs the product `y = alpha * m * x + beta * y` with a dense
+/// block of `k` vectors.
+/// @param m An object of type COOhash representing the matrix, i.e. the lhs.
+/// @param x The rhs block, row-major with `k` columns.
+/// @param y The output block, row-major with `k` columns, it must hold `k *
+/// m.get_rows()` elements.
+/// @param k The number of vectors in the blocks.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `y`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+void by_block_dynamic(class COOhash<T, S> const& m, std::span<T const> x,
+                      std::span<T> y, size_t k, T alpha, T beta);
+
+/// @details The position of each element is packed in a 64-bit key, the line in
+/// the high half and the index within the line in the low half, so that sorting
+/// the keys sorts the elements coherently with the storage order; both must be
+/// smaller than 2^32 - 1, so building a matrix with 2^32 rows or columns or
+/// more, or packing a larger index after a `resize`, throws
+/// `std::overflow_error` in every build. Keys and values are kept in two
+/// vectors used as a hash table with linear probing and a power of two
+/// capacity, at most 70% full: a lookup usually touches one or two contiguous
+/// slots instead of the `log2(nnz)` nodes of a tree. Removals shift back the
+/// following elements of the cluster, so no tombstones are left behind. The
+/// elements are sorted only when they are needed in order, i.e. when
+/// compressing or printing.
+template <NumericOrComplex T, StorageOrder S>
+class COOhash : virtual public Dimensions {
+    using keysvec = std::vector<std::uint64_t>;  ///< Vector of packed keys.
+    using valuesvec = std::vector<T>;            ///< Vector of matrix values.
+
+   protected:
+    /// @brief Default constructor for the COOhash class.
+    COOhash() = default;
+
+    /// @brief Constructs a COOhash matrix from index-value pairs.
+    /// @tparam B Boolean constant to indicate wether the matrix' size was given
+    /// as input.
+    /// @param indexes The container of index pairs.
+    /// @param values The container of matrix values.
+    template <bool B>
+    COOhash(std::bool_constant<B>, SizetPairContainer auto const& indexes,
+            NumericContainer auto const& values);
+
+    /// @brief Constructs a COOhash matrix from a map of index-value pairs.
+    /// @tparam B Boolean constant to indicate wether the matrix' size was given
+    /// as input.
+    /// @param m The map of index-value pairs.
+    template <bool B>
+    COOhash(std::bool_constant<B>,
+            std::map<std::pair<size_t, size_t>, T> const& m);
+
+    /// @brief Constructs a COOhash matrix by reading data from a file.
+    /// @param file_name The name of the file to read the data from.
+    COOhash(std::string& file_name);
+
+    /// @brief In the process of compressing the matrix sends all the
+    /// triplets, coherently with the storage order.
+    /// @tparam F The type of the receiver.
+    /// @param receiver A callable taking the row index, the column index and
+    /// the value of each element.
+    template <typename F>
+    void compress_from_dynamic(F&& receiver) const;
+
+    /// @brief Builds the data structure from the triplets sent by another
+    /// format.
+    /// @tparam F The type of the sender.
+    /// @param num_elements The number of triplets that will be sent.
+    /// @param sender A callable taking a receiver and calling it on every
+    /// triplet, coherently with the storage order.
+    template <typename F>
+    void uncompress_from_triplets(size_t num_elements, F&& sender);
+
+    /// @brief Gets the number of non-zero elements.
+    /// @return The number of non-zero elements.
+    size_t get_num_elements_dynamic() const;
+
+    /// @brief Releases the dynamic storage format.
+    void release_dynamic();
+
+    /// @brief Packs a position in a key.
+    /// @param i The row index.
+    /// @param j The column index.
+    /// @return The key, with the line in the high half.
+    static std::uint64_t pack(size_t i, size_t j);
+
+    /// @brief Unpacks a key.
+    /// @param key The key.
+    /// @return The row and column indexes.
+    static std::pair<size_t, size_t> unpack(std::uint64_t key);
+
+    /// @brief Checks that every position of the matrix can be packed in a
+    /// key.
+    void check_dimensions() const;
+
+    /// @brief Finds the slot of a key.
+    /// @param key The key.
+    /// @return The slot holding the key or, if it's not stored, the empty slot
+    /// ending its cluster.
+    size_t find_slot(std::uint64_t key) const;
+
+    /// @brief Builds an empty table.
+    /// @param num_elements The number of elements the table must hold without
+    /// growing.
+    void allocate_dynamic(size_t num_elements);
+
+    /// @brief Moves the elements into a table with a different capacity.
+    /// @param num_elements The number of elements the new table must hold
+    /// without growing.
+    void rehash(size_t num_elements);
+
+    /// @brief Gets the elements sorted by key.
+    /// @return The keys and the values, sorted coherently with the storage
+    /// order.
+    std::vector<std::pair<std::uint64_t, T>> sorted_elements() const;
+
+    static constexpr std::uint64_t empty_key =
+        ~std::uint64_t{0};  ///< Key marking an empty slot.
+
+    std::unique_ptr<keysvec> keysptr;      ///< Pointer to the slot keys.
+    std::unique_ptr<valuesvec> valuesptr;  ///< Pointer to the slot values.
+    size_t num_elements = 0;               ///< Number of stored elements.
+    unsigned shift = 64;  ///< 64 minus the log2 of the capacity.
+
+   public:
+    /// @brief Finds the value at the specified position (read-only).
+    /// @param i The row index.
+    /// @param j The column index.
+    /// @return The value at the specified position.
+    T find_dynamic_const(size_t i, size_t j) const;
+
+    /// @brief Finds the value at the specified position (read-write).
+    /// @param i The row index.
+    /// @param j The column index.
+    /// @return A reference to the value at the specified position.
+    T& find_dynamic(size_t i, size_t j);
+
+    /// @brief Removes the element at the specified position.
+    /// @param i The row index.
+    /// @param j The column index.
+    /// @return True if the element was removed, false otherwise.
+    bool remove_dynamic(size_t i, size_t j);
+
+    /// @brief Removes all the elements satisfying a predicate.
+    /// @tparam F The type of the predicate.
+    /// @param pred A callable taking the row index, the column index and the
+    /// value of each element, and returning true if it has to be removed.
+    /// @return The number of removed elements.
+    template <typename F>
+    size_t remove_if_dynamic(F&& pred);
+
+    /// @brief Prints the matrix in dynamic format to the standard output.
+    void print_dynamic() const;
+
+    /// @brief Computes the norm of the matrix.
+    /// @tparam N The type of norm to compute (Infinity, One, or
+    /// Frobenius).
+    /// @return The computed norm value.
+    template <NormType N>
+    double norm_dynamic() const;
+
+    friend std::vector<T> by_vector_dynamic<>(COOhash<T, S> const& m,
+                                              std::vector<T> const& v);
+
+    friend void by_vector_dynamic<>(COOhash<T, S> const& m,
+                                    std::span<T const> v, std::span<T> result,
+                                    T alpha, T beta);
+
+    friend void by_vector_transpose_dynamic<>(COOhash<T, S> const& m,
+                                              std::span<T const> v,
+                                              std::span<T> result, T alpha,
+                                              T beta);
+
+    friend void by_block_dynamic<>(COOhash<T, S> const& m,
+                                   std::span<T const> x, std::span<T> y,
+                                   size_t k, T alpha, T beta);
+};
+
+}  // namespace algebra
+
+#endif
@@ -3,10 +3,14 @@
 
 #include <map>
 #include <memory>
+#include <memory_resource>
+#include <span>
 
+#include "BlockKernels.hpp"
 #include "Comparators.hpp"
 #include "Concepts.hpp"
 #include "Dimensions.hpp"
+#include "NodeArena.hpp"
 
 using namespace comparators;
 namespace algebra {
@@ -26,12 +30,53 @@ template <NumericOrComplex T, StorageOrder S>
 std::vector<T> by_vector_dynamic(class COOmap<T, S> const& m,
                                  std::vector<T> const& v);
 
+/// @brief Performs the matrix-vector product `result = alpha * m * v + beta *
+/// result` writing into a buffer owned by the caller.
+/// @param m An object of type COOmap representing the matrix, i.e. the lhs.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer, it must hold `m.get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+void by_vector_dynamic(class COOmap<T, S> const& m, std::span<T const> v,
+                       std::span<T> result, T alpha, T beta);
+
+/// @brief Performs the transpose product `result = alpha * m^T * v + beta *
+/// result` writing into a buffer owned by the caller.
+/// @param m An object of type COOmap representing the matrix, i.e. the lhs.
+/// @param v The vector, it must hold `m.get_rows()` elements.
+/// @param result The output buffer, it must hold `m.get_columns()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+void by_vector_transpose_dynamic(class COOmap<T, S> const& m,
+                                 std::span<T const> v, std::span<T> result,
+                                 T alpha, T beta);
+
+/// @brief Performs the product `y = alpha * m * x + beta * y` with a dense
+/// block of `k` vectors.
+/// @param m An object of type COOmap representing the matrix, i.e. the lhs.
+/// @param x The rhs block, row-major with `k` columns.
+/// @param y The output block, row-major with `k` columns, it must hold `k *
+/// m.get_rows()` elements.
+/// @param k The number of vectors in the blocks.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `y`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+void by_block_dynamic(class COOmap<T, S> const& m, std::span<T const> x,
+                      std::span<T> y, size_t k, T alpha, T beta);
+
 template <NumericOrComplex T, StorageOrder S>
 class COOmap : virtual public Dimensions {
-    using valuesmap = std::map<std::pair<size_t, size_t>, T,
-                               Comparator<S>>;  ///< Map of index-value pairs.
-    using ivtuple = std::tuple<size_t, size_t,
-                               T>;  ///< Tuple representing a matrix element.
+    using valuesmap =
+        std::pmr::map<std::pair<size_t, size_t>, T,
+                      Comparator<S>>;  ///< Map of index-value pairs.
 
    protected:
     /// @brief Default constructor for the COOmap class.
@@ -58,29 +103,35 @@ class COOmap : virtual public Dimensions {
     /// @param file_name The name of the file to read the matrix data from.
     COOmap(std::string& file_name);
 
-    /// @brief In the process of compressing the matrix sends the next tuple.
-    /// @param first_it Flags the first iteration.
-    /// @param tupleptr Pointer to a tuple representing a matrix element.
-    void compress_from_dynamic(bool first_it,
-                               std::unique_ptr<ivtuple> const& tupleptr);
-
-    /// @brief Takes a triplet and inserts it into the data structure.
-    /// @param first_it Flags the first iteration.
-    /// @param tupleptr Pointer to a tuple representing a matrix element.
-    void uncompress_from_triplets(bool first_it,
-                                  std::unique_ptr<ivtuple> const& tupleptr);
+    /// @brief In the process of compressing the matrix sends all the
+    /// triplets, coherently with the storage order.
+    /// @tparam F The type of the receiver.
+    /// @param receiver A callable taking the row index, the column index and
+    /// the value of each element.
+    template <typename F>
+    void compress_from_dynamic(F&& receiver) const;
+
+    /// @brief Builds the data structure from the triplets sent by another
+    /// format.
+    /// @tparam F The type of the sender.
+    /// @param num_elements The number of triplets that will be sent.
+    /// @param sender A callable taking a receiver and calling it on every
+    /// triplet, coherently with the storage order.
+    template <typename F>
+    void uncompress_from_triplets(size_t num_elements, F&& sender);
 
     /// @brief Gets the number of non-zero elements.
     /// @return The number of non-zero elements.
     size_t get_num_elements_dynamic() const;
 
-    /// @brief Initializes the dynamic storage format.
-    void initialize_dynamic();
-
     /// @brief Releases the dynamic storage format.
     void release_dynamic();
 
-    std::unique_ptr<valuesmap>
+    /// @brief Builds an empty map in a released arena.
+    void allocate_dynamic();
+
+    NodeArena arena;  ///< Arena the nodes of the map are carved from.
+    std::unique_ptr<valuesmap, ArenaDeleter>
         matrixptr;  ///< Pointer to the map of index-value pairs.
 
    public:
@@ -102,6 +153,14 @@ class COOmap : virtual public Dimensions {
     /// @return True if the element was removed, false otherwise.
     bool remove_dynamic(size_t i, size_t j);
 
+    /// @brief Removes all the elements satisfying a predicate.
+    /// @tparam F The type of the predicate.
+    /// @param pred A callable taking the row index, the column index and the
+    /// value of each element, and returning true if it has to be removed.
+    /// @return The number of removed elements.
+    template <typename F>
+    size_t remove_if_dynamic(F&& pred);
+
     /// @brief Prints the matrix in dynamic format to the standard output.
     void print_dynamic() const;
 
@@ -113,6 +172,17 @@ class COOmap : virtual public Dimensions {
 
     friend std::vector<T> by_vector_dynamic<>(COOmap<T, S> const& m,
                                               std::vector<T> const& v);
+
+    friend void by_vector_dynamic<>(COOmap<T, S> const& m, std::span<T const> v,
+                                    std::span<T> result, T alpha, T beta);
+
+    friend void by_vector_transpose_dynamic<>(COOmap<T, S> const& m,
+                                              std::span<T const> v,
+                                              std::span<T> result, T alpha,
+                                              T beta);
+
+    friend void by_block_dynamic<>(COOmap<T, S> const& m, std::span<T const> x,
+                                   std::span<T> y, size_t k, T alpha, T beta);
 };
 
 }  // namespace algebra
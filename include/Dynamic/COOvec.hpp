@@ -0,0 +1,219 @@
+#ifndef COOVEC_HPP
+#define COOVEC_HPP
+
+#include <map>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "BlockKernels.hpp"
+#include "Comparators.hpp"
+#include "Concepts.hpp"
+#include "Dimensions.hpp"
+
+using namespace comparators;
+namespace algebra {
+
+/// @brief Represents a matrix in Coordinate format stored in contiguous
+/// vectors (COOvec).
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+class COOvec;
+
+/// @brief Performs matrix-vector product.
+/// @param m An object of type COOvec representing the matrix, i.e. the lhs.
+/// @param v The vector, i.e. the rhs.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+std::vector<T> by_vector_dynamic(class COOvec<T, S> const& m,
+                                 std::vector<T> const& v);
+
+/// @brief Performs the matrix-vector product `result = alpha * m * v + beta *
+/// result` writing into a buffer owned by the caller.
+/// @param m An object of type COOvec representing the matrix, i.e. the lhs.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer, it must hold `m.get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+void by_vector_dynamic(class COOvec<T, S> const& m, std::span<T const> v,
+                       std::span<T> result, T alpha, T beta);
+
+/// @brief Performs the transpose product `result = alpha * m^T * v + beta *
+/// result` writing into a buffer owned by the caller.
+/// @param m An object of type COOvec representing the matrix, i.e. the lhs.
+/// @param v The vector, it must hold `m.get_rows()` elements.
+/// @param result The output buffer, it must hold `m.get_columns()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+void by_vector_transpose_dynamic(class COOvec<T, S> const& m,
+                                 std::span<T const> v, std::span<T> result,
+                                 T alpha, T beta);
+
+/// @brief Performs the product `y = alpha * m * x + beta * y` with a dense
+/// block of `k` vectors.
+/// @param m An object of type COOvec representing the matrix, i.e. the lhs.
+/// @param x The rhs block, row-major with `k` columns.
+/// @param y The output block, row-major with `k` columns, it must hold `k *
+/// m.get_rows()` elements.
+/// @param k The number of vectors in the blocks.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `y`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+void by_block_dynamic(class COOvec<T, S> const& m, std::span<T const> x,
+                      std::span<T> y, size_t k, T alpha, T beta);
+
+/// @details Row indexes, column indexes and values are kept in three separate
+/// vectors. The first `sorted_size` elements are sorted coherently with the
+/// storage order and are looked up by binary search. New elements are
+/// appended after them, in an unsorted buffer that is scanned linearly and
+/// merged into the sorted part when it grows past the square root of the
+/// sorted part, or when the elements are needed in order.
+template <NumericOrComplex T, StorageOrder S>
+class COOvec : virtual public Dimensions {
+    using indexvec = std::vector<size_t>;  ///< Vector of indices.
+    using valuesvec = std::vector<T>;      ///< Vector of matrix values.
+
+   protected:
+    /// @brief Default constructor for the COOvec class.
+    COOvec() = default;
+
+    /// @brief Constructs a COOvec matrix from index-value pairs.
+    /// @tparam B Boolean constant to indicate wether the matrix' size was given
+    /// as input.
+    /// @param indexes The container of index pairs.
+    /// @param values The container of matrix values.
+    template <bool B>
+    COOvec(std::bool_constant<B>, SizetPairContainer auto const& indexes,
+           NumericContainer auto const& values);
+
+    /// @brief Constructs a COOvec matrix from a map of index-value pairs.
+    /// @tparam B Boolean constant to indicate wether the matrix' size was given
+    /// as input.
+    /// @param m The map of index-value pairs.
+    template <bool B>
+    COOvec(std::bool_constant<B>,
+           std::map<std::pair<size_t, size_t>, T> const& m);
+
+    /// @brief Constructs a COOvec matrix by reading data from a file.
+    /// @param file_name The name of the file to read the data from.
+    COOvec(std::string& file_name);
+
+    /// @brief In the process of compressing the matrix sends all the
+    /// triplets, coherently with the storage order.
+    /// @tparam F The type of the receiver.
+    /// @param receiver A callable taking the row index, the column index and
+    /// the value of each element.
+    template <typename F>
+    void compress_from_dynamic(F&& receiver) const;
+
+    /// @brief Builds the data structure from the triplets sent by another
+    /// format.
+    /// @tparam F The type of the sender.
+    /// @param num_elements The number of triplets that will be sent.
+    /// @param sender A callable taking a receiver and calling it on every
+    /// triplet, coherently with the storage order.
+    template <typename F>
+    void uncompress_from_triplets(size_t num_elements, F&& sender);
+
+    /// @brief Gets the number of non-zero elements.
+    /// @return The number of non-zero elements.
+    size_t get_num_elements_dynamic() const;
+
+    /// @brief Releases the dynamic storage format.
+    void release_dynamic();
+
+    /// @brief Sorts the input and stores it, replacing the current content.
+    /// @param indexes The index pairs.
+    /// @param values The matrix values.
+    void assign_sorted(std::vector<std::pair<size_t, size_t>>& indexes,
+                       valuesvec& values);
+
+    /// @brief Visits the elements coherently with the storage order, merging
+    /// the unsorted buffer on the fly.
+    /// @tparam F The type of the visitor.
+    /// @param visitor A callable taking the position of each element in the
+    /// vectors.
+    template <typename F>
+    void for_each_sorted(F&& visitor) const;
+
+    /// @brief Merges the unsorted buffer into the sorted part.
+    void merge_buffer();
+
+    /// @brief Finds the position of an element.
+    /// @param i The row index.
+    /// @param j The column index.
+    /// @return The position in the vectors of the element, or the number of
+    /// elements if it's not stored.
+    size_t find_position(size_t i, size_t j) const;
+
+    std::unique_ptr<indexvec> rowsptr;  ///< Pointer to the row indexes.
+    std::unique_ptr<indexvec> colsptr;  ///< Pointer to the column indexes.
+    std::unique_ptr<valuesvec> valuesptr;  ///< Pointer to the matrix values.
+    size_t sorted_size = 0;     ///< Number of elements in the sorted part.
+    Comparator<S> comparator;  ///< Comparator coherent with the storage order.
+
+   public:
+    /// @brief Finds the value at the specified position (read-only).
+    /// @param i The row index.
+    /// @param j The column index.
+    /// @return The value at the specified position.
+    T find_dynamic_const(size_t i, size_t j) const;
+
+    /// @brief Finds the value at the specified position (read-write).
+    /// @param i The row index.
+    /// @param j The column index.
+    /// @return A reference to the value at the specified position.
+    T& find_dynamic(size_t i, size_t j);
+
+    /// @brief Removes the element at the specified position.
+    /// @param i The row index.
+    /// @param j The column index.
+    /// @return True if the element was removed, false otherwise.
+    bool remove_dynamic(size_t i, size_t j);
+
+    /// @brief Removes all the elements satisfying a predicate.
+    /// @tparam F The type of the predicate.
+    /// @param pred A callable taking the row index, the column index and the
+    /// value of each element, and returning true if it has to be removed.
+    /// @return The number of removed elements.
+    template <typename F>
+    size_t remove_if_dynamic(F&& pred);
+
+    /// @brief Prints the matrix in dynamic format to the standard output.
+    void print_dynamic() const;
+
+    /// @brief Computes the norm of the matrix.
+    /// @tparam N The type of norm to compute (Infinity, One, or
+    /// Frobenius).
+    /// @return The computed norm value.
+    template <NormType N>
+    double norm_dynamic() const;
+
+    friend std::vector<T> by_vector_dynamic<>(COOvec<T, S> const& m,
+                                              std::vector<T> const& v);
+
+    friend void by_vector_dynamic<>(COOvec<T, S> const& m, std::span<T const> v,
+                                    std::span<T> result, T alpha, T beta);
+
+    friend void by_vector_transpose_dynamic<>(COOvec<T, S> const& m,
+                                              std::span<T const> v,
+                                              std::span<T> result, T alpha,
+                                              T beta);
+
+    friend void by_block_dynamic<>(COOvec<T, S> const& m, std::span<T const> x,
+                                   std::span<T> y, size_t k, T alpha, T beta);
+};
+
+}  // namespace algebra
+
+#endif
@@ -0,0 +1,710 @@
+#ifndef BSRIMPL_HPP
+#define BSRIMPL_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <utility>
+
+#include "BSR.hpp"
+#include "Comparators.hpp"
+#include "Profiling.hpp"
+
+using namespace comparators;
+namespace algebra {
+
+/// @brief Constructs a BSR matrix from the block compressed format data.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam R The number of rows of a block.
+/// @tparam C The number of columns of a block.
+/// @tparam B Boolean constant to indicate wether the matrix' size was given
+/// as input.
+/// @param out The block index of each block.
+/// @param in The first block of each block line, plus the number of blocks.
+/// @param val The container of the values of the blocks, `R * C` for each
+/// one, laid out line by line.
+/// @details The non-zero values are the elements of the matrix. If the size
+/// wasn't given as input, it is the smallest one holding all the blocks.
+template <NumericOrComplex T, StorageOrder S, size_t R, size_t C>
+template <bool B>
+BSR<T, S, R, C>::BSR(std::bool_constant<B>, SizetContainer auto const& out,
+                     SizetContainer auto const& in,
+                     NumericContainer auto const& val) {
+    innerindex_ptr = std::make_unique<indexvec>(in.begin(), in.end());
+    outerindex_ptr = std::make_unique<indexvec>(out.begin(), out.end());
+    values_ptr = std::make_unique<valuesvec>(val.begin(), val.end());
+    masks_ptr = std::make_unique<masksvec>(outerindex_ptr->size(), 0);
+
+    auto const& inner = *innerindex_ptr;
+    auto const& outer = *outerindex_ptr;
+    auto const& values = *values_ptr;
+    auto& masks = *masks_ptr;
+
+#ifdef DEBUG
+    assert(!inner.empty() && inner.back() == outer.size() &&
+           values.size() == outer.size() * block_size &&
+           "Error in BSR constructor: sizes don't match.\n");
+    for (size_t line = 0; line + 1 < inner.size(); ++line) {
+        for (size_t k = inner[line] + 1; k < inner[line + 1]; ++k) {
+            assert(outer[k] > outer[k - 1] &&
+                   "Error in BSR constructor: redefinition of the same block "
+                   "(equal or misordered indexes).\n");
+        }
+    }
+#endif
+
+    if constexpr (!B) {
+        size_t lines = (inner.size() - 1) * block_lines;
+        size_t indexes = 0;
+        for (auto const& el : outer) {
+            indexes = std::max(indexes, (el + 1) * block_indexes);
+        }
+
+        if constexpr (S == rowMajor) {
+            this->resize(lines, indexes);
+        }
+        else {
+            this->resize(indexes, lines);
+        }
+    }
+    check_dimensions();
+
+    num_elements = 0;
+    for (size_t k = 0; k < outer.size(); ++k) {
+        for (size_t offset = 0; offset < block_size; ++offset) {
+            if (values[k * block_size + offset] != T{}) {
+                masks[k] |= std::uint64_t{1} << offset;
+                ++num_elements;
+            }
+        }
+    }
+}
+
+/// @brief Checks that the dimensions are multiples of the block ones.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam R The number of rows of a block.
+/// @tparam C The number of columns of a block.
+template <NumericOrComplex T, StorageOrder S, size_t R, size_t C>
+void BSR<T, S, R, C>::check_dimensions() const {
+#ifdef DEBUG
+    assert(this->rows % R == 0 && this->columns % C == 0 &&
+           "Error in BSR: the dimensions must be multiples of the block "
+           "ones.\n");
+#endif
+}
+
+/// @brief Computes the block line, the block index and the position inside
+/// the block of an element.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam R The number of rows of a block.
+/// @tparam C The number of columns of a block.
+/// @param i The row index.
+/// @param j The column index.
+/// @return The block line, the block index and the offset of the element
+/// inside its block.
+template <NumericOrComplex T, StorageOrder S, size_t R, size_t C>
+std::array<size_t, 3> BSR<T, S, R, C>::locate(size_t i, size_t j) const {
+    size_t line = (S == rowMajor) ? i : j;
+    size_t index = (S == rowMajor) ? j : i;
+
+    return {line / block_lines, index / block_indexes,
+            (line % block_lines) * block_indexes + index % block_indexes};
+}
+
+/// @brief Finds a block.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam R The number of rows of a block.
+/// @tparam C The number of columns of a block.
+/// @param line The block line.
+/// @param index The block index.
+/// @return The position of the block, or of the first block after it if it's
+/// not stored.
+template <NumericOrComplex T, StorageOrder S, size_t R, size_t C>
+size_t BSR<T, S, R, C>::find_block(size_t line, size_t index) const {
+    auto const& inner = *innerindex_ptr;
+    auto const& outer = *outerindex_ptr;
+
+    auto first = outer.begin() + inner[line];
+    auto last = outer.begin() + inner[line + 1];
+    return std::lower_bound(first, last, index) - outer.begin();
+}
+
+/// @brief Finds the value at the specified position (read-only).
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam R The number of rows of a block.
+/// @tparam C The number of columns of a block.
+/// @param i The row index.
+/// @param j The column index.
+/// @return The value at the specified position.
+template <NumericOrComplex T, StorageOrder S, size_t R, size_t C>
+T BSR<T, S, R, C>::find_compressed_const(size_t i, size_t j) const {
+    auto [line, index, offset] = locate(i, j);
+    size_t k = find_block(line, index);
+
+    if (k < (*innerindex_ptr)[line + 1] && (*outerindex_ptr)[k] == index) {
+        return (*values_ptr)[k * block_size + offset];
+    }
+    return T{};
+}
+
+/// @brief Finds the value at the specified position (read-write).
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam R The number of rows of a block.
+/// @tparam C The number of columns of a block.
+/// @param i The row index.
+/// @param j The column index.
+/// @return A reference to the value at the specified position.
+/// @details If the block of the element is not stored, a block of zeros is
+/// inserted, moving all the following blocks.
+template <NumericOrComplex T, StorageOrder S, size_t R, size_t C>
+T& BSR<T, S, R, C>::find_compressed(size_t i, size_t j) {
+    auto [line, index, offset] = locate(i, j);
+    auto& inner = *innerindex_ptr;
+    auto& outer = *outerindex_ptr;
+    auto& values = *values_ptr;
+    auto& masks = *masks_ptr;
+
+    size_t k = find_block(line, index);
+    if (k == inner[line + 1] || outer[k] != index) {
+        PROFILE_SCOPE("insert_compressed", "BSR");
+        PROFILE_BYTES((outer.size() - k) *
+                          (sizeof(size_t) + sizeof(std::uint64_t)) +
+                      (values.size() - k * block_size) * sizeof(T));
+
+        outer.insert(outer.begin() + k, index);
+        masks.insert(masks.begin() + k, 0);
+        values.insert(values.begin() + k * block_size, block_size, T{});
+
+        for (size_t l = line + 1; l < inner.size(); ++l) {
+            inner[l]++;
+        }
+    }
+
+    const std::uint64_t bit = std::uint64_t{1} << offset;
+    if (!(masks[k] & bit)) {
+        masks[k] |= bit;
+        ++num_elements;
+    }
+    return values[k * block_size + offset];
+}
+
+/// @brief In the process of uncompressing the matrix sends all the triplets,
+/// coherently with the storage order.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam R The number of rows of a block.
+/// @tparam C The number of columns of a block.
+/// @tparam F The type of the receiver.
+/// @param receiver A callable taking the row index, the column index and the
+/// value of each element.
+/// @details Each line is sent by visiting the blocks of its block line in
+/// order, so the elements come out sorted; the padding is skipped.
+template <NumericOrComplex T, StorageOrder S, size_t R, size_t C>
+template <typename F>
+void BSR<T, S, R, C>::uncompress_from_compressed(F&& receiver) const {
+    auto const& inner = *innerindex_ptr;
+    auto const& outer = *outerindex_ptr;
+    auto const& values = *values_ptr;
+    auto const& masks = *masks_ptr;
+
+    for (size_t block_line = 0; block_line + 1 < inner.size(); ++block_line) {
+        for (size_t r = 0; r < block_lines; ++r) {
+            const size_t line = block_line * block_lines + r;
+
+            for (size_t k = inner[block_line]; k < inner[block_line + 1];
+                 ++k) {
+                for (size_t c = 0; c < block_indexes; ++c) {
+                    const size_t offset = r * block_indexes + c;
+                    if (!((masks[k] >> offset) & 1)) continue;
+
+                    const size_t index = outer[k] * block_indexes + c;
+                    if constexpr (S == rowMajor) {
+                        receiver(line, index, values[k * block_size + offset]);
+                    }
+                    else {
+                        receiver(index, line, values[k * block_size + offset]);
+                    }
+                }
+            }
+        }
+    }
+}
+
+/// @brief Builds the data structure from the triplets sent by another format.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam R The number of rows of a block.
+/// @tparam C The number of columns of a block.
+/// @tparam F The type of the sender.
+/// @param num_elements The number of triplets that will be sent.
+/// @param sender A callable taking a receiver and calling it on every triplet,
+/// coherently with the storage order.
+/// @details The triplets of a block line arrive together, so they are
+/// buffered until the next block line begins: then the blocks they touch are
+/// sorted, appended, and filled. A vector with one slot per block index maps
+/// each touched block to its position and is cleared by visiting the touched
+/// blocks only, so each block line costs time proportional to its elements.
+template <NumericOrComplex T, StorageOrder S, size_t R, size_t C>
+template <typename F>
+void BSR<T, S, R, C>::compress_from_triplets(size_t num_elements,
+                                             F&& sender) {
+    PROFILE_SCOPE("compress", "BSR");
+    check_dimensions();
+    constexpr size_t npos = ~size_t{0};
+
+    const size_t num_lines = (S == rowMajor) ? this->rows : this->columns;
+    const size_t num_indexes = (S == rowMajor) ? this->columns : this->rows;
+
+    innerindex_ptr =
+        std::make_unique<indexvec>(num_lines / block_lines + 1, 0);
+    outerindex_ptr = std::make_unique<indexvec>();
+    values_ptr = std::make_unique<valuesvec>();
+    masks_ptr = std::make_unique<masksvec>();
+
+    auto& inner = *innerindex_ptr;
+    auto& outer = *outerindex_ptr;
+    auto& values = *values_ptr;
+    auto& masks = *masks_ptr;
+
+    outer.reserve(num_elements / block_size);
+    masks.reserve(num_elements / block_size);
+    values.reserve(num_elements);
+    this->num_elements = 0;
+
+    struct Pending {
+        size_t index;   ///< Block index.
+        size_t offset;  ///< Offset inside the block.
+        T value;        ///< Value of the element.
+    };
+    std::vector<Pending> pending;
+    std::vector<size_t> slot(num_indexes / block_indexes, npos);
+    std::vector<size_t> touched;
+    size_t current = 0;
+
+    auto flush = [&]() {
+        std::sort(touched.begin(), touched.end());
+        for (auto const& index : touched) {
+            slot[index] = outer.size();
+            outer.push_back(index);
+            masks.push_back(0);
+        }
+        values.resize(outer.size() * block_size, T{});
+
+        for (auto const& el : pending) {
+            size_t k = slot[el.index];
+            values[k * block_size + el.offset] = el.value;
+            masks[k] |= std::uint64_t{1} << el.offset;
+        }
+
+        for (auto const& index : touched) slot[index] = npos;
+        inner[current + 1] = touched.size();
+        touched.clear();
+        pending.clear();
+    };
+
+    sender([&](size_t i, size_t j, T const& value) {
+        auto [line, index, offset] = locate(i, j);
+        if (line != current) {
+            flush();
+            current = line;
+        }
+        if (slot[index] == npos) {
+            slot[index] = 0;
+            touched.push_back(index);
+        }
+        pending.push_back({index, offset, value});
+        ++this->num_elements;
+    });
+    flush();
+
+    for (size_t line = 0; line + 1 < inner.size(); ++line) {
+        inner[line + 1] += inner[line];
+    }
+    PROFILE_BYTES(values.size() * sizeof(T) +
+                  outer.size() * (sizeof(size_t) + sizeof(std::uint64_t)) +
+                  inner.size() * sizeof(size_t));
+}
+
+/// @brief Gets the number of non-zero elements.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam R The number of rows of a block.
+/// @tparam C The number of columns of a block.
+/// @return The number of non-zero elements, the padding excluded.
+template <NumericOrComplex T, StorageOrder S, size_t R, size_t C>
+size_t BSR<T, S, R, C>::get_num_elements_compressed() const {
+    return num_elements;
+}
+
+/// @brief Releases the compressed storage format.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam R The number of rows of a block.
+/// @tparam C The number of columns of a block.
+template <NumericOrComplex T, StorageOrder S, size_t R, size_t C>
+void BSR<T, S, R, C>::release_compressed() {
+    innerindex_ptr.reset();
+    outerindex_ptr.reset();
+    values_ptr.reset();
+    masks_ptr.reset();
+    num_elements = 0;
+}
+
+/// @brief Removes the element at the specified position.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam R The number of rows of a block.
+/// @tparam C The number of columns of a block.
+/// @param i The row index.
+/// @param j The column index.
+/// @return True if the element was removed, false otherwise.
+/// @details The element becomes padding, and its block is removed when no
+/// element is left in it.
+template <NumericOrComplex T, StorageOrder S, size_t R, size_t C>
+bool BSR<T, S, R, C>::remove_compressed(size_t i, size_t j) {
+    auto [line, index, offset] = locate(i, j);
+    auto& inner = *innerindex_ptr;
+    auto& outer = *outerindex_ptr;
+    auto& values = *values_ptr;
+    auto& masks = *masks_ptr;
+
+    size_t k = find_block(line, index);
+    const std::uint64_t bit = std::uint64_t{1} << offset;
+    if (k == inner[line + 1] || outer[k] != index || !(masks[k] & bit)) {
+        return false;
+    }
+
+    masks[k] &= ~bit;
+    values[k * block_size + offset] = T{};
+    --num_elements;
+
+    if (masks[k] == 0) {
+        outer.erase(outer.begin() + k);
+        masks.erase(masks.begin() + k);
+        auto first = values.begin() + k * block_size;
+        values.erase(first, first + block_size);
+
+        for (size_t l = line + 1; l < inner.size(); ++l) {
+            inner[l]--;
+        }
+    }
+    return true;
+}
+
+/// @brief Removes all the elements satisfying a predicate.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam R The number of rows of a block.
+/// @tparam C The number of columns of a block.
+/// @tparam F The type of the predicate.
+/// @param pred A callable taking the row index, the column index and the
+/// value of each element, and returning true if it has to be removed.
+/// @return The number of removed elements.
+/// @details The blocks left with some element are moved towards the front of
+/// the arrays and the inner indexes are rebuilt in the same pass.
+template <NumericOrComplex T, StorageOrder S, size_t R, size_t C>
+template <typename F>
+size_t BSR<T, S, R, C>::remove_if_compressed(F&& pred) {
+    auto& inner = *innerindex_ptr;
+    auto& outer = *outerindex_ptr;
+    auto& values = *values_ptr;
+    auto& masks = *masks_ptr;
+
+    size_t removed = 0;
+    size_t write = 0;
+    size_t begin = 0;
+    for (size_t block_line = 0; block_line + 1 < inner.size(); ++block_line) {
+        size_t end = inner[block_line + 1];
+        for (size_t k = begin; k < end; ++k) {
+            T* block = values.data() + k * block_size;
+
+            for (size_t offset = 0; offset < block_size; ++offset) {
+                if (!((masks[k] >> offset) & 1)) continue;
+
+                size_t line =
+                    block_line * block_lines + offset / block_indexes;
+                size_t index =
+                    outer[k] * block_indexes + offset % block_indexes;
+                bool remove;
+                if constexpr (S == rowMajor) {
+                    remove = pred(line, index, std::as_const(block[offset]));
+                }
+                else {
+                    remove = pred(index, line, std::as_const(block[offset]));
+                }
+
+                if (remove) {
+                    masks[k] &= ~(std::uint64_t{1} << offset);
+                    block[offset] = T{};
+                    ++removed;
+                }
+            }
+
+            if (masks[k] != 0) {
+                outer[write] = outer[k];
+                masks[write] = masks[k];
+                std::copy(block, block + block_size,
+                          values.data() + write * block_size);
+                ++write;
+            }
+        }
+        begin = end;
+        inner[block_line + 1] = write;
+    }
+
+    outer.resize(write);
+    masks.resize(write);
+    values.resize(write * block_size);
+    num_elements -= removed;
+    return removed;
+}
+
+/// @brief Prints the matrix in compressed format to the standard output.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam R The number of rows of a block.
+/// @tparam C The number of columns of a block.
+template <NumericOrComplex T, StorageOrder S, size_t R, size_t C>
+void BSR<T, S, R, C>::print_compressed() const {
+    std::cout << "Printing blocks of " << R << "x" << C << "." << std::endl;
+    std::cout << "Values: ";
+    for (const auto& el : *values_ptr) {
+        std::cout << el << " ";
+    }
+    std::cout << std::endl;
+    std::cout << "Outer indexes: ";
+    for (auto const& el : *outerindex_ptr) {
+        std::cout << el << " ";
+    }
+    std::cout << std::endl;
+
+    std::cout << "Inner indexes: ";
+    for (auto const& el : *innerindex_ptr) {
+        std::cout << el << " ";
+    }
+    std::cout << std::endl;
+}
+
+/// @brief Computes the norm of the matrix.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam R The number of rows of a block.
+/// @tparam C The number of columns of a block.
+/// @tparam N The type of norm to compute (Infinity, One, or Frobenius).
+/// @return The computed norm value.
+/// @details The padding is zero, so the blocks are summed whole.
+template <NumericOrComplex T, StorageOrder S, size_t R, size_t C>
+template <NormType N>
+double BSR<T, S, R, C>::norm_compressed() const {
+    auto const& inner = *innerindex_ptr;
+    auto const& outer = *outerindex_ptr;
+    auto const& values = *values_ptr;
+
+    if constexpr (N == Frobenius) {
+        double sum = 0.0;
+        for (auto const& el : values) {
+            sum += std::abs(el) * std::abs(el);
+        }
+        return std::sqrt(sum);
+    }
+    else {
+        std::vector<double> par(N == Infinity ? this->rows : this->columns,
+                                0);
+
+        for (size_t block_line = 0; block_line + 1 < inner.size();
+             ++block_line) {
+            for (size_t k = inner[block_line]; k < inner[block_line + 1];
+                 ++k) {
+                for (size_t offset = 0; offset < block_size; ++offset) {
+                    size_t line =
+                        block_line * block_lines + offset / block_indexes;
+                    size_t index =
+                        outer[k] * block_indexes + offset % block_indexes;
+                    size_t row = (S == rowMajor) ? line : index;
+                    size_t column = (S == rowMajor) ? index : line;
+
+                    par[N == Infinity ? row : column] +=
+                        std::abs(values[k * block_size + offset]);
+                }
+            }
+        }
+        return par.empty() ? 0.0 : *std::max_element(par.begin(), par.end());
+    }
+}
+
+/// @brief Gets the number of stored blocks.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam R The number of rows of a block.
+/// @tparam C The number of columns of a block.
+/// @return The number of blocks.
+template <NumericOrComplex T, StorageOrder S, size_t R, size_t C>
+size_t BSR<T, S, R, C>::get_num_blocks() const {
+    return outerindex_ptr->size();
+}
+
+/// @brief Gets the fraction of the stored block values which are elements of
+/// the matrix, the rest being padding.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam R The number of rows of a block.
+/// @tparam C The number of columns of a block.
+/// @return The fill ratio, 1 if every block is full.
+/// @details A low ratio means that the block dimensions don't match the
+/// structure of the matrix, and `YALE` would be faster.
+template <NumericOrComplex T, StorageOrder S, size_t R, size_t C>
+double BSR<T, S, R, C>::get_fill_ratio() const {
+    if (values_ptr->empty()) return 1.0;
+    return static_cast<double>(num_elements) /
+           static_cast<double>(values_ptr->size());
+}
+
+/// @brief Gets the inner index vector.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam R The number of rows of a block.
+/// @tparam C The number of columns of a block.
+/// @return A read-only view of the first block of each block line.
+template <NumericOrComplex T, StorageOrder S, size_t R, size_t C>
+std::span<size_t const> BSR<T, S, R, C>::get_inner_indexes() const {
+    return *innerindex_ptr;
+}
+
+/// @brief Gets the outer index vector.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam R The number of rows of a block.
+/// @tparam C The number of columns of a block.
+/// @return A read-only view of the block index of each block.
+template <NumericOrComplex T, StorageOrder S, size_t R, size_t C>
+std::span<size_t const> BSR<T, S, R, C>::get_outer_indexes() const {
+    return *outerindex_ptr;
+}
+
+/// @brief Gets the values vector.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam R The number of rows of a block.
+/// @tparam C The number of columns of a block.
+/// @return A read-only view of the values of the blocks.
+template <NumericOrComplex T, StorageOrder S, size_t R, size_t C>
+std::span<T const> BSR<T, S, R, C>::get_values() const {
+    return *values_ptr;
+}
+
+/// @brief Performs matrix-vector product.
+/// @param m An object of type BSR representing the matrix, i.e. the lhs.
+/// @param v The vector, i.e. the rhs.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam R The number of rows of a block.
+/// @tparam C The number of columns of a block.
+template <NumericOrComplex T, StorageOrder S, size_t R, size_t C>
+std::vector<T> by_vector_compressed(BSR<T, S, R, C> const& m,
+                                    std::vector<T> const& v) {
+    std::vector<T> result(m.rows, T{});
+    by_vector_compressed(m, std::span<T const>(v), std::span<T>(result), T{1},
+                         T{0});
+    return result;
+}
+
+/// @brief Performs the matrix-vector product `result = alpha * m * v + beta *
+/// result` writing into a buffer owned by the caller.
+/// @param m An object of type BSR representing the matrix, i.e. the lhs.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer, it must hold `m.get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam R The number of rows of a block.
+/// @tparam C The number of columns of a block.
+/// @details In column-major order the lines are the columns, so the arrays
+/// are multiplied as those of the transpose.
+template <NumericOrComplex T, StorageOrder S, size_t R, size_t C>
+void by_vector_compressed(BSR<T, S, R, C> const& m, std::span<T const> v,
+                          std::span<T> result, T alpha, T beta) {
+    using M = BSR<T, S, R, C>;
+    bsr_product<M::block_lines, M::block_indexes, S == columnMajor>(
+        m.get_inner_indexes(), m.get_outer_indexes(), m.get_values(), v,
+        result, alpha, beta);
+}
+
+/// @brief Performs the matrix-vector product `result = alpha * m * v + beta *
+/// result` on multiple threads.
+/// @param m An object of type BSR representing the matrix, i.e. the lhs.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer, it must hold `m.get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam R The number of rows of a block.
+/// @tparam C The number of columns of a block.
+template <NumericOrComplex T, StorageOrder S, size_t R, size_t C>
+void by_vector_compressed_parallel(BSR<T, S, R, C> const& m,
+                                   std::span<T const> v, std::span<T> result,
+                                   T alpha, T beta, unsigned num_threads) {
+    using M = BSR<T, S, R, C>;
+    bsr_product_parallel<M::block_lines, M::block_indexes, S == columnMajor>(
+        m.get_inner_indexes(), m.get_outer_indexes(), m.get_values(), v,
+        result, alpha, beta, num_threads);
+}
+
+/// @brief Performs the transpose product `result = alpha * m^T * v + beta *
+/// result` writing into a buffer owned by the caller.
+/// @param m An object of type BSR representing the matrix, i.e. the lhs.
+/// @param v The vector, it must hold `m.get_rows()` elements.
+/// @param result The output buffer, it must hold `m.get_columns()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam R The number of rows of a block.
+/// @tparam C The number of columns of a block.
+template <NumericOrComplex T, StorageOrder S, size_t R, size_t C>
+void by_vector_transpose_compressed(BSR<T, S, R, C> const& m,
+                                    std::span<T const> v, std::span<T> result,
+                                    T alpha, T beta) {
+    using M = BSR<T, S, R, C>;
+    bsr_product<M::block_lines, M::block_indexes, S == rowMajor>(
+        m.get_inner_indexes(), m.get_outer_indexes(), m.get_values(), v,
+        result, alpha, beta);
+}
+
+/// @brief Performs the transpose product `result = alpha * m^T * v + beta *
+/// result` on multiple threads.
+/// @param m An object of type BSR representing the matrix, i.e. the lhs.
+/// @param v The vector, it must hold `m.get_rows()` elements.
+/// @param result The output buffer, it must hold `m.get_columns()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam R The number of rows of a block.
+/// @tparam C The number of columns of a block.
+template <NumericOrComplex T, StorageOrder S, size_t R, size_t C>
+void by_vector_transpose_compressed_parallel(BSR<T, S, R, C> const& m,
+                                             std::span<T const> v,
+                                             std::span<T> result, T alpha,
+                                             T beta, unsigned num_threads) {
+    using M = BSR<T, S, R, C>;
+    bsr_product_parallel<M::block_lines, M::block_indexes, S == rowMajor>(
+        m.get_inner_indexes(), m.get_outer_indexes(), m.get_values(), v,
+        result, alpha, beta, num_threads);
+}
+
+}  // namespace algebra
+
+#endif
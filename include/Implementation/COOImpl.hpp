@@ -5,11 +5,15 @@
 #include <complex>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <memory>
+#include <utility>
 
 #include "COO.hpp"
 #include "Comparators.hpp"
 #include "Concepts.hpp"
+#include "MatrixMarket.hpp"
+#include "Profiling.hpp"
 
 using namespace comparators;
 namespace algebra {
@@ -47,8 +51,7 @@ COO<T, S>::COO(std::bool_constant<B>, SizetPairContainer auto const& indexes,
     apply_permutation(tempindexes, p);
     apply_permutation(tempvalues, p);
 
-    indexptr = std::make_unique<indexlist>();
-    valuesptr = std::make_unique<valueslist>();
+    allocate_dynamic();
 
     size_t max_index_r = 0, max_index_c = 0;
     auto it1 = tempindexes.rbegin();
@@ -118,8 +121,7 @@ COO<T, S>::COO(std::bool_constant<B>,
     apply_permutation(tempindexes, p);
     apply_permutation(tempvalues, p);
 
-    indexptr = std::make_unique<indexlist>();
-    valuesptr = std::make_unique<valueslist>();
+    allocate_dynamic();
 
     size_t max_index_r = 0, max_index_c = 0;
     auto it1 = tempindexes.rbegin();
@@ -154,82 +156,22 @@ COO<T, S>::COO(std::bool_constant<B>,
 /// @tparam T The type of the matrix elements.
 /// @tparam S The storage order (row-major or column-major).
 /// @param file_name The name of the file to read the matrix data from.
-/// @details This constructor reads a `Matrix Market` file, parses its contents,
-/// and initializes the matrix. It validates the file format and ensures that
-/// the indices are within bounds.
+/// @details This constructor reads a `Matrix Market` file with `read_market`,
+/// honoring the field and the symmetry declared in the header. The entries are
+/// sorted with a counting sort on the lines and then inserted in order.
 template <NumericOrComplex T, StorageOrder S>
 COO<T, S>::COO(std::string& file_name) {
-    std::ifstream file(file_name);
-#ifdef DEBUG
-    assert(file && "Error in COO constructor: cannot open file.");
-#endif
-
-    std::string line;
-    std::getline(file, line);
-
-#ifdef DEBUG
-    assert(line.substr(0, 14) == "%%MatrixMarket" &&
-           "Error in COO constructor: invalid Matrix Market file.");
-#endif
-
-    while (std::getline(file, line)) {
-        if (line.empty()) continue;
-        if (line[0] != '%') break;
-    }
-
-    size_t nnz;
-    std::istringstream dims(line);
-    dims >> this->rows >> this->columns >> nnz;
-
-    std::vector<T> tempvalues;
-    std::vector<std::pair<size_t, size_t>> tempindexes;
-
-    tempvalues.reserve(nnz);
-    tempindexes.reserve(nnz);
-
-    size_t row, col;
-    T value;
-
-    for (size_t i = 0; i < nnz && std::getline(file, line); ++i) {
-        std::istringstream dims(line);
-        dims >> row >> col >> value;
-        tempvalues.push_back(value);
-        tempindexes.push_back({row - 1, col - 1});
-    }
-
+    MarketData<T> data = read_market<T>(file_name);
+    this->resize(data.header.rows, data.header.columns);
     comparator = Comparator<S>{};
-    std::vector<size_t> p = sort_permutation(tempindexes, comparator);
-
-    apply_permutation(tempindexes, p);
-    apply_permutation(tempvalues, p);
-
-    indexptr = std::make_unique<indexlist>();
-    valuesptr = std::make_unique<valueslist>();
-
-    auto it1 = tempindexes.rbegin();
-    auto it2 = tempvalues.rbegin();
-
-    while (it1 != tempindexes.rend() && it2 != tempvalues.rend()) {
-#ifdef DEBUG
-        assert((*it1).first < this->rows && (*it1).second < this->columns &&
-               "Error in COO constructor: indexes out of bounds (too big).\n");
-        assert((*it1).first >= 0 && (*it1).second >= 0 &&
-               "Error in COO constructor: indexes out of bounds (negative).\n");
-
-        if (it1 != tempindexes.rbegin()) {
-            auto compare = it1;
-            --compare;
-            assert((*it1) != (*compare) &&
-                   "Error in COO constructor: redefinition of the same element "
-                   "(equal indexes).\n");
-        }
-#endif
-
-        indexptr->push_front(*it1);
-        valuesptr->push_front(*it2);
-        it1++;
-        it2++;
-    }
+    std::vector<size_t> inner, outer;
+    std::vector<T> values;
+    market_to_compressed<T, S>(data, S == rowMajor ? this->rows : this->columns,
+                               inner, outer, values);
+
+    uncompress_from_triplets(values.size(), [&](auto&& receiver) {
+        for_each_compressed<S>(inner, outer, values, receiver);
+    });
 }
 
 /// @brief Finds the value at the specified position (read-only).
@@ -269,6 +211,7 @@ T COO<T, S>::find_dynamic_const(size_t i, size_t j) const {
 /// into the data structure and returns a reference to it.
 template <NumericOrComplex T, StorageOrder S>
 T& COO<T, S>::find_dynamic(size_t i, size_t j) {
+    PROFILE_SCOPE("find_dynamic", "COO");
     auto it1 = indexptr->begin();
     auto next1 = indexptr->before_begin();
 
@@ -276,6 +219,7 @@ T& COO<T, S>::find_dynamic(size_t i, size_t j) {
     auto next2 = valuesptr->before_begin();
 
     while (it1 != indexptr->end()) {
+        PROFILE_BYTES(sizeof(std::pair<size_t, size_t>) + sizeof(T));
         if ((*it1).first == i && (*it1).second == j) {
             return *it2;
         }
@@ -296,54 +240,52 @@ T& COO<T, S>::find_dynamic(size_t i, size_t j) {
     return *it2;
 }
 
-/// @brief In the process of compressing the matrix sends the next tuple.
+/// @brief In the process of compressing the matrix sends all the triplets,
+/// coherently with the storage order.
 /// @tparam T The type of the matrix elements.
 /// @tparam S The storage order (row-major or column-major).
-/// @param first_it Flags the first iteration.
-/// @param tupleptr Pointer to a tuple representing a matrix element.
-/// @details This function iterates through the dynamic data structure and
-/// sends the tuples to a receiver that uses them to build a compressed
-/// representation.
+/// @tparam F The type of the receiver.
+/// @param receiver A callable taking the row index, the column index and the
+/// value of each element.
+/// @details This function walks the two lists side by side, they are already
+/// sorted coherently with the storage order.
 template <NumericOrComplex T, StorageOrder S>
-void COO<T, S>::compress_from_dynamic(
-    bool first_it, std::unique_ptr<ivtuple> const& tupleptr) {
-    auto static valuesit = (*valuesptr).begin();
-    auto static indexit = (*indexptr).begin();
-
-    if (first_it) {
-        valuesit = (*valuesptr).begin();
-        indexit = (*indexptr).begin();
-    }
+template <typename F>
+void COO<T, S>::compress_from_dynamic(F&& receiver) const {
+    auto valuesit = (*valuesptr).begin();
 
-    (*tupleptr) =
-        std::make_tuple((*indexit).first, (*indexit).second, *valuesit);
-
-    ++valuesit;
-    ++indexit;
+    for (auto const& [i, j] : *indexptr) {
+        receiver(i, j, *valuesit);
+        ++valuesit;
+    }
 }
 
-/// @brief Takes a triplet and inserts it into the data structure.
+/// @brief Builds the data structure from the triplets sent by another format.
 /// @tparam T The type of the matrix elements.
 /// @tparam S The storage order (row-major or column-major).
-/// @param first_it Flags the first iteration.
-/// @param tupleptr Pointer to a tuple representing a matrix element.
-/// @details This function takes a tuple and inserts its contents into the
-/// dynamic data structure.
+/// @tparam F The type of the sender.
+/// @param num_elements The number of triplets that will be sent.
+/// @param sender A callable taking a receiver and calling it on every triplet,
+/// coherently with the storage order.
+/// @details The triplets arrive sorted, so each one is inserted after the
+/// previous one. A list can't be preallocated, so `num_elements` is only used
+/// by the profiler.
 template <NumericOrComplex T, StorageOrder S>
+template <typename F>
 void COO<T, S>::uncompress_from_triplets(
-    bool first_it, std::unique_ptr<ivtuple> const& tupleptr) {
-    auto static lastind = indexptr->before_begin();
-    auto static lastval = valuesptr->before_begin();
-
-    if (first_it) {
-        lastind = indexptr->before_begin();
-        lastval = valuesptr->before_begin();
-    }
-
-    lastind = indexptr->insert_after(
-        lastind,
-        std::make_pair(std::get<0>(*tupleptr), std::get<1>(*tupleptr)));
-    lastval = valuesptr->insert_after(lastval, std::get<2>(*tupleptr));
+    [[maybe_unused]] size_t num_elements, F&& sender) {
+    PROFILE_SCOPE("uncompress", "COO");
+    allocate_dynamic();
+
+    auto lastind = indexptr->before_begin();
+    auto lastval = valuesptr->before_begin();
+
+    sender([&](size_t i, size_t j, T const& value) {
+        lastind = indexptr->insert_after(lastind, std::make_pair(i, j));
+        lastval = valuesptr->insert_after(lastval, value);
+    });
+    PROFILE_BYTES(num_elements *
+                  (sizeof(std::pair<size_t, size_t>) + sizeof(T)));
 }
 
 /// @brief Gets the number of non-zero elements.
@@ -358,25 +300,27 @@ size_t COO<T, S>::get_num_elements_dynamic() const {
         std::distance((*valuesptr).begin(), (*valuesptr).end()));
 }
 
-/// @brief Initializes the dynamic storage format.
-/// @tparam T The type of the matrix elements.
-/// @tparam S The storage order (row-major or column-major).
-/// @details This function allocates memory for the index and values lists.
-template <NumericOrComplex T, StorageOrder S>
-void COO<T, S>::initialize_dynamic() {
-    indexptr = std::make_unique<indexlist>();
-    valuesptr = std::make_unique<valueslist>();
-}
-
 /// @brief Releases the dynamic storage format.
 /// @tparam T The type of the matrix elements.
 /// @tparam S The storage order (row-major or column-major).
 /// @details This function deallocates the memory used by the index and values
-/// lists.
+/// lists, releasing the slabs of the arena without visiting the nodes.
 template <NumericOrComplex T, StorageOrder S>
 void COO<T, S>::release_dynamic() {
     indexptr.reset();
     valuesptr.reset();
+    arena.release();
+}
+
+/// @brief Builds empty lists in a released arena.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @details The previous lists, if any, are released.
+template <NumericOrComplex T, StorageOrder S>
+void COO<T, S>::allocate_dynamic() {
+    release_dynamic();
+    indexptr.reset(arena.create<indexlist>());
+    valuesptr.reset(arena.create<valueslist>());
 }
 
 /// @brief Gets the next line in the matrix.
@@ -482,6 +426,36 @@ bool COO<T, S>::remove_dynamic(size_t i, size_t j) {
     return false;
 }
 
+/// @brief Removes all the elements satisfying a predicate.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam F The type of the predicate.
+/// @param pred A callable taking the row index, the column index and the
+/// value of each element, and returning true if it has to be removed.
+/// @return The number of removed elements.
+/// @details The lists are traversed once, unlinking the removed elements.
+template <NumericOrComplex T, StorageOrder S>
+template <typename F>
+size_t COO<T, S>::remove_if_dynamic(F&& pred) {
+    size_t removed = 0;
+    auto prev1 = (*indexptr).before_begin();
+    auto prev2 = (*valuesptr).before_begin();
+
+    for (auto it1 = std::next(prev1), it2 = std::next(prev2);
+         it1 != (*indexptr).end();) {
+        if (pred((*it1).first, (*it1).second, std::as_const(*it2))) {
+            it1 = (*indexptr).erase_after(prev1);
+            it2 = (*valuesptr).erase_after(prev2);
+            ++removed;
+        }
+        else {
+            prev1 = it1++;
+            prev2 = it2++;
+        }
+    }
+    return removed;
+}
+
 /// @brief Prints the matrix in dynamic format to the standard output.
 /// @tparam T The type of the matrix elements.
 /// @tparam S The storage order (row-major or column-major).
@@ -544,17 +518,104 @@ void COO<T, S>::print_dynamic() const {
 template <NumericOrComplex T, StorageOrder S>
 std::vector<T> by_vector_dynamic(COO<T, S> const& m, std::vector<T> const& v) {
     std::vector<T> result(m.rows);
+    by_vector_dynamic(m, std::span<T const>(v), std::span<T>(result), T{1},
+                      T{0});
+    return result;
+}
+
+/// @brief Performs the matrix-vector product `result = alpha * m * v + beta *
+/// result` writing into a buffer owned by the caller.
+/// @param m An object of type COO representing the matrix, i.e. the lhs.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer, it must hold `m.get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @details When `beta` is zero the previous content of `result` is never
+/// read.
+template <NumericOrComplex T, StorageOrder S>
+void by_vector_dynamic(COO<T, S> const& m, std::span<T const> v,
+                       std::span<T> result, T alpha, T beta) {
+    if (beta == T{}) {
+        std::fill(result.begin(), result.end(), T{});
+    }
+    else if (beta != T{1}) {
+        for (auto& el : result) el *= beta;
+    }
+
+    auto indexit = m.indexptr->begin();
+    auto valuesit = m.valuesptr->begin();
+
+    while (indexit != m.indexptr->end()) {
+        result[indexit->first] += alpha * (*valuesit * v[indexit->second]);
+        ++indexit;
+        ++valuesit;
+    }
+}
+
+/// @brief Performs the transpose product `result = alpha * m^T * v + beta *
+/// result` writing into a buffer owned by the caller.
+/// @param m An object of type COO representing the matrix, i.e. the lhs.
+/// @param v The vector, it must hold `m.get_rows()` elements.
+/// @param result The output buffer, it must hold `m.get_columns()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @details The elements are visited as in `by_vector_dynamic`, with the
+/// roles of the row and the column index swapped.
+template <NumericOrComplex T, StorageOrder S>
+void by_vector_transpose_dynamic(COO<T, S> const& m, std::span<T const> v,
+                                 std::span<T> result, T alpha, T beta) {
+    if (beta == T{}) {
+        std::fill(result.begin(), result.end(), T{});
+    }
+    else if (beta != T{1}) {
+        for (auto& el : result) el *= beta;
+    }
 
     auto indexit = m.indexptr->begin();
     auto valuesit = m.valuesptr->begin();
 
     while (indexit != m.indexptr->end()) {
-        result[indexit->first] += *valuesit * v[indexit->second];
+        result[indexit->second] += alpha * (*valuesit * v[indexit->first]);
         ++indexit;
         ++valuesit;
     }
+}
 
-    return std::move(result);
+/// @brief Performs the product `y = alpha * m * x + beta * y` with a dense
+/// block of `k` vectors.
+/// @param m An object of type COO representing the matrix, i.e. the lhs.
+/// @param x The rhs block, row-major with `k` columns.
+/// @param y The output block, row-major with `k` columns, it must hold `k *
+/// m.get_rows()` elements.
+/// @param k The number of vectors in the blocks.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `y`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @details The elements are visited once per panel of the block, see
+/// `block_panels`, each one updating a contiguous row of the panel.
+template <NumericOrComplex T, StorageOrder S>
+void by_block_dynamic(COO<T, S> const& m, std::span<T const> x,
+                      std::span<T> y, size_t k, T alpha, T beta) {
+    block_scale(y, beta);
+
+    block_panels(k, [&](auto width, size_t first) {
+        constexpr size_t W = decltype(width)::value;
+        auto indexit = m.indexptr->begin();
+        auto valuesit = m.valuesptr->begin();
+
+        while (indexit != m.indexptr->end()) {
+            block_axpy<W>(x.data() + indexit->second * k + first,
+                          y.data() + indexit->first * k + first,
+                          alpha * *valuesit);
+            ++indexit;
+            ++valuesit;
+        }
+    });
 }
 
 }  // namespace algebra
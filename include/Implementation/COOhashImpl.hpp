@@ -0,0 +1,633 @@
+#ifndef COOHASHIMPL_HPP
+#define COOHASHIMPL_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "COOhash.hpp"
+#include "Comparators.hpp"
+#include "Concepts.hpp"
+#include "MatrixMarket.hpp"
+#include "Profiling.hpp"
+
+using namespace comparators;
+namespace algebra {
+
+/// @brief Constructs a COOhash matrix from index-value pairs.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam B Boolean constant to indicate wether the matrix' size was given
+/// as input.
+/// @param indexes The container of index pairs.
+/// @param values The container of matrix values.
+/// @details This constructor inserts the elements in a table large enough to
+/// hold all of them and, if the dimensions weren't given, infers them.
+template <NumericOrComplex T, StorageOrder S>
+template <bool B>
+COOhash<T, S>::COOhash(std::bool_constant<B>,
+                       SizetPairContainer auto const& indexes,
+                       NumericContainer auto const& values) {
+    if constexpr (B) check_dimensions();
+    size_t index_size =
+        static_cast<size_t>(std::distance(indexes.begin(), indexes.end()));
+#ifdef DEBUG
+    size_t values_size =
+        static_cast<size_t>(std::distance(values.begin(), values.end()));
+    assert(index_size == values_size &&
+           "Error in COOhash constructor: sizes don't match.\n");
+#endif
+
+    allocate_dynamic(index_size);
+
+    size_t max_index_r = 0, max_index_c = 0;
+    auto it2 = values.begin();
+    for (auto it1 = indexes.begin(); it1 != indexes.end(); ++it1, ++it2) {
+        auto [i, j] = *it1;
+#ifdef DEBUG
+        if constexpr (B) {
+            assert(i < this->rows && j < this->columns &&
+                   "Error in COOhash constructor: indexes out of bounds (too "
+                   "big).\n");
+        }
+        assert((*keysptr)[find_slot(pack(i, j))] == empty_key &&
+               "Error in COOhash constructor: redefinition of the same "
+               "element (equal indexes).\n");
+#endif
+
+        if constexpr (!B) {
+            max_index_r = std::max(max_index_r, i);
+            max_index_c = std::max(max_index_c, j);
+        }
+
+        find_dynamic(i, j) = *it2;
+    }
+
+    if constexpr (!B) this->resize(max_index_r + 1, max_index_c + 1);
+}
+
+/// @brief Constructs a COOhash matrix from a map of index-value pairs.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam B Boolean constant to indicate wether the matrix' size was given
+/// as input.
+/// @param m The map of index-value pairs.
+/// @details This constructor inserts the elements in a table large enough to
+/// hold all of them and, if the dimensions weren't given, infers them.
+template <NumericOrComplex T, StorageOrder S>
+template <bool B>
+COOhash<T, S>::COOhash(std::bool_constant<B>,
+                       std::map<std::pair<size_t, size_t>, T> const& m) {
+    if constexpr (B) check_dimensions();
+    allocate_dynamic(m.size());
+
+    size_t max_index_r = 0, max_index_c = 0;
+    for (auto const& [key, val] : m) {
+#ifdef DEBUG
+        if constexpr (B) {
+            assert(key.first < this->rows && key.second < this->columns &&
+                   "Error in COOhash constructor: indexes out of bounds (too "
+                   "big).\n");
+        }
+#endif
+
+        if constexpr (!B) {
+            max_index_r = std::max(max_index_r, key.first);
+            max_index_c = std::max(max_index_c, key.second);
+        }
+
+        find_dynamic(key.first, key.second) = val;
+    }
+
+    if constexpr (!B) this->resize(max_index_r + 1, max_index_c + 1);
+}
+
+/// @brief Constructs a COOhash matrix by reading data from a file.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @param file_name The name of the file to read the matrix data from.
+/// @details This constructor reads a `Matrix Market` file with `read_market`,
+/// honoring the field and the symmetry declared in the header. The entries are
+/// sorted with a counting sort on the lines and then inserted in order.
+template <NumericOrComplex T, StorageOrder S>
+COOhash<T, S>::COOhash(std::string& file_name) {
+    MarketData<T> data = read_market<T>(file_name);
+    this->resize(data.header.rows, data.header.columns);
+    check_dimensions();
+    std::vector<size_t> inner, outer;
+    std::vector<T> values;
+    market_to_compressed<T, S>(data, S == rowMajor ? this->rows : this->columns,
+                               inner, outer, values);
+
+    uncompress_from_triplets(values.size(), [&](auto&& receiver) {
+        for_each_compressed<S>(inner, outer, values, receiver);
+    });
+}
+
+/// @brief Packs a position in a key.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @param i The row index.
+/// @param j The column index.
+/// @return The key, with the line in the high half.
+template <NumericOrComplex T, StorageOrder S>
+std::uint64_t COOhash<T, S>::pack(size_t i, size_t j) {
+    if (i >= 0xffffffff || j >= 0xffffffff) {
+        throw std::overflow_error(
+            "Error in COOhash: indexes don't fit in 32 bits.");
+    }
+    if constexpr (S == rowMajor) {
+        return (static_cast<std::uint64_t>(i) << 32) | j;
+    }
+    else {
+        return (static_cast<std::uint64_t>(j) << 32) | i;
+    }
+}
+
+/// @brief Unpacks a key.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @param key The key.
+/// @return The row and column indexes.
+template <NumericOrComplex T, StorageOrder S>
+std::pair<size_t, size_t> COOhash<T, S>::unpack(std::uint64_t key) {
+    size_t line = static_cast<size_t>(key >> 32);
+    size_t index = static_cast<size_t>(key & 0xffffffff);
+    if constexpr (S == rowMajor) {
+        return {line, index};
+    }
+    else {
+        return {index, line};
+    }
+}
+
+/// @brief Checks that every position of the matrix can be packed in a key.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @details Throws `std::overflow_error` if the matrix has 2^32 rows or
+/// columns or more, since its last index couldn't be packed.
+template <NumericOrComplex T, StorageOrder S>
+void COOhash<T, S>::check_dimensions() const {
+    if (this->rows > 0xffffffff || this->columns > 0xffffffff) {
+        throw std::overflow_error(
+            "Error in COOhash: dimensions don't fit in 32 bits.");
+    }
+}
+
+/// @brief Finds the slot of a key.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @param key The key.
+/// @return The slot holding the key or, if it's not stored, the empty slot
+/// ending its cluster.
+/// @details The home slot is given by the high bits of the key multiplied by
+/// the golden ratio, which spreads consecutive positions of a line over the
+/// whole table; the following slots are then probed in order.
+template <NumericOrComplex T, StorageOrder S>
+size_t COOhash<T, S>::find_slot(std::uint64_t key) const {
+    auto const& keys = *keysptr;
+    size_t mask = keys.size() - 1;
+    size_t slot = static_cast<size_t>((key * 0x9e3779b97f4a7c15) >> shift);
+
+    while (keys[slot] != empty_key && keys[slot] != key) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+/// @brief Builds an empty table.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @param num_elements The number of elements the table must hold without
+/// growing.
+/// @details The capacity is the smallest power of two, not smaller than 16,
+/// keeping the load factor under 70%.
+template <NumericOrComplex T, StorageOrder S>
+void COOhash<T, S>::allocate_dynamic(size_t num_elements) {
+    size_t capacity = 16;
+    shift = 60;
+    while (num_elements * 10 > capacity * 7) {
+        capacity *= 2;
+        --shift;
+    }
+
+    keysptr = std::make_unique<keysvec>(capacity, empty_key);
+    valuesptr = std::make_unique<valuesvec>(capacity);
+    this->num_elements = 0;
+}
+
+/// @brief Moves the elements into a table with a different capacity.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @param num_elements The number of elements the new table must hold without
+/// growing.
+template <NumericOrComplex T, StorageOrder S>
+void COOhash<T, S>::rehash(size_t num_elements) {
+    auto keys = std::move(keysptr);
+    auto values = std::move(valuesptr);
+    allocate_dynamic(num_elements);
+
+    for (size_t slot = 0; slot < keys->size(); ++slot) {
+        if ((*keys)[slot] == empty_key) continue;
+        size_t target = find_slot((*keys)[slot]);
+        (*keysptr)[target] = (*keys)[slot];
+        (*valuesptr)[target] = (*values)[slot];
+        ++this->num_elements;
+    }
+}
+
+/// @brief Gets the elements sorted by key.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @return The keys and the values, sorted coherently with the storage order.
+/// @details The elements are distributed by line with a counting sort, then
+/// each line, usually short, is sorted on its own. The table is only read
+/// sequentially.
+template <NumericOrComplex T, StorageOrder S>
+std::vector<std::pair<std::uint64_t, T>> COOhash<T, S>::sorted_elements()
+    const {
+    auto const& keys = *keysptr;
+    auto const& values = *valuesptr;
+    size_t num_lines = (S == rowMajor) ? this->rows : this->columns;
+
+    std::vector<size_t> begin(num_lines + 1, 0);
+    for (auto key : keys) {
+        if (key != empty_key) ++begin[(key >> 32) + 1];
+    }
+    for (size_t line = 0; line < num_lines; ++line) {
+        begin[line + 1] += begin[line];
+    }
+
+    std::vector<std::pair<std::uint64_t, T>> elements(num_elements);
+    std::vector<size_t> next(begin.begin(), begin.end() - 1);
+    for (size_t slot = 0; slot < keys.size(); ++slot) {
+        if (keys[slot] != empty_key) {
+            elements[next[keys[slot] >> 32]++] = {keys[slot], values[slot]};
+        }
+    }
+
+    auto by_key = [](auto const& a, auto const& b) {
+        return a.first < b.first;
+    };
+    for (size_t line = 0; line < num_lines; ++line) {
+        std::sort(elements.begin() + begin[line],
+                  elements.begin() + begin[line + 1], by_key);
+    }
+    return elements;
+}
+
+/// @brief Finds the value at the specified position (read-only).
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @param i The row index.
+/// @param j The column index.
+/// @return The value at the specified position.
+/// @details If no match is found, it returns 0.
+template <NumericOrComplex T, StorageOrder S>
+T COOhash<T, S>::find_dynamic_const(size_t i, size_t j) const {
+    std::uint64_t key = pack(i, j);
+    size_t slot = find_slot(key);
+    return (*keysptr)[slot] == key ? (*valuesptr)[slot] : 0;
+}
+
+/// @brief Finds the value at the specified position (read-write).
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @param i The row index.
+/// @param j The column index.
+/// @return A reference to the value at the specified position.
+/// @details If the position does not exist, a new entry is added, doubling
+/// the capacity first if the table would be more than 70% full. As for any
+/// vector, the returned reference is invalidated by the next insertion.
+template <NumericOrComplex T, StorageOrder S>
+T& COOhash<T, S>::find_dynamic(size_t i, size_t j) {
+    std::uint64_t key = pack(i, j);
+    size_t slot = find_slot(key);
+    if ((*keysptr)[slot] == key) return (*valuesptr)[slot];
+
+    if ((num_elements + 1) * 10 > keysptr->size() * 7) {
+        rehash(2 * (num_elements + 1));
+        slot = find_slot(key);
+    }
+
+    (*keysptr)[slot] = key;
+    (*valuesptr)[slot] = T{};
+    ++num_elements;
+    return (*valuesptr)[slot];
+}
+
+/// @brief In the process of compressing the matrix sends all the triplets,
+/// coherently with the storage order.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam F The type of the receiver.
+/// @param receiver A callable taking the row index, the column index and the
+/// value of each element.
+/// @details The elements are sorted by key, which sorts them coherently with
+/// the storage order, see `sorted_elements`.
+template <NumericOrComplex T, StorageOrder S>
+template <typename F>
+void COOhash<T, S>::compress_from_dynamic(F&& receiver) const {
+    for (auto const& [key, value] : sorted_elements()) {
+        auto [i, j] = unpack(key);
+        receiver(i, j, value);
+    }
+}
+
+/// @brief Builds the data structure from the triplets sent by another format.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam F The type of the sender.
+/// @param num_elements The number of triplets that will be sent.
+/// @param sender A callable taking a receiver and calling it on every triplet,
+/// coherently with the storage order.
+/// @details The table is sized for all the triplets, so it never grows.
+template <NumericOrComplex T, StorageOrder S>
+template <typename F>
+void COOhash<T, S>::uncompress_from_triplets(size_t num_elements, F&& sender) {
+    PROFILE_SCOPE("uncompress", "COOhash");
+    check_dimensions();
+    allocate_dynamic(num_elements);
+
+    sender([&](size_t i, size_t j, T const& value) {
+        std::uint64_t key = pack(i, j);
+        size_t slot = find_slot(key);
+        (*keysptr)[slot] = key;
+        (*valuesptr)[slot] = value;
+        ++this->num_elements;
+    });
+    PROFILE_BYTES(num_elements * (sizeof(std::uint64_t) + sizeof(T)));
+}
+
+/// @brief Gets the number of non-zero elements.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @return The number of non-zero elements.
+template <NumericOrComplex T, StorageOrder S>
+size_t COOhash<T, S>::get_num_elements_dynamic() const {
+    return num_elements;
+}
+
+/// @brief Releases the dynamic storage format.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @details This function deallocates the memory used by the table.
+template <NumericOrComplex T, StorageOrder S>
+void COOhash<T, S>::release_dynamic() {
+    keysptr.reset();
+    valuesptr.reset();
+    num_elements = 0;
+}
+
+/// @brief Computes the norm of the matrix.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam N The type of norm to compute (Infinity, One, or Frobenius).
+/// @return The computed norm value.
+/// @details The sums are accumulated per row or per column, so the elements
+/// need not to be sorted.
+template <NumericOrComplex T, StorageOrder S>
+template <NormType N>
+double COOhash<T, S>::norm_dynamic() const {
+    auto const& keys = *keysptr;
+    auto const& values = *valuesptr;
+
+    if constexpr (N == Infinity || N == One) {
+        std::vector<double> partial_res(
+            N == Infinity ? this->rows : this->columns, 0);
+
+        for (size_t slot = 0; slot < keys.size(); ++slot) {
+            if (keys[slot] == empty_key) continue;
+            auto [i, j] = unpack(keys[slot]);
+            partial_res[N == Infinity ? i : j] += std::abs(values[slot]);
+        }
+        return *std::max_element(partial_res.begin(), partial_res.end());
+    }
+    else {
+        double sum = 0.0;
+
+        for (size_t slot = 0; slot < keys.size(); ++slot) {
+            if (keys[slot] == empty_key) continue;
+            sum += std::abs(values[slot]) * std::abs(values[slot]);
+        }
+        return std::sqrt(sum);
+    }
+}
+
+/// @brief Removes the element at the specified position.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @param i The row index.
+/// @param j The column index.
+/// @return True if the element was removed, false otherwise.
+/// @details The following elements of the cluster whose home slot doesn't lie
+/// between the hole and themselves are shifted back into the hole, so that
+/// every element stays reachable from its home slot.
+template <NumericOrComplex T, StorageOrder S>
+bool COOhash<T, S>::remove_dynamic(size_t i, size_t j) {
+    auto& keys = *keysptr;
+    auto& values = *valuesptr;
+
+    std::uint64_t key = pack(i, j);
+    size_t hole = find_slot(key);
+    if (keys[hole] != key) return false;
+
+    size_t mask = keys.size() - 1;
+    for (size_t next = (hole + 1) & mask; keys[next] != empty_key;
+         next = (next + 1) & mask) {
+        size_t home =
+            static_cast<size_t>((keys[next] * 0x9e3779b97f4a7c15) >> shift);
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            keys[hole] = keys[next];
+            values[hole] = values[next];
+            hole = next;
+        }
+    }
+
+    keys[hole] = empty_key;
+    values[hole] = T{};
+    --num_elements;
+    return true;
+}
+
+/// @brief Removes all the elements satisfying a predicate.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam F The type of the predicate.
+/// @param pred A callable taking the row index, the column index and the
+/// value of each element, and returning true if it has to be removed.
+/// @return The number of removed elements.
+/// @details The removed elements are cleared in a single pass, which breaks
+/// the clusters, then the kept ones are moved to a new table sized for them.
+template <NumericOrComplex T, StorageOrder S>
+template <typename F>
+size_t COOhash<T, S>::remove_if_dynamic(F&& pred) {
+    auto& keys = *keysptr;
+    auto& values = *valuesptr;
+
+    size_t removed = 0;
+    for (size_t slot = 0; slot < keys.size(); ++slot) {
+        if (keys[slot] == empty_key) continue;
+        auto [i, j] = unpack(keys[slot]);
+        if (pred(i, j, std::as_const(values[slot]))) {
+            keys[slot] = empty_key;
+            ++removed;
+        }
+    }
+
+    if (removed > 0) rehash(num_elements - removed);
+    return removed;
+}
+
+/// @brief Prints the matrix in dynamic format to the standard output.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @details This function visits the elements sorted by key and prints them
+/// in a human-readable format. It handles both row-major and column-major
+/// storage.
+template <NumericOrComplex T, StorageOrder S>
+void COOhash<T, S>::print_dynamic() const {
+    auto elements = sorted_elements();
+
+    size_t count = 0;
+    size_t outer_size = (S == rowMajor) ? this->rows : this->columns;
+    size_t inner_size = (S == rowMajor) ? this->columns : this->rows;
+
+    if constexpr (S == columnMajor) {
+        std::cout
+            << "Printing the transpose matrix (since it is stored column-wise)."
+            << std::endl;
+    }
+
+    for (size_t a = 0; a < outer_size; ++a) {
+        for (size_t b = 0; b < inner_size; ++b) {
+            auto position = (S == rowMajor) ? std::make_pair(a, b)
+                                            : std::make_pair(b, a);
+            if (count < elements.size() &&
+                unpack(elements[count].first) == position) {
+                std::cout << elements[count].second << " ";
+                count++;
+            }
+            else {
+                std::cout << "0 ";
+            }
+        }
+        std::cout << std::endl;
+    }
+}
+
+/// @brief Performs matrix-vector product.
+/// @param m An object of type COOhash representing the matrix, i.e. the lhs.
+/// @param v The vector, i.e. the rhs.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+std::vector<T> by_vector_dynamic(COOhash<T, S> const& m,
+                                 std::vector<T> const& v) {
+    std::vector<T> result(m.rows);
+    by_vector_dynamic(m, std::span<T const>(v), std::span<T>(result), T{1},
+                      T{0});
+    return result;
+}
+
+/// @brief Performs the matrix-vector product `result = alpha * m * v + beta *
+/// result` writing into a buffer owned by the caller.
+/// @param m An object of type COOhash representing the matrix, i.e. the lhs.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer, it must hold `m.get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @details The product doesn't depend on the order of the elements, so the
+/// table is streamed as it is.
+template <NumericOrComplex T, StorageOrder S>
+void by_vector_dynamic(COOhash<T, S> const& m, std::span<T const> v,
+                       std::span<T> result, T alpha, T beta) {
+    if (beta == T{}) {
+        std::fill(result.begin(), result.end(), T{});
+    }
+    else if (beta != T{1}) {
+        for (auto& el : result) el *= beta;
+    }
+
+    auto const& keys = *m.keysptr;
+    auto const& values = *m.valuesptr;
+
+    for (size_t slot = 0; slot < keys.size(); ++slot) {
+        if (keys[slot] == COOhash<T, S>::empty_key) continue;
+        auto [i, j] = COOhash<T, S>::unpack(keys[slot]);
+        result[i] += alpha * (values[slot] * v[j]);
+    }
+}
+
+/// @brief Performs the transpose product `result = alpha * m^T * v + beta *
+/// result` writing into a buffer owned by the caller.
+/// @param m An object of type COOhash representing the matrix, i.e. the lhs.
+/// @param v The vector, it must hold `m.get_rows()` elements.
+/// @param result The output buffer, it must hold `m.get_columns()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @details The elements are visited as in `by_vector_dynamic`, with the
+/// roles of the row and the column index swapped.
+template <NumericOrComplex T, StorageOrder S>
+void by_vector_transpose_dynamic(COOhash<T, S> const& m, std::span<T const> v,
+                                 std::span<T> result, T alpha, T beta) {
+    if (beta == T{}) {
+        std::fill(result.begin(), result.end(), T{});
+    }
+    else if (beta != T{1}) {
+        for (auto& el : result) el *= beta;
+    }
+
+    auto const& keys = *m.keysptr;
+    auto const& values = *m.valuesptr;
+
+    for (size_t slot = 0; slot < keys.size(); ++slot) {
+        if (keys[slot] == COOhash<T, S>::empty_key) continue;
+        auto [i, j] = COOhash<T, S>::unpack(keys[slot]);
+        result[j] += alpha * (values[slot] * v[i]);
+    }
+}
+
+/// @brief Performs the product `y = alpha * m * x + beta * y` with a dense
+/// block of `k` vectors.
+/// @param m An object of type COOhash representing the matrix, i.e. the lhs.
+/// @param x The rhs block, row-major with `k` columns.
+/// @param y The output block, row-major with `k` columns, it must hold `k *
+/// m.get_rows()` elements.
+/// @param k The number of vectors in the blocks.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `y`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @details The elements are visited once per panel of the block, see
+/// `block_panels`, each one updating a contiguous row of the panel.
+template <NumericOrComplex T, StorageOrder S>
+void by_block_dynamic(COOhash<T, S> const& m, std::span<T const> x,
+                      std::span<T> y, size_t k, T alpha, T beta) {
+    block_scale(y, beta);
+
+    auto const& keys = *m.keysptr;
+    auto const& values = *m.valuesptr;
+
+    block_panels(k, [&](auto width, size_t first) {
+        constexpr size_t W = decltype(width)::value;
+        for (size_t slot = 0; slot < keys.size(); ++slot) {
+            if (keys[slot] == COOhash<T, S>::empty_key) continue;
+            auto [i, j] = COOhash<T, S>::unpack(keys[slot]);
+            block_axpy<W>(x.data() + j * k + first, y.data() + i * k + first,
+                          alpha * values[slot]);
+        }
+    });
+}
+
+}  // namespace algebra
+
+#endif
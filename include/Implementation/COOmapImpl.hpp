@@ -4,10 +4,13 @@
 #include <cassert>
 #include <fstream>
 #include <iostream>
+#include <utility>
 
 #include "COOmap.hpp"
 #include "Comparators.hpp"
 #include "Concepts.hpp"
+#include "MatrixMarket.hpp"
+#include "Profiling.hpp"
 
 using namespace comparators;
 namespace algebra {
@@ -37,7 +40,7 @@ COOmap<T, S>::COOmap(std::bool_constant<B>,
 #endif
 
     size_t max_index_r = 0, max_index_c = 0;
-    matrixptr = std::make_unique<valuesmap>();
+    allocate_dynamic();
 
     auto it2 = values.begin();
     for (auto it1 = indexes.begin(); it1 != indexes.end(); ++it1) {
@@ -82,7 +85,7 @@ template <NumericOrComplex T, StorageOrder S>
 template <bool B>
 COOmap<T, S>::COOmap(std::bool_constant<B>,
                      std::map<std::pair<size_t, size_t>, T> const& m) {
-    matrixptr = std::make_unique<valuesmap>(Comparator<S>{});
+    allocate_dynamic();
 
     size_t max_index_r = 0, max_index_c = 0;
     for (auto const& [key, val] : m) {
@@ -113,42 +116,21 @@ COOmap<T, S>::COOmap(std::bool_constant<B>,
 /// @tparam T The type of the matrix elements.
 /// @tparam S The storage order (row-major or column-major).
 /// @param file_name The name of the file to read the matrix data from.
-/// @details This constructor reads a `Matrix Market` file, parses its contents,
-/// and initializes the matrix. It validates the file format and ensures that
-/// the indices are within bounds.
+/// @details This constructor reads a `Matrix Market` file with `read_market`,
+/// honoring the field and the symmetry declared in the header. The entries are
+/// sorted with a counting sort on the lines and then inserted in order.
 template <NumericOrComplex T, StorageOrder S>
 COOmap<T, S>::COOmap(std::string& file_name) {
-    std::ifstream file(file_name);
-#ifdef DEBUG
-    assert(file && "Cannot open file.");
-#endif
-
-    std::string line;
-    std::getline(file, line);
-#ifdef DEBUG
-    assert(line.substr(0, 14) == "%%MatrixMarket" &&
-           "Invalid Matrix Market file.");
-#endif
-
-    while (std::getline(file, line)) {
-        if (line.empty()) continue;
-        if (line[0] != '%') break;
-    }
-
-    std::istringstream dims(line);
-    int nnz;
-    dims >> this->rows >> this->columns >> nnz;
-
-    valuesmap m;
-    size_t row, col;
-    T value;
-    for (int i = 0; i < nnz && std::getline(file, line); ++i) {
-        std::istringstream dims(line);
-        dims >> row >> col >> value;
-        m[{row - 1, col - 1}] = value;
-    }
-
-    this->matrixptr = std::make_unique<valuesmap>(std::move(m));
+    MarketData<T> data = read_market<T>(file_name);
+    this->resize(data.header.rows, data.header.columns);
+    std::vector<size_t> inner, outer;
+    std::vector<T> values;
+    market_to_compressed<T, S>(data, S == rowMajor ? this->rows : this->columns,
+                               inner, outer, values);
+
+    uncompress_from_triplets(values.size(), [&](auto&& receiver) {
+        for_each_compressed<S>(inner, outer, values, receiver);
+    });
 }
 
 /// @brief Finds the value at the specified position (read-write).
@@ -180,42 +162,45 @@ T COOmap<T, S>::find_dynamic_const(size_t i, size_t j) const {
         return 0;
 }
 
-/// @brief In the process of compressing the matrix sends the next tuple.
+/// @brief In the process of compressing the matrix sends all the triplets,
+/// coherently with the storage order.
 /// @tparam T The type of the matrix elements.
 /// @tparam S The storage order (row-major or column-major).
-/// @param first_it Flags the first iteration.
-/// @param tupleptr Pointer to a tuple representing a matrix element.
-/// @details This function iterates through the dynamic data structure and
-/// sends the tuples to a receiver that uses them to build a compressed
-/// representation.
+/// @tparam F The type of the receiver.
+/// @param receiver A callable taking the row index, the column index and the
+/// value of each element.
+/// @details The map is ordered by the comparator of the storage order, so an
+/// in-order visit sends the triplets sorted.
 template <NumericOrComplex T, StorageOrder S>
-void COOmap<T, S>::compress_from_dynamic(
-    bool first_it, std::unique_ptr<ivtuple> const& tupleptr) {
-    auto static matrixit = (*matrixptr).begin();
-
-    if (first_it) {
-        matrixit = (*matrixptr).begin();
+template <typename F>
+void COOmap<T, S>::compress_from_dynamic(F&& receiver) const {
+    for (auto const& [key, value] : *matrixptr) {
+        receiver(key.first, key.second, value);
     }
-
-    (*tupleptr) = std::make_tuple((*matrixit).first.first,
-                                  (*matrixit).first.second, (*matrixit).second);
-
-    ++matrixit;
 }
 
-/// @brief Takes a triplet and inserts it into the data structure.
+/// @brief Builds the data structure from the triplets sent by another format.
 /// @tparam T The type of the matrix elements.
 /// @tparam S The storage order (row-major or column-major).
-/// @param first_it Flags the first iteration.
-/// @param tupleptr Pointer to a tuple representing a matrix element.
-/// @details This function takes a tuple and inserts its contents into the
-/// dynamic data structure.
+/// @tparam F The type of the sender.
+/// @param num_elements The number of triplets that will be sent.
+/// @param sender A callable taking a receiver and calling it on every triplet,
+/// coherently with the storage order.
+/// @details The triplets arrive sorted, so the end of the map is a correct
+/// hint and every insertion takes constant amortized time. A map can't be
+/// preallocated, so `num_elements` is only used by the profiler.
 template <NumericOrComplex T, StorageOrder S>
+template <typename F>
 void COOmap<T, S>::uncompress_from_triplets(
-    bool first_it, std::unique_ptr<ivtuple> const& tupleptr) {
-    (*matrixptr)[std::make_pair(std::get<0>(*tupleptr),
-                                std::get<1>(*tupleptr))] =
-        std::get<2>(*tupleptr);
+    [[maybe_unused]] size_t num_elements, F&& sender) {
+    PROFILE_SCOPE("uncompress", "COOmap");
+    allocate_dynamic();
+
+    sender([&](size_t i, size_t j, T const& value) {
+        matrixptr->emplace_hint(matrixptr->end(), std::make_pair(i, j), value);
+    });
+    PROFILE_BYTES(num_elements *
+                  (sizeof(std::pair<size_t, size_t>) + sizeof(T)));
 }
 
 /// @brief Gets the number of non-zero elements.
@@ -229,22 +214,25 @@ size_t COOmap<T, S>::get_num_elements_dynamic() const {
     return (*matrixptr).size();
 }
 
-/// @brief Initializes the dynamic storage format.
+/// @brief Releases the dynamic storage format.
 /// @tparam T The type of the matrix elements.
 /// @tparam S The storage order (row-major or column-major).
-/// @details This function allocates memory for the map.
+/// @details This function deallocates the memory used by the map, releasing
+/// the slabs of the arena without visiting the nodes.
 template <NumericOrComplex T, StorageOrder S>
-void COOmap<T, S>::initialize_dynamic() {
-    matrixptr = std::make_unique<valuesmap>();
+void COOmap<T, S>::release_dynamic() {
+    matrixptr.reset();
+    arena.release();
 }
 
-/// @brief Releases the dynamic storage format.
+/// @brief Builds an empty map in a released arena.
 /// @tparam T The type of the matrix elements.
 /// @tparam S The storage order (row-major or column-major).
-/// @details This function deallocates the memory used by the map.
+/// @details The previous map, if any, is released.
 template <NumericOrComplex T, StorageOrder S>
-void COOmap<T, S>::release_dynamic() {
-    matrixptr.reset();
+void COOmap<T, S>::allocate_dynamic() {
+    release_dynamic();
+    matrixptr.reset(arena.create<valuesmap>());
 }
 
 /// @brief Computes the norm of the matrix.
@@ -297,6 +285,31 @@ bool COOmap<T, S>::remove_dynamic(size_t i, size_t j) {
     return (*matrixptr).erase({i, j});
 }
 
+/// @brief Removes all the elements satisfying a predicate.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam F The type of the predicate.
+/// @param pred A callable taking the row index, the column index and the
+/// value of each element, and returning true if it has to be removed.
+/// @return The number of removed elements.
+/// @details The map is traversed once, erasing the removed elements.
+template <NumericOrComplex T, StorageOrder S>
+template <typename F>
+size_t COOmap<T, S>::remove_if_dynamic(F&& pred) {
+    size_t removed = 0;
+    for (auto it = matrixptr->begin(); it != matrixptr->end();) {
+        if (pred(it->first.first, it->first.second,
+                 std::as_const(it->second))) {
+            it = matrixptr->erase(it);
+            ++removed;
+        }
+        else {
+            ++it;
+        }
+    }
+    return removed;
+}
+
 /// @brief Prints the matrix in dynamic format to the standard output.
 /// @tparam T The type of the matrix elements.
 /// @tparam S The storage order (row-major or column-major).
@@ -353,14 +366,88 @@ template <NumericOrComplex T, StorageOrder S>
 std::vector<T> by_vector_dynamic(COOmap<T, S> const& m,
                                  std::vector<T> const& v) {
     std::vector<T> result(m.rows);
-    auto mapit = m.matrixptr->begin();
+    by_vector_dynamic(m, std::span<T const>(v), std::span<T>(result), T{1},
+                      T{0});
+    return result;
+}
+
+/// @brief Performs the matrix-vector product `result = alpha * m * v + beta *
+/// result` writing into a buffer owned by the caller.
+/// @param m An object of type COOmap representing the matrix, i.e. the lhs.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer, it must hold `m.get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @details When `beta` is zero the previous content of `result` is never
+/// read.
+template <NumericOrComplex T, StorageOrder S>
+void by_vector_dynamic(COOmap<T, S> const& m, std::span<T const> v,
+                       std::span<T> result, T alpha, T beta) {
+    if (beta == T{}) {
+        std::fill(result.begin(), result.end(), T{});
+    }
+    else if (beta != T{1}) {
+        for (auto& el : result) el *= beta;
+    }
+
+    for (auto const& [key, value] : *m.matrixptr) {
+        result[key.first] += alpha * (value * v[key.second]);
+    }
+}
 
-    while (mapit != m.matrixptr->end()) {
-        result[mapit->first.first] += mapit->second * v[mapit->first.second];
-        ++mapit;
+/// @brief Performs the transpose product `result = alpha * m^T * v + beta *
+/// result` writing into a buffer owned by the caller.
+/// @param m An object of type COOmap representing the matrix, i.e. the lhs.
+/// @param v The vector, it must hold `m.get_rows()` elements.
+/// @param result The output buffer, it must hold `m.get_columns()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @details The elements are visited as in `by_vector_dynamic`, with the
+/// roles of the row and the column index swapped.
+template <NumericOrComplex T, StorageOrder S>
+void by_vector_transpose_dynamic(COOmap<T, S> const& m, std::span<T const> v,
+                                 std::span<T> result, T alpha, T beta) {
+    if (beta == T{}) {
+        std::fill(result.begin(), result.end(), T{});
+    }
+    else if (beta != T{1}) {
+        for (auto& el : result) el *= beta;
     }
 
-    return std::move(result);
+    for (auto const& [key, value] : *m.matrixptr) {
+        result[key.second] += alpha * (value * v[key.first]);
+    }
+}
+
+/// @brief Performs the product `y = alpha * m * x + beta * y` with a dense
+/// block of `k` vectors.
+/// @param m An object of type COOmap representing the matrix, i.e. the lhs.
+/// @param x The rhs block, row-major with `k` columns.
+/// @param y The output block, row-major with `k` columns, it must hold `k *
+/// m.get_rows()` elements.
+/// @param k The number of vectors in the blocks.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `y`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @details The elements are visited once per panel of the block, see
+/// `block_panels`, each one updating a contiguous row of the panel.
+template <NumericOrComplex T, StorageOrder S>
+void by_block_dynamic(COOmap<T, S> const& m, std::span<T const> x,
+                      std::span<T> y, size_t k, T alpha, T beta) {
+    block_scale(y, beta);
+
+    block_panels(k, [&](auto width, size_t first) {
+        constexpr size_t W = decltype(width)::value;
+        for (auto const& [key, value] : *m.matrixptr) {
+            block_axpy<W>(x.data() + key.second * k + first,
+                          y.data() + key.first * k + first, alpha * value);
+        }
+    });
 }
 
 }  // namespace algebra
@@ -0,0 +1,594 @@
+#ifndef COOVECIMPL_HPP
+#define COOVECIMPL_HPP
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <ranges>
+#include <utility>
+
+#include "COOvec.hpp"
+#include "Comparators.hpp"
+#include "Concepts.hpp"
+#include "MatrixMarket.hpp"
+#include "Profiling.hpp"
+
+using namespace comparators;
+namespace algebra {
+
+/// @brief Constructs a COOvec matrix from index-value pairs.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam B Boolean constant to indicate wether the matrix' size was given
+/// as input.
+/// @param indexes The container of index pairs.
+/// @param values The container of matrix values.
+/// @details This constructor copies the input, sorts it based on the storage
+/// order and, if the dimensions weren't given, infers them.
+template <NumericOrComplex T, StorageOrder S>
+template <bool B>
+COOvec<T, S>::COOvec(std::bool_constant<B>,
+                     SizetPairContainer auto const& indexes,
+                     NumericContainer auto const& values) {
+    std::vector<std::pair<size_t, size_t>> tempindexes(indexes.begin(),
+                                                       indexes.end());
+    valuesvec tempvalues(values.begin(), values.end());
+
+#ifdef DEBUG
+    assert(tempindexes.size() == tempvalues.size() &&
+           "Error in COOvec constructor: sizes don't match.\n");
+#endif
+
+    assign_sorted(tempindexes, tempvalues);
+
+    if constexpr (!B) {
+        size_t max_index_r = 0, max_index_c = 0;
+        for (size_t k = 0; k < sorted_size; ++k) {
+            max_index_r = std::max(max_index_r, (*rowsptr)[k]);
+            max_index_c = std::max(max_index_c, (*colsptr)[k]);
+        }
+        this->resize(max_index_r + 1, max_index_c + 1);
+    }
+}
+
+/// @brief Constructs a COOvec matrix from a map of index-value pairs.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam B Boolean constant to indicate wether the matrix' size was given
+/// as input.
+/// @param m The map of index-value pairs.
+/// @details This constructor extracts keys and values from the input map and
+/// stores them sorted based on the storage order.
+template <NumericOrComplex T, StorageOrder S>
+template <bool B>
+COOvec<T, S>::COOvec(std::bool_constant<B>,
+                     std::map<std::pair<size_t, size_t>, T> const& m) {
+    std::vector<std::pair<size_t, size_t>> tempindexes;
+    valuesvec tempvalues;
+
+    tempindexes.reserve(m.size());
+    tempvalues.reserve(m.size());
+
+    for (auto const& [key, val] : m) {
+        tempindexes.push_back(key);
+        tempvalues.push_back(val);
+    }
+
+    assign_sorted(tempindexes, tempvalues);
+
+    if constexpr (!B) {
+        size_t max_index_r = 0, max_index_c = 0;
+        for (size_t k = 0; k < sorted_size; ++k) {
+            max_index_r = std::max(max_index_r, (*rowsptr)[k]);
+            max_index_c = std::max(max_index_c, (*colsptr)[k]);
+        }
+        this->resize(max_index_r + 1, max_index_c + 1);
+    }
+}
+
+/// @brief Constructs a COOvec matrix by reading data from a file.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @param file_name The name of the file to read the matrix data from.
+/// @details This constructor reads a `Matrix Market` file with `read_market`,
+/// honoring the field and the symmetry declared in the header. The entries are
+/// sorted with a counting sort on the lines and then inserted in order.
+template <NumericOrComplex T, StorageOrder S>
+COOvec<T, S>::COOvec(std::string& file_name) {
+    MarketData<T> data = read_market<T>(file_name);
+    this->resize(data.header.rows, data.header.columns);
+    comparator = Comparator<S>{};
+    std::vector<size_t> inner, outer;
+    std::vector<T> values;
+    market_to_compressed<T, S>(data, S == rowMajor ? this->rows : this->columns,
+                               inner, outer, values);
+
+    uncompress_from_triplets(values.size(), [&](auto&& receiver) {
+        for_each_compressed<S>(inner, outer, values, receiver);
+    });
+}
+
+/// @brief Sorts the input and stores it, replacing the current content.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @param indexes The index pairs.
+/// @param values The matrix values.
+/// @details The input is sorted in place with `sort_permutation` and
+/// `apply_permutation`, then split into the three vectors.
+template <NumericOrComplex T, StorageOrder S>
+void COOvec<T, S>::assign_sorted(
+    std::vector<std::pair<size_t, size_t>>& indexes, valuesvec& values) {
+    comparator = Comparator<S>{};
+    std::vector<size_t> p = sort_permutation(indexes, comparator);
+
+    apply_permutation(indexes, p);
+    apply_permutation(values, p);
+
+    rowsptr = std::make_unique<indexvec>();
+    colsptr = std::make_unique<indexvec>();
+    valuesptr = std::make_unique<valuesvec>(std::move(values));
+
+    rowsptr->reserve(indexes.size());
+    colsptr->reserve(indexes.size());
+
+    for (size_t k = 0; k < indexes.size(); ++k) {
+#ifdef DEBUG
+        assert((k == 0 || indexes[k] != indexes[k - 1]) &&
+               "Error in COOvec constructor: redefinition of the same element "
+               "(equal indexes).\n");
+#endif
+        rowsptr->push_back(indexes[k].first);
+        colsptr->push_back(indexes[k].second);
+    }
+
+    sorted_size = indexes.size();
+}
+
+/// @brief Visits the elements coherently with the storage order, merging the
+/// unsorted buffer on the fly.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam F The type of the visitor.
+/// @param visitor A callable taking the position of each element in the
+/// vectors.
+/// @details The buffer is sorted on its own and then merged with the sorted
+/// part in a single linear pass, so the cost is linear in the number of
+/// elements plus the cost of sorting the buffer.
+template <NumericOrComplex T, StorageOrder S>
+template <typename F>
+void COOvec<T, S>::for_each_sorted(F&& visitor) const {
+    size_t total = valuesptr->size();
+
+    std::vector<std::pair<size_t, size_t>> tail;
+    tail.reserve(total - sorted_size);
+    for (size_t k = sorted_size; k < total; ++k) {
+        tail.push_back({(*rowsptr)[k], (*colsptr)[k]});
+    }
+    std::vector<size_t> p = sort_permutation(tail, comparator);
+
+    size_t a = 0, b = 0;
+    while (a < sorted_size || b < p.size()) {
+        if (b == p.size() ||
+            (a < sorted_size &&
+             comparator(std::make_pair((*rowsptr)[a], (*colsptr)[a]),
+                        tail[p[b]]))) {
+            visitor(a++);
+        }
+        else {
+            visitor(sorted_size + p[b++]);
+        }
+    }
+}
+
+/// @brief Merges the unsorted buffer into the sorted part.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+void COOvec<T, S>::merge_buffer() {
+    size_t total = valuesptr->size();
+    if (sorted_size == total) return;
+    PROFILE_SCOPE("merge_buffer", "COOvec");
+    PROFILE_BYTES(2 * total * (2 * sizeof(size_t) + sizeof(T)));
+
+    auto rows = std::make_unique<indexvec>();
+    auto cols = std::make_unique<indexvec>();
+    auto values = std::make_unique<valuesvec>();
+    rows->reserve(total);
+    cols->reserve(total);
+    values->reserve(total);
+
+    for_each_sorted([&](size_t k) {
+        rows->push_back((*rowsptr)[k]);
+        cols->push_back((*colsptr)[k]);
+        values->push_back((*valuesptr)[k]);
+    });
+
+    rowsptr = std::move(rows);
+    colsptr = std::move(cols);
+    valuesptr = std::move(values);
+    sorted_size = total;
+}
+
+/// @brief Finds the position of an element.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @param i The row index.
+/// @param j The column index.
+/// @return The position in the vectors of the element, or the number of
+/// elements if it's not stored.
+/// @details The sorted part is binary searched, the unsorted buffer is
+/// scanned linearly.
+template <NumericOrComplex T, StorageOrder S>
+size_t COOvec<T, S>::find_position(size_t i, size_t j) const {
+    auto key = std::make_pair(i, j);
+    auto sorted = std::views::iota(size_t{0}, sorted_size);
+    auto it = std::ranges::partition_point(sorted, [&](size_t k) {
+        return comparator(std::make_pair((*rowsptr)[k], (*colsptr)[k]), key);
+    });
+
+    if (it != sorted.end() && (*rowsptr)[*it] == i && (*colsptr)[*it] == j) {
+        return *it;
+    }
+
+    for (size_t k = sorted_size; k < valuesptr->size(); ++k) {
+        if ((*rowsptr)[k] == i && (*colsptr)[k] == j) return k;
+    }
+
+    return valuesptr->size();
+}
+
+/// @brief Finds the value at the specified position (read-only).
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @param i The row index.
+/// @param j The column index.
+/// @return The value at the specified position.
+/// @details If no match is found, it returns 0.
+template <NumericOrComplex T, StorageOrder S>
+T COOvec<T, S>::find_dynamic_const(size_t i, size_t j) const {
+    size_t k = find_position(i, j);
+    return k < valuesptr->size() ? (*valuesptr)[k] : 0;
+}
+
+/// @brief Finds the value at the specified position (read-write).
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @param i The row index.
+/// @param j The column index.
+/// @return A reference to the value at the specified position.
+/// @details If the position does not exist, a new entry is appended to the
+/// unsorted buffer, which is merged first if it has grown too long. As for
+/// any vector, the returned reference is invalidated by the next insertion.
+template <NumericOrComplex T, StorageOrder S>
+T& COOvec<T, S>::find_dynamic(size_t i, size_t j) {
+    size_t k = find_position(i, j);
+    if (k < valuesptr->size()) return (*valuesptr)[k];
+
+    size_t buffer_size = valuesptr->size() - sorted_size;
+    if (buffer_size * buffer_size > sorted_size && buffer_size >= 64) {
+        merge_buffer();
+    }
+
+    rowsptr->push_back(i);
+    colsptr->push_back(j);
+    valuesptr->push_back(T{});
+    return valuesptr->back();
+}
+
+/// @brief In the process of compressing the matrix sends all the triplets,
+/// coherently with the storage order.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam F The type of the receiver.
+/// @param receiver A callable taking the row index, the column index and the
+/// value of each element.
+/// @details The buffer is merged on the fly, so that the triplets are sent in
+/// order without copying the vectors.
+template <NumericOrComplex T, StorageOrder S>
+template <typename F>
+void COOvec<T, S>::compress_from_dynamic(F&& receiver) const {
+    for_each_sorted([&](size_t k) {
+        receiver((*rowsptr)[k], (*colsptr)[k], (*valuesptr)[k]);
+    });
+}
+
+/// @brief Builds the data structure from the triplets sent by another format.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam F The type of the sender.
+/// @param num_elements The number of triplets that will be sent.
+/// @param sender A callable taking a receiver and calling it on every triplet,
+/// coherently with the storage order.
+/// @details The triplets arrive sorted, so they all end up in the sorted part.
+template <NumericOrComplex T, StorageOrder S>
+template <typename F>
+void COOvec<T, S>::uncompress_from_triplets(size_t num_elements, F&& sender) {
+    PROFILE_SCOPE("uncompress", "COOvec");
+    rowsptr = std::make_unique<indexvec>();
+    colsptr = std::make_unique<indexvec>();
+    valuesptr = std::make_unique<valuesvec>();
+
+    rowsptr->reserve(num_elements);
+    colsptr->reserve(num_elements);
+    valuesptr->reserve(num_elements);
+
+    sender([&](size_t i, size_t j, T const& value) {
+        rowsptr->push_back(i);
+        colsptr->push_back(j);
+        valuesptr->push_back(value);
+    });
+
+    sorted_size = valuesptr->size();
+    PROFILE_BYTES(sorted_size * (2 * sizeof(size_t) + sizeof(T)));
+}
+
+/// @brief Gets the number of non-zero elements.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @return The number of non-zero elements.
+/// @details This function returns the size of the values vector.
+template <NumericOrComplex T, StorageOrder S>
+size_t COOvec<T, S>::get_num_elements_dynamic() const {
+    return valuesptr->size();
+}
+
+/// @brief Releases the dynamic storage format.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @details This function deallocates the memory used by the three vectors.
+template <NumericOrComplex T, StorageOrder S>
+void COOvec<T, S>::release_dynamic() {
+    rowsptr.reset();
+    colsptr.reset();
+    valuesptr.reset();
+    sorted_size = 0;
+}
+
+/// @brief Computes the norm of the matrix.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam N The type of norm to compute (Infinity, One, or Frobenius).
+/// @return The computed norm value.
+/// @details The sums are accumulated per row or per column, so the unsorted
+/// buffer needs not to be merged.
+template <NumericOrComplex T, StorageOrder S>
+template <NormType N>
+double COOvec<T, S>::norm_dynamic() const {
+    if constexpr (N == Infinity || N == One) {
+        auto const& lines = (N == Infinity) ? *rowsptr : *colsptr;
+        std::vector<double> partial_res(
+            N == Infinity ? this->rows : this->columns, 0);
+
+        for (size_t k = 0; k < valuesptr->size(); ++k) {
+            partial_res[lines[k]] += std::abs((*valuesptr)[k]);
+        }
+        return *std::max_element(partial_res.begin(), partial_res.end());
+    }
+    else {
+        double sum = 0.0;
+
+        for (auto const& el : *valuesptr) {
+            sum += std::abs(el) * std::abs(el);
+        }
+        return std::sqrt(sum);
+    }
+}
+
+/// @brief Removes the element at the specified position.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @param i The row index.
+/// @param j The column index.
+/// @return True if the element was removed, false otherwise.
+/// @details Elements of the sorted part are erased preserving the order,
+/// elements of the buffer are replaced by the last one.
+template <NumericOrComplex T, StorageOrder S>
+bool COOvec<T, S>::remove_dynamic(size_t i, size_t j) {
+    size_t k = find_position(i, j);
+    if (k == valuesptr->size()) return false;
+
+    if (k < sorted_size) {
+        rowsptr->erase(rowsptr->begin() + k);
+        colsptr->erase(colsptr->begin() + k);
+        valuesptr->erase(valuesptr->begin() + k);
+        sorted_size--;
+    }
+    else {
+        (*rowsptr)[k] = rowsptr->back();
+        (*colsptr)[k] = colsptr->back();
+        (*valuesptr)[k] = valuesptr->back();
+        rowsptr->pop_back();
+        colsptr->pop_back();
+        valuesptr->pop_back();
+    }
+
+    return true;
+}
+
+/// @brief Removes all the elements satisfying a predicate.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam F The type of the predicate.
+/// @param pred A callable taking the row index, the column index and the
+/// value of each element, and returning true if it has to be removed.
+/// @return The number of removed elements.
+/// @details The kept elements are moved towards the front of the vectors in a
+/// single pass; their relative order doesn't change, so the sorted part stays
+/// sorted.
+template <NumericOrComplex T, StorageOrder S>
+template <typename F>
+size_t COOvec<T, S>::remove_if_dynamic(F&& pred) {
+    auto& rows = *rowsptr;
+    auto& cols = *colsptr;
+    auto& values = *valuesptr;
+
+    size_t write = 0;
+    size_t sorted = 0;
+    for (size_t k = 0; k < values.size(); ++k) {
+        if (!pred(rows[k], cols[k], std::as_const(values[k]))) {
+            rows[write] = rows[k];
+            cols[write] = cols[k];
+            values[write] = values[k];
+            ++write;
+            if (k < sorted_size) ++sorted;
+        }
+    }
+
+    size_t removed = values.size() - write;
+    rows.resize(write);
+    cols.resize(write);
+    values.resize(write);
+    sorted_size = sorted;
+    return removed;
+}
+
+/// @brief Prints the matrix in dynamic format to the standard output.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @details This function visits the elements in order without merging the
+/// buffer and prints them in a human-readable format. It handles both
+/// row-major and column-major storage.
+template <NumericOrComplex T, StorageOrder S>
+void COOvec<T, S>::print_dynamic() const {
+    std::vector<std::pair<size_t, size_t>> indexes;
+    indexes.reserve(valuesptr->size());
+    for (size_t k = 0; k < valuesptr->size(); ++k) {
+        indexes.push_back({(*rowsptr)[k], (*colsptr)[k]});
+    }
+    std::vector<size_t> p = sort_permutation(indexes, comparator);
+
+    size_t count = 0;
+    size_t outer_size = (S == rowMajor) ? this->rows : this->columns;
+    size_t inner_size = (S == rowMajor) ? this->columns : this->rows;
+
+    if constexpr (S == columnMajor) {
+        std::cout
+            << "Printing the transpose matrix (since it is stored column-wise)."
+            << std::endl;
+    }
+
+    for (size_t a = 0; a < outer_size; ++a) {
+        for (size_t b = 0; b < inner_size; ++b) {
+            auto position = (S == rowMajor) ? std::make_pair(a, b)
+                                            : std::make_pair(b, a);
+            if (count < p.size() && indexes[p[count]] == position) {
+                std::cout << (*valuesptr)[p[count]] << " ";
+                count++;
+            }
+            else {
+                std::cout << "0 ";
+            }
+        }
+        std::cout << std::endl;
+    }
+}
+
+/// @brief Performs matrix-vector product.
+/// @param m An object of type COOvec representing the matrix, i.e. the lhs.
+/// @param v The vector, i.e. the rhs.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+std::vector<T> by_vector_dynamic(COOvec<T, S> const& m,
+                                 std::vector<T> const& v) {
+    std::vector<T> result(m.rows);
+    by_vector_dynamic(m, std::span<T const>(v), std::span<T>(result), T{1},
+                      T{0});
+    return result;
+}
+
+/// @brief Performs the matrix-vector product `result = alpha * m * v + beta *
+/// result` writing into a buffer owned by the caller.
+/// @param m An object of type COOvec representing the matrix, i.e. the lhs.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer, it must hold `m.get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @details The product doesn't depend on the order of the elements, so the
+/// three vectors are streamed as they are.
+template <NumericOrComplex T, StorageOrder S>
+void by_vector_dynamic(COOvec<T, S> const& m, std::span<T const> v,
+                       std::span<T> result, T alpha, T beta) {
+    if (beta == T{}) {
+        std::fill(result.begin(), result.end(), T{});
+    }
+    else if (beta != T{1}) {
+        for (auto& el : result) el *= beta;
+    }
+
+    auto const& rows = *m.rowsptr;
+    auto const& cols = *m.colsptr;
+    auto const& values = *m.valuesptr;
+
+    for (size_t k = 0; k < values.size(); ++k) {
+        result[rows[k]] += alpha * (values[k] * v[cols[k]]);
+    }
+}
+
+/// @brief Performs the transpose product `result = alpha * m^T * v + beta *
+/// result` writing into a buffer owned by the caller.
+/// @param m An object of type COOvec representing the matrix, i.e. the lhs.
+/// @param v The vector, it must hold `m.get_rows()` elements.
+/// @param result The output buffer, it must hold `m.get_columns()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @details The elements are visited as in `by_vector_dynamic`, with the
+/// roles of the row and the column index swapped.
+template <NumericOrComplex T, StorageOrder S>
+void by_vector_transpose_dynamic(COOvec<T, S> const& m, std::span<T const> v,
+                                 std::span<T> result, T alpha, T beta) {
+    if (beta == T{}) {
+        std::fill(result.begin(), result.end(), T{});
+    }
+    else if (beta != T{1}) {
+        for (auto& el : result) el *= beta;
+    }
+
+    auto const& rows = *m.rowsptr;
+    auto const& cols = *m.colsptr;
+    auto const& values = *m.valuesptr;
+
+    for (size_t k = 0; k < values.size(); ++k) {
+        result[cols[k]] += alpha * (values[k] * v[rows[k]]);
+    }
+}
+
+/// @brief Performs the product `y = alpha * m * x + beta * y` with a dense
+/// block of `k` vectors.
+/// @param m An object of type COOvec representing the matrix, i.e. the lhs.
+/// @param x The rhs block, row-major with `k` columns.
+/// @param y The output block, row-major with `k` columns, it must hold `k *
+/// m.get_rows()` elements.
+/// @param k The number of vectors in the blocks.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `y`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @details The elements are visited once per panel of the block, see
+/// `block_panels`, each one updating a contiguous row of the panel.
+template <NumericOrComplex T, StorageOrder S>
+void by_block_dynamic(COOvec<T, S> const& m, std::span<T const> x,
+                      std::span<T> y, size_t k, T alpha, T beta) {
+    block_scale(y, beta);
+
+    auto const& rows = *m.rowsptr;
+    auto const& cols = *m.colsptr;
+    auto const& values = *m.valuesptr;
+
+    block_panels(k, [&](auto width, size_t first) {
+        constexpr size_t W = decltype(width)::value;
+        for (size_t l = 0; l < values.size(); ++l) {
+            block_axpy<W>(x.data() + cols[l] * k + first,
+                          y.data() + rows[l] * k + first, alpha * values[l]);
+        }
+    });
+}
+
+}  // namespace algebra
+
+#endif
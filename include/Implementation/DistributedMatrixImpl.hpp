@@ -0,0 +1,359 @@
+#ifndef DISTRIBUTEDMATRIXIMPL_HPP
+#define DISTRIBUTEDMATRIXIMPL_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <numeric>
+#include <span>
+#include <type_traits>
+
+#include "DistributedMatrix.hpp"
+#include "MatrixImpl.hpp"
+#include "MatrixMarket.hpp"
+#include "YALEImpl.hpp"
+
+namespace algebra {
+
+/// @brief MPI datatype made of the bytes of a trivially copyable type, freed
+/// when it goes out of scope.
+/// @tparam U The type.
+template <typename U>
+class MPIBytesType {
+    static_assert(std::is_trivially_copyable_v<U>);
+
+   public:
+    /// @brief Creates and commits the datatype.
+    MPIBytesType() {
+        MPI_Type_contiguous(static_cast<int>(sizeof(U)), MPI_BYTE, &type);
+        MPI_Type_commit(&type);
+    }
+
+    MPIBytesType(MPIBytesType const&) = delete;
+    MPIBytesType& operator=(MPIBytesType const&) = delete;
+
+    /// @brief Frees the datatype.
+    ~MPIBytesType() { MPI_Type_free(&type); }
+
+    /// @brief Gets the datatype.
+    /// @return The datatype.
+    MPI_Datatype get() const { return type; }
+
+   private:
+    MPI_Datatype type;  ///< The datatype.
+};
+
+/// @brief Splits a range into contiguous blocks of about the same length.
+/// @param length The length of the range.
+/// @param num_parts The number of blocks.
+/// @return The `num_parts + 1` boundaries of the blocks.
+inline std::vector<size_t> block_offsets(size_t length, int num_parts) {
+    std::vector<size_t> offsets(num_parts + 1);
+    for (int k = 0; k <= num_parts; ++k) {
+        offsets[k] = length / num_parts * k +
+                     std::min<size_t>(k, length % num_parts);
+    }
+    return offsets;
+}
+
+/// @brief Constructs a matrix from elements given by any process, each one is
+/// sent to the owner of its row.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam Dynamic The class template for dynamic storage of the local
+/// blocks.
+/// @param comm The communicator.
+/// @param rows The number of rows.
+/// @param columns The number of columns.
+/// @param indexes The global row and column indexes of the elements given by
+/// this process, each position given once by all the processes.
+/// @param values The values of the elements.
+template <NumericOrComplex T, template <typename, StorageOrder> class Dynamic>
+DistributedMatrix<T, Dynamic>::DistributedMatrix(
+    MPI_Comm comm, size_t rows, size_t columns,
+    std::vector<std::pair<size_t, size_t>> const& indexes,
+    std::vector<T> const& values)
+    : comm(comm),
+      rows(rows),
+      columns(columns),
+      diagonal(UseCompressed{}, 0, 0, std::vector<size_t>{},
+               std::vector<size_t>{0}, std::vector<T>{}),
+      off_diagonal(UseCompressed{}, 0, 0, std::vector<size_t>{},
+                   std::vector<size_t>{0}, std::vector<T>{}) {
+#ifdef DEBUG
+    assert(indexes.size() == values.size() &&
+           "Error in DistributedMatrix constructor: sizes don't match.\n");
+#endif
+
+    std::vector<Entry> entries(indexes.size());
+    for (size_t k = 0; k < indexes.size(); ++k) {
+        entries[k] = {indexes[k].first, indexes[k].second, values[k]};
+    }
+    distribute(entries);
+}
+
+/// @brief Constructs a matrix by reading a Matrix Market file, each process
+/// parsing only its share of the entries.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam Dynamic The class template for dynamic storage of the local
+/// blocks.
+/// @param comm The communicator.
+/// @param file_name The name of the file, readable by every process.
+/// @details Process `r` of `p` parses the `r`-th of `p` slices of the file,
+/// cut at line boundaries by `read_market_part`, adds the entries implied by
+/// the symmetry of the file and sends each entry to the owner of its row, so
+/// no process parses or holds more than its share of the file.
+template <NumericOrComplex T, template <typename, StorageOrder> class Dynamic>
+DistributedMatrix<T, Dynamic>::DistributedMatrix(MPI_Comm comm,
+                                                 std::string const& file_name)
+    : comm(comm),
+      diagonal(UseCompressed{}, 0, 0, std::vector<size_t>{},
+               std::vector<size_t>{0}, std::vector<T>{}),
+      off_diagonal(UseCompressed{}, 0, 0, std::vector<size_t>{},
+                   std::vector<size_t>{0}, std::vector<T>{}) {
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    MarketData<T> data = read_market_part<T>(file_name, rank, size);
+    rows = data.header.rows;
+    columns = data.header.columns;
+
+#ifdef DEBUG
+    unsigned long long count = data.values.size(), total = 0;
+    MPI_Allreduce(&count, &total, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, comm);
+    assert(total == data.header.entries &&
+           "Error in Matrix Market reader: wrong number of entries.\n");
+#endif
+
+    bool general = data.header.symmetry == MarketSymmetry::General;
+    std::vector<Entry> entries;
+    entries.reserve(general ? data.values.size() : 2 * data.values.size());
+    for (size_t k = 0; k < data.values.size(); ++k) {
+        entries.push_back({data.rows[k], data.columns[k], data.values[k]});
+        if (!general && data.rows[k] != data.columns[k]) {
+            entries.push_back(
+                {data.columns[k], data.rows[k],
+                 mirrored_value(data.values[k], data.header.symmetry)});
+        }
+    }
+    distribute(entries);
+}
+
+/// @brief Sends each element to the owner of its row, then builds the local
+/// blocks and the plan of the halo exchange.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam Dynamic The class template for dynamic storage of the local
+/// blocks.
+/// @param entries The elements given by this process.
+/// @details The rows and the columns are split in blocks of the same length
+/// up to one. The elements are bucketed by owner with a counting sort and
+/// exchanged by a single `MPI_Alltoallv`, then the received ones are split
+/// between the two blocks and compressed by `market_to_compressed`.
+template <NumericOrComplex T, template <typename, StorageOrder> class Dynamic>
+void DistributedMatrix<T, Dynamic>::distribute(
+    std::vector<Entry> const& entries) {
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    row_offsets = block_offsets(rows, size);
+    column_offsets = block_offsets(columns, size);
+
+    auto row_owner = [&](size_t i) {
+        return static_cast<int>(std::upper_bound(row_offsets.begin(),
+                                                 row_offsets.end(), i) -
+                                row_offsets.begin() - 1);
+    };
+
+    std::vector<int> send_counts(size, 0), recv_counts(size, 0);
+    for (auto const& entry : entries) {
+#ifdef DEBUG
+        assert(entry.row < rows && entry.column < columns &&
+               "Error in DistributedMatrix constructor: indexes out of "
+               "bounds.\n");
+#endif
+        send_counts[row_owner(entry.row)]++;
+    }
+    MPI_Alltoall(send_counts.data(), 1, MPI_INT, recv_counts.data(), 1,
+                 MPI_INT, comm);
+
+    std::vector<int> send_displs(size + 1, 0), recv_displs(size + 1, 0);
+    std::partial_sum(send_counts.begin(), send_counts.end(),
+                     send_displs.begin() + 1);
+    std::partial_sum(recv_counts.begin(), recv_counts.end(),
+                     recv_displs.begin() + 1);
+
+    std::vector<Entry> sorted(entries.size());
+    std::vector<int> next(send_displs.begin(), send_displs.end() - 1);
+    for (auto const& entry : entries) {
+        sorted[next[row_owner(entry.row)]++] = entry;
+    }
+
+    std::vector<Entry> received(recv_displs.back());
+    MPIBytesType<Entry> entry_type;
+    MPI_Alltoallv(sorted.data(), send_counts.data(), send_displs.data(),
+                  entry_type.get(), received.data(), recv_counts.data(),
+                  recv_displs.data(), entry_type.get(), comm);
+
+    const size_t row_begin = get_row_begin();
+    const size_t column_begin = get_column_begin();
+    const size_t column_end = get_column_end();
+    const size_t local_rows = get_row_end() - row_begin;
+
+    ghosts.clear();
+    for (auto const& entry : received) {
+        if (entry.column < column_begin || entry.column >= column_end) {
+            ghosts.push_back(entry.column);
+        }
+    }
+    std::sort(ghosts.begin(), ghosts.end());
+    ghosts.erase(std::unique(ghosts.begin(), ghosts.end()), ghosts.end());
+
+    MarketData<T> diagonal_data, off_diagonal_data;
+    for (auto const& entry : received) {
+        bool owned = entry.column >= column_begin && entry.column < column_end;
+        auto& data = owned ? diagonal_data : off_diagonal_data;
+        data.rows.push_back(entry.row - row_begin);
+        data.columns.push_back(
+            owned ? entry.column - column_begin
+                  : static_cast<size_t>(std::lower_bound(ghosts.begin(),
+                                                         ghosts.end(),
+                                                         entry.column) -
+                                        ghosts.begin()));
+        data.values.push_back(entry.value);
+    }
+
+    auto build = [&](MarketData<T> const& data, size_t num_columns) {
+        std::vector<size_t> inner, outer;
+        std::vector<T> values;
+        market_to_compressed<T, rowMajor>(data, local_rows, inner, outer,
+                                          values, 1);
+        return LocalMatrix(UseCompressed{}, local_rows, num_columns, outer,
+                           inner, values);
+    };
+    diagonal = build(diagonal_data, column_end - column_begin);
+    off_diagonal = build(off_diagonal_data, ghosts.size());
+
+    plan_exchange();
+}
+
+/// @brief Builds the lists of the entries to send to and to receive from each
+/// process in the product.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam Dynamic The class template for dynamic storage of the local
+/// blocks.
+/// @details The ghost columns are sorted, so those owned by each process are
+/// contiguous and are received in place. Each process tells the owners which
+/// of their entries it needs, by an `MPI_Alltoall` of the counts and an
+/// `MPI_Alltoallv` of the indexes; only the processes actually exchanging
+/// entries are kept as neighbours.
+template <NumericOrComplex T, template <typename, StorageOrder> class Dynamic>
+void DistributedMatrix<T, Dynamic>::plan_exchange() {
+    std::vector<int> need_counts(size, 0), give_counts(size, 0);
+    recv_ranks.clear();
+    recv_offsets.assign(1, 0);
+    for (size_t k = 0; k < ghosts.size();) {
+        int owner = static_cast<int>(
+            std::upper_bound(column_offsets.begin(), column_offsets.end(),
+                             ghosts[k]) -
+            column_offsets.begin() - 1);
+        size_t end = k;
+        while (end < ghosts.size() &&
+               ghosts[end] < column_offsets[owner + 1]) {
+            ++end;
+        }
+        need_counts[owner] = static_cast<int>(end - k);
+        recv_ranks.push_back(owner);
+        recv_offsets.push_back(end);
+        k = end;
+    }
+    MPI_Alltoall(need_counts.data(), 1, MPI_INT, give_counts.data(), 1,
+                 MPI_INT, comm);
+
+    std::vector<int> need_displs(size + 1, 0), give_displs(size + 1, 0);
+    std::partial_sum(need_counts.begin(), need_counts.end(),
+                     need_displs.begin() + 1);
+    std::partial_sum(give_counts.begin(), give_counts.end(),
+                     give_displs.begin() + 1);
+
+    send_indexes.resize(give_displs.back());
+    MPIBytesType<size_t> index_type;
+    MPI_Alltoallv(ghosts.data(), need_counts.data(), need_displs.data(),
+                  index_type.get(), send_indexes.data(), give_counts.data(),
+                  give_displs.data(), index_type.get(), comm);
+
+    const size_t column_begin = get_column_begin();
+    for (auto& index : send_indexes) index -= column_begin;
+
+    send_ranks.clear();
+    send_offsets.assign(1, 0);
+    for (int q = 0; q < size; ++q) {
+        if (give_counts[q] == 0) continue;
+        send_ranks.push_back(q);
+        send_offsets.push_back(give_displs[q + 1]);
+    }
+
+    ghost_values.resize(ghosts.size());
+    send_values.resize(send_indexes.size());
+    requests.resize(recv_ranks.size() + send_ranks.size());
+}
+
+/// @brief Performs the distributed matrix-vector product `y = A * x`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam Dynamic The class template for dynamic storage of the local
+/// blocks.
+/// @param x The owned entries of the vector, i.e. the rhs, it must hold
+/// `get_column_end() - get_column_begin()` elements.
+/// @param y The owned entries of the result, it must hold `get_row_end() -
+/// get_row_begin()` elements.
+/// @param num_threads The number of threads of the local products, zero means
+/// as many as the hardware supports.
+/// @details The receives of the ghost entries are posted first, then the
+/// requested owned entries are packed and sent, all nonblocking. The diagonal
+/// block is multiplied while the messages are in flight, and the
+/// off-diagonal block is added once they have all arrived. The buffers are
+/// allocated once, when the matrix is built, so the product doesn't
+/// allocate; they also make it unsafe to call from several threads at once.
+template <NumericOrComplex T, template <typename, StorageOrder> class Dynamic>
+void DistributedMatrix<T, Dynamic>::multiply_into(std::span<T const> x,
+                                                  std::span<T> y,
+                                                  unsigned num_threads) {
+#ifdef DEBUG
+    assert(x.size() == get_column_end() - get_column_begin() &&
+           y.size() == get_row_end() - get_row_begin() &&
+           "Error in call to multiply_into: non-matching dimensions.\n");
+    for (size_t k = 0; k + 1 < send_offsets.size(); ++k) {
+        assert((send_offsets[k + 1] - send_offsets[k]) * sizeof(T) <=
+                   static_cast<size_t>(INT_MAX) &&
+               "Error in call to multiply_into: halo message too large.\n");
+    }
+#endif
+    const int tag = 0;
+    size_t num_requests = 0;
+
+    for (size_t k = 0; k < recv_ranks.size(); ++k) {
+        size_t count = recv_offsets[k + 1] - recv_offsets[k];
+        MPI_Irecv(ghost_values.data() + recv_offsets[k],
+                  static_cast<int>(count * sizeof(T)), MPI_BYTE, recv_ranks[k],
+                  tag, comm, &requests[num_requests++]);
+    }
+
+    for (size_t k = 0; k < send_indexes.size(); ++k) {
+        send_values[k] = x[send_indexes[k]];
+    }
+    for (size_t k = 0; k < send_ranks.size(); ++k) {
+        size_t count = send_offsets[k + 1] - send_offsets[k];
+        MPI_Isend(send_values.data() + send_offsets[k],
+                  static_cast<int>(count * sizeof(T)), MPI_BYTE, send_ranks[k],
+                  tag, comm, &requests[num_requests++]);
+    }
+
+    diagonal.multiply_into(x, y, T{1}, T{0}, num_threads);
+
+    MPI_Waitall(static_cast<int>(num_requests), requests.data(),
+                MPI_STATUSES_IGNORE);
+
+    if (!ghosts.empty()) {
+        off_diagonal.multiply_into(ghost_values, y, T{1}, T{1}, num_threads);
+    }
+}
+
+}  // namespace algebra
+#endif
@@ -0,0 +1,165 @@
+#ifndef KRYLOVIMPL_HPP
+#define KRYLOVIMPL_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include "Krylov.hpp"
+#include "MatrixImpl.hpp"
+#include "VectorKernels.hpp"
+
+namespace algebra {
+
+/// @brief Solves `A * x = b` with the conjugate gradient method, for
+/// symmetric (hermitian if complex) positive definite matrices.
+/// @param a The matrix `A`, square.
+/// @param b The right-hand side.
+/// @param x The initial guess, overwritten with the solution.
+/// @param tolerance The relative residual `|b - A * x| / |b|` to reach.
+/// @param max_iterations The maximum number of iterations, zero means as many
+/// as the rows of the matrix.
+/// @param num_threads The number of threads used by the products in
+/// compressed state, zero means as many as the hardware supports.
+/// @return The number of iterations, the final relative residual and whether
+/// the tolerance was reached.
+/// @details Each iteration sweeps the matrix once, with `multiply_dot`
+/// computing `q = A * p` together with `p^H * q`, and updates the residual
+/// together with its norm, so each iteration makes four passes over the
+/// vectors instead of six.
+MATRIX_TEMPLATE
+SolverResult conjugate_gradient(MATRIX_TYPE const& a,
+                                std::type_identity_t<std::span<T const>> b,
+                                std::type_identity_t<std::span<T>> x,
+                                double tolerance, std::size_t max_iterations,
+                                unsigned num_threads) {
+    const std::size_t n = a.get_rows();
+#ifdef DEBUG
+    assert(a.get_columns() == n && b.size() == n && x.size() == n &&
+           "Error in call to conjugate_gradient: non-matching dimensions.\n");
+#endif
+    if (max_iterations == 0) max_iterations = n;
+
+    SolverResult result;
+    const double b_norm = squared_norm(b);
+    if (b_norm == 0.0) {
+        std::fill(x.begin(), x.end(), T{});
+        result.converged = true;
+        return result;
+    }
+    const double target = tolerance * tolerance * b_norm;
+
+    std::vector<T> r(b.begin(), b.end()), q(n);
+    double rr = a.multiply_residual(x, r, T{1}, num_threads);
+    std::vector<T> p(r);
+
+    while (rr > target && result.iterations < max_iterations) {
+        T pq = a.multiply_dot(p, q, num_threads);
+        if (pq == T{}) break;
+
+        T alpha = static_cast<T>(rr) / pq;
+        axpy<T>(alpha, p, x);
+        double rr_new = axpy_norm<T>(-alpha, q, r);
+        xpby<T>(r, static_cast<T>(rr_new / rr), p);
+
+        rr = rr_new;
+        ++result.iterations;
+    }
+
+    result.residual = std::sqrt(rr / b_norm);
+    result.converged = rr <= target;
+    return result;
+}
+
+/// @brief Solves `A * x = b` with the stabilized biconjugate gradient method
+/// (BiCGSTAB), for general square matrices.
+/// @param a The matrix `A`, square.
+/// @param b The right-hand side.
+/// @param x The initial guess, overwritten with the solution.
+/// @param tolerance The relative residual `|b - A * x| / |b|` to reach.
+/// @param max_iterations The maximum number of iterations, zero means as many
+/// as the rows of the matrix.
+/// @param num_threads The number of threads used by the products in
+/// compressed state, zero means as many as the hardware supports.
+/// @return The number of iterations, the final relative residual and whether
+/// the tolerance was reached.
+/// @details The two products of each iteration are `v = A * p` and `t = A *
+/// s`; the second one computes `s^H * t` with `multiply_dot`, and the updates
+/// of `s` and `r` compute their norms in the same pass. The intermediate
+/// vector `s` overwrites `r`. The iterations stop early on a breakdown, i.e.
+/// when a denominator vanishes.
+MATRIX_TEMPLATE
+SolverResult bicgstab(MATRIX_TYPE const& a,
+                      std::type_identity_t<std::span<T const>> b,
+                      std::type_identity_t<std::span<T>> x, double tolerance,
+                      std::size_t max_iterations, unsigned num_threads) {
+    const std::size_t n = a.get_rows();
+#ifdef DEBUG
+    assert(a.get_columns() == n && b.size() == n && x.size() == n &&
+           "Error in call to bicgstab: non-matching dimensions.\n");
+#endif
+    if (max_iterations == 0) max_iterations = n;
+
+    SolverResult result;
+    const double b_norm = squared_norm(b);
+    if (b_norm == 0.0) {
+        std::fill(x.begin(), x.end(), T{});
+        result.converged = true;
+        return result;
+    }
+    const double target = tolerance * tolerance * b_norm;
+
+    std::vector<T> r(b.begin(), b.end());
+    double rr = a.multiply_residual(x, r, T{1}, num_threads);
+    const std::vector<T> r_hat(r);
+    std::vector<T> p(n, T{}), v(n, T{}), t(n);
+    T rho{1}, alpha{1}, omega{1};
+
+    while (rr > target && result.iterations < max_iterations) {
+        T rho_new = dot<T>(r_hat, r);
+        if (rho_new == T{}) break;
+
+        T beta = (rho_new / rho) * (alpha / omega);
+        for (std::size_t i = 0; i < n; ++i) {
+            p[i] = r[i] + beta * (p[i] - omega * v[i]);
+        }
+
+        a.multiply_into(p, v, T{1}, T{0}, num_threads);
+        T rv = dot<T>(r_hat, v);
+        if (rv == T{}) break;
+        alpha = rho_new / rv;
+
+        double ss = axpy_norm<T>(-alpha, v, r);
+        ++result.iterations;
+        if (ss <= target) {
+            axpy<T>(alpha, p, x);
+            rr = ss;
+            break;
+        }
+
+        T st = a.multiply_dot(r, t, num_threads);
+        double tt = squared_norm<T>(t);
+        if (tt == 0.0) {
+            axpy<T>(alpha, p, x);
+            rr = ss;
+            break;
+        }
+        omega = conjugate(st) / static_cast<T>(tt);
+
+        for (std::size_t i = 0; i < n; ++i) {
+            x[i] += alpha * p[i] + omega * r[i];
+        }
+        rr = axpy_norm<T>(-omega, t, r);
+        rho = rho_new;
+        if (omega == T{}) break;
+    }
+
+    result.residual = std::sqrt(rr / b_norm);
+    result.converged = rr <= target;
+    return result;
+}
+
+}  // namespace algebra
+
+#endif
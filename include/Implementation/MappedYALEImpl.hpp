@@ -0,0 +1,222 @@
+#ifndef MAPPEDYALEIMPL_HPP
+#define MAPPEDYALEIMPL_HPP
+
+#include <cassert>
+#include <cstring>
+#include <iostream>
+
+#include "CompressedKernels.hpp"
+#include "MappedYALE.hpp"
+#include "Snapshot.hpp"
+
+using namespace comparators;
+namespace algebra {
+
+/// @brief Maps a binary snapshot.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @param file_name The name of the file written by `save_snapshot`.
+/// @details The header is checked against the template arguments and the
+/// inner index array against the header, then the arrays are viewed in
+/// place: nothing is copied nor parsed. The outer indexes and the values are
+/// trusted, see `check_snapshot_lines`.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+MappedYALE<T, S, I, P>::MappedYALE(std::string const& file_name)
+    : file{file_name} {
+    this->resize(0, 0);
+
+    std::string_view text = file.view();
+    bool valid = check_snapshot<S, T, P, I>(text);
+
+    SnapshotHeader header;
+    std::span<P const> lines;
+    if (valid) {
+        std::memcpy(&header, text.data(), sizeof(SnapshotHeader));
+        size_t num_lines = (S == rowMajor) ? header.rows : header.columns;
+        lines = {reinterpret_cast<P const*>(text.data() + header.inner_offset),
+                 num_lines + 1};
+        valid = check_snapshot_lines(lines, header.nnz);
+    }
+
+#ifdef DEBUG
+    assert(valid &&
+           "Error in MappedYALE constructor: invalid or incompatible "
+           "snapshot.\n");
+#endif
+    if (!valid) return;
+
+    this->resize(header.rows, header.columns);
+    inner = lines;
+    outer = {reinterpret_cast<I const*>(text.data() + header.outer_offset),
+             header.nnz};
+    values = {reinterpret_cast<T const*>(text.data() + header.values_offset),
+              header.nnz};
+}
+
+/// @brief Checks if the snapshot was mapped successfully.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @return True if the snapshot matched the template arguments.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+bool MappedYALE<T, S, I, P>::is_valid() const {
+    return !inner.empty();
+}
+
+/// @brief Accesses the element at the specified position.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @param i The row index.
+/// @param j The column index.
+/// @return The value at the specified position.
+/// @details If no match is found, it returns 0.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+T MappedYALE<T, S, I, P>::operator()(std::size_t i, std::size_t j) const {
+#ifdef DEBUG
+    assert(i < this->rows && j < this->columns &&
+           "Error in call to MappedYALE::operator(): indexes out of bounds.\n");
+#endif
+
+    return compressed_find<S>(inner, outer, values, i, j);
+}
+
+/// @brief Gets the number of non-zero elements in the matrix.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @return The number of non-zero elements.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+size_t MappedYALE<T, S, I, P>::get_num_elements() const {
+    return values.size();
+}
+
+/// @brief Computes the norm of the matrix.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @tparam N The type of norm to compute (Infinity, One, or Frobenius).
+/// @return The computed norm value.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+template <NormType N>
+double MappedYALE<T, S, I, P>::norm() const {
+    return compressed_norm<N, S>(inner, outer, values, this->rows,
+                                 this->columns);
+}
+
+/// @brief Performs the matrix-vector product `y = alpha * A * x + beta * y`
+/// writing into a buffer owned by the caller.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @param x The vector, i.e. the rhs.
+/// @param y The output buffer, it must hold `get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `y`.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+void MappedYALE<T, S, I, P>::multiply_into(std::span<T const> x,
+                                           std::span<T> y, T alpha, T beta,
+                                           unsigned num_threads) const {
+#ifdef DEBUG
+    assert(x.size() == this->columns &&
+           "Error in call to multiply_into: wrong size of the rhs.\n");
+    assert(y.size() == this->rows &&
+           "Error in call to multiply_into: wrong size of the output.\n");
+#endif
+
+    if (num_threads == 1) {
+        compressed_product<S>(inner, outer, values, x, y, alpha, beta);
+    }
+    else {
+        compressed_product_parallel<S>(inner, outer, values, x, y, alpha, beta,
+                                       num_threads);
+    }
+}
+
+/// @brief Gets the inner index array.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @return A read-only view of the beginning of each line.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+std::span<P const> MappedYALE<T, S, I, P>::get_inner_indexes() const {
+    return inner;
+}
+
+/// @brief Gets the outer index array.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @return A read-only view of the outer index of each element.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+std::span<I const> MappedYALE<T, S, I, P>::get_outer_indexes() const {
+    return outer;
+}
+
+/// @brief Gets the values array.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @return A read-only view of the value of each element.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+std::span<T const> MappedYALE<T, S, I, P>::get_values() const {
+    return values;
+}
+
+/// @brief Prints the matrix in compressed format to the standard output.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @details The output is the same of `YALE::print_compressed`.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+void MappedYALE<T, S, I, P>::print() const {
+    std::cout << "Values: ";
+    for (const auto& el : values) {
+        std::cout << el << " ";
+    }
+    std::cout << std::endl;
+    std::cout << "Outer indexes: ";
+    for (auto const& el : outer) {
+        std::cout << el << " ";
+    }
+    std::cout << std::endl;
+
+    std::cout << "Inner indexes: ";
+    for (auto const& el : inner) {
+        std::cout << el << " ";
+    }
+    std::cout << std::endl;
+}
+
+/// @brief Performs matrix-vector product.
+/// @param m An object of type MappedYALE representing the matrix, i.e. the
+/// lhs.
+/// @param v The vector, i.e. the rhs.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+std::vector<T> operator*(MappedYALE<T, S, I, P> const& m,
+                         std::vector<T> const& v) {
+    std::vector<T> result(m.rows);
+    m.multiply_into(v, result);
+    return result;
+}
+
+}  // namespace algebra
+
+#endif
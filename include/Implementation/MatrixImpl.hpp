@@ -1,11 +1,19 @@
 #ifndef MATRIX_IMPL_HPP
 #define MATRIX_IMPL_HPP
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <memory>
+#include <mutex>
+#include <utility>
 
+#include "CompressedKernels.hpp"
 #include "Dimensions.hpp"
 #include "Matrix.hpp"
+#include "Reordering.hpp"
+#include "SpGEMMKernels.hpp"
+#include "VectorKernels.hpp"
 
 using namespace comparators;
 namespace algebra {
@@ -110,7 +118,9 @@ MATRIX_TYPE::Matrix(UseDynamic, ConvertibleToSizeT auto const r,
 /// parsing the contents of the specified file.
 MATRIX_TEMPLATE
 MATRIX_TYPE::Matrix(std::string& file_name)
-    : Compressed<T, S>{}, Dynamic<T, S>{file_name} {}
+    : Compressed<T, S>{}, Dynamic<T, S>{file_name} {
+    isCompressed = false;
+}
 
 /// @brief Accesses the element at the specified position (read-only).
 /// @param i The row index.
@@ -132,19 +142,37 @@ T MATRIX_TYPE::operator()(std::size_t i, std::size_t j) const {
     }
 }
 
-/// @brief Accesses the element at the specified position (read-write).
+/// @brief Accesses the element at the specified position (read-write),
+/// inserting a zero if it's not stored, the same as `at_or_insert`.
+/// @param i The row index.
+/// @param j The column index.
+/// @return A reference to the value at the specified position.
+/// @details Reading through a non-const matrix fills it with explicit zeros,
+/// `freeze` gives a view which only reads.
+MATRIX_TEMPLATE
+T& MATRIX_TYPE::operator()(std::size_t i, std::size_t j) {
+    return at_or_insert(i, j);
+}
+
+/// @brief Accesses the element at the specified position (read-write),
+/// inserting a zero if it's not stored.
 /// @param i The row index.
 /// @param j The column index.
 /// @return A reference to the value at the specified position.
 /// @details This function checks whether the matrix is compressed or dynamic
 /// and retrieves a reference to the value at the specified position
-/// accordingly.
+/// accordingly. The cached properties are cleared, as an element may be
+/// inserted. The reference can be written at any later time, so the norms
+/// are no longer cached until `compress` or `uncompress` rebuild the storage
+/// and the references handed out are no longer valid.
 MATRIX_TEMPLATE
-T& MATRIX_TYPE::operator()(std::size_t i, std::size_t j) {
+T& MATRIX_TYPE::at_or_insert(std::size_t i, std::size_t j) {
 #ifdef DEBUG
     assert(i < this->rows && j < this->columns && i >= 0 && j >= 0 &&
-           "Error in call to operator(): indexes out of bounds.\n");
+           "Error in call to at_or_insert: indexes out of bounds.\n");
 #endif
+    invalidate_cache();
+    hasWritableReferences = true;
     if (!isCompressed) {
         return this->find_dynamic(i, j);
     }
@@ -153,6 +181,42 @@ T& MATRIX_TYPE::operator()(std::size_t i, std::size_t j) {
     }
 }
 
+/// @brief Sets the element at the specified position, inserting it if it's
+/// not stored.
+/// @param i The row index.
+/// @param j The column index.
+/// @param value The value of the element.
+/// @details No reference is handed out, so the norms are still cached
+/// afterwards.
+MATRIX_TEMPLATE
+void MATRIX_TYPE::insert(std::size_t i, std::size_t j, T const& value) {
+    const bool references = hasWritableReferences;
+    at_or_insert(i, j) = value;
+    hasWritableReferences = references;
+}
+
+/// @brief Calls a function on every stored element, without modifying the
+/// matrix.
+/// @tparam F The type of the function.
+/// @param f A callable taking the row index, the column index and the value
+/// of each element.
+/// @details The elements are streamed by the same sender used by `compress`
+/// or `uncompress`, in the order of the storage: line by line in compressed
+/// state.
+MATRIX_TEMPLATE
+template <typename F>
+void MATRIX_TYPE::for_each(F&& f) const {
+    auto receiver = [&f](size_t i, size_t j, T const& value) {
+        f(i, j, value);
+    };
+    if (!isCompressed) {
+        this->compress_from_dynamic(receiver);
+    }
+    else {
+        this->uncompress_from_compressed(receiver);
+    }
+}
+
 /// @brief Checks if the matrix is in compressed storage format.
 /// @return True if the matrix is compressed, false otherwise.
 /// @details This function returns the value of the `isCompressed` flag.
@@ -175,76 +239,241 @@ size_t MATRIX_TYPE::get_num_elements() const {
 
 /// @brief Compresses the matrix into a compact storage format.
 /// @details This function converts the matrix from dynamic to compressed
-/// storage format by iterating through its elements and transferring them
-/// into the compressed structure.
+/// storage format: the compressed format receives a sender that streams
+/// every element of the dynamic format through the receiver it provides, in a
+/// single pass and without any state shared between matrices.
 MATRIX_TEMPLATE
 void MATRIX_TYPE::compress() {
 #ifdef DEBUG
     assert(isCompressed == false &&
            "Error in call to compress method: matrix already compressed.\n");
+    assert(!isAssembling &&
+           "Error in call to compress method: assembly in progress.\n");
 #endif
 
-    size_t num_elements = get_num_elements();
-
-    if constexpr (S == rowMajor) {
-        this->initialize_compressed(this->get_rows() + 1, num_elements,
-                                    num_elements);
-    }
-    else {
-        this->initialize_compressed(this->get_columns() + 1, num_elements,
-                                    num_elements);
-    }
-
-    auto tupleptr = std::make_unique<std::tuple<size_t, size_t, T>>();
-    for (size_t i = 0; i < num_elements; ++i) {
-        (this)->compress_from_dynamic(i == 0, tupleptr);
-        (this)->compress_from_triplets(i == num_elements - 1, tupleptr);
-    }
+    this->compress_from_triplets(
+        get_num_elements(),
+        [this](auto&& receiver) { this->compress_from_dynamic(receiver); });
 
     this->release_dynamic();
+    invalidate_cache();
+    hasWritableReferences = false;
     isCompressed = true;
 }
 
 /// @brief Uncompresses the matrix into a dynamic storage format.
 /// @details This function converts the matrix from compressed to dynamic
-/// storage format by iterating through its elements and transferring them
-/// into the dynamic structure.
+/// storage format: the dynamic format receives a sender that streams every
+/// element of the compressed format through the receiver it provides, in a
+/// single pass and without any state shared between matrices.
 MATRIX_TEMPLATE
 void MATRIX_TYPE::uncompress() {
 #ifdef DEBUG
     assert(
         isCompressed == true &&
         "Error in call to uncompress method: matrix already uncompressed.\n");
+    assert(!isAssembling &&
+           "Error in call to uncompress method: assembly in progress.\n");
 #endif
 
-    size_t num_elements = get_num_elements();
-
-    this->initialize_dynamic();
-
-    auto tupleptr = std::make_unique<std::tuple<size_t, size_t, T>>();
-    for (size_t i = 0; i < num_elements; ++i) {
-        (this)->uncompress_from_compressed(i == 0, tupleptr);
-        (this)->uncompress_from_triplets(i == 0, tupleptr);
-    }
+    this->uncompress_from_triplets(get_num_elements(), [this](auto&& receiver) {
+        this->uncompress_from_compressed(receiver);
+    });
 
     this->release_compressed();
+    invalidate_cache();
+    hasWritableReferences = false;
     isCompressed = false;
 }
 
+/// @brief Gets the range of the elements of a row of a row-major matrix,
+/// compressed in a YALE-like format.
+/// @param i The row index.
+/// @return The range of the column indexes and of the values, holding spans
+/// into the compressed arrays.
+/// @details The formats providing `lines_compressed`, i.e. YALE and
+/// MixedYALE, store each row contiguously, so the range costs as much as a
+/// loop over the arrays. It's invalidated by any modification of the matrix.
+MATRIX_TEMPLATE
+auto MATRIX_TYPE::row(std::size_t i) const
+    requires(S == rowMajor)
+{
+#ifdef DEBUG
+    assert(isCompressed && "Error in call to row: matrix not compressed.\n");
+    assert(i < this->rows && "Error in call to row: index out of bounds.\n");
+#endif
+    return nonzeros().line(i);
+}
+
+/// @brief Gets the range of the elements of a column of a column-major
+/// matrix, compressed in a YALE-like format.
+/// @param j The column index.
+/// @return The range of the row indexes and of the values, holding spans
+/// into the compressed arrays.
+/// @details The same as `row`, for column-major matrices.
+MATRIX_TEMPLATE
+auto MATRIX_TYPE::column(std::size_t j) const
+    requires(S == columnMajor)
+{
+#ifdef DEBUG
+    assert(isCompressed &&
+           "Error in call to column: matrix not compressed.\n");
+    assert(j < this->columns &&
+           "Error in call to column: index out of bounds.\n");
+#endif
+    return nonzeros().line(j);
+}
+
+/// @brief Gets the range of the elements of a matrix compressed in a
+/// YALE-like format, line by line.
+/// @return The range of the rows, the columns and the values, whose `line`
+/// method gives the range of a line.
+/// @details The other formats, and the dynamic state, are traversed by
+/// `for_each`.
+MATRIX_TEMPLATE
+auto MATRIX_TYPE::nonzeros() const {
+#ifdef DEBUG
+    assert(isCompressed &&
+           "Error in call to nonzeros: matrix not compressed.\n");
+#endif
+    return lines_compressed(static_cast<const Compressed<T, S>&>(*this));
+}
+
 /// @brief Computes the norm of the matrix.
 /// @tparam N The type of norm to compute (infinity, one, or Frobenius).
 /// @return The computed norm value.
 /// @details This function checks whether the matrix is compressed or dynamic
-/// and computes the specified norm accordingly.
+/// and computes the specified norm accordingly. The norm is cached, so that
+/// it's computed again only after the matrix is modified, unless references
+/// handed out by the read-write `operator()` may still be written. The cache
+/// is filled holding its mutex, so several threads can ask for a norm at
+/// once.
 MATRIX_TEMPLATE
 template <NormType N>
 double MATRIX_TYPE::norm() const {
-    if (!isCompressed) {
-        return (this)->template norm_dynamic<N>();
+    auto compute = [this] {
+        if (!isCompressed) {
+            return (this)->template norm_dynamic<N>();
+        }
+        else {
+            return (this)->template norm_compressed<N>();
+        }
+    };
+    if (hasWritableReferences) return compute();
+
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    auto& cached = cache.norms[N];
+    if (!cached) cached = compute();
+    return *cached;
+}
+
+/// @brief Gets the structural properties of the matrix.
+/// @return The number of elements, the length of each row and of the longest
+/// one, the bandwidth and the number of elements on the diagonal.
+/// @details The properties are computed in a single pass of `for_each`, so
+/// every format provides them; they're cached until the matrix is modified,
+/// and computed holding the mutex of the cache.
+MATRIX_TEMPLATE
+MatrixStats const& MATRIX_TYPE::stats() const {
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    if (!cache.stats) {
+        MatrixStats stats;
+        stats.row_lengths.assign(this->rows, 0);
+        for_each([&stats](size_t i, size_t j, T const&) {
+            stats.num_elements++;
+            stats.row_lengths[i]++;
+            stats.bandwidth = std::max(stats.bandwidth, i > j ? i - j : j - i);
+            if (i == j) stats.num_diagonal++;
+        });
+        for (auto const& length : stats.row_lengths) {
+            stats.max_row_length = std::max(stats.max_row_length, length);
+        }
+        cache.stats = std::move(stats);
     }
-    else {
-        return (this)->template norm_compressed<N>();
+    return *cache.stats;
+}
+
+/// @brief Extracts the diagonal of the matrix, e.g. for a Jacobi
+/// preconditioner.
+/// @return The elements `(i, i)`, zero if not stored, for `i` up to the
+/// smaller dimension.
+/// @details Compressed formats providing `diagonal_positions_compressed`
+/// locate the diagonal in the values array once, then the positions are
+/// cached, holding the mutex of the cache, and each call is a gather. The
+/// other formats, and the dynamic state, look up every element with
+/// `operator()`.
+MATRIX_TEMPLATE
+std::vector<T> MATRIX_TYPE::diagonal() const {
+    const size_t n = std::min(this->rows, this->columns);
+    std::vector<T> result(n, T{0});
+
+    if constexpr (requires(Compressed<T, S> const& c) {
+                      diagonal_positions_compressed(c);
+                  }) {
+        if (isCompressed) {
+            auto const& c = static_cast<const Compressed<T, S>&>(*this);
+            std::vector<size_t> const* cached;
+            {
+                std::lock_guard<std::mutex> lock(cache.mutex);
+                if (!cache.diagonal_positions) {
+                    cache.diagonal_positions = diagonal_positions_compressed(c);
+                }
+                cached = &*cache.diagonal_positions;
+            }
+
+            auto const& positions = *cached;
+            auto values = c.get_values();
+            for (size_t i = 0; i < n; ++i) {
+                if (positions[i] != no_position) {
+                    result[i] = static_cast<T>(values[positions[i]]);
+                }
+            }
+            return result;
+        }
     }
+
+    for (size_t i = 0; i < n; ++i) result[i] = (*this)(i, i);
+    return result;
+}
+
+/// @brief Moves the cached properties of another matrix.
+/// @param other The cache to move.
+/// @details The mutex isn't movable, so each cache keeps its own; moving a
+/// matrix mustn't race with its const methods anyway.
+MATRIX_TEMPLATE
+MATRIX_TYPE::Cache::Cache(Cache&& other) noexcept
+    : norms(other.norms),
+      stats(std::move(other.stats)),
+      diagonal_positions(std::move(other.diagonal_positions)) {}
+
+/// @brief Moves the cached properties of another matrix.
+/// @param other The cache to move.
+/// @return This cache.
+MATRIX_TEMPLATE
+typename MATRIX_TYPE::Cache& MATRIX_TYPE::Cache::operator=(
+    Cache&& other) noexcept {
+    norms = other.norms;
+    stats = std::move(other.stats);
+    diagonal_positions = std::move(other.diagonal_positions);
+    return *this;
+}
+
+/// @brief Clears the cached properties depending on the values and the copy
+/// on the device, called by the modifications keeping the sparsity pattern.
+/// @details The structural properties and the positions of the diagonal stay
+/// valid, so a numeric update doesn't have to compute them again.
+MATRIX_TEMPLATE
+void MATRIX_TYPE::invalidate_values() {
+    cache.norms = {};
+    release_device();
+}
+
+/// @brief Clears the cached properties and the copy on the device, called by
+/// every modification.
+MATRIX_TEMPLATE
+void MATRIX_TYPE::invalidate_cache() {
+    cache = Cache{};
+    release_device();
 }
 
 /// @brief Removes the element at the specified position.
@@ -259,6 +488,7 @@ bool MATRIX_TYPE::remove(size_t i, size_t j) {
     assert(i < this->rows && j < this->columns && i >= 0 && j >= 0 &&
            "Error in call method remove: indexes out of bounds.\n");
 #endif
+    invalidate_cache();
     if (!isCompressed) {
         return (this)->remove_dynamic(i, j);
     }
@@ -267,6 +497,183 @@ bool MATRIX_TYPE::remove(size_t i, size_t j) {
     }
 }
 
+/// @brief Removes all the elements satisfying a predicate.
+/// @tparam F The type of the predicate.
+/// @param pred A callable taking the row index, the column index and the
+/// value of each element, and returning true if it has to be removed.
+/// @return The number of removed elements.
+/// @details Unlike repeated calls to `remove`, the storage is compacted in a
+/// single pass in both states.
+MATRIX_TEMPLATE
+template <typename F>
+size_t MATRIX_TYPE::remove_if(F&& pred) {
+#ifdef DEBUG
+    assert(!isAssembling &&
+           "Error in call to remove_if: assembly in progress.\n");
+#endif
+    invalidate_cache();
+    if (!isCompressed) {
+        return this->remove_if_dynamic(std::forward<F>(pred));
+    }
+    else {
+        return this->remove_if_compressed(std::forward<F>(pred));
+    }
+}
+
+/// @brief Removes the elements whose absolute value doesn't exceed a
+/// tolerance, e.g. to sparsify the matrix.
+/// @param tolerance The tolerance, by default only zeros are removed.
+/// @return The number of removed elements.
+MATRIX_TEMPLATE
+size_t MATRIX_TYPE::prune(double tolerance) {
+    return remove_if([tolerance](size_t, size_t, T const& value) {
+        return std::abs(value) <= tolerance;
+    });
+}
+
+/// @brief Finds the positions of elements in the values array of a matrix
+/// compressed in a YALE-like format, e.g. once for a sparsity pattern reused
+/// by many numeric updates.
+/// @param indexes The container of the positions, as pairs of row and column
+/// indexes.
+/// @return The position of each element, or `no_position` if it's not
+/// stored, valid until the sparsity pattern changes.
+/// @details Finding the positions costs one binary search per element, then
+/// `add_values` updates the elements without searching them again.
+MATRIX_TEMPLATE
+std::vector<size_t> MATRIX_TYPE::value_positions(
+    SizetPairContainer auto const& indexes) const {
+    static_assert(
+        requires(Compressed<T, S> const& c) {
+            c.positions_compressed(indexes);
+        },
+        "value_positions needs a YALE-like compressed format");
+#ifdef DEBUG
+    assert(isCompressed && !isAssembling &&
+           "Error in call to value_positions: matrix must be compressed.\n");
+#endif
+
+    return this->positions_compressed(indexes);
+}
+
+/// @brief Sets all the stored values of a compressed matrix to zero, keeping
+/// its sparsity pattern.
+/// @details The compressed arrays are reused as they are, e.g. at every step
+/// of a time-stepping scheme whose pattern doesn't change, instead of
+/// building a new matrix and compressing it.
+MATRIX_TEMPLATE
+void MATRIX_TYPE::zero_values() {
+    static_assert(
+        requires(Compressed<T, S>& c) { c.zero_values_compressed(); },
+        "zero_values needs a YALE-like compressed format");
+#ifdef DEBUG
+    assert(isCompressed && !isAssembling &&
+           "Error in call to zero_values: matrix must be compressed.\n");
+#endif
+
+    invalidate_values();
+    this->zero_values_compressed();
+}
+
+/// @brief Adds contributions to stored elements of a compressed matrix, at
+/// the positions found by `value_positions`.
+/// @param positions The position of each contribution, none of them
+/// `no_position`. The same position can appear many times.
+/// @param values The contributions.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @details Nothing is searched nor allocated. With more than one thread the
+/// contributions are split between them and added atomically, since several
+/// of them can target the same element.
+MATRIX_TEMPLATE
+void MATRIX_TYPE::add_values(std::span<size_t const> positions,
+                             std::span<T const> values,
+                             unsigned num_threads) {
+    static_assert(
+        requires(Compressed<T, S>& c) {
+            c.add_values_compressed(positions, values, num_threads);
+        },
+        "add_values needs a YALE-like compressed format");
+#ifdef DEBUG
+    assert(isCompressed && !isAssembling &&
+           "Error in call to add_values: matrix must be compressed.\n");
+    assert(positions.size() == values.size() &&
+           "Error in call to add_values: positions and values have different "
+           "sizes.\n");
+#endif
+
+    invalidate_values();
+    this->add_values_compressed(positions, values, num_threads);
+}
+
+/// @brief Starts a batched assembly, elements are inserted by `insert_batch`
+/// until `assembly_end` is called.
+/// @param mode How an inserted element is combined with the one already
+/// stored at the same position.
+/// @details In compressed state the inserted elements are buffered and merged
+/// all together by `assembly_end`, so that inserting `n` elements in a matrix
+/// with `nnz` non-zero elements costs `O(n log n + nnz)` instead of the
+/// `O(n * nnz)` of the insertions through `operator()`.
+MATRIX_TEMPLATE
+void MATRIX_TYPE::assembly_begin(InsertMode mode) {
+#ifdef DEBUG
+    assert(!isAssembling &&
+           "Error in call to assembly_begin: assembly already started.\n");
+#endif
+    isAssembling = true;
+    insertMode = mode;
+}
+
+/// @brief Inserts a batch of elements during an assembly.
+/// @param indexes The container of the positions, as pairs of row and column
+/// indexes.
+/// @param values The container of the values.
+/// @details In dynamic state the elements are inserted right away, in
+/// compressed state they can't be read until `assembly_end` is called.
+MATRIX_TEMPLATE
+void MATRIX_TYPE::insert_batch(SizetPairContainer auto const& indexes,
+                               NumericContainer auto const& values) {
+#ifdef DEBUG
+    assert(isAssembling &&
+           "Error in call to insert_batch: assembly not started.\n");
+    assert(indexes.size() == values.size() &&
+           "Error in call to insert_batch: indexes and values have different "
+           "sizes.\n");
+#endif
+    invalidate_cache();
+    auto value = values.begin();
+    for (auto const& [i, j] : indexes) {
+        if (!isCompressed) {
+#ifdef DEBUG
+            assert(i < this->rows && j < this->columns &&
+                   "Error in call to insert_batch: indexes out of bounds.\n");
+#endif
+            auto& element = this->find_dynamic(i, j);
+            element = (insertMode == Add) ? element + *value : *value;
+        }
+        else {
+            this->insert_compressed(i, j, *value);
+        }
+        ++value;
+    }
+}
+
+/// @brief Ends the assembly, after it all the inserted elements can be read.
+/// @details In compressed state the buffered elements are merged into the
+/// compressed arrays in a single pass.
+MATRIX_TEMPLATE
+void MATRIX_TYPE::assembly_end() {
+#ifdef DEBUG
+    assert(isAssembling &&
+           "Error in call to assembly_end: assembly not started.\n");
+#endif
+    if (isCompressed) {
+        this->assemble_compressed(insertMode);
+    }
+    invalidate_cache();
+    isAssembling = false;
+}
+
 /// @brief Prints the matrix to the standard output.
 /// @details This function checks whether the matrix is compressed or dynamic
 /// and prints its elements accordingly.
@@ -282,24 +689,601 @@ void MATRIX_TYPE::print() const {
     }
 }
 
+/// @brief Performs the matrix-vector product `y = alpha * A * x + beta * y`
+/// writing into a buffer owned by the caller.
+/// @param x The vector, i.e. the rhs.
+/// @param y The output buffer, it must hold `get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `y`.
+/// @param num_threads The number of threads used in compressed state, zero
+/// means as many as the hardware supports.
+/// @details This function checks whether the matrix is compressed or dynamic
+/// and calls the corresponding kernel, neither of which copies the matrix.
+/// When `beta` is zero the previous content of `y` is never read. The dynamic
+/// formats are always traversed by a single thread.
+MATRIX_TEMPLATE
+void MATRIX_TYPE::multiply_into(std::span<T const> x, std::span<T> y, T alpha,
+                                T beta, unsigned num_threads) const {
+#ifdef DEBUG
+    assert(this->columns == x.size() && this->rows == y.size() &&
+           "Error in call to multiply_into: non-matching dimensions.\n");
+#endif
+
+    if (!isCompressed) {
+        by_vector_dynamic(static_cast<const Dynamic<T, S>&>(*this), x, y,
+                          alpha, beta);
+    }
+    else if (num_threads == 1) {
+        by_vector_compressed(static_cast<const Compressed<T, S>&>(*this), x, y,
+                             alpha, beta);
+    }
+    else {
+        by_vector_compressed_parallel(
+            static_cast<const Compressed<T, S>&>(*this), x, y, alpha, beta,
+            num_threads);
+    }
+}
+
+/// @brief Performs the product `Y = alpha * A * X + beta * Y` with a dense
+/// block of `k` vectors, writing into a buffer owned by the caller.
+/// @param x The rhs block, row-major with `k` columns: element `c` of the
+/// vector multiplying column `j` is `x[j * k + c]`.
+/// @param y The output block, row-major with `k` columns, it must hold `k *
+/// get_rows()` elements.
+/// @param k The number of vectors in the blocks.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `y`.
+/// @details The matrix is read once for the whole block instead of once per
+/// vector, with unrolled loops for blocks of 4, 8 and 16 vectors. A block of a
+/// single vector is handled by `multiply_into`.
+MATRIX_TEMPLATE
+void MATRIX_TYPE::multiply_block(std::span<T const> x, std::span<T> y,
+                                 size_t k, T alpha, T beta) const {
+#ifdef DEBUG
+    assert(this->columns * k == x.size() && this->rows * k == y.size() &&
+           "Error in call to multiply_block: non-matching dimensions.\n");
+#endif
+
+    if (k == 1) {
+        multiply_into(x, y, alpha, beta);
+    }
+    else if (!isCompressed) {
+        by_block_dynamic(static_cast<const Dynamic<T, S>&>(*this), x, y, k,
+                         alpha, beta);
+    }
+    else {
+        by_block_compressed(static_cast<const Compressed<T, S>&>(*this), x, y,
+                            k, alpha, beta);
+    }
+}
+
+/// @brief Uploads the compressed arrays of a YALE-like matrix to a device,
+/// where they stay until the matrix is modified.
+/// @param stream The stream running the products on the device.
+/// @details The inner, outer and values arrays are copied as they are, with
+/// their own index and value types, into buffers of the device that persist
+/// across products. The formats providing `lines_compressed`, i.e. YALE and
+/// MixedYALE, store every element in these arrays; the others can't be
+/// uploaded.
+MATRIX_TEMPLATE
+void MATRIX_TYPE::to_device(DeviceStream& stream) {
+    static_assert(
+        requires(Compressed<T, S> const& c) { lines_compressed(c); },
+        "to_device needs a YALE-like compressed format");
+#ifdef DEBUG
+    assert(isCompressed && !isAssembling &&
+           "Error in call to to_device: matrix must be compressed.\n");
+#endif
+
+    auto inner = this->get_inner_indexes();
+    auto outer = this->get_outer_indexes();
+    auto values = this->get_values();
+    device = std::make_shared<DeviceYALE<
+        T, S, typename decltype(values)::value_type,
+        typename decltype(inner)::value_type,
+        typename decltype(outer)::value_type> const>(inner, outer, values);
+    device_stream = &stream;
+}
+
+/// @brief Checks if the matrix has a copy on a device.
+/// @return True after `to_device`, until the matrix is modified.
+MATRIX_TEMPLATE
+bool MATRIX_TYPE::is_on_device() const {
+    return device != nullptr;
+}
+
+/// @brief Frees the copy of the matrix on the device.
+/// @details The buffers are freed once the enqueued products reading them are
+/// done.
+MATRIX_TEMPLATE
+void MATRIX_TYPE::release_device() {
+    device.reset();
+    device_stream = nullptr;
+}
+
+/// @brief Enqueues the product `y = alpha * A * x + beta * y` on the stream
+/// of the copy on the device.
+/// @param x The vector, i.e. the rhs.
+/// @param y The output buffer, it must hold `get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `y`.
+/// @return The future completed when `y` is written. Until then `x` and `y`
+/// must stay alive and `y` mustn't be accessed.
+/// @details The products enqueued on the same stream run in order, so a
+/// product can read the output of the previous one without waiting.
+MATRIX_TEMPLATE
+std::future<void> MATRIX_TYPE::multiply_async(std::span<T const> x,
+                                              std::span<T> y, T alpha,
+                                              T beta) const {
+#ifdef DEBUG
+    assert(device && "Error in call to multiply_async: not on a device.\n");
+    assert(this->columns == x.size() && this->rows == y.size() &&
+           "Error in call to multiply_async: non-matching dimensions.\n");
+#endif
+
+    return device_stream->enqueue([device = device, x, y, alpha, beta] {
+        device->multiply(x, y, alpha, beta);
+    });
+}
+
+/// @brief Enqueues the product `Y = alpha * A * X + beta * Y` with a dense
+/// block of `k` vectors on the stream of the copy on the device.
+/// @param x The rhs block, row-major with `k` columns.
+/// @param y The output block, row-major with `k` columns, it must hold `k *
+/// get_rows()` elements.
+/// @param k The number of vectors in the blocks.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `y`.
+/// @return The future completed when `y` is written. Until then `x` and `y`
+/// must stay alive and `y` mustn't be accessed.
+MATRIX_TEMPLATE
+std::future<void> MATRIX_TYPE::multiply_block_async(std::span<T const> x,
+                                                    std::span<T> y, size_t k,
+                                                    T alpha, T beta) const {
+#ifdef DEBUG
+    assert(device &&
+           "Error in call to multiply_block_async: not on a device.\n");
+    assert(this->columns * k == x.size() && this->rows * k == y.size() &&
+           "Error in call to multiply_block_async: non-matching "
+           "dimensions.\n");
+#endif
+
+    return device_stream->enqueue([device = device, x, y, k, alpha, beta] {
+        device->multiply_block(x, y, k, alpha, beta);
+    });
+}
+
+/// @brief Performs the transpose product `y = alpha * A^T * x + beta * y`
+/// writing into a buffer owned by the caller, without building the transpose.
+/// Complex elements are not conjugated.
+/// @param x The vector, it must hold `get_rows()` elements.
+/// @param y The output buffer, it must hold `get_columns()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `y`.
+/// @param num_threads The number of threads used in compressed state, zero
+/// means as many as the hardware supports.
+/// @details The kernels read the same data as `multiply_into`: the compressed
+/// arrays are traversed as the arrays of the transpose in the opposite storage
+/// order, the dynamic formats swap the role of the indexes.
+MATRIX_TEMPLATE
+void MATRIX_TYPE::multiply_transpose(std::span<T const> x, std::span<T> y,
+                                     T alpha, T beta,
+                                     unsigned num_threads) const {
+#ifdef DEBUG
+    assert(this->rows == x.size() && this->columns == y.size() &&
+           "Error in call to multiply_transpose: non-matching dimensions.\n");
+#endif
+
+    if (!isCompressed) {
+        by_vector_transpose_dynamic(static_cast<const Dynamic<T, S>&>(*this), x,
+                                    y, alpha, beta);
+    }
+    else if (num_threads == 1) {
+        by_vector_transpose_compressed(
+            static_cast<const Compressed<T, S>&>(*this), x, y, alpha, beta);
+    }
+    else {
+        by_vector_transpose_compressed_parallel(
+            static_cast<const Compressed<T, S>&>(*this), x, y, alpha, beta,
+            num_threads);
+    }
+}
+
+/// @brief Performs the matrix-vector product `y = A * x` of a square matrix
+/// and computes `x^H * y` in the same sweep.
+/// @param x The vector, i.e. the rhs.
+/// @param y The output buffer, it must hold `get_rows()` elements.
+/// @param num_threads The number of threads used in compressed state, zero
+/// means as many as the hardware supports.
+/// @return The dot product `x^H * y`, conjugating `x`.
+/// @details Compressed formats providing `by_vector_dot_compressed` compute
+/// the dot product while sweeping the matrix, so neither vector is read
+/// again. The other formats, and the dynamic state, multiply with
+/// `multiply_into` and then take the dot product.
+MATRIX_TEMPLATE
+T MATRIX_TYPE::multiply_dot(std::span<T const> x, std::span<T> y,
+                            unsigned num_threads) const {
+#ifdef DEBUG
+    assert(this->rows == this->columns && this->columns == x.size() &&
+           this->rows == y.size() &&
+           "Error in call to multiply_dot: non-matching dimensions.\n");
+#endif
+
+    if constexpr (requires(Compressed<T, S> const& c, std::span<T const> a,
+                           std::span<T> b) {
+                      by_vector_dot_compressed(c, a, b, num_threads);
+                  }) {
+        if (isCompressed) {
+            return by_vector_dot_compressed(
+                static_cast<const Compressed<T, S>&>(*this), x, y,
+                num_threads);
+        }
+    }
+
+    multiply_into(x, y, T{1}, T{0}, num_threads);
+    return dot(x, std::span<T const>(y));
+}
+
+/// @brief Updates a residual, `r -= alpha * A * p`, and computes its squared
+/// norm in the same sweep.
+/// @param p The vector, i.e. the rhs.
+/// @param r The residual, it must hold `get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param num_threads The number of threads used in compressed state, zero
+/// means as many as the hardware supports.
+/// @return The squared euclidean norm of the updated `r`.
+/// @details Compressed formats providing `residual_compressed` update `r`
+/// while sweeping the matrix. The other formats, and the dynamic state,
+/// update `r` with `multiply_into` and then take its norm.
+MATRIX_TEMPLATE
+double MATRIX_TYPE::multiply_residual(std::span<T const> p, std::span<T> r,
+                                      T alpha, unsigned num_threads) const {
+#ifdef DEBUG
+    assert(this->columns == p.size() && this->rows == r.size() &&
+           "Error in call to multiply_residual: non-matching dimensions.\n");
+#endif
+
+    if constexpr (requires(Compressed<T, S> const& c, std::span<T const> a,
+                           std::span<T> b) {
+                      residual_compressed(c, a, b, alpha, num_threads);
+                  }) {
+        if (isCompressed) {
+            return residual_compressed(
+                static_cast<const Compressed<T, S>&>(*this), p, r, alpha,
+                num_threads);
+        }
+    }
+
+    multiply_into(p, r, -alpha, T{1}, num_threads);
+    return squared_norm(std::span<T const>(r));
+}
+
+/// @brief Builds the transpose of the matrix, with the same formats and
+/// storage order. Complex elements are not conjugated.
+/// @return The transpose, in the same state as the matrix.
+/// @details In compressed state the arrays of the transpose are those of the
+/// matrix in the opposite storage order, computed by `compressed_transpose`.
+/// In dynamic state the elements are received in storage order, i.e. sorted
+/// by line and then by index within the line: a stable counting sort on the
+/// index sorts them by index and then by line, which is the storage order of
+/// the transpose, so the new matrix is built by the same one pass used by
+/// `uncompress`, without any comparison sort. The elements are scattered
+/// once into their buckets and then streamed in order, so that building the
+/// transpose reads them sequentially. Both cost `O(nnz + n)`.
+MATRIX_TEMPLATE
+MATRIX_TYPE MATRIX_TYPE::transpose() const {
+#ifdef DEBUG
+    assert(!isAssembling &&
+           "Error in call to transpose: assembly in progress.\n");
+#endif
+
+    const size_t outer_extent = (S == rowMajor) ? this->columns : this->rows;
+    MATRIX_TYPE result(UseDynamic{}, this->columns, this->rows,
+                       std::vector<std::pair<size_t, size_t>>{},
+                       std::vector<T>{});
+
+    if (isCompressed) {
+        result.release_dynamic();
+        result.build_compressed([&](auto& inner, auto& outer, auto& values) {
+            compressed_transpose(this->get_inner_indexes(),
+                                 this->get_outer_indexes(), this->get_values(),
+                                 outer_extent, inner, outer, values);
+        });
+        result.isCompressed = true;
+        return result;
+    }
+
+    const size_t num_elements = get_num_elements();
+    std::vector<size_t> lines, indexes;
+    std::vector<T> values;
+    std::vector<size_t> end(outer_extent + 1, 0);
+    lines.reserve(num_elements);
+    indexes.reserve(num_elements);
+    values.reserve(num_elements);
+
+    this->compress_from_dynamic([&](size_t i, size_t j, T const& value) {
+        size_t index = (S == rowMajor) ? j : i;
+        lines.push_back((S == rowMajor) ? i : j);
+        indexes.push_back(index);
+        values.push_back(value);
+        end[index + 1]++;
+    });
+
+    for (size_t index = 0; index < outer_extent; ++index) {
+        end[index + 1] += end[index];
+    }
+
+    // After the scatter end[index] is the end of the bucket of index.
+    std::vector<std::pair<size_t, T>> buckets(num_elements);
+    for (size_t k = 0; k < num_elements; ++k) {
+        buckets[end[indexes[k]]++] = {lines[k], values[k]};
+    }
+
+    result.uncompress_from_triplets(num_elements, [&](auto&& send) {
+        size_t k = 0;
+        for (size_t index = 0; index < outer_extent; ++index) {
+            for (; k < end[index]; ++k) {
+                auto const& [line, value] = buckets[k];
+                if constexpr (S == rowMajor) {
+                    send(index, line, value);
+                }
+                else {
+                    send(line, index, value);
+                }
+            }
+        }
+    });
+
+    return result;
+}
+
+/// @brief Computes the sparse matrix-matrix product `A * B`.
+/// @tparam S2 The storage order of `B`.
+/// @param other The matrix `B`, i.e. the rhs.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @return The product, compressed and in the storage order of `A`.
+/// @details Both matrices must be compressed. In row-major order the product
+/// is computed by `compressed_spgemm` on the arrays of the two matrices, in
+/// column-major order the same arrays are those of `A^T` and `B^T` in
+/// row-major order, and `C^T = B^T * A^T`. If `B` is stored in the other
+/// order its arrays are transposed first with `compressed_transpose`, in
+/// `O(nnz + n)`.
+MATRIX_TEMPLATE
+template <StorageOrder S2>
+MATRIX_TYPE MATRIX_TYPE::multiply(
+    Matrix<T, Compressed, Dynamic, S2> const& other,
+    unsigned num_threads) const {
+#ifdef DEBUG
+    assert(this->columns == other.get_rows() &&
+           "Error in call to multiply: non-matching dimensions.\n");
+    assert(isCompressed && other.is_compressed() &&
+           "Error in call to multiply: matrices must be compressed.\n");
+#endif
+
+    MATRIX_TYPE result(UseDynamic{}, this->rows, other.get_columns(),
+                       std::vector<std::pair<size_t, size_t>>{},
+                       std::vector<T>{});
+    result.release_dynamic();
+
+    auto product = [&](auto b_inner, auto b_outer, auto b_values) {
+        result.build_compressed([&](auto& inner, auto& outer, auto& values) {
+            if constexpr (S == rowMajor) {
+                compressed_spgemm(this->get_inner_indexes(),
+                                  this->get_outer_indexes(), this->get_values(),
+                                  b_inner, b_outer, b_values,
+                                  other.get_columns(), inner, outer, values,
+                                  num_threads);
+            }
+            else {
+                compressed_spgemm(b_inner, b_outer, b_values,
+                                  this->get_inner_indexes(),
+                                  this->get_outer_indexes(), this->get_values(),
+                                  this->rows, inner, outer, values,
+                                  num_threads);
+            }
+        });
+    };
+
+    if constexpr (S2 == S) {
+        product(other.get_inner_indexes(), other.get_outer_indexes(),
+                other.get_values());
+    }
+    else {
+        std::vector<size_t> inner, outer;
+        std::vector<T> values;
+        compressed_transpose(
+            other.get_inner_indexes(), other.get_outer_indexes(),
+            other.get_values(),
+            (S2 == rowMajor) ? other.get_columns() : other.get_rows(), inner,
+            outer, values);
+        product(std::span<size_t const>(inner), std::span<size_t const>(outer),
+                std::span<T const>(values));
+    }
+
+    result.isCompressed = true;
+    return result;
+}
+
+/// @brief Computes the sparse linear combination `alpha * A + beta * B`, both
+/// matrices must be compressed and have the same dimensions.
+/// @tparam S2 The storage order of `B`.
+/// @param other The matrix `B`.
+/// @param alpha The scaling factor of `A`.
+/// @param beta The scaling factor of `B`.
+/// @return The combination, compressed and in the storage order of `A`.
+/// @details The compressed arrays are merged line by line by
+/// `compressed_add`, after transposing `B` if its storage order differs. The
+/// result is built through `build_compressed`, so the compressed format must
+/// provide it, as multiply does.
+MATRIX_TEMPLATE
+template <StorageOrder S2>
+MATRIX_TYPE MATRIX_TYPE::add(Matrix<T, Compressed, Dynamic, S2> const& other,
+                             T alpha, T beta) const {
+#ifdef DEBUG
+    assert(this->rows == other.get_rows() &&
+           this->columns == other.get_columns() &&
+           "Error in call to add: non-matching dimensions.\n");
+    assert(isCompressed && other.is_compressed() &&
+           "Error in call to add: matrices must be compressed.\n");
+#endif
+
+    MATRIX_TYPE result(UseDynamic{}, this->rows, this->columns,
+                       std::vector<std::pair<size_t, size_t>>{},
+                       std::vector<T>{});
+    result.release_dynamic();
+
+    auto sum = [&](auto b_inner, auto b_outer, auto b_values) {
+        result.build_compressed([&](auto& inner, auto& outer, auto& values) {
+            compressed_add(this->get_inner_indexes(), this->get_outer_indexes(),
+                           this->get_values(), b_inner, b_outer, b_values,
+                           alpha, beta, inner, outer, values);
+        });
+    };
+
+    if constexpr (S2 == S) {
+        sum(other.get_inner_indexes(), other.get_outer_indexes(),
+            other.get_values());
+    }
+    else {
+        std::vector<size_t> inner, outer;
+        std::vector<T> values;
+        compressed_transpose(
+            other.get_inner_indexes(), other.get_outer_indexes(),
+            other.get_values(),
+            (S2 == rowMajor) ? other.get_columns() : other.get_rows(), inner,
+            outer, values);
+        sum(std::span<size_t const>(inner), std::span<size_t const>(outer),
+            std::span<T const>(values));
+    }
+
+    result.isCompressed = true;
+    return result;
+}
+
+/// @brief Computes a reverse Cuthill-McKee ordering of a square matrix, which
+/// must be compressed, to reduce its bandwidth.
+/// @return The permutation `perm`, where `perm[i]` is the old index of the row
+/// and column that become row and column `i`.
+/// @details The ordering is computed by `reverse_cuthill_mckee` on the graph
+/// of `A + A^T`. It's meant to be applied once, before a solve: the matrix
+/// with `permute`, the vectors with `apply_permutation`, and the solution
+/// brought back with the inverse permutation, see `invert_permutation`.
+MATRIX_TEMPLATE
+std::vector<size_t> MATRIX_TYPE::reverse_cuthill_mckee() const {
+#ifdef DEBUG
+    assert(isCompressed &&
+           "Error in call to reverse_cuthill_mckee: matrix not compressed.\n");
+    assert(this->rows == this->columns &&
+           "Error in call to reverse_cuthill_mckee: the matrix must be "
+           "square.\n");
+#endif
+
+    return algebra::reverse_cuthill_mckee(this->get_inner_indexes(),
+                                          this->get_outer_indexes());
+}
+
+/// @brief Builds the symmetric permutation `P * A * P^T` of a square matrix,
+/// which must be compressed, i.e. the matrix `B` with `B(i, j) = A(perm[i],
+/// perm[j])`.
+/// @param perm The permutation, e.g. the one computed by
+/// `reverse_cuthill_mckee`.
+/// @return The permuted matrix, compressed.
+/// @details The arrays of the result are computed by `compressed_permute` in
+/// `O(nnz + n)`. Any permutation can be applied, e.g. a nested dissection
+/// ordering computed by an external library.
+MATRIX_TEMPLATE
+MATRIX_TYPE MATRIX_TYPE::permute(std::span<size_t const> perm) const {
+#ifdef DEBUG
+    assert(isCompressed &&
+           "Error in call to permute: matrix not compressed.\n");
+    assert(this->rows == this->columns && perm.size() == this->rows &&
+           "Error in call to permute: non-matching dimensions.\n");
+#endif
+
+    MATRIX_TYPE result(UseDynamic{}, this->rows, this->columns,
+                       std::vector<std::pair<size_t, size_t>>{},
+                       std::vector<T>{});
+    result.release_dynamic();
+    result.build_compressed([&](auto& inner, auto& outer, auto& values) {
+        compressed_permute(this->get_inner_indexes(),
+                           this->get_outer_indexes(), this->get_values(), perm,
+                           inner, outer, values);
+    });
+    result.isCompressed = true;
+    return result;
+}
+
 /// @brief Performs matrix-vector product.
 /// @param m An object of type Matrix representing the matrix, i.e. the lhs.
 /// @param v The vector, i.e. the rhs.
 /// @tparam T The type of the matrix elements (numeric or complex).
 /// @tparam S The storage order (row-major or column-major).
+/// @return The lazy product, computed when it's converted to `std::vector<T>`
+/// or combined with other products and vectors, see `LinearCombination`.
+/// @details The matrix and the vector are only referenced, so the product
+/// must be evaluated before either of them is modified or destroyed, and
+/// keeping it in an `auto` variable keeps it lazy until it's indexed or
+/// iterated over. A temporary matrix or vector would dangle and is rejected by
+/// the deleted overloads.
 MATRIX_TEMPLATE
-std::vector<T> operator*(MATRIX_TYPE const& m, std::vector<T> const& v) {
+LinearCombination<T, ProductTerm<T, MATRIX_TYPE>> operator*(
+    MATRIX_TYPE const& m, std::vector<T> const& v) {
 #ifdef DEBUG
-    assert(m.columns == v.size() &&
+    assert(m.get_columns() == v.size() &&
            "Error in call operator *: non-matching dimensions.\n");
 #endif
 
-    if (!m.isCompressed) {
-        return by_vector_dynamic(static_cast<const Dynamic<T, S>&>(m), v);
-    }
-    else {
-        return by_vector_compressed(static_cast<const Compressed<T, S>&>(m), v);
-    }
+    return LinearCombination<T, ProductTerm<T, MATRIX_TYPE>>(
+        ProductTerm<T, MATRIX_TYPE>{&m, std::span<T const>(v), T{1}});
+}
+
+/// @brief Computes the sparse matrix-matrix product.
+/// @param a The lhs.
+/// @param b The rhs.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order of the lhs.
+/// @tparam S2 The storage order of the rhs.
+/// @return The product, see `Matrix::multiply`.
+template <NumericOrComplex T,
+          template <typename, StorageOrder> class Compressed,
+          template <typename, StorageOrder> class Dynamic, StorageOrder S,
+          StorageOrder S2>
+MATRIX_TYPE operator*(MATRIX_TYPE const& a,
+                      Matrix<T, Compressed, Dynamic, S2> const& b) {
+    return a.multiply(b);
+}
+
+/// @brief Computes the sparse matrix sum.
+/// @param a The lhs.
+/// @param b The rhs.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order of the lhs.
+/// @tparam S2 The storage order of the rhs.
+/// @return The sum, see `Matrix::add`.
+template <NumericOrComplex T,
+          template <typename, StorageOrder> class Compressed,
+          template <typename, StorageOrder> class Dynamic, StorageOrder S,
+          StorageOrder S2>
+MATRIX_TYPE operator+(MATRIX_TYPE const& a,
+                      Matrix<T, Compressed, Dynamic, S2> const& b) {
+    return a.add(b);
+}
+
+/// @brief Computes the sparse matrix difference.
+/// @param a The lhs.
+/// @param b The rhs.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order of the lhs.
+/// @tparam S2 The storage order of the rhs.
+/// @return The difference, see `Matrix::add`.
+template <NumericOrComplex T,
+          template <typename, StorageOrder> class Compressed,
+          template <typename, StorageOrder> class Dynamic, StorageOrder S,
+          StorageOrder S2>
+MATRIX_TYPE operator-(MATRIX_TYPE const& a,
+                      Matrix<T, Compressed, Dynamic, S2> const& b) {
+    return a.add(b, T{1}, T{-1});
 }
 
 }  // namespace algebra
@@ -0,0 +1,188 @@
+#ifndef MATRIXVIEWIMPL_HPP
+#define MATRIXVIEWIMPL_HPP
+
+#include <cassert>
+#include <span>
+#include <utility>
+
+#include "MatrixImpl.hpp"
+#include "MatrixView.hpp"
+
+namespace algebra {
+
+/// @brief Gets a read-only view of the matrix, which can be shared by several
+/// threads.
+/// @return The view, valid as long as the matrix isn't modified.
+/// @details The matrix can't be frozen during an assembly, as the elements
+/// buffered in compressed state can't be read until it ends.
+MATRIX_TEMPLATE
+MatrixView<T, Compressed, Dynamic, S> MATRIX_TYPE::freeze() const {
+#ifdef DEBUG
+    assert(!isAssembling &&
+           "Error in call to freeze: assembly in progress.\n");
+#endif
+    return MatrixView<T, Compressed, Dynamic, S>(*this);
+}
+
+/// @brief Constructs a view of a matrix.
+/// @param matrix The matrix to view.
+MATRIX_TEMPLATE
+MatrixView<T, Compressed, Dynamic, S>::MatrixView(MATRIX_TYPE const& matrix)
+    : matrix(&matrix) {}
+
+/// @brief Reads the element at the specified position, zero if it's not
+/// stored.
+/// @param i The row index.
+/// @param j The column index.
+/// @return The value at the specified position.
+/// @details The const lookup of the matrix is used, which never inserts.
+MATRIX_TEMPLATE
+T MatrixView<T, Compressed, Dynamic, S>::operator()(std::size_t i,
+                                                    std::size_t j) const {
+    return (*matrix)(i, j);
+}
+
+/// @brief Gets the number of rows.
+/// @return The number of rows.
+MATRIX_TEMPLATE
+size_t MatrixView<T, Compressed, Dynamic, S>::get_rows() const {
+    return matrix->get_rows();
+}
+
+/// @brief Gets the number of columns.
+/// @return The number of columns.
+MATRIX_TEMPLATE
+size_t MatrixView<T, Compressed, Dynamic, S>::get_columns() const {
+    return matrix->get_columns();
+}
+
+/// @brief Gets the number of non-zero elements in the matrix.
+/// @return The number of non-zero elements.
+MATRIX_TEMPLATE
+size_t MatrixView<T, Compressed, Dynamic, S>::get_num_elements() const {
+    return matrix->get_num_elements();
+}
+
+/// @brief Checks if the matrix is in compressed storage format.
+/// @return True if the matrix is compressed, false otherwise.
+MATRIX_TEMPLATE
+bool MatrixView<T, Compressed, Dynamic, S>::is_compressed() const {
+    return matrix->is_compressed();
+}
+
+/// @brief Calls a function on every stored element.
+/// @tparam F The type of the function.
+/// @param f A callable taking the row index, the column index and the value
+/// of each element.
+MATRIX_TEMPLATE
+template <typename F>
+void MatrixView<T, Compressed, Dynamic, S>::for_each(F&& f) const {
+    matrix->for_each(std::forward<F>(f));
+}
+
+/// @brief Gets the range of the elements of a row of a row-major matrix,
+/// compressed in a YALE-like format.
+/// @param i The row index.
+/// @return The range of the column indexes and of the values.
+MATRIX_TEMPLATE
+auto MatrixView<T, Compressed, Dynamic, S>::row(std::size_t i) const
+    requires(S == rowMajor)
+{
+    return matrix->row(i);
+}
+
+/// @brief Gets the range of the elements of a column of a column-major
+/// matrix, compressed in a YALE-like format.
+/// @param j The column index.
+/// @return The range of the row indexes and of the values.
+MATRIX_TEMPLATE
+auto MatrixView<T, Compressed, Dynamic, S>::column(std::size_t j) const
+    requires(S == columnMajor)
+{
+    return matrix->column(j);
+}
+
+/// @brief Gets the range of the elements of a matrix compressed in a
+/// YALE-like format, line by line.
+/// @return The range of the rows, the columns and the values.
+MATRIX_TEMPLATE
+auto MatrixView<T, Compressed, Dynamic, S>::nonzeros() const {
+    return matrix->nonzeros();
+}
+
+/// @brief Performs the matrix-vector product `y = alpha * A * x + beta * y`
+/// writing into a buffer owned by the caller.
+/// @param x The vector, i.e. the rhs.
+/// @param y The output buffer, it must hold `get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `y`.
+/// @param num_threads The number of threads used in compressed state, zero
+/// means as many as the hardware supports.
+MATRIX_TEMPLATE
+void MatrixView<T, Compressed, Dynamic, S>::multiply_into(
+    std::span<T const> x, std::span<T> y, T alpha, T beta,
+    unsigned num_threads) const {
+    matrix->multiply_into(x, y, alpha, beta, num_threads);
+}
+
+/// @brief Performs the product `Y = alpha * A * X + beta * Y` with a dense
+/// block of `k` vectors, writing into a buffer owned by the caller.
+/// @param x The rhs block, row-major with `k` columns.
+/// @param y The output block, row-major with `k` columns, it must hold `k *
+/// get_rows()` elements.
+/// @param k The number of vectors in the blocks.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `y`.
+MATRIX_TEMPLATE
+void MatrixView<T, Compressed, Dynamic, S>::multiply_block(
+    std::span<T const> x, std::span<T> y, size_t k, T alpha, T beta) const {
+    matrix->multiply_block(x, y, k, alpha, beta);
+}
+
+/// @brief Performs the transpose product `y = alpha * A^T * x + beta * y`
+/// writing into a buffer owned by the caller. Complex elements are not
+/// conjugated.
+/// @param x The vector, it must hold `get_rows()` elements.
+/// @param y The output buffer, it must hold `get_columns()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `y`.
+/// @param num_threads The number of threads used in compressed state, zero
+/// means as many as the hardware supports.
+MATRIX_TEMPLATE
+void MatrixView<T, Compressed, Dynamic, S>::multiply_transpose(
+    std::span<T const> x, std::span<T> y, T alpha, T beta,
+    unsigned num_threads) const {
+    matrix->multiply_transpose(x, y, alpha, beta, num_threads);
+}
+
+/// @brief Performs the matrix-vector product `y = A * x` of a square matrix
+/// and computes `x^H * y` in the same sweep.
+/// @param x The vector, i.e. the rhs.
+/// @param y The output buffer, it must hold `get_rows()` elements.
+/// @param num_threads The number of threads used in compressed state, zero
+/// means as many as the hardware supports.
+/// @return The dot product `x^H * y`, conjugating `x`.
+MATRIX_TEMPLATE
+T MatrixView<T, Compressed, Dynamic, S>::multiply_dot(
+    std::span<T const> x, std::span<T> y, unsigned num_threads) const {
+    return matrix->multiply_dot(x, y, num_threads);
+}
+
+/// @brief Updates a residual, `r -= alpha * A * p`, and computes its squared
+/// norm in the same sweep.
+/// @param p The vector, i.e. the rhs.
+/// @param r The residual, it must hold `get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param num_threads The number of threads used in compressed state, zero
+/// means as many as the hardware supports.
+/// @return The squared euclidean norm of the updated `r`.
+MATRIX_TEMPLATE
+double MatrixView<T, Compressed, Dynamic, S>::multiply_residual(
+    std::span<T const> p, std::span<T> r, T alpha,
+    unsigned num_threads) const {
+    return matrix->multiply_residual(p, r, alpha, num_threads);
+}
+
+}  // namespace algebra
+
+#endif
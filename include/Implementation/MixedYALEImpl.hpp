@@ -0,0 +1,623 @@
+#ifndef MIXEDYALEIMPL_HPP
+#define MIXEDYALEIMPL_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+#include "Comparators.hpp"
+#include "MixedYALE.hpp"
+#include "Profiling.hpp"
+
+using namespace comparators;
+namespace algebra {
+
+/// @brief Constructs a MixedYALE matrix by reading a Matrix Market file.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @tparam B Boolean constant to indicate wether the matrix' size was given
+/// as input.
+/// @param file_name The name of the file to read the data from.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @details The file is parsed and laid out as in the YALE constructor, with
+/// values of type `T`, which are then rounded to `V` in a single pass. If the
+/// size wasn't given as input, the one declared in the header is used.
+template <NumericOrComplex T, StorageOrder S, StorageFor<T> V, IndexType I,
+          IndexType P>
+template <bool B>
+MixedYALE<T, S, V, I, P>::MixedYALE(std::bool_constant<B>,
+                                    std::string const& file_name,
+                                    unsigned num_threads) {
+    MarketData<T> data = read_market<T>(file_name, num_threads);
+
+    if constexpr (B) {
+#ifdef DEBUG
+        assert(data.header.rows <= this->rows &&
+               data.header.columns <= this->columns &&
+               "Error in MixedYALE constructor: indexes out of bounds (too "
+               "big).\n");
+#endif
+    }
+    else {
+        this->resize(data.header.rows, data.header.columns);
+    }
+
+    size_t max_elements = data.values.size();
+    if (data.header.symmetry != MarketSymmetry::General) max_elements *= 2;
+    if (!fits_indexes(S == rowMajor ? this->columns : this->rows,
+                      max_elements)) {
+        throw std::overflow_error(
+            "Error in MixedYALE constructor: indexes overflow the index "
+            "types.");
+    }
+
+    innerindex_ptr = std::make_unique<innervec>();
+    outerindex_ptr = std::make_unique<outervec>();
+
+    std::vector<T> values;
+    market_to_compressed<T, S>(data, S == rowMajor ? this->rows : this->columns,
+                               *innerindex_ptr, *outerindex_ptr, values,
+                               num_threads);
+
+    values_ptr = std::make_unique<valuesvec>();
+    values_ptr->reserve(values.size());
+    for (auto const& el : values) values_ptr->emplace_back(el);
+}
+
+/// @brief Finds the value at the specified position (read-only).
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @param i The row index.
+/// @param j The column index.
+/// @return The value at the specified position, converted to `T`.
+/// @details The stored value is binary searched with `compressed_find`.
+template <NumericOrComplex T, StorageOrder S, StorageFor<T> V, IndexType I,
+          IndexType P>
+T MixedYALE<T, S, V, I, P>::find_compressed_const(size_t i, size_t j) const {
+    return static_cast<T>(compressed_find<S>(
+        get_inner_indexes(), get_outer_indexes(), get_values(), i, j));
+}
+
+/// @brief In the process of uncompressing the matrix sends all the triplets,
+/// coherently with the storage order.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @tparam F The type of the receiver.
+/// @param receiver A callable taking the row index, the column index and the
+/// value of each element.
+/// @details The values are sent converted to `T`, i.e. as rounded when the
+/// matrix was compressed.
+template <NumericOrComplex T, StorageOrder S, StorageFor<T> V, IndexType I,
+          IndexType P>
+template <typename F>
+void MixedYALE<T, S, V, I, P>::uncompress_from_compressed(
+    F&& receiver) const {
+    auto const& inner = *innerindex_ptr;
+    auto const& outer = *outerindex_ptr;
+    auto const& values = *values_ptr;
+
+    for (size_t line = 0; line + 1 < inner.size(); ++line) {
+        for (size_t k = inner[line]; k < inner[line + 1]; ++k) {
+            const T value = static_cast<T>(values[k]);
+            if constexpr (S == rowMajor) {
+                receiver(line, static_cast<size_t>(outer[k]), value);
+            }
+            else {
+                receiver(static_cast<size_t>(outer[k]), line, value);
+            }
+        }
+    }
+}
+
+/// @brief Builds the data structure from the triplets sent by another format,
+/// rounding the values.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @tparam F The type of the sender.
+/// @param num_elements The number of triplets that will be sent.
+/// @param sender A callable taking a receiver and calling it on every triplet,
+/// coherently with the storage order.
+/// @details As in YALE, a single pass counts the elements of each line while
+/// appending the outer indexes and the values, and a prefix sum turns the
+/// counts into the inner index vector. An element rounded to zero is kept,
+/// so the number of elements doesn't change.
+template <NumericOrComplex T, StorageOrder S, StorageFor<T> V, IndexType I,
+          IndexType P>
+template <typename F>
+void MixedYALE<T, S, V, I, P>::compress_from_triplets(size_t num_elements,
+                                                      F&& sender) {
+    PROFILE_SCOPE("compress", "MixedYALE");
+    size_t num_lines = (S == rowMajor) ? this->rows : this->columns;
+
+    if (!fits_indexes(S == rowMajor ? this->columns : this->rows,
+                      num_elements)) {
+        throw std::overflow_error(
+            "Error in call to compress_from_triplets: indexes overflow the "
+            "index types.");
+    }
+
+    innerindex_ptr = std::make_unique<innervec>(num_lines + 1, 0);
+    outerindex_ptr = std::make_unique<outervec>();
+    values_ptr = std::make_unique<valuesvec>();
+
+    auto& inner = *innerindex_ptr;
+    auto& outer = *outerindex_ptr;
+    auto& values = *values_ptr;
+
+    outer.reserve(num_elements);
+    values.reserve(num_elements);
+
+    sender([&](size_t i, size_t j, T const& value) {
+        auto [in, out] = inner_outer(i, j);
+        inner[in + 1]++;
+        outer.push_back(static_cast<I>(out));
+        values.emplace_back(value);
+    });
+
+    for (size_t line = 0; line < num_lines; ++line) {
+        inner[line + 1] += inner[line];
+    }
+    PROFILE_BYTES(values.size() * (sizeof(V) + sizeof(I)) +
+                  inner.size() * sizeof(P));
+}
+
+/// @brief Gets the number of non-zero elements.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @return The number of non-zero elements.
+template <NumericOrComplex T, StorageOrder S, StorageFor<T> V, IndexType I,
+          IndexType P>
+size_t MixedYALE<T, S, V, I, P>::get_num_elements_compressed() const {
+    return values_ptr->size();
+}
+
+/// @brief Releases the compressed storage format.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+template <NumericOrComplex T, StorageOrder S, StorageFor<T> V, IndexType I,
+          IndexType P>
+void MixedYALE<T, S, V, I, P>::release_compressed() {
+    innerindex_ptr.reset();
+    outerindex_ptr.reset();
+    values_ptr.reset();
+}
+
+/// @brief Computes the inner and outer indexes for a given position.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @param i The row index.
+/// @param j The column index.
+/// @return A pair representing the inner and outer indexes.
+template <NumericOrComplex T, StorageOrder S, StorageFor<T> V, IndexType I,
+          IndexType P>
+std::pair<size_t, size_t> MixedYALE<T, S, V, I, P>::inner_outer(
+    size_t i, size_t j) const {
+    if constexpr (S == rowMajor) {
+        return {i, j};
+    }
+    else {
+        return {j, i};
+    }
+}
+
+/// @brief Checks if the indexes of a matrix can be stored in the index types.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @param outer_extent The number of columns in row-major order, of rows in
+/// column-major order.
+/// @param num_elements The number of non-zero elements.
+/// @return True if no index would overflow.
+/// @details The biggest outer index is `outer_extent - 1` and the biggest
+/// inner index, the last one, is `num_elements`.
+template <NumericOrComplex T, StorageOrder S, StorageFor<T> V, IndexType I,
+          IndexType P>
+bool MixedYALE<T, S, V, I, P>::fits_indexes(size_t outer_extent,
+                                            size_t num_elements) {
+    return num_elements <= std::numeric_limits<P>::max() &&
+           (outer_extent == 0 ||
+            outer_extent - 1 <= std::numeric_limits<I>::max());
+}
+
+/// @brief Removes the element at the specified position.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @param i The row index.
+/// @param j The column index.
+/// @return True if the element was removed, false otherwise.
+template <NumericOrComplex T, StorageOrder S, StorageFor<T> V, IndexType I,
+          IndexType P>
+bool MixedYALE<T, S, V, I, P>::remove_compressed(size_t i, size_t j) {
+    auto [in, out] = inner_outer(i, j);
+
+    auto& inner = *innerindex_ptr;
+    auto& outer = *outerindex_ptr;
+
+    auto first = outer.begin() + inner[in];
+    auto last = outer.begin() + inner[in + 1];
+    auto lower = std::lower_bound(first, last, out);
+    if (lower == last || *lower != out) return false;
+
+    values_ptr->erase(values_ptr->begin() + (lower - outer.begin()));
+    outer.erase(lower);
+
+    for (size_t l = in + 1; l < inner.size(); ++l) {
+        inner[l]--;
+    }
+    return true;
+}
+
+/// @brief Removes all the elements satisfying a predicate.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @tparam F The type of the predicate.
+/// @param pred A callable taking the row index, the column index and the
+/// value of each element, converted to `T`, and returning true if it has to
+/// be removed.
+/// @return The number of removed elements.
+/// @details The kept elements are moved towards the front of the arrays and
+/// the inner indexes are rebuilt in the same pass, so every element is moved
+/// at most once.
+template <NumericOrComplex T, StorageOrder S, StorageFor<T> V, IndexType I,
+          IndexType P>
+template <typename F>
+size_t MixedYALE<T, S, V, I, P>::remove_if_compressed(F&& pred) {
+    auto& inner = *innerindex_ptr;
+    auto& outer = *outerindex_ptr;
+    auto& values = *values_ptr;
+
+    size_t write = 0;
+    size_t begin = 0;
+    for (size_t line = 0; line + 1 < inner.size(); ++line) {
+        size_t end = inner[line + 1];
+        for (size_t k = begin; k < end; ++k) {
+            const T value = static_cast<T>(values[k]);
+            bool removed;
+            if constexpr (S == rowMajor) {
+                removed = pred(line, static_cast<size_t>(outer[k]), value);
+            }
+            else {
+                removed = pred(static_cast<size_t>(outer[k]), line, value);
+            }
+            if (!removed) {
+                outer[write] = outer[k];
+                values[write] = values[k];
+                ++write;
+            }
+        }
+        begin = end;
+        inner[line + 1] = static_cast<P>(write);
+    }
+
+    size_t removed = values.size() - write;
+    outer.resize(write);
+    values.resize(write);
+    return removed;
+}
+
+/// @brief Prints the matrix in compressed format to the standard output.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @details The values are printed as stored, i.e. rounded.
+template <NumericOrComplex T, StorageOrder S, StorageFor<T> V, IndexType I,
+          IndexType P>
+void MixedYALE<T, S, V, I, P>::print_compressed() const {
+    std::cout << "Values: ";
+    for (const auto& el : *values_ptr) {
+        std::cout << el << " ";
+    }
+    std::cout << std::endl;
+    std::cout << "Outer indexes: ";
+    for (auto const& el : *outerindex_ptr) {
+        std::cout << el << " ";
+    }
+    std::cout << std::endl;
+
+    std::cout << "Inner indexes: ";
+    for (auto const& el : *innerindex_ptr) {
+        std::cout << el << " ";
+    }
+    std::cout << std::endl;
+}
+
+/// @brief Computes the norm of the matrix.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @tparam N The type of norm to compute (Infinity, One, or Frobenius).
+/// @return The computed norm value.
+/// @details The norm of the stored, i.e. rounded, values is computed by
+/// `compressed_norm`, summing in `double`.
+template <NumericOrComplex T, StorageOrder S, StorageFor<T> V, IndexType I,
+          IndexType P>
+template <NormType N>
+double MixedYALE<T, S, V, I, P>::norm_compressed() const {
+    return compressed_norm<N, S>(get_inner_indexes(), get_outer_indexes(),
+                                 get_values(), this->rows, this->columns);
+}
+
+/// @brief Gets the inner index vector.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @return A read-only view of the beginning of each line.
+template <NumericOrComplex T, StorageOrder S, StorageFor<T> V, IndexType I,
+          IndexType P>
+std::span<P const> MixedYALE<T, S, V, I, P>::get_inner_indexes() const {
+    return *innerindex_ptr;
+}
+
+/// @brief Gets the outer index vector.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @return A read-only view of the outer index of each element.
+template <NumericOrComplex T, StorageOrder S, StorageFor<T> V, IndexType I,
+          IndexType P>
+std::span<I const> MixedYALE<T, S, V, I, P>::get_outer_indexes() const {
+    return *outerindex_ptr;
+}
+
+/// @brief Gets the stored values vector.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @return A read-only view of the stored value of each element.
+template <NumericOrComplex T, StorageOrder S, StorageFor<T> V, IndexType I,
+          IndexType P>
+std::span<V const> MixedYALE<T, S, V, I, P>::get_values() const {
+    return *values_ptr;
+}
+
+/// @brief Performs matrix-vector product.
+/// @param m An object of type MixedYALE representing the matrix, i.e. the
+/// lhs.
+/// @param v The vector, i.e. the rhs.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+template <NumericOrComplex T, StorageOrder S, StorageFor<T> V, IndexType I,
+          IndexType P>
+std::vector<T> by_vector_compressed(MixedYALE<T, S, V, I, P> const& m,
+                                    std::vector<T> const& v) {
+    std::vector<T> result(m.rows, T{});
+    by_vector_compressed(m, std::span<T const>(v), std::span<T>(result), T{1},
+                         T{0});
+    return result;
+}
+
+/// @brief Performs the matrix-vector product `result = alpha * m * v + beta *
+/// result` writing into a buffer owned by the caller.
+/// @param m An object of type MixedYALE representing the matrix, i.e. the
+/// lhs.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer, it must hold `m.get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @details The work is done by `compressed_product`, which widens each
+/// value to `T` before multiplying it.
+template <NumericOrComplex T, StorageOrder S, StorageFor<T> V, IndexType I,
+          IndexType P>
+void by_vector_compressed(MixedYALE<T, S, V, I, P> const& m,
+                          std::span<T const> v, std::span<T> result, T alpha,
+                          T beta) {
+    compressed_product<S>(m.get_inner_indexes(), m.get_outer_indexes(),
+                          m.get_values(), v, result, alpha, beta);
+}
+
+/// @brief Performs the matrix-vector product `result = alpha * m * v + beta *
+/// result` on multiple threads.
+/// @param m An object of type MixedYALE representing the matrix, i.e. the
+/// lhs.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer, it must hold `m.get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @details The work is done by `compressed_product_parallel`.
+template <NumericOrComplex T, StorageOrder S, StorageFor<T> V, IndexType I,
+          IndexType P>
+void by_vector_compressed_parallel(MixedYALE<T, S, V, I, P> const& m,
+                                   std::span<T const> v, std::span<T> result,
+                                   T alpha, T beta, unsigned num_threads) {
+    compressed_product_parallel<S>(m.get_inner_indexes(),
+                                   m.get_outer_indexes(), m.get_values(), v,
+                                   result, alpha, beta, num_threads);
+}
+
+/// @brief Performs the transpose product `result = alpha * m^T * v + beta *
+/// result` writing into a buffer owned by the caller.
+/// @param m An object of type MixedYALE representing the matrix, i.e. the
+/// lhs.
+/// @param v The vector, it must hold `m.get_rows()` elements.
+/// @param result The output buffer, it must hold `m.get_columns()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @details As in YALE, the work is done by `compressed_product`
+/// instantiated for the opposite storage order.
+template <NumericOrComplex T, StorageOrder S, StorageFor<T> V, IndexType I,
+          IndexType P>
+void by_vector_transpose_compressed(MixedYALE<T, S, V, I, P> const& m,
+                                    std::span<T const> v, std::span<T> result,
+                                    T alpha, T beta) {
+    compressed_product<opposite_order(S)>(m.get_inner_indexes(),
+                                          m.get_outer_indexes(),
+                                          m.get_values(), v, result, alpha,
+                                          beta);
+}
+
+/// @brief Performs the transpose product `result = alpha * m^T * v + beta *
+/// result` on multiple threads.
+/// @param m An object of type MixedYALE representing the matrix, i.e. the
+/// lhs.
+/// @param v The vector, it must hold `m.get_rows()` elements.
+/// @param result The output buffer, it must hold `m.get_columns()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @details The work is done by `compressed_product_parallel` instantiated
+/// for the opposite storage order.
+template <NumericOrComplex T, StorageOrder S, StorageFor<T> V, IndexType I,
+          IndexType P>
+void by_vector_transpose_compressed_parallel(
+    MixedYALE<T, S, V, I, P> const& m, std::span<T const> v,
+    std::span<T> result, T alpha, T beta, unsigned num_threads) {
+    compressed_product_parallel<opposite_order(S)>(
+        m.get_inner_indexes(), m.get_outer_indexes(), m.get_values(), v,
+        result, alpha, beta, num_threads);
+}
+
+/// @brief Performs the matrix-vector product `y = m * x` and computes `x^H *
+/// y` in the same sweep.
+/// @param m An object of type MixedYALE representing a square matrix.
+/// @param x The vector, i.e. the rhs.
+/// @param y The output buffer, as long as `x`.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @return The dot product `x^H * y`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @details The work is done by `compressed_product_dot`.
+template <NumericOrComplex T, StorageOrder S, StorageFor<T> V, IndexType I,
+          IndexType P>
+T by_vector_dot_compressed(MixedYALE<T, S, V, I, P> const& m,
+                           std::span<T const> x, std::span<T> y,
+                           unsigned num_threads) {
+    return compressed_product_dot<S>(m.get_inner_indexes(),
+                                     m.get_outer_indexes(), m.get_values(), x,
+                                     y, num_threads);
+}
+
+/// @brief Updates a residual, `r -= alpha * m * p`, and computes its squared
+/// norm in the same sweep.
+/// @param m An object of type MixedYALE representing the matrix, i.e. the
+/// lhs.
+/// @param p The vector, i.e. the rhs.
+/// @param r The residual, it must hold `m.get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @return The squared euclidean norm of the updated `r`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @details The work is done by `compressed_residual`.
+template <NumericOrComplex T, StorageOrder S, StorageFor<T> V, IndexType I,
+          IndexType P>
+double residual_compressed(MixedYALE<T, S, V, I, P> const& m,
+                           std::span<T const> p, std::span<T> r, T alpha,
+                           unsigned num_threads) {
+    return compressed_residual<S>(m.get_inner_indexes(), m.get_outer_indexes(),
+                                  m.get_values(), p, r, alpha, num_threads);
+}
+
+/// @brief Finds the positions of the diagonal elements in the values array.
+/// @param m An object of type MixedYALE.
+/// @return The position of each element `(i, i)`, or `no_position` if it's
+/// not stored.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @details The work is done by `compressed_diagonal_positions`.
+template <NumericOrComplex T, StorageOrder S, StorageFor<T> V, IndexType I,
+          IndexType P>
+std::vector<size_t> diagonal_positions_compressed(
+    MixedYALE<T, S, V, I, P> const& m) {
+    return compressed_diagonal_positions(
+        m.get_inner_indexes(), m.get_outer_indexes(),
+        std::min(m.get_rows(), m.get_columns()));
+}
+
+/// @brief Gets the range of the lines and of the elements of the matrix.
+/// @param m An object of type MixedYALE.
+/// @return The range, holding spans into the arrays of `m`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+template <NumericOrComplex T, StorageOrder S, StorageFor<T> V, IndexType I,
+          IndexType P>
+CompressedLines<T, S, V, P, I> lines_compressed(
+    MixedYALE<T, S, V, I, P> const& m) {
+    return CompressedLines<T, S, V, P, I>(
+        m.get_inner_indexes(), m.get_outer_indexes(), m.get_values());
+}
+
+}  // namespace algebra
+
+#endif
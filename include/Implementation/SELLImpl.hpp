@@ -0,0 +1,637 @@
+#ifndef SELLIMPL_HPP
+#define SELLIMPL_HPP
+
+#include <cassert>
+#include <iostream>
+#include <numeric>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "Comparators.hpp"
+#include "Profiling.hpp"
+#include "SELL.hpp"
+
+using namespace comparators;
+namespace algebra {
+
+/// @brief Constructs a SELL matrix from YALE-like compressed data.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam B Boolean constant to indicate wether the matrix' size was given
+/// as input.
+/// @param out The outer index container.
+/// @param in The inner index container.
+/// @param val The container of matrix values.
+/// @details The input is the same accepted by the YALE constructor, it is
+/// validated and then rearranged in slices by `build_slices`.
+template <NumericOrComplex T, StorageOrder S>
+template <bool B>
+SELL<T, S>::SELL(std::bool_constant<B>, SizetContainer auto const& out,
+                 SizetContainer auto const& in,
+                 NumericContainer auto const& val) {
+    indexvec inner(in.begin(), in.end());
+    indexvec outer(out.begin(), out.end());
+    valuesvec vals(val.begin(), val.end());
+
+#ifdef DEBUG
+    assert(!inner.empty() && outer.size() == vals.size() &&
+           inner.back() == vals.size() &&
+           "Error in SELL constructor: sizes don't match.\n");
+
+    if constexpr (B && S == rowMajor) {
+        assert(inner.size() == (this->rows + 1) &&
+               "Error in SELL constructor: sizes don't match.\n");
+    }
+    else if constexpr (B && S == columnMajor) {
+        assert(inner.size() == (this->columns + 1) &&
+               "Error in SELL constructor: sizes don't match.\n");
+    }
+#endif
+
+    indexvec lengths(inner.size() - 1);
+    for (size_t l = 0; l < lengths.size(); ++l) {
+        lengths[l] = inner[l + 1] - inner[l];
+    }
+
+    if constexpr (!B) {
+        size_t max_size_outer = 0;
+        for (auto const& el : outer) {
+            max_size_outer = std::max(max_size_outer, el);
+        }
+
+        if constexpr (S == rowMajor)
+            this->resize(lengths.size(), max_size_outer + 1);
+        else
+            this->resize(max_size_outer + 1, lengths.size());
+    }
+
+    build_slices(lengths, outer, vals);
+}
+
+/// @brief Builds the sliced layout from lines stored contiguously.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @param lengths The length of each line.
+/// @param outer The outer indexes, line after line.
+/// @param vals The values, line after line.
+/// @details Lines are sorted by decreasing length inside each window of
+/// `sigma` lines, so that lines of similar length end up in the same chunk and
+/// little padding is needed. The number of positions is rounded up to a
+/// multiple of `chunk`, positions past the last line are empty.
+template <NumericOrComplex T, StorageOrder S>
+void SELL<T, S>::build_slices(indexvec const& lengths, indexvec const& outer,
+                              valuesvec const& vals) {
+    size_t num_lines = lengths.size();
+    size_t num_chunks = (num_lines + chunk - 1) / chunk;
+
+    permutation_ptr = std::make_unique<indexvec>(num_chunks * chunk);
+    position_ptr = std::make_unique<indexvec>(num_lines);
+    linelen_ptr = std::make_unique<indexvec>(num_chunks * chunk, 0);
+    chunklen_ptr = std::make_unique<indexvec>(num_chunks, 0);
+    chunkptr_ptr = std::make_unique<indexvec>(num_chunks + 1, 0);
+
+    std::iota(permutation_ptr->begin(), permutation_ptr->end(), 0);
+    for (size_t w = 0; w < num_lines; w += sigma) {
+        auto first = permutation_ptr->begin() + w;
+        auto last = permutation_ptr->begin() + std::min(w + sigma, num_lines);
+        std::stable_sort(first, last, [&](size_t a, size_t b) {
+            return lengths[a] > lengths[b];
+        });
+    }
+
+    indexvec start(num_lines + 1, 0);
+    for (size_t l = 0; l < num_lines; ++l) {
+        start[l + 1] = start[l] + lengths[l];
+    }
+
+    for (size_t r = 0; r < num_lines; ++r) {
+        (*position_ptr)[(*permutation_ptr)[r]] = r;
+        (*linelen_ptr)[r] = lengths[(*permutation_ptr)[r]];
+        (*chunklen_ptr)[r / chunk] =
+            std::max((*chunklen_ptr)[r / chunk], (*linelen_ptr)[r]);
+    }
+
+    for (size_t c = 0; c < num_chunks; ++c) {
+        (*chunkptr_ptr)[c + 1] =
+            (*chunkptr_ptr)[c] + (*chunklen_ptr)[c] * chunk;
+    }
+
+    outerindex_ptr = std::make_unique<indexvec>(chunkptr_ptr->back(), 0);
+    values_ptr = std::make_unique<valuesvec>(chunkptr_ptr->back(), T{});
+
+    for (size_t r = 0; r < num_lines; ++r) {
+        size_t line = (*permutation_ptr)[r];
+        for (size_t k = 0; k < lengths[line]; ++k) {
+            (*outerindex_ptr)[slot(r, k)] = outer[start[line] + k];
+            (*values_ptr)[slot(r, k)] = vals[start[line] + k];
+        }
+    }
+
+    num_elements = start.back();
+}
+
+/// @brief Gets the position of the k-th element of a sorted line.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @param r The position of the line after sorting.
+/// @param k The position of the element in the line.
+/// @return The position in the outer index and values vectors.
+template <NumericOrComplex T, StorageOrder S>
+size_t SELL<T, S>::slot(size_t r, size_t k) const {
+    return (*chunkptr_ptr)[r / chunk] + k * chunk + r % chunk;
+}
+
+/// @brief Finds the value at the specified position (read-only).
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @param i The row index.
+/// @param j The column index.
+/// @return The value at the specified position.
+/// @details Elements of a line are sorted by outer index, the line is scanned
+/// until the index is found or exceeded. If the value is not found, it returns
+/// a default-constructed value.
+template <NumericOrComplex T, StorageOrder S>
+T SELL<T, S>::find_compressed_const(size_t i, size_t j) const {
+    auto [line, out] = inner_outer(i, j);
+    size_t r = (*position_ptr)[line];
+
+    for (size_t k = 0; k < (*linelen_ptr)[r]; ++k) {
+        size_t current = (*outerindex_ptr)[slot(r, k)];
+        if (current == out) return (*values_ptr)[slot(r, k)];
+        if (current > out) break;
+    }
+
+    return T{};
+}
+
+/// @brief Finds the value at the specified position (read-write).
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @param i The row index.
+/// @param j The column index.
+/// @return A reference to the value at the specified position.
+/// @details If the value does not exist, a new entry is inserted in the line
+/// keeping it sorted. When the line already fills its chunk, the chunk is
+/// widened by one slot per line; the sorting of the lines is not updated, as
+/// it only affects the amount of padding.
+template <NumericOrComplex T, StorageOrder S>
+T& SELL<T, S>::find_compressed(size_t i, size_t j) {
+    auto [line, out] = inner_outer(i, j);
+    size_t r = (*position_ptr)[line];
+    size_t len = (*linelen_ptr)[r];
+
+    size_t k = 0;
+    while (k < len && (*outerindex_ptr)[slot(r, k)] < out) ++k;
+
+    if (k < len && (*outerindex_ptr)[slot(r, k)] == out) {
+        return (*values_ptr)[slot(r, k)];
+    }
+
+    PROFILE_SCOPE("insert_compressed", "SELL");
+    PROFILE_BYTES((len - k) * (sizeof(size_t) + sizeof(T)));
+
+    size_t c = r / chunk;
+    if (len == (*chunklen_ptr)[c]) {
+        auto pos = (*chunkptr_ptr)[c + 1];
+        PROFILE_BYTES((values_ptr->size() - pos) *
+                      (sizeof(size_t) + sizeof(T)));
+        outerindex_ptr->insert(outerindex_ptr->begin() + pos, chunk, 0);
+        values_ptr->insert(values_ptr->begin() + pos, chunk, T{});
+
+        for (size_t l = c + 1; l < chunkptr_ptr->size(); ++l) {
+            (*chunkptr_ptr)[l] += chunk;
+        }
+        (*chunklen_ptr)[c]++;
+    }
+
+    for (size_t q = len; q > k; --q) {
+        (*outerindex_ptr)[slot(r, q)] = (*outerindex_ptr)[slot(r, q - 1)];
+        (*values_ptr)[slot(r, q)] = (*values_ptr)[slot(r, q - 1)];
+    }
+
+    (*outerindex_ptr)[slot(r, k)] = out;
+    (*values_ptr)[slot(r, k)] = T{};
+    (*linelen_ptr)[r]++;
+    num_elements++;
+
+    return (*values_ptr)[slot(r, k)];
+}
+
+/// @brief In the process of uncompressing the matrix sends all the triplets,
+/// coherently with the storage order.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam F The type of the receiver.
+/// @param receiver A callable taking the row index, the column index and the
+/// value of each element.
+/// @details Lines are visited in their original order, not in the sorted one,
+/// so that the triplets are sent coherently with the storage order.
+template <NumericOrComplex T, StorageOrder S>
+template <typename F>
+void SELL<T, S>::uncompress_from_compressed(F&& receiver) const {
+    for (size_t line = 0; line < position_ptr->size(); ++line) {
+        size_t r = (*position_ptr)[line];
+
+        for (size_t k = 0; k < (*linelen_ptr)[r]; ++k) {
+            size_t index = slot(r, k);
+
+            if constexpr (S == rowMajor) {
+                receiver(line, (*outerindex_ptr)[index], (*values_ptr)[index]);
+            }
+            else {
+                receiver((*outerindex_ptr)[index], line, (*values_ptr)[index]);
+            }
+        }
+    }
+}
+
+/// @brief Builds the data structure from the triplets sent by another format.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam F The type of the sender.
+/// @param num_elements The number of triplets that will be sent.
+/// @param sender A callable taking a receiver and calling it on every triplet,
+/// coherently with the storage order.
+/// @details The triplets are collected line after line in vectors of exact
+/// size while counting the length of each line, then the slices are built.
+template <NumericOrComplex T, StorageOrder S>
+template <typename F>
+void SELL<T, S>::compress_from_triplets(size_t num_elements, F&& sender) {
+    PROFILE_SCOPE("compress", "SELL");
+    indexvec lengths((S == rowMajor) ? this->rows : this->columns, 0);
+    indexvec outer;
+    valuesvec vals;
+
+    outer.reserve(num_elements);
+    vals.reserve(num_elements);
+
+    sender([&](size_t i, size_t j, T const& value) {
+        auto [line, out] = inner_outer(i, j);
+        lengths[line]++;
+        outer.push_back(out);
+        vals.push_back(value);
+    });
+
+    build_slices(lengths, outer, vals);
+    PROFILE_BYTES(values_ptr->size() * (sizeof(size_t) + sizeof(T)));
+}
+
+/// @brief Gets the number of non-zero elements.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @return The number of non-zero elements.
+/// @details Padding slots are not counted.
+template <NumericOrComplex T, StorageOrder S>
+size_t SELL<T, S>::get_num_elements_compressed() const {
+    return num_elements;
+};
+
+/// @brief Releases the compressed storage format.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @details This function deallocates the memory used by all the vectors.
+template <NumericOrComplex T, StorageOrder S>
+void SELL<T, S>::release_compressed() {
+    chunkptr_ptr.reset();
+    chunklen_ptr.reset();
+    linelen_ptr.reset();
+    permutation_ptr.reset();
+    position_ptr.reset();
+    outerindex_ptr.reset();
+    values_ptr.reset();
+    num_elements = 0;
+}
+
+/// @brief Computes the norm of the matrix.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam N The type of norm to compute (Infinity, One, or Frobenius).
+/// @return The computed norm value.
+/// @details Padding slots hold zeros, so they can be safely included in the
+/// Frobenius norm.
+template <NumericOrComplex T, StorageOrder S>
+template <NormType N>
+double SELL<T, S>::norm_compressed() const {
+    if constexpr ((N == Infinity && S == rowMajor) ||
+                  (N == One && S == columnMajor)) {
+        double res = 0.0;
+
+        for (size_t r = 0; r < position_ptr->size(); ++r) {
+            double sum = 0.0;
+            for (size_t k = 0; k < (*linelen_ptr)[r]; ++k) {
+                sum += std::abs((*values_ptr)[slot(r, k)]);
+            }
+            res = std::max(res, sum);
+        }
+        return res;
+    }
+
+    else if constexpr (N == One || N == Infinity) {
+        std::vector<double> par(S == rowMajor ? this->columns : this->rows, 0);
+
+        for (size_t r = 0; r < position_ptr->size(); ++r) {
+            for (size_t k = 0; k < (*linelen_ptr)[r]; ++k) {
+                par[(*outerindex_ptr)[slot(r, k)]] +=
+                    std::abs((*values_ptr)[slot(r, k)]);
+            }
+        }
+        return *std::max_element(par.begin(), par.end());
+    }
+
+    else {
+        double sum = 0.0;
+        for (auto const& el : *values_ptr) {
+            sum += std::abs(el) * std::abs(el);
+        }
+        return std::sqrt(sum);
+    }
+}
+
+/// @brief Computes the inner and outer indices for a given position.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @param i The row index.
+/// @param j The column index.
+/// @return A pair representing the inner and outer indexes.
+/// @details This function determines the inner and outer indexes based on
+/// the storage order of the matrix.
+template <NumericOrComplex T, StorageOrder S>
+std::pair<size_t, size_t> SELL<T, S>::inner_outer(size_t i, size_t j) const {
+    if constexpr (S == rowMajor) {
+        return {i, j};
+    }
+    else {
+        return {j, i};
+    }
+}
+
+/// @brief Removes the element at the specified position.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @param i The row index.
+/// @param j The column index.
+/// @return True if the element was removed, false otherwise.
+/// @details The following elements of the line are shifted back by one slot
+/// and the freed slot becomes padding. The chunk is never shrunk.
+template <NumericOrComplex T, StorageOrder S>
+bool SELL<T, S>::remove_compressed(size_t i, size_t j) {
+    auto [line, out] = inner_outer(i, j);
+    size_t r = (*position_ptr)[line];
+    size_t len = (*linelen_ptr)[r];
+
+    size_t k = 0;
+    while (k < len && (*outerindex_ptr)[slot(r, k)] < out) ++k;
+
+    if (k == len || (*outerindex_ptr)[slot(r, k)] != out) return false;
+
+    for (; k + 1 < len; ++k) {
+        (*outerindex_ptr)[slot(r, k)] = (*outerindex_ptr)[slot(r, k + 1)];
+        (*values_ptr)[slot(r, k)] = (*values_ptr)[slot(r, k + 1)];
+    }
+
+    (*outerindex_ptr)[slot(r, len - 1)] = 0;
+    (*values_ptr)[slot(r, len - 1)] = T{};
+    (*linelen_ptr)[r]--;
+    num_elements--;
+
+    return true;
+}
+
+/// @brief Prints the matrix in compressed format to the standard output.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @details This function prints values and outer indexes slot by slot,
+/// followed by the chunk pointers and the sorting permutation.
+template <NumericOrComplex T, StorageOrder S>
+void SELL<T, S>::print_compressed() const {
+    std::cout << "Values: ";
+    for (const auto& el : *values_ptr) {
+        std::cout << el << " ";
+    }
+    std::cout << std::endl;
+
+    std::cout << "Outer indexes: ";
+    for (auto const& el : *outerindex_ptr) {
+        std::cout << el << " ";
+    }
+    std::cout << std::endl;
+
+    std::cout << "Chunk pointers: ";
+    for (auto const& el : *chunkptr_ptr) {
+        std::cout << el << " ";
+    }
+    std::cout << std::endl;
+
+    std::cout << "Permutation: ";
+    for (size_t r = 0; r < position_ptr->size(); ++r) {
+        std::cout << (*permutation_ptr)[r] << " ";
+    }
+    std::cout << std::endl;
+}
+
+/// @brief Performs the row-major product on a range of chunks.
+/// @param m An object of type SELL representing the matrix, i.e. the lhs.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @param first The first chunk.
+/// @param last One past the last chunk.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @details Each chunk is processed one slot at a time, accumulating the
+/// products of all its lines at once. For `double` values this is done with
+/// AVX-512 or AVX2 gathers when the compiler targets them, with a scalar loop
+/// otherwise. The lanes of the lines shorter than the slot are masked out
+/// using the line lengths, so padding never reads `v[0]` and an infinite or
+/// NaN `v[0]` doesn't leak into the lines that don't reference it.
+template <NumericOrComplex T, StorageOrder S>
+void multiply_chunks(SELL<T, S> const& m, std::span<T const> v,
+                     std::span<T> result, T alpha, T beta, size_t first,
+                     size_t last) {
+    constexpr size_t chunk = SELL<T, S>::chunk;
+    auto const& outer = *(m.outerindex_ptr);
+    auto const& values = *(m.values_ptr);
+    auto const& chunkptr = *(m.chunkptr_ptr);
+    auto const& chunklen = *(m.chunklen_ptr);
+    auto const& linelen = *(m.linelen_ptr);
+    auto const& permutation = *(m.permutation_ptr);
+    const size_t num_lines = m.position_ptr->size();
+    const bool overwrite = (beta == T{});
+
+    for (size_t c = first; c < last; ++c) {
+        T acc[chunk] = {};
+        const size_t base = chunkptr[c];
+        const size_t width = chunklen[c];
+        size_t const* lengths = linelen.data() + c * chunk;
+
+#if defined(__AVX512F__)
+        if constexpr (std::is_same_v<T, double> && chunk == 8) {
+            __m512d sum = _mm512_setzero_pd();
+            __m512i lens = _mm512_loadu_si512(lengths);
+            for (size_t k = 0; k < width; ++k) {
+                size_t index = base + k * chunk;
+                __mmask8 live = _mm512_cmpgt_epu64_mask(
+                    lens, _mm512_set1_epi64(static_cast<long long>(k)));
+                __m512i cols = _mm512_loadu_si512(outer.data() + index);
+                __m512d x = _mm512_mask_i64gather_pd(_mm512_setzero_pd(), live,
+                                                     cols, v.data(), 8);
+                __m512d a = _mm512_loadu_pd(values.data() + index);
+                sum = _mm512_mask3_fmadd_pd(a, x, sum, live);
+            }
+            _mm512_storeu_pd(acc, sum);
+        }
+        else
+#elif defined(__AVX2__)
+        if constexpr (std::is_same_v<T, double> && chunk == 8) {
+            __m256d sum0 = _mm256_setzero_pd();
+            __m256d sum1 = _mm256_setzero_pd();
+            __m256i lens0 =
+                _mm256_loadu_si256(reinterpret_cast<__m256i const*>(lengths));
+            __m256i lens1 = _mm256_loadu_si256(
+                reinterpret_cast<__m256i const*>(lengths + 4));
+            for (size_t k = 0; k < width; ++k) {
+                size_t index = base + k * chunk;
+                __m256i slot = _mm256_set1_epi64x(static_cast<long long>(k));
+                __m256d live0 =
+                    _mm256_castsi256_pd(_mm256_cmpgt_epi64(lens0, slot));
+                __m256d live1 =
+                    _mm256_castsi256_pd(_mm256_cmpgt_epi64(lens1, slot));
+                __m256i cols0 = _mm256_loadu_si256(
+                    reinterpret_cast<__m256i const*>(outer.data() + index));
+                __m256i cols1 = _mm256_loadu_si256(
+                    reinterpret_cast<__m256i const*>(outer.data() + index + 4));
+                __m256d x0 = _mm256_mask_i64gather_pd(
+                    _mm256_setzero_pd(), v.data(), cols0, live0, 8);
+                __m256d x1 = _mm256_mask_i64gather_pd(
+                    _mm256_setzero_pd(), v.data(), cols1, live1, 8);
+                __m256d a0 = _mm256_loadu_pd(values.data() + index);
+                __m256d a1 = _mm256_loadu_pd(values.data() + index + 4);
+#if defined(__FMA__)
+                sum0 = _mm256_fmadd_pd(a0, x0, sum0);
+                sum1 = _mm256_fmadd_pd(a1, x1, sum1);
+#else
+                sum0 = _mm256_add_pd(sum0, _mm256_mul_pd(a0, x0));
+                sum1 = _mm256_add_pd(sum1, _mm256_mul_pd(a1, x1));
+#endif
+            }
+            _mm256_storeu_pd(acc, sum0);
+            _mm256_storeu_pd(acc + 4, sum1);
+        }
+        else
+#endif
+        {
+            for (size_t k = 0; k < width; ++k) {
+                size_t index = base + k * chunk;
+                for (size_t lane = 0; lane < chunk; ++lane) {
+                    if (k < lengths[lane]) {
+                        acc[lane] +=
+                            values[index + lane] * v[outer[index + lane]];
+                    }
+                }
+            }
+        }
+
+        for (size_t lane = 0; lane < chunk && c * chunk + lane < num_lines;
+             ++lane) {
+            size_t line = permutation[c * chunk + lane];
+            result[line] = overwrite ? alpha * acc[lane]
+                                     : alpha * acc[lane] + beta * result[line];
+        }
+    }
+}
+
+/// @brief Performs matrix-vector product.
+/// @param m An object of type SELL representing the matrix, i.e. the lhs.
+/// @param v The vector, i.e. the rhs.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+std::vector<T> by_vector_compressed(SELL<T, S> const& m,
+                                    std::vector<T> const& v) {
+    std::vector<T> result(m.rows, T{});
+    by_vector_compressed(m, std::span<T const>(v), std::span<T>(result), T{1},
+                         T{0});
+    return result;
+}
+
+/// @brief Performs the matrix-vector product `result = alpha * m * v + beta *
+/// result` writing into a buffer owned by the caller.
+/// @param m An object of type SELL representing the matrix, i.e. the lhs.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer, it must hold `m.get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @details In row-major order the chunks are processed by `multiply_chunks`.
+/// In column-major order each line scatters into the result, which doesn't
+/// benefit from the sliced layout, and a scalar loop is used.
+template <NumericOrComplex T, StorageOrder S>
+void by_vector_compressed(SELL<T, S> const& m, std::span<T const> v,
+                          std::span<T> result, T alpha, T beta) {
+    if constexpr (S == rowMajor) {
+        multiply_chunks(m, v, result, alpha, beta, 0,
+                        m.chunklen_ptr->size());
+    }
+    else {
+        if (beta == T{}) {
+            std::fill(result.begin(), result.end(), T{});
+        }
+        else if (beta != T{1}) {
+            for (auto& el : result) el *= beta;
+        }
+
+        for (size_t r = 0; r < m.position_ptr->size(); ++r) {
+            const T scaled = alpha * v[(*m.permutation_ptr)[r]];
+            for (size_t k = 0; k < (*m.linelen_ptr)[r]; ++k) {
+                size_t index = m.slot(r, k);
+                result[(*m.outerindex_ptr)[index]] +=
+                    (*m.values_ptr)[index] * scaled;
+            }
+        }
+    }
+}
+
+/// @brief Performs the matrix-vector product `result = alpha * m * v + beta *
+/// result` on multiple threads.
+/// @param m An object of type SELL representing the matrix, i.e. the lhs.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer, it must hold `m.get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @details In row-major order the chunks are split among the threads by
+/// slot count, padding included. Column-major matrices use the sequential
+/// kernel.
+template <NumericOrComplex T, StorageOrder S>
+void by_vector_compressed_parallel(SELL<T, S> const& m, std::span<T const> v,
+                                   std::span<T> result, T alpha, T beta,
+                                   unsigned num_threads) {
+    size_t num_parts = std::min<size_t>(resolve_threads(num_threads),
+                                        m.num_elements / parallel_grain);
+
+    if constexpr (S == rowMajor) {
+        if (num_parts > 1) {
+            const std::vector<size_t> bounds = balanced_partition(
+                std::span<size_t const>(*m.chunkptr_ptr), num_parts);
+
+            parallel_for(num_parts, [&](size_t k) {
+                multiply_chunks(m, v, result, alpha, beta, bounds[k],
+                                bounds[k + 1]);
+            });
+            return;
+        }
+    }
+
+    by_vector_compressed(m, v, result, alpha, beta);
+}
+
+}  // namespace algebra
+
+#endif
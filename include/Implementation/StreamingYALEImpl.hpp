@@ -0,0 +1,221 @@
+#ifndef STREAMINGYALEIMPL_HPP
+#define STREAMINGYALEIMPL_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <filesystem>
+#include <future>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+
+#include "CompressedKernels.hpp"
+#include "Snapshot.hpp"
+#include "StreamingYALE.hpp"
+
+using namespace comparators;
+namespace algebra {
+
+/// @brief Opens a binary snapshot.
+/// @tparam T The type of the matrix elements.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @param file_name The name of the file written by `save_snapshot`.
+/// @param panel_rows The number of rows read at a time.
+/// @details Only the header is read and checked against the template
+/// arguments, the arrays are read and checked by the products. Empty panels
+/// are rejected with `std::invalid_argument`.
+template <NumericOrComplex T, IndexType I, IndexType P>
+StreamingYALE<T, I, P>::StreamingYALE(std::string const& file_name,
+                                      size_t panel_rows)
+    : file{file_name, std::ios::binary}, panel_rows{panel_rows} {
+    if (panel_rows == 0) {
+        throw std::invalid_argument(
+            "Error in StreamingYALE constructor: empty panels.");
+    }
+    this->resize(0, 0);
+
+    std::error_code error;
+    std::uintmax_t size = std::filesystem::file_size(file_name, error);
+    file.read(reinterpret_cast<char*>(&header), sizeof(SnapshotHeader));
+    valid = file && !error &&
+            check_snapshot_header<rowMajor, T, P, I>(header, size);
+
+#ifdef DEBUG
+    assert(valid &&
+           "Error in StreamingYALE constructor: invalid or incompatible "
+           "snapshot.\n");
+#endif
+    if (!valid) return;
+
+    this->resize(header.rows, header.columns);
+}
+
+/// @brief Checks if the snapshot was opened successfully.
+/// @tparam T The type of the matrix elements.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @return True if the snapshot matched the template arguments.
+template <NumericOrComplex T, IndexType I, IndexType P>
+bool StreamingYALE<T, I, P>::is_valid() const {
+    return valid;
+}
+
+/// @brief Gets the number of non-zero elements in the matrix.
+/// @tparam T The type of the matrix elements.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @return The number of non-zero elements.
+template <NumericOrComplex T, IndexType I, IndexType P>
+size_t StreamingYALE<T, I, P>::get_num_elements() const {
+    return valid ? header.nnz : 0;
+}
+
+/// @brief Gets the number of rows read at a time.
+/// @tparam T The type of the matrix elements.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @return The number of rows of a panel.
+template <NumericOrComplex T, IndexType I, IndexType P>
+size_t StreamingYALE<T, I, P>::get_panel_rows() const {
+    return panel_rows;
+}
+
+/// @brief Gets the number of panels read by a product.
+/// @tparam T The type of the matrix elements.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @return The number of panels.
+template <NumericOrComplex T, IndexType I, IndexType P>
+size_t StreamingYALE<T, I, P>::get_num_panels() const {
+    return (this->rows + panel_rows - 1) / panel_rows;
+}
+
+/// @brief Gets the memory held by the panel buffers.
+/// @tparam T The type of the matrix elements.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @return The number of bytes, zero before the first product.
+/// @details The buffers keep their capacity between the panels and the
+/// products, so this is the memory of the two largest panels read so far.
+template <NumericOrComplex T, IndexType I, IndexType P>
+size_t StreamingYALE<T, I, P>::get_resident_bytes() const {
+    size_t bytes = 0;
+    for (Panel const& panel : panels) {
+        bytes += panel.inner.capacity() * sizeof(P) +
+                 panel.outer.capacity() * sizeof(I) +
+                 panel.values.capacity() * sizeof(T);
+    }
+    return bytes;
+}
+
+/// @brief Performs the matrix-vector product `y = alpha * A * x + beta * y`
+/// writing into a buffer owned by the caller.
+/// @tparam T The type of the matrix elements.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @param x The vector, i.e. the rhs.
+/// @param y The output buffer, it must hold `get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `y`.
+/// @param num_threads The number of threads of the product of each panel,
+/// zero means as many as the hardware supports.
+/// @details The panel `k + 1` is read by a background task while the rows of
+/// the panel `k` are multiplied, and the reads are issued one after the
+/// other, so the file is only accessed by one task at a time. Each panel is
+/// multiplied by the same kernel as a YALE matrix into its rows of `y`. If a
+/// panel can't be read or is corrupted, the `std::runtime_error` thrown by
+/// `load_panel` is propagated through its future, the matrix becomes invalid
+/// and the rows of `y` after the last complete panel are left untouched.
+template <NumericOrComplex T, IndexType I, IndexType P>
+void StreamingYALE<T, I, P>::multiply_into(std::span<T const> x,
+                                           std::span<T> y, T alpha, T beta,
+                                           unsigned num_threads) {
+#ifdef DEBUG
+    assert(x.size() == this->columns && y.size() == this->rows &&
+           "Error in call to StreamingYALE::multiply_into: dimensions "
+           "mismatch.\n");
+#endif
+
+    const size_t num_panels = get_num_panels();
+    if (!valid || num_panels == 0) return;
+
+    std::future<void> next = std::async(
+        std::launch::async, [this] { load_panel(0, panels[0]); });
+
+    try {
+        for (size_t k = 0; k < num_panels; ++k) {
+            next.get();
+            if (k + 1 < num_panels) {
+                next = std::async(std::launch::async, [this, k] {
+                    load_panel(k + 1, panels[(k + 1) % 2]);
+                });
+            }
+
+            Panel const& panel = panels[k % 2];
+            compressed_product_parallel<rowMajor>(
+                std::span<P const>(panel.inner),
+                std::span<I const>(panel.outer),
+                std::span<T const>(panel.values), x,
+                y.subspan(k * panel_rows, panel.inner.size() - 1), alpha,
+                beta, num_threads);
+        }
+    } catch (...) {
+        valid = false;
+        throw;
+    }
+}
+
+/// @brief Reads a panel of rows from the snapshot.
+/// @tparam T The type of the matrix elements.
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @param k The index of the panel.
+/// @param panel The buffer to fill, reused from the previous panels.
+/// @details The beginnings of the rows are read first, checked against the
+/// header and rebased on the first element of the panel, then the elements
+/// of the panel are read in one go from the outer index and values arrays
+/// and their columns are checked. The checks are linear in the size of the
+/// panel, which is read from the file anyway, and a failed read or a check
+/// that doesn't pass throws `std::runtime_error`.
+template <NumericOrComplex T, IndexType I, IndexType P>
+void StreamingYALE<T, I, P>::load_panel(size_t k, Panel& panel) {
+    const size_t first = k * panel_rows;
+    const size_t last = std::min(first + panel_rows, this->rows);
+
+    auto read = [&](std::uint64_t offset, auto& array, size_t count) {
+        using U = std::decay_t<decltype(array[0])>;
+        array.resize(count);
+        file.seekg(static_cast<std::streamoff>(offset));
+        file.read(reinterpret_cast<char*>(array.data()),
+                  static_cast<std::streamsize>(count * sizeof(U)));
+        if (!file) {
+            throw std::runtime_error("Error in StreamingYALE: read failed.");
+        }
+    };
+
+    read(header.inner_offset + first * sizeof(P), panel.inner,
+         last - first + 1);
+    if (!std::is_sorted(panel.inner.begin(), panel.inner.end()) ||
+        panel.inner.back() > header.nnz ||
+        (first == 0 && panel.inner.front() != 0) ||
+        (last == this->rows && panel.inner.back() != header.nnz)) {
+        throw std::runtime_error(
+            "Error in StreamingYALE: corrupted inner indexes.");
+    }
+    const P base = panel.inner.front();
+    for (P& begin : panel.inner) begin -= base;
+
+    const size_t count = panel.inner.back();
+    read(header.outer_offset + base * sizeof(I), panel.outer, count);
+    read(header.values_offset + base * sizeof(T), panel.values, count);
+    for (I column : panel.outer) {
+        if (column >= this->columns) {
+            throw std::runtime_error(
+                "Error in StreamingYALE: corrupted outer indexes.");
+        }
+    }
+}
+
+}  // namespace algebra
+#endif
@@ -0,0 +1,708 @@
+#ifndef SYMYALEIMPL_HPP
+#define SYMYALEIMPL_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "Comparators.hpp"
+#include "Profiling.hpp"
+#include "SymYALE.hpp"
+
+using namespace comparators;
+namespace algebra {
+
+/// @brief Constructs a SymYALE matrix from the compressed format data of its
+/// lower triangle.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam B Boolean constant to indicate wether the matrix' size was given
+/// as input.
+/// @param out The outer index container.
+/// @param in The inner index container.
+/// @param val The container of matrix values.
+/// @details The containers are laid out as the ones accepted by the YALE
+/// constructor and must only hold elements on or below the diagonal. If the
+/// size wasn't given as input, the matrix is square with one line per inner
+/// index but the last.
+template <NumericOrComplex T, StorageOrder S>
+template <bool B>
+SymYALE<T, S>::SymYALE(std::bool_constant<B>, SizetContainer auto const& out,
+                       SizetContainer auto const& in,
+                       NumericContainer auto const& val) {
+    innerindex_ptr = std::make_unique<indexvec>(in.begin(), in.end());
+    outerindex_ptr = std::make_unique<indexvec>(out.begin(), out.end());
+    values_ptr = std::make_unique<valuesvec>(val.begin(), val.end());
+
+    auto const& inner = *innerindex_ptr;
+    auto const& outer = *outerindex_ptr;
+
+    if constexpr (!B) this->resize(inner.size() - 1, inner.size() - 1);
+
+#ifdef DEBUG
+    assert(this->rows == this->columns &&
+           "Error in SymYALE constructor: the matrix must be square.\n");
+    assert(inner.size() == this->rows + 1 && outer.size() == inner.back() &&
+           values_ptr->size() == outer.size() &&
+           "Error in SymYALE constructor: sizes don't match.\n");
+
+    for (size_t line = 0; line < this->rows; ++line) {
+        for (size_t k = inner[line]; k < inner[line + 1]; ++k) {
+            assert((S == rowMajor ? outer[k] <= line : outer[k] >= line) &&
+                   outer[k] < this->rows &&
+                   "Error in SymYALE constructor: element out of the lower "
+                   "triangle.\n");
+            assert((k == inner[line] || outer[k] > outer[k - 1]) &&
+                   "Error in SymYALE constructor: redefinition of the same "
+                   "element (equal or misordered indexes).\n");
+        }
+    }
+#endif
+
+    count_diagonal();
+}
+
+/// @brief Constructs a SymYALE matrix by reading a Matrix Market file.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam B Boolean constant to indicate wether the matrix' size was given
+/// as input.
+/// @param file_name The name of the file to read the data from.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @details A `symmetric` file stores one triangle, which is folded into the
+/// lower one, i.e. entries above the diagonal are moved to their mirrored
+/// position, and placed without expanding it by `market_to_compressed`. A
+/// `hermitian` file is read the same way if `T` is real, where it's the same
+/// as a symmetric one. Of a `general` file only the lower triangle is kept,
+/// after checking that every entry above the diagonal is equal to its mirror.
+/// Files that can't be stored by mirroring the lower triangle as it is, i.e.
+/// `skew-symmetric`, complex `hermitian` and non-symmetric `general` ones, as
+/// well as non-square matrices, are rejected with `std::invalid_argument`. If
+/// the size wasn't given as input, the one declared in the header is used.
+template <NumericOrComplex T, StorageOrder S>
+template <bool B>
+SymYALE<T, S>::SymYALE(std::bool_constant<B>, std::string const& file_name,
+                       unsigned num_threads) {
+    MarketData<T> data = read_market<T>(file_name, num_threads);
+    const MarketSymmetry symmetry = data.header.symmetry;
+    const bool general = symmetry == MarketSymmetry::General;
+
+    if (!general && symmetry != MarketSymmetry::Symmetric &&
+        (symmetry != MarketSymmetry::Hermitian || is_complex<T>::value)) {
+        throw std::invalid_argument(
+            "Error in SymYALE constructor: only general and symmetric files "
+            "are supported.");
+    }
+    if (data.header.rows != data.header.columns) {
+        throw std::invalid_argument(
+            "Error in SymYALE constructor: the matrix must be square.");
+    }
+
+    if constexpr (B) {
+        if (data.header.rows > this->rows) {
+            throw std::invalid_argument(
+                "Error in SymYALE constructor: indexes out of bounds (too "
+                "big).");
+        }
+    }
+    else {
+        this->resize(data.header.rows, data.header.columns);
+    }
+
+    // Entries above the diagonal of a general file, at their mirrored
+    // position, checked against the lower triangle once it's compressed.
+    std::vector<std::pair<size_t, size_t>> upper;
+    std::vector<T> upper_values;
+    size_t num_lower = 0;
+
+    size_t write = 0;
+    for (size_t k = 0; k < data.values.size(); ++k) {
+        size_t i = data.rows[k];
+        size_t j = data.columns[k];
+
+        if (i < j) {
+            if (general) {
+                upper.emplace_back(j, i);
+                upper_values.push_back(data.values[k]);
+                continue;
+            }
+            std::swap(i, j);
+        }
+        else if (i > j) {
+            ++num_lower;
+        }
+
+        data.rows[write] = i;
+        data.columns[write] = j;
+        data.values[write] = data.values[k];
+        ++write;
+    }
+
+    data.rows.resize(write);
+    data.columns.resize(write);
+    data.values.resize(write);
+    data.header.symmetry = MarketSymmetry::General;
+
+    innerindex_ptr = std::make_unique<indexvec>();
+    outerindex_ptr = std::make_unique<indexvec>();
+    values_ptr = std::make_unique<valuesvec>();
+
+    market_to_compressed<T, S>(data, this->rows, *innerindex_ptr,
+                               *outerindex_ptr, *values_ptr, num_threads);
+
+    if (general && !mirrors_lower(upper, upper_values, num_lower)) {
+        throw std::invalid_argument(
+            "Error in SymYALE constructor: the matrix is not symmetric.");
+    }
+
+    count_diagonal();
+}
+
+/// @brief Finds the value at the specified position (read-only).
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @param i The row index.
+/// @param j The column index.
+/// @return The value at the specified position.
+/// @details The stored element is binary searched with `compressed_find`.
+template <NumericOrComplex T, StorageOrder S>
+T SymYALE<T, S>::find_compressed_const(size_t i, size_t j) const {
+    return compressed_find<S>(get_inner_indexes(), get_outer_indexes(),
+                              get_values(), std::max(i, j), std::min(i, j));
+}
+
+/// @brief Finds the value at the specified position (read-write).
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @param i The row index.
+/// @param j The column index.
+/// @return A reference to the value at the specified position, shared with
+/// the mirrored position.
+/// @details If the value does not exist, this function inserts a new entry
+/// into the lower triangle and returns a reference to it. Every insertion
+/// moves all the following elements.
+template <NumericOrComplex T, StorageOrder S>
+T& SymYALE<T, S>::find_compressed(size_t i, size_t j) {
+    auto [in, out] = inner_outer(i, j);
+    auto& inner = *innerindex_ptr;
+    auto& outer = *outerindex_ptr;
+    auto& values = *values_ptr;
+
+    auto first = outer.begin() + inner[in];
+    auto last = outer.begin() + inner[in + 1];
+    auto lower = std::lower_bound(first, last, out);
+    auto diff = lower - outer.begin();
+
+    if (lower != last && *lower == out) {
+        return values[diff];
+    }
+
+    PROFILE_SCOPE("insert_compressed", "SymYALE");
+    PROFILE_BYTES((values.size() - diff) * (sizeof(T) + sizeof(size_t)) +
+                  (inner.size() - in - 1) * sizeof(size_t));
+
+    outer.insert(lower, out);
+    auto ref = values.insert(values.begin() + diff, T{});
+
+    for (size_t l = in + 1; l < inner.size(); ++l) {
+        inner[l]++;
+    }
+    if (in == out) ++num_diagonal;
+
+    return *ref;
+}
+
+/// @brief In the process of uncompressing the matrix sends all the triplets
+/// of the whole matrix, coherently with the storage order.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam F The type of the receiver.
+/// @param receiver A callable taking the row index, the column index and the
+/// value of each element.
+/// @details The mirrored part of a line is a line of the transposed
+/// triangle, so the triangle is transposed once with `compressed_transpose`
+/// and each line is sent as the concatenation of the two parts, which
+/// are sorted and meet at the diagonal.
+template <NumericOrComplex T, StorageOrder S>
+template <typename F>
+void SymYALE<T, S>::uncompress_from_compressed(F&& receiver) const {
+    auto const& inner = *innerindex_ptr;
+    auto const& outer = *outerindex_ptr;
+    auto const& values = *values_ptr;
+
+    indexvec t_inner, t_outer;
+    valuesvec t_values;
+    compressed_transpose(get_inner_indexes(), get_outer_indexes(),
+                         get_values(), this->rows, t_inner, t_outer, t_values);
+
+    auto send = [&](size_t line, size_t index, T const& value) {
+        if constexpr (S == rowMajor) {
+            receiver(line, index, value);
+        }
+        else {
+            receiver(index, line, value);
+        }
+    };
+
+    for (size_t line = 0; line + 1 < inner.size(); ++line) {
+        if constexpr (S == columnMajor) {
+            for (size_t k = t_inner[line]; k < t_inner[line + 1]; ++k) {
+                if (t_outer[k] != line) send(line, t_outer[k], t_values[k]);
+            }
+        }
+
+        for (size_t k = inner[line]; k < inner[line + 1]; ++k) {
+            send(line, outer[k], values[k]);
+        }
+
+        if constexpr (S == rowMajor) {
+            for (size_t k = t_inner[line]; k < t_inner[line + 1]; ++k) {
+                if (t_outer[k] != line) send(line, t_outer[k], t_values[k]);
+            }
+        }
+    }
+}
+
+/// @brief Builds the data structure from the triplets sent by another format,
+/// keeping the lower triangle.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam F The type of the sender.
+/// @param num_elements The number of triplets that will be sent.
+/// @param sender A callable taking a receiver and calling it on every triplet,
+/// coherently with the storage order.
+/// @details A single pass counts the elements of each line while appending
+/// the outer indexes and the values, and a prefix sum turns the counts into
+/// the inner index vector. The elements above the diagonal are set aside and
+/// checked against their mirrored elements once the lower triangle is
+/// compressed: a non-square or non-symmetric matrix throws
+/// `std::invalid_argument` in every build, and `Matrix::compress` then leaves
+/// the matrix dynamic.
+template <NumericOrComplex T, StorageOrder S>
+template <typename F>
+void SymYALE<T, S>::compress_from_triplets(size_t num_elements, F&& sender) {
+    PROFILE_SCOPE("compress", "SymYALE");
+    if (this->rows != this->columns) {
+        throw std::invalid_argument(
+            "Error in call to compress: the matrix must be square.");
+    }
+
+    innerindex_ptr = std::make_unique<indexvec>(this->rows + 1, 0);
+    outerindex_ptr = std::make_unique<indexvec>();
+    values_ptr = std::make_unique<valuesvec>();
+
+    auto& inner = *innerindex_ptr;
+    auto& outer = *outerindex_ptr;
+    auto& values = *values_ptr;
+
+    outer.reserve((num_elements + this->rows) / 2);
+    values.reserve((num_elements + this->rows) / 2);
+
+    std::vector<std::pair<size_t, size_t>> upper;
+    std::vector<T> upper_values;
+    size_t num_lower = 0;
+    sender([&](size_t i, size_t j, T const& value) {
+        if (i < j) {
+            upper.emplace_back(j, i);
+            upper_values.push_back(value);
+            return;
+        }
+        if (i > j) ++num_lower;
+
+        auto [in, out] = inner_outer(i, j);
+        inner[in + 1]++;
+        outer.push_back(out);
+        values.push_back(value);
+    });
+
+    for (size_t line = 0; line < this->rows; ++line) {
+        inner[line + 1] += inner[line];
+    }
+    if (!mirrors_lower(upper, upper_values, num_lower)) {
+        release_compressed();
+        throw std::invalid_argument(
+            "Error in call to compress: the matrix is not symmetric.");
+    }
+    count_diagonal();
+    PROFILE_BYTES(values.size() * (sizeof(T) + sizeof(size_t)) +
+                  inner.size() * sizeof(size_t));
+}
+
+/// @brief Gets the number of non-zero elements of the whole matrix.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @return The number of non-zero elements.
+/// @details Every stored element off the diagonal counts twice.
+template <NumericOrComplex T, StorageOrder S>
+size_t SymYALE<T, S>::get_num_elements_compressed() const {
+    return 2 * values_ptr->size() - num_diagonal;
+}
+
+/// @brief Gets the number of stored elements, i.e. the non-zero elements of
+/// the lower triangle.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @return The number of stored elements.
+template <NumericOrComplex T, StorageOrder S>
+size_t SymYALE<T, S>::get_num_stored_elements() const {
+    return values_ptr->size();
+}
+
+/// @brief Releases the compressed storage format.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+void SymYALE<T, S>::release_compressed() {
+    innerindex_ptr.reset();
+    outerindex_ptr.reset();
+    values_ptr.reset();
+    num_diagonal = 0;
+}
+
+/// @brief Computes the inner and outer indexes of the stored element for a
+/// given position.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @param i The row index.
+/// @param j The column index.
+/// @return A pair representing the inner and outer indexes in the lower
+/// triangle.
+template <NumericOrComplex T, StorageOrder S>
+std::pair<size_t, size_t> SymYALE<T, S>::inner_outer(size_t i,
+                                                     size_t j) const {
+    if (i < j) std::swap(i, j);
+
+    if constexpr (S == rowMajor) {
+        return {i, j};
+    }
+    else {
+        return {j, i};
+    }
+}
+
+/// @brief Counts the stored elements on the diagonal.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @details The diagonal element of a line is its last one in row-major
+/// order and its first one in column-major order, so a single look at each
+/// line is enough.
+template <NumericOrComplex T, StorageOrder S>
+void SymYALE<T, S>::count_diagonal() {
+    auto const& inner = *innerindex_ptr;
+    auto const& outer = *outerindex_ptr;
+
+    num_diagonal = 0;
+    for (size_t line = 0; line + 1 < inner.size(); ++line) {
+        if (inner[line] == inner[line + 1]) continue;
+
+        size_t k = (S == rowMajor) ? inner[line + 1] - 1 : inner[line];
+        if (outer[k] == line) ++num_diagonal;
+    }
+}
+
+/// @brief Checks that the elements above the diagonal mirror the stored ones.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @param upper The mirrored position of each element above the diagonal.
+/// @param upper_values The value of each element above the diagonal.
+/// @param num_lower The number of stored elements below the diagonal.
+/// @return True if the two triangles are the mirror of each other.
+/// @details Each position appears once, so if every element above the
+/// diagonal matches the value of a distinct stored one and the counts are
+/// equal, the two triangles are the mirror of each other. The positions are
+/// found with `compressed_positions`, so explicit zeros must match too.
+template <NumericOrComplex T, StorageOrder S>
+bool SymYALE<T, S>::mirrors_lower(
+    std::vector<std::pair<size_t, size_t>> const& upper,
+    std::vector<T> const& upper_values, size_t num_lower) const {
+    if (upper.size() != num_lower) return false;
+
+    std::vector<size_t> positions = compressed_positions<S>(
+        get_inner_indexes(), get_outer_indexes(), upper);
+    auto values = get_values();
+    for (size_t k = 0; k < upper.size(); ++k) {
+        if (positions[k] == no_position ||
+            values[positions[k]] != upper_values[k]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// @brief Removes the element at the specified position, together with its
+/// mirrored element.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @param i The row index.
+/// @param j The column index.
+/// @return True if the element was removed, false otherwise.
+template <NumericOrComplex T, StorageOrder S>
+bool SymYALE<T, S>::remove_compressed(size_t i, size_t j) {
+    auto [in, out] = inner_outer(i, j);
+
+    auto& inner = *innerindex_ptr;
+    auto& outer = *outerindex_ptr;
+
+    auto first = outer.begin() + inner[in];
+    auto last = outer.begin() + inner[in + 1];
+    auto lower = std::lower_bound(first, last, out);
+    if (lower == last || *lower != out) return false;
+
+    values_ptr->erase(values_ptr->begin() + (lower - outer.begin()));
+    outer.erase(lower);
+
+    for (size_t l = in + 1; l < inner.size(); ++l) {
+        inner[l]--;
+    }
+    if (in == out) --num_diagonal;
+    return true;
+}
+
+/// @brief Removes all the elements satisfying a predicate.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam F The type of the predicate.
+/// @param pred A callable taking the row index, the column index and the
+/// value of each stored element, i.e. of the lower triangle, and returning
+/// true if it has to be removed together with its mirrored element.
+/// @return The number of removed elements of the whole matrix.
+/// @details The kept elements are moved towards the front of the arrays and
+/// the inner indexes are rebuilt in the same pass, so every element is moved
+/// at most once.
+template <NumericOrComplex T, StorageOrder S>
+template <typename F>
+size_t SymYALE<T, S>::remove_if_compressed(F&& pred) {
+    auto& inner = *innerindex_ptr;
+    auto& outer = *outerindex_ptr;
+    auto& values = *values_ptr;
+    size_t before = get_num_elements_compressed();
+
+    size_t write = 0;
+    size_t begin = 0;
+    for (size_t line = 0; line + 1 < inner.size(); ++line) {
+        size_t end = inner[line + 1];
+        for (size_t k = begin; k < end; ++k) {
+            bool removed;
+            if constexpr (S == rowMajor) {
+                removed = pred(line, outer[k], std::as_const(values[k]));
+            }
+            else {
+                removed = pred(outer[k], line, std::as_const(values[k]));
+            }
+            if (!removed) {
+                outer[write] = outer[k];
+                values[write] = values[k];
+                ++write;
+            }
+        }
+        begin = end;
+        inner[line + 1] = write;
+    }
+
+    outer.resize(write);
+    values.resize(write);
+    count_diagonal();
+    return before - get_num_elements_compressed();
+}
+
+/// @brief Prints the matrix in compressed format to the standard output.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @details The arrays of the lower triangle are printed as they are.
+template <NumericOrComplex T, StorageOrder S>
+void SymYALE<T, S>::print_compressed() const {
+    std::cout << "Printing the lower triangle (since the matrix is symmetric)."
+              << std::endl;
+    std::cout << "Values: ";
+    for (const auto& el : *values_ptr) {
+        std::cout << el << " ";
+    }
+    std::cout << std::endl;
+    std::cout << "Outer indexes: ";
+    for (auto const& el : *outerindex_ptr) {
+        std::cout << el << " ";
+    }
+    std::cout << std::endl;
+
+    std::cout << "Inner indexes: ";
+    for (auto const& el : *innerindex_ptr) {
+        std::cout << el << " ";
+    }
+    std::cout << std::endl;
+}
+
+/// @brief Computes the norm of the matrix.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam N The type of norm to compute (Infinity, One, or Frobenius).
+/// @return The computed norm value.
+/// @details The matrix is symmetric, so the one and infinity norms coincide:
+/// each element off the diagonal adds its absolute value to the sums of its
+/// line and of its mirrored line. In the Frobenius norm it counts twice.
+template <NumericOrComplex T, StorageOrder S>
+template <NormType N>
+double SymYALE<T, S>::norm_compressed() const {
+    auto const& inner = *innerindex_ptr;
+    auto const& outer = *outerindex_ptr;
+    auto const& values = *values_ptr;
+
+    if constexpr (N == Frobenius) {
+        double sum = 0.0;
+        for (size_t line = 0; line + 1 < inner.size(); ++line) {
+            for (size_t k = inner[line]; k < inner[line + 1]; ++k) {
+                double square = std::abs(values[k]) * std::abs(values[k]);
+                sum += (outer[k] == line) ? square : 2 * square;
+            }
+        }
+        return std::sqrt(sum);
+    }
+    else {
+        std::vector<double> par(this->rows, 0);
+        for (size_t line = 0; line + 1 < inner.size(); ++line) {
+            for (size_t k = inner[line]; k < inner[line + 1]; ++k) {
+                par[line] += std::abs(values[k]);
+                if (outer[k] != line) par[outer[k]] += std::abs(values[k]);
+            }
+        }
+        return par.empty() ? 0.0 : *std::max_element(par.begin(), par.end());
+    }
+}
+
+/// @brief Gets the inner index vector of the lower triangle.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @return A read-only view of the beginning of each line.
+template <NumericOrComplex T, StorageOrder S>
+std::span<size_t const> SymYALE<T, S>::get_inner_indexes() const {
+    return *innerindex_ptr;
+}
+
+/// @brief Gets the outer index vector of the lower triangle.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @return A read-only view of the outer index of each element.
+template <NumericOrComplex T, StorageOrder S>
+std::span<size_t const> SymYALE<T, S>::get_outer_indexes() const {
+    return *outerindex_ptr;
+}
+
+/// @brief Gets the values vector of the lower triangle.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @return A read-only view of the value of each element.
+template <NumericOrComplex T, StorageOrder S>
+std::span<T const> SymYALE<T, S>::get_values() const {
+    return *values_ptr;
+}
+
+/// @brief Performs matrix-vector product.
+/// @param m An object of type SymYALE representing the matrix, i.e. the lhs.
+/// @param v The vector, i.e. the rhs.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+std::vector<T> by_vector_compressed(SymYALE<T, S> const& m,
+                                    std::vector<T> const& v) {
+    std::vector<T> result(m.rows, T{});
+    by_vector_compressed(m, std::span<T const>(v), std::span<T>(result), T{1},
+                         T{0});
+    return result;
+}
+
+/// @brief Performs the matrix-vector product `result = alpha * m * v + beta *
+/// result` writing into a buffer owned by the caller.
+/// @param m An object of type SymYALE representing the matrix, i.e. the lhs.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer, it must hold `m.get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @details The work is done by `compressed_symmetric_product`, which reads
+/// each stored element once.
+template <NumericOrComplex T, StorageOrder S>
+void by_vector_compressed(SymYALE<T, S> const& m, std::span<T const> v,
+                          std::span<T> result, T alpha, T beta) {
+    compressed_symmetric_product(m.get_inner_indexes(), m.get_outer_indexes(),
+                                 m.get_values(), v, result, alpha, beta);
+}
+
+/// @brief Performs the matrix-vector product `result = alpha * m * v + beta *
+/// result` on multiple threads.
+/// @param m An object of type SymYALE representing the matrix, i.e. the lhs.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer, it must hold `m.get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @details The work is done by `compressed_symmetric_product_parallel`.
+template <NumericOrComplex T, StorageOrder S>
+void by_vector_compressed_parallel(SymYALE<T, S> const& m,
+                                   std::span<T const> v, std::span<T> result,
+                                   T alpha, T beta, unsigned num_threads) {
+    compressed_symmetric_product_parallel(
+        m.get_inner_indexes(), m.get_outer_indexes(), m.get_values(), v,
+        result, alpha, beta, num_threads);
+}
+
+/// @brief Performs the transpose product `result = alpha * m^T * v + beta *
+/// result`, the same as the direct one.
+/// @param m An object of type SymYALE representing the matrix, i.e. the lhs.
+/// @param v The vector, it must hold `m.get_rows()` elements.
+/// @param result The output buffer, it must hold `m.get_columns()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+void by_vector_transpose_compressed(SymYALE<T, S> const& m,
+                                    std::span<T const> v, std::span<T> result,
+                                    T alpha, T beta) {
+    by_vector_compressed(m, v, result, alpha, beta);
+}
+
+/// @brief Performs the transpose product `result = alpha * m^T * v + beta *
+/// result` on multiple threads, the same as the direct one.
+/// @param m An object of type SymYALE representing the matrix, i.e. the lhs.
+/// @param v The vector, it must hold `m.get_rows()` elements.
+/// @param result The output buffer, it must hold `m.get_columns()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+template <NumericOrComplex T, StorageOrder S>
+void by_vector_transpose_compressed_parallel(SymYALE<T, S> const& m,
+                                             std::span<T const> v,
+                                             std::span<T> result, T alpha,
+                                             T beta, unsigned num_threads) {
+    by_vector_compressed_parallel(m, v, result, alpha, beta, num_threads);
+}
+
+/// @brief Finds the positions of the diagonal elements in the values array.
+/// @param m An object of type SymYALE.
+/// @return The position of each element `(i, i)`, or `no_position` if it's
+/// not stored.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @details The work is done by `compressed_diagonal_positions`.
+template <NumericOrComplex T, StorageOrder S>
+std::vector<size_t> diagonal_positions_compressed(
+    SymYALE<T, S> const& m) {
+    return compressed_diagonal_positions(
+        m.get_inner_indexes(), m.get_outer_indexes(),
+        std::min(m.get_rows(), m.get_columns()));
+}
+
+}  // namespace algebra
+
+#endif
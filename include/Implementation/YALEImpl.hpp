@@ -1,10 +1,14 @@
 #ifndef YALEIMP_HPP
 #define YALEIMP_HPP
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
+#include <stdexcept>
+#include <utility>
 
 #include "Comparators.hpp"
+#include "Profiling.hpp"
 #include "YALE.hpp"
 
 using namespace comparators;
@@ -13,6 +17,8 @@ namespace algebra {
 /// @brief Constructs a YALE matrix from compressed format data.
 /// @tparam T The type of the matrix elements.
 /// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
 /// @tparam B Boolean constant to indicate wether the matrix' size was given
 /// as input.
 /// @param out The outer index container.
@@ -21,11 +27,12 @@ namespace algebra {
 /// @details This constructor initializes the YALE matrix by iterating through
 /// the provided containers. It validates the indices and populates the internal
 /// data structures.
-template <NumericOrComplex T, StorageOrder S>
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
 template <bool B>
-YALE<T, S>::YALE(std::bool_constant<B>, SizetContainer auto const& out,
-                 SizetContainer auto const& in,
-                 NumericContainer auto const& val) {
+YALE<T, S, I, P>::YALE(std::bool_constant<B>,
+                       SizetContainer auto const& out,
+                       SizetContainer auto const& in,
+                       NumericContainer auto const& val) {
     size_t inner_index_size =
         static_cast<size_t>(std::distance(in.begin(), in.end()));
     size_t outer_index_size =
@@ -49,9 +56,9 @@ YALE<T, S>::YALE(std::bool_constant<B>, SizetContainer auto const& out,
 
     comparator = Comparator<S>{};
 
-    innerindex_ptr = std::make_unique<std::vector<size_t>>();
-    outerindex_ptr = std::make_unique<std::vector<size_t>>();
-    values_ptr = std::make_unique<std::vector<T>>();
+    innerindex_ptr = std::make_unique<innervec>();
+    outerindex_ptr = std::make_unique<outervec>();
+    values_ptr = std::make_unique<valuesvec>();
 
     (*innerindex_ptr).reserve(inner_index_size);
     (*outerindex_ptr).reserve(outer_index_size);
@@ -96,274 +103,427 @@ YALE<T, S>::YALE(std::bool_constant<B>, SizetContainer auto const& out,
 
         if constexpr (!B) max_size_outer = std::max(max_size_outer, *outer_it);
 
-        outerindex_ptr->push_back(*outer_it);
+        outerindex_ptr->push_back(static_cast<I>(*outer_it));
         values_ptr->push_back(*val_it);
         ++val_it;
         ++outer_it;
 
         while (inner_it != in.end() && outer_it - out.begin() >= *inner_it) {
-            innerindex_ptr->push_back(*inner_it);
+            innerindex_ptr->push_back(static_cast<P>(*inner_it));
             ++inner_it;
         }
     }
 
+    size_t outer_extent = (S == rowMajor) ? this->columns : this->rows;
+    if constexpr (!B) outer_extent = max_size_outer + 1;
+    if (!fits_indexes(outer_extent, outer_index_size)) {
+        throw std::overflow_error(
+            "Error in YALE constructor: indexes overflow the index types.");
+    }
+
     if constexpr (!B && S == rowMajor)
         this->resize(inner_index_size - 1, max_size_outer + 1);
     else if constexpr (!B && S == columnMajor)
         this->resize(max_size_outer + 1, inner_index_size - 1);
 }
 
+/// @brief Constructs a YALE matrix by reading a Matrix Market file.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @tparam B Boolean constant to indicate wether the matrix' size was given
+/// as input.
+/// @param file_name The name of the file to read the data from.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @details The file is parsed in parallel by `read_market` and the three
+/// vectors are built directly with a counting sort on the lines, honoring the
+/// symmetry declared in the header. If the size wasn't given as input, the
+/// one declared in the header is used.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+template <bool B>
+YALE<T, S, I, P>::YALE(std::bool_constant<B>, std::string const& file_name,
+                       unsigned num_threads) {
+    MarketData<T> data = read_market<T>(file_name, num_threads);
+
+    if constexpr (B) {
+#ifdef DEBUG
+        assert(data.header.rows <= this->rows &&
+               data.header.columns <= this->columns &&
+               "Error in YALE constructor: indexes out of bounds (too "
+               "big).\n");
+#endif
+    }
+    else {
+        this->resize(data.header.rows, data.header.columns);
+    }
+
+    size_t max_elements = data.values.size();
+    if (data.header.symmetry != MarketSymmetry::General) max_elements *= 2;
+    if (!fits_indexes(S == rowMajor ? this->columns : this->rows,
+                      max_elements)) {
+        throw std::overflow_error(
+            "Error in YALE constructor: indexes overflow the index types.");
+    }
+
+    comparator = Comparator<S>{};
+
+    innerindex_ptr = std::make_unique<innervec>();
+    outerindex_ptr = std::make_unique<outervec>();
+    values_ptr = std::make_unique<valuesvec>();
+
+    market_to_compressed<T, S>(data, S == rowMajor ? this->rows : this->columns,
+                               *innerindex_ptr, *outerindex_ptr, *values_ptr,
+                               num_threads);
+}
+
 /// @brief Finds the value at the specified position (read-only).
 /// @tparam T The type of the matrix elements.
 /// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
 /// @param i The row index.
 /// @param j The column index.
 /// @return The value at the specified position.
 /// @details This function uses binary search to locate the value in the
 /// compressed storage format. If the value is not found, it returns a
 /// default-constructed value.
-template <NumericOrComplex T, StorageOrder S>
-T YALE<T, S>::find_compressed_const(size_t i, size_t j) const {
-    auto [in, out] = inner_outer(i, j);
-    int cumulated = (*innerindex_ptr)[in];
-    int current_line = (*innerindex_ptr)[in + 1] - cumulated;
-
-    auto lower = std::lower_bound(
-        (*outerindex_ptr).begin() + cumulated,
-        (*outerindex_ptr).begin() + current_line + cumulated - 1, out);
-
-    if (*lower == out) {
-        return (*values_ptr)[lower - (*outerindex_ptr).begin()];
-    }
-
-    return T{};
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+T YALE<T, S, I, P>::find_compressed_const(size_t i, size_t j) const {
+    return compressed_find<S>(get_inner_indexes(), get_outer_indexes(),
+                              get_values(), i, j);
 }
 
 /// @brief Finds the value at the specified position (read-write).
 /// @tparam T The type of the matrix elements.
 /// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
 /// @param i The row index.
 /// @param j The column index.
 /// @return A reference to the value at the specified position.
 /// @details If the value does not exist, this function inserts a new entry
-/// into the compressed storage format and returns a reference to it.
-template <NumericOrComplex T, StorageOrder S>
-T& YALE<T, S>::find_compressed(size_t i, size_t j) {
+/// into the compressed storage format and returns a reference to it. Every
+/// insertion moves all the following elements, to insert many elements use
+/// `insert_compressed` and `assemble_compressed`.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+T& YALE<T, S, I, P>::find_compressed(size_t i, size_t j) {
     auto [in, out] = inner_outer(i, j);
-    size_t cumulated = (*innerindex_ptr)[in];
-    size_t current_line = (*innerindex_ptr)[in + 1] - cumulated;
+    auto& inner = *innerindex_ptr;
+    auto& outer = *outerindex_ptr;
+    auto& values = *values_ptr;
 
-    auto lower = std::lower_bound(
-        (*outerindex_ptr).begin() + cumulated,
-        (*outerindex_ptr).begin() + current_line + cumulated - 1, out);
+    auto first = outer.begin() + inner[in];
+    auto last = outer.begin() + inner[in + 1];
+    auto lower = std::lower_bound(first, last, out);
+    auto diff = lower - outer.begin();
 
-    if (*lower == out) {
-        return (*values_ptr)[lower - (*outerindex_ptr).begin()];
+    if (lower != last && *lower == out) {
+        return values[diff];
     }
-    else {
-        typename std::vector<T>::iterator ref;
-        auto diff = lower - (*outerindex_ptr).begin();
 
-        if (*lower > out) {
-            ref = (*values_ptr).insert((*values_ptr).begin() + diff, 0);
-            (*outerindex_ptr).insert((*outerindex_ptr).begin() + diff, out);
-        }
-        else {
-            ref = (*values_ptr).insert((*values_ptr).begin() + diff + 1, 0);
-            (*outerindex_ptr).insert((*outerindex_ptr).begin() + diff + 1, out);
-        }
+    PROFILE_SCOPE("insert_compressed", "YALE");
+    PROFILE_BYTES((values.size() - diff) * (sizeof(T) + sizeof(I)) +
+                  (inner.size() - in - 1) * sizeof(P));
 
-        for (auto i = 1 + in; i < rows + 1; ++i) {
-            (*innerindex_ptr)[i]++;
-        }
+    if (!fits_indexes(out + 1, values.size() + 1)) {
+        throw std::overflow_error(
+            "Error in call to find_compressed: indexes overflow the index "
+            "types.");
+    }
+
+    outer.insert(lower, static_cast<I>(out));
+    auto ref = values.insert(values.begin() + diff, T{});
 
-        return *ref;
+    for (size_t l = in + 1; l < inner.size(); ++l) {
+        inner[l]++;
     }
+
+    return *ref;
 }
 
-/// @brief In the process of compressing the matrix sends the next tuple.
+/// @brief In the process of uncompressing the matrix sends all the triplets,
+/// coherently with the storage order.
 /// @tparam T The type of the matrix elements.
 /// @tparam S The storage order (row-major or column-major).
-/// @param first_it Flags the first iteration.
-/// @param tupleptr Pointer to a tuple representing a matrix element.
-/// @details This function removes the specified element from the compressed
-/// storage format and adjusts the indices accordingly.
-template <NumericOrComplex T, StorageOrder S>
-void YALE<T, S>::uncompress_from_compressed(
-    bool first_it, std::unique_ptr<ivtuple> const& tupleptr) {
-    auto static innerit = (*innerindex_ptr).begin();
-    auto static outerit = (*outerindex_ptr).begin();
-    auto static valuesit = (*values_ptr).begin();
-
-    if (first_it) {
-        innerit = (*innerindex_ptr).begin();
-        outerit = (*outerindex_ptr).begin();
-        valuesit = (*values_ptr).begin();
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @tparam F The type of the receiver.
+/// @param receiver A callable taking the row index, the column index and the
+/// value of each element.
+/// @details Lines are visited one after the other, so the triplets come out
+/// already sorted and the receiver can append them.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+template <typename F>
+void YALE<T, S, I, P>::uncompress_from_compressed(F&& receiver) const {
+    auto const& inner = *innerindex_ptr;
+    auto const& outer = *outerindex_ptr;
+    auto const& values = *values_ptr;
+
+    for (size_t line = 0; line + 1 < inner.size(); ++line) {
+        for (size_t k = inner[line]; k < inner[line + 1]; ++k) {
+            if constexpr (S == rowMajor) {
+                receiver(line, outer[k], values[k]);
+            }
+            else {
+                receiver(outer[k], line, values[k]);
+            }
+        }
     }
+}
 
-    auto next = innerit;
-    ++next;
-
-    if constexpr (S == rowMajor) {
-        (*tupleptr) = std::make_tuple(innerit - (*innerindex_ptr).begin(),
-                                      *outerit, *valuesit);
-    }
-    else {
-        (*tupleptr) = std::make_tuple(
-            *outerit, innerit - (*innerindex_ptr).begin(), *valuesit);
+/// @brief Builds the data structure from the triplets sent by another format.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @tparam F The type of the sender.
+/// @param num_elements The number of triplets that will be sent.
+/// @param sender A callable taking a receiver and calling it on every triplet,
+/// coherently with the storage order.
+/// @details The three vectors are allocated with their exact size, then a
+/// single pass counts the elements of each line while appending the outer
+/// indexes and the values, and a prefix sum turns the counts into the inner
+/// index vector.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+template <typename F>
+void YALE<T, S, I, P>::compress_from_triplets(size_t num_elements,
+                                              F&& sender) {
+    PROFILE_SCOPE("compress", "YALE");
+    size_t num_lines = (S == rowMajor) ? this->rows : this->columns;
+
+    if (!fits_indexes(S == rowMajor ? this->columns : this->rows,
+                      num_elements)) {
+        throw std::overflow_error(
+            "Error in call to compress_from_triplets: indexes overflow the "
+            "index types.");
     }
 
-    ++outerit;
-    ++valuesit;
+    innerindex_ptr = std::make_unique<innervec>(num_lines + 1, 0);
+    outerindex_ptr = std::make_unique<outervec>();
+    values_ptr = std::make_unique<valuesvec>();
+
+    auto& inner = *innerindex_ptr;
+    auto& outer = *outerindex_ptr;
+    auto& values = *values_ptr;
 
-    if (valuesit - (*values_ptr).begin() >= *next) {
-        ++innerit;
+    outer.reserve(num_elements);
+    values.reserve(num_elements);
+
+    sender([&](size_t i, size_t j, T const& value) {
+        auto [in, out] = inner_outer(i, j);
+        inner[in + 1]++;
+        outer.push_back(static_cast<I>(out));
+        values.push_back(value);
+    });
+
+    for (size_t line = 0; line < num_lines; ++line) {
+        inner[line + 1] += inner[line];
     }
+    PROFILE_BYTES(values.size() * (sizeof(T) + sizeof(I)) +
+                  inner.size() * sizeof(P));
 }
 
-/// @brief Takes a triplet and inserts it into the data structure.
+/// @brief Replaces the compressed arrays with the ones filled by a builder.
 /// @tparam T The type of the matrix elements.
 /// @tparam S The storage order (row-major or column-major).
-/// @param last_it Flags the last iteration.
-/// @param tupleptr Pointer to a tuple representing a matrix element.
-/// @details This function processes the triplets and updates the compressed
-/// storage format. If it's the last iteration, it finalizes the inner index
-/// array.
-template <NumericOrComplex T, StorageOrder S>
-void YALE<T, S>::compress_from_triplets(
-    bool last_it, std::unique_ptr<ivtuple> const& tupleptr) {
-    if constexpr (S == rowMajor) {
-        (*innerindex_ptr)[std::get<0>(*tupleptr) + 1]++;
-        (*outerindex_ptr).push_back(std::get<1>(*tupleptr));
-        (*values_ptr).push_back(std::get<2>(*tupleptr));
-    }
-    else {
-        (*innerindex_ptr)[std::get<1>(*tupleptr) + 1]++;
-        (*outerindex_ptr).push_back(std::get<0>(*tupleptr));
-        (*values_ptr).push_back(std::get<2>(*tupleptr));
-    }
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @tparam F The type of the builder.
+/// @param builder A callable taking the inner index, the outer index and the
+/// values vectors, empty, and filling them.
+/// @details Used by the operations computing the arrays directly, e.g. the
+/// transpose and the matrix-matrix product, which skip the triplets.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+template <typename F>
+void YALE<T, S, I, P>::build_compressed(F&& builder) {
+    innerindex_ptr = std::make_unique<innervec>();
+    outerindex_ptr = std::make_unique<outervec>();
+    values_ptr = std::make_unique<valuesvec>();
+    pending.clear();
 
-    if (last_it) {
-        auto prev = (*innerindex_ptr).begin();
-        auto next = prev;
-        ++next;
-        for (; next != (*innerindex_ptr).end(); ++next) {
-            *next += *prev;
-            ++prev;
-        }
+    builder(*innerindex_ptr, *outerindex_ptr, *values_ptr);
+
+    if (!fits_indexes(S == rowMajor ? this->columns : this->rows,
+                      values_ptr->size())) {
+        release_compressed();
+        throw std::overflow_error(
+            "Error in call to build_compressed: indexes overflow the index "
+            "types.");
     }
 }
 
 /// @brief Gets the number of non-zero elements.
 /// @tparam T The type of the matrix elements.
 /// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
 /// @return The number of non-zero elements.
 /// @details This function returns the size of the values array, which
 /// represents the number of non-zero elements in the matrix.
-template <NumericOrComplex T, StorageOrder S>
-size_t YALE<T, S>::get_num_elements_compressed() const {
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+size_t YALE<T, S, I, P>::get_num_elements_compressed() const {
     return (*values_ptr).size();
 };
 
-/// @brief Initializes the compressed storage format.
-/// @tparam T The type of the matrix elements.
-/// @tparam S The storage order (row-major or column-major).
-/// @param insize The size of the inner index container.
-/// @param outsize The size of the outer index container.
-/// @param valsize The size of the values container.
-/// @details This function allocates memory for the inner index, outer index,
-/// and values containers and resizes them to the specified sizes.
-template <NumericOrComplex T, StorageOrder S>
-void YALE<T, S>::initialize_compressed(size_t insize, size_t outsize,
-                                       size_t valsize) {
-    innerindex_ptr = std::make_unique<indexvec>();
-    outerindex_ptr = std::make_unique<indexvec>();
-    values_ptr = std::make_unique<valuesvec>();
-
-    (*innerindex_ptr).resize(insize);
-    (*outerindex_ptr).reserve(outsize);
-    (*values_ptr).reserve(valsize);
-}
-
 /// @brief Releases the compressed storage format.
 /// @tparam T The type of the matrix elements.
 /// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
 /// @details This function deallocates the memory used by the inner index,
 /// outer index, and values containers.
-template <NumericOrComplex T, StorageOrder S>
-void YALE<T, S>::release_compressed() {
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+void YALE<T, S, I, P>::release_compressed() {
+    pending.clear();
     innerindex_ptr.reset();
     outerindex_ptr.reset();
     values_ptr.reset();
 }
 
-/// @brief Computes the norm of the matrix.
+/// @brief Gets the inner index vector.
 /// @tparam T The type of the matrix elements.
 /// @tparam S The storage order (row-major or column-major).
-/// @tparam N The type of norm to compute (Infinity, One, or Frobenius).
-/// @return The computed norm value.
-/// @details This function calculates the specified norm by iterating through
-/// the compressed storage format and applying the appropriate formula.
-template <NumericOrComplex T, StorageOrder S>
-template <NormType N>
-double YALE<T, S>::norm_compressed() const {
-    if constexpr (N == One && S == rowMajor) {
-        std::vector<double> par(this->columns, 0);
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @return A read-only view of the beginning of each line.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+std::span<P const> YALE<T, S, I, P>::get_inner_indexes() const {
+    return *innerindex_ptr;
+}
 
-        for (size_t i = 0; i < (*values_ptr).size(); ++i) {
-            par[(*outerindex_ptr)[i]] += std::abs((*values_ptr)[i]);
-        }
-        return *std::max_element(par.begin(), par.end());
-    }
+/// @brief Gets the outer index vector.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @return A read-only view of the outer index of each element.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+std::span<I const> YALE<T, S, I, P>::get_outer_indexes() const {
+    return *outerindex_ptr;
+}
 
-    else if constexpr (N == Infinity && S == columnMajor) {
-        std::vector<double> par(this->rows, 0);
+/// @brief Gets the values vector.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @return A read-only view of the value of each element.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+std::span<T const> YALE<T, S, I, P>::get_values() const {
+    return *values_ptr;
+}
 
-        for (size_t i = 0; i < (*values_ptr).size(); ++i) {
-            par[(*outerindex_ptr)[i]] += std::abs((*values_ptr)[i]);
-        }
-        return *std::max_element(par.begin(), par.end());
+/// @brief Finds the positions of elements in the values vector.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @param indexes The container of the positions, as pairs of row and column
+/// indexes.
+/// @return The position of each element, or `no_position` if it's not
+/// stored.
+/// @details Each element is binary searched in its line once, then the
+/// positions stay valid as long as the sparsity pattern doesn't change.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+std::vector<size_t> YALE<T, S, I, P>::positions_compressed(
+    SizetPairContainer auto const& indexes) const {
+#ifdef DEBUG
+    for (auto const& [i, j] : indexes) {
+        assert(i < this->rows && j < this->columns &&
+               "Error in call to value_positions: indexes out of bounds.\n");
     }
+#endif
 
-    else if constexpr ((N == Infinity && S == rowMajor) ||
-                       (N == One && S == columnMajor)) {
-        double res = 0.0;
-        double sum = 0.0;
-        size_t cumulated;
-        auto it = (*values_ptr).begin();
-
-        for (size_t k = 1; k < (*innerindex_ptr).size(); ++k) {
-            cumulated = (*innerindex_ptr)[k];
-            for (auto it = (*values_ptr).begin() + (*innerindex_ptr)[k - 1];
-                 it != (*values_ptr).begin() + cumulated; ++it) {
-                sum += std::abs(*it);
-            }
+    return compressed_positions<S>(get_inner_indexes(), get_outer_indexes(),
+                                   indexes);
+}
 
-            res = std::max(res, sum);
-            sum = 0.0;
-        }
-        return res;
-    }
+/// @brief Sets all the values to zero, keeping the sparsity pattern.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @details The values are overwritten in place, nothing is allocated.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+void YALE<T, S, I, P>::zero_values_compressed() {
+    std::fill(values_ptr->begin(), values_ptr->end(), T{0});
+}
 
-    else {
-        double sum = 0.0;
-        for (auto const& el : *values_ptr) {
-            sum += std::abs(el) * std::abs(el);
-        }
-        return std::sqrt(sum);
+/// @brief Adds contributions to the values at known positions.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @param positions The position of each contribution in the values vector.
+/// @param contributions The contributions.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+void YALE<T, S, I, P>::add_values_compressed(
+    std::span<size_t const> positions, std::span<T const> contributions,
+    unsigned num_threads) {
+#ifdef DEBUG
+    for (size_t position : positions) {
+        assert(position < values_ptr->size() &&
+               "Error in call to add_values: position not stored.\n");
     }
+#endif
+
+    compressed_scatter_add(std::span<T>(*values_ptr), positions,
+                           contributions, num_threads);
+}
+
+/// @brief Writes a binary snapshot of the matrix that can be loaded without
+/// parsing by `MappedYALE`.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @param file_name The name of the file to write.
+/// @details The three vectors are written as they are in memory, see
+/// `write_snapshot`.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+void YALE<T, S, I, P>::save_snapshot(std::string const& file_name) const {
+#ifdef DEBUG
+    assert(innerindex_ptr &&
+           "Error in call to save_snapshot: matrix not compressed.\n");
+#endif
+
+    write_snapshot<S>(file_name, this->rows, this->columns,
+                      get_inner_indexes(), get_outer_indexes(), get_values());
+}
+
+/// @brief Computes the norm of the matrix.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @tparam N The type of norm to compute (Infinity, One, or Frobenius).
+/// @return The computed norm value.
+/// @details This function calculates the specified norm with
+/// `compressed_norm`, iterating through the compressed storage format.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+template <NormType N>
+double YALE<T, S, I, P>::norm_compressed() const {
+    return compressed_norm<N, S>(get_inner_indexes(), get_outer_indexes(),
+                                 get_values(), this->rows, this->columns);
 }
 
 /// @brief Computes the inner and outer indices for a given position.
 /// @tparam T The type of the matrix elements.
 /// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
 /// @param i The row index.
 /// @param j The column index.
 /// @return A pair representing the inner and outer indexes.
 /// @details This function determines the inner and outer indexes based on
 /// the storage order of the matrix.
-template <NumericOrComplex T, StorageOrder S>
-std::pair<size_t, size_t> YALE<T, S>::inner_outer(size_t i, size_t j) const {
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+std::pair<size_t, size_t> YALE<T, S, I, P>::inner_outer(size_t i,
+                                                        size_t j) const {
     if constexpr (S == rowMajor) {
         return {i, j};
     }
@@ -372,57 +532,235 @@ std::pair<size_t, size_t> YALE<T, S>::inner_outer(size_t i, size_t j) const {
     }
 }
 
+/// @brief Checks if the indexes of a matrix can be stored in the index types.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @param outer_extent The number of columns in row-major order, of rows in
+/// column-major order.
+/// @param num_elements The number of non-zero elements.
+/// @return True if no index would overflow.
+/// @details The biggest outer index is `outer_extent - 1` and the biggest
+/// inner index, the last one, is `num_elements`.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+bool YALE<T, S, I, P>::fits_indexes(size_t outer_extent,
+                                    size_t num_elements) {
+    return num_elements <= std::numeric_limits<P>::max() &&
+           (outer_extent == 0 ||
+            outer_extent - 1 <= std::numeric_limits<I>::max());
+}
+
 /// @brief Removes the element at the specified position.
 /// @tparam T The type of the matrix elements.
 /// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
 /// @param i The row index.
 /// @param j The column index.
 /// @return True if the element was removed, false otherwise.
 /// @details This function removes the specified element from the compressed
 /// storage format and adjusts the indexes accordingly.
-template <NumericOrComplex T, StorageOrder S>
-bool YALE<T, S>::remove_compressed(size_t i, size_t j) {
-    auto [inner_index_to_find, outer_index_to_find] = inner_outer(i, j);
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+bool YALE<T, S, I, P>::remove_compressed(size_t i, size_t j) {
+    auto [in, out] = inner_outer(i, j);
 
-    auto inner_indices = *(this->innerindex_ptr);
-    auto outer_indices = *(this->outerindex_ptr);
-    auto values = *(this->values_ptr);
+    auto& inner = *innerindex_ptr;
+    auto& outer = *outerindex_ptr;
 
-    size_t row_start, row_end;
+    auto first = outer.begin() + inner[in];
+    auto last = outer.begin() + inner[in + 1];
+    auto lower = std::lower_bound(first, last, out);
+    if (lower == last || *lower != out) return false;
 
-    if constexpr (S == rowMajor) {
-        row_start = inner_indices[i];
-        row_end = inner_indices[i + 1];
+    values_ptr->erase(values_ptr->begin() + (lower - outer.begin()));
+    outer.erase(lower);
+
+    for (size_t l = in + 1; l < inner.size(); ++l) {
+        inner[l]--;
     }
-    else {
-        row_start = inner_indices[j];
-        row_end = inner_indices[j + 1];
+    return true;
+}
+
+/// @brief Removes all the elements satisfying a predicate.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @tparam F The type of the predicate.
+/// @param pred A callable taking the row index, the column index and the
+/// value of each element, and returning true if it has to be removed.
+/// @return The number of removed elements.
+/// @details The kept elements are moved towards the front of the arrays and
+/// the inner indexes are rebuilt in the same pass, so every element is moved
+/// at most once.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+template <typename F>
+size_t YALE<T, S, I, P>::remove_if_compressed(F&& pred) {
+    auto& inner = *innerindex_ptr;
+    auto& outer = *outerindex_ptr;
+    auto& values = *values_ptr;
+
+    size_t write = 0;
+    size_t begin = 0;
+    for (size_t line = 0; line + 1 < inner.size(); ++line) {
+        size_t end = inner[line + 1];
+        for (size_t k = begin; k < end; ++k) {
+            bool removed;
+            if constexpr (S == rowMajor) {
+                removed = pred(line, static_cast<size_t>(outer[k]),
+                               std::as_const(values[k]));
+            }
+            else {
+                removed = pred(static_cast<size_t>(outer[k]), line,
+                               std::as_const(values[k]));
+            }
+            if (!removed) {
+                outer[write] = outer[k];
+                values[write] = values[k];
+                ++write;
+            }
+        }
+        begin = end;
+        inner[line + 1] = static_cast<P>(write);
+    }
+
+    size_t removed = values.size() - write;
+    outer.resize(write);
+    values.resize(write);
+    return removed;
+}
+
+/// @brief Adds an element to the buffer of the elements waiting to be merged
+/// into the compressed arrays by `assemble_compressed`.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @param i The row index.
+/// @param j The column index.
+/// @param value The value of the element.
+/// @details The compressed arrays are left untouched, so the element can't be
+/// read until it's merged.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+void YALE<T, S, I, P>::insert_compressed(size_t i, size_t j, T const& value) {
+#ifdef DEBUG
+    assert(i < this->rows && j < this->columns &&
+           "Error in call to insert_batch: indexes out of bounds.\n");
+#endif
+
+    auto [in, out] = inner_outer(i, j);
+    pending.push_back({in, out, value});
+}
+
+/// @brief Merges the buffered elements into the compressed arrays.
+/// @tparam T The type of the matrix elements.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @param mode How an element is combined with the ones at the same position,
+/// either stored or buffered before it.
+/// @details The buffer is sorted and its duplicates are combined, then the
+/// elements already stored are updated in place and the new ones are merged
+/// into the arrays with a single backward pass, that moves every stored
+/// element at most once and needs no memory besides the growth of the
+/// arrays.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+void YALE<T, S, I, P>::assemble_compressed(InsertMode mode) {
+    if (pending.empty()) return;
+
+    std::stable_sort(pending.begin(), pending.end(),
+                     [](PendingElement const& a, PendingElement const& b) {
+                         return a.line < b.line ||
+                                (a.line == b.line && a.index < b.index);
+                     });
+
+    auto& inner = *innerindex_ptr;
+    auto& outer = *outerindex_ptr;
+    auto& values = *values_ptr;
+
+    size_t fresh = 0;
+    for (size_t k = 0; k < pending.size(); ++k) {
+        auto const& element = pending[k];
+        if (fresh > 0 && pending[fresh - 1].line == element.line &&
+            pending[fresh - 1].index == element.index) {
+            if (mode == Add) {
+                pending[fresh - 1].value += element.value;
+            }
+            else {
+                pending[fresh - 1].value = element.value;
+            }
+            continue;
+        }
+
+        auto first = outer.begin() + inner[element.line];
+        auto last = outer.begin() + inner[element.line + 1];
+        auto lower = std::lower_bound(first, last, element.index);
+
+        if (lower != last && *lower == element.index) {
+            auto& value = values[lower - outer.begin()];
+            value = (mode == Add) ? value + element.value : element.value;
+            while (k + 1 < pending.size() &&
+                   pending[k + 1].line == element.line &&
+                   pending[k + 1].index == element.index) {
+                ++k;
+                value = (mode == Add) ? value + pending[k].value
+                                      : pending[k].value;
+            }
+        }
+        else {
+            pending[fresh++] = element;
+        }
     }
 
-    for (size_t k = row_start; k < row_end; ++k) {
-        size_t current_outer_index = outer_indices[k];
-        if (current_outer_index == outer_index_to_find) {
-            values_ptr->erase(values_ptr->begin() + k);
-            outerindex_ptr->erase(outerindex_ptr->begin() + k);
+    size_t old_size = values.size();
+    size_t new_size = old_size + fresh;
+
+    if (!fits_indexes(S == rowMajor ? this->columns : this->rows,
+                      new_size)) {
+        throw std::overflow_error(
+            "Error in call to assemble_compressed: indexes overflow the "
+            "index types.");
+    }
 
-            for (size_t l = (S == rowMajor ? i + 1 : j + 1);
-                 l < innerindex_ptr->size(); ++l) {
-                (*innerindex_ptr)[l]--;
+    outer.resize(new_size);
+    values.resize(new_size);
+
+    size_t write = new_size;
+    size_t p = fresh;
+    for (size_t line = inner.size() - 1; line-- > 0 && p > 0;) {
+        size_t begin = inner[line];
+        size_t k = inner[line + 1];
+        inner[line + 1] = static_cast<P>(write);
+
+        while (k > begin || (p > 0 && pending[p - 1].line == line)) {
+            --write;
+            if (p > 0 && pending[p - 1].line == line &&
+                (k == begin || pending[p - 1].index > outer[k - 1])) {
+                --p;
+                outer[write] = static_cast<I>(pending[p].index);
+                values[write] = pending[p].value;
+            }
+            else {
+                --k;
+                outer[write] = outer[k];
+                values[write] = values[k];
             }
-            return true;
         }
     }
 
-    return false;
+    pending.clear();
 }
 
 /// @brief Prints the matrix in compressed format to the standard output.
 /// @tparam T The type of the matrix elements.
 /// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
 /// @details This function iterates through the compressed storage format and
 /// prints values, outer indices, and inner indices.
-template <NumericOrComplex T, StorageOrder S>
-void YALE<T, S>::print_compressed() const {
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+void YALE<T, S, I, P>::print_compressed() const {
     std::cout << "Values: ";
     for (const auto& el : *values_ptr) {
         std::cout << el << " ";
@@ -446,34 +784,205 @@ void YALE<T, S>::print_compressed() const {
 /// @param v The vector, i.e. the rhs.
 /// @tparam T The type of the matrix elements (numeric or complex).
 /// @tparam S The storage order (row-major or column-major).
-template <NumericOrComplex T, StorageOrder S>
-std::vector<T> by_vector_compressed(YALE<T, S> const& m,
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+std::vector<T> by_vector_compressed(YALE<T, S, I, P> const& m,
                                     std::vector<T> const& v) {
     std::vector<T> result(m.rows, T{});
+    by_vector_compressed(m, std::span<T const>(v), std::span<T>(result), T{1},
+                         T{0});
+    return result;
+}
 
-    const auto inner_indices = *(m.innerindex_ptr);
-    const auto outer_indices = *(m.outerindex_ptr);
-    const auto values = *(m.values_ptr);
-    const size_t num_rows = m.rows;
+/// @brief Performs the matrix-vector product `result = alpha * m * v + beta *
+/// result` writing into a buffer owned by the caller.
+/// @param m An object of type YALE representing the matrix, i.e. the lhs.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer, it must hold `m.get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @details The compressed arrays are read in place and no memory is
+/// allocated. As in BLAS, when `beta` is zero the previous content of `result`
+/// is never read, so it doesn't need to be initialized.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+void by_vector_compressed(YALE<T, S, I, P> const& m, std::span<T const> v,
+                          std::span<T> result, T alpha, T beta) {
+    compressed_product<S>(m.get_inner_indexes(), m.get_outer_indexes(),
+                          m.get_values(), v, result, alpha, beta);
+}
 
-    for (size_t i = 0; i < num_rows; ++i) {
-        size_t start = inner_indices[i];
-        size_t end = inner_indices[i + 1];
+/// @brief Performs the matrix-vector product `result = alpha * m * v + beta *
+/// result` on multiple threads.
+/// @param m An object of type YALE representing the matrix, i.e. the lhs.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer, it must hold `m.get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @details The work is done by `compressed_product_parallel`, which splits
+/// the lines among the threads in blocks with roughly the same number of
+/// non-zero elements.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+void by_vector_compressed_parallel(YALE<T, S, I, P> const& m,
+                                   std::span<T const> v, std::span<T> result,
+                                   T alpha, T beta, unsigned num_threads) {
+    compressed_product_parallel<S>(m.get_inner_indexes(),
+                                   m.get_outer_indexes(), m.get_values(), v,
+                                   result, alpha, beta, num_threads);
+}
 
-        for (size_t j = start; j < end; ++j) {
-            size_t outer_index = outer_indices[j];
-            T value = values[j];
+/// @brief Performs the product `y = alpha * m * x + beta * y` with a dense
+/// block of `k` vectors.
+/// @param m An object of type YALE representing the matrix, i.e. the lhs.
+/// @param x The rhs block, row-major with `k` columns.
+/// @param y The output block, row-major with `k` columns, it must hold `k *
+/// m.get_rows()` elements.
+/// @param k The number of vectors in the blocks.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `y`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @details The work is done by `compressed_product_block`, which reads the
+/// compressed arrays once for the whole block.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+void by_block_compressed(YALE<T, S, I, P> const& m, std::span<T const> x,
+                         std::span<T> y, size_t k, T alpha, T beta) {
+    compressed_product_block<S>(m.get_inner_indexes(), m.get_outer_indexes(),
+                                m.get_values(), x, y, k, alpha, beta);
+}
 
-            if constexpr (S == rowMajor) {
-                result[i] += value * v[outer_index];
-            }
-            else {
-                result[outer_index] += value * v[i];
-            }
-        }
-    }
+/// @brief Performs the transpose product `result = alpha * m^T * v + beta *
+/// result` writing into a buffer owned by the caller.
+/// @param m An object of type YALE representing the matrix, i.e. the lhs.
+/// @param v The vector, it must hold `m.get_rows()` elements.
+/// @param result The output buffer, it must hold `m.get_columns()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @details The arrays of a matrix are also the arrays of its transpose in
+/// the opposite storage order, so the work is done by `compressed_product`
+/// instantiated for that order: in row-major order the product scatters
+/// along the rows, in column-major order it gathers along the columns.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+void by_vector_transpose_compressed(YALE<T, S, I, P> const& m,
+                                    std::span<T const> v, std::span<T> result,
+                                    T alpha, T beta) {
+    compressed_product<opposite_order(S)>(m.get_inner_indexes(),
+                                          m.get_outer_indexes(),
+                                          m.get_values(), v, result, alpha,
+                                          beta);
+}
 
-    return result;
+/// @brief Performs the transpose product `result = alpha * m^T * v + beta *
+/// result` on multiple threads.
+/// @param m An object of type YALE representing the matrix, i.e. the lhs.
+/// @param v The vector, it must hold `m.get_rows()` elements.
+/// @param result The output buffer, it must hold `m.get_columns()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @details As for `by_vector_transpose_compressed`, the work is done by
+/// `compressed_product_parallel` instantiated for the opposite storage order.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+void by_vector_transpose_compressed_parallel(YALE<T, S, I, P> const& m,
+                                             std::span<T const> v,
+                                             std::span<T> result, T alpha,
+                                             T beta, unsigned num_threads) {
+    compressed_product_parallel<opposite_order(S)>(
+        m.get_inner_indexes(), m.get_outer_indexes(), m.get_values(), v,
+        result, alpha, beta, num_threads);
+}
+
+/// @brief Performs the matrix-vector product `y = m * x` and computes `x^H *
+/// y` in the same sweep.
+/// @param m An object of type YALE representing a square matrix.
+/// @param x The vector, i.e. the rhs.
+/// @param y The output buffer, as long as `x`.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @return The dot product `x^H * y`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @details The work is done by `compressed_product_dot`.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+T by_vector_dot_compressed(YALE<T, S, I, P> const& m, std::span<T const> x,
+                           std::span<T> y, unsigned num_threads) {
+    return compressed_product_dot<S>(m.get_inner_indexes(),
+                                     m.get_outer_indexes(), m.get_values(), x,
+                                     y, num_threads);
+}
+
+/// @brief Updates a residual, `r -= alpha * m * p`, and computes its squared
+/// norm in the same sweep.
+/// @param m An object of type YALE representing the matrix, i.e. the lhs.
+/// @param p The vector, i.e. the rhs.
+/// @param r The residual, it must hold `m.get_rows()` elements.
+/// @param alpha The scaling factor of the product.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @return The squared euclidean norm of the updated `r`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @details The work is done by `compressed_residual`.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+double residual_compressed(YALE<T, S, I, P> const& m, std::span<T const> p,
+                           std::span<T> r, T alpha, unsigned num_threads) {
+    return compressed_residual<S>(m.get_inner_indexes(), m.get_outer_indexes(),
+                                  m.get_values(), p, r, alpha, num_threads);
+}
+
+/// @brief Finds the positions of the diagonal elements in the values array.
+/// @param m An object of type YALE.
+/// @return The position of each element `(i, i)`, or `no_position` if it's
+/// not stored.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+/// @details The work is done by `compressed_diagonal_positions`.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+std::vector<size_t> diagonal_positions_compressed(
+    YALE<T, S, I, P> const& m) {
+    return compressed_diagonal_positions(
+        m.get_inner_indexes(), m.get_outer_indexes(),
+        std::min(m.get_rows(), m.get_columns()));
+}
+
+/// @brief Gets the range of the lines and of the elements of the matrix.
+/// @param m An object of type YALE.
+/// @return The range, holding spans into the arrays of `m`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam I The type of the outer indexes.
+/// @tparam P The type of the inner indexes.
+template <NumericOrComplex T, StorageOrder S, IndexType I, IndexType P>
+CompressedLines<T, S, T, P, I> lines_compressed(YALE<T, S, I, P> const& m) {
+    return CompressedLines<T, S, T, P, I>(
+        m.get_inner_indexes(), m.get_outer_indexes(), m.get_values());
 }
 
 }  // namespace algebra
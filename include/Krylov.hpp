@@ -0,0 +1,60 @@
+#ifndef KRYLOV_HPP
+#define KRYLOV_HPP
+
+#include <cstddef>
+#include <span>
+#include <type_traits>
+
+#include "Matrix.hpp"
+
+namespace algebra {
+
+/// @brief Outcome of an iterative solver.
+struct SolverResult {
+    std::size_t iterations = 0;  ///< Number of iterations performed.
+    double residual = 0.0;       ///< Final relative residual `|r| / |b|`.
+    bool converged = false;      ///< True if the tolerance was reached.
+};
+
+/// @brief Solves `A * x = b` with the conjugate gradient method, for
+/// symmetric (hermitian if complex) positive definite matrices.
+/// @param a The matrix `A`, square.
+/// @param b The right-hand side.
+/// @param x The initial guess, overwritten with the solution.
+/// @param tolerance The relative residual `|b - A * x| / |b|` to reach.
+/// @param max_iterations The maximum number of iterations, zero means as many
+/// as the rows of the matrix.
+/// @param num_threads The number of threads used by the products in
+/// compressed state, zero means as many as the hardware supports.
+/// @return The number of iterations, the final relative residual and whether
+/// the tolerance was reached.
+MATRIX_TEMPLATE
+SolverResult conjugate_gradient(MATRIX_TYPE const& a,
+                                std::type_identity_t<std::span<T const>> b,
+                                std::type_identity_t<std::span<T>> x,
+                                double tolerance = 1e-10,
+                                std::size_t max_iterations = 0,
+                                unsigned num_threads = 1);
+
+/// @brief Solves `A * x = b` with the stabilized biconjugate gradient method
+/// (BiCGSTAB), for general square matrices.
+/// @param a The matrix `A`, square.
+/// @param b The right-hand side.
+/// @param x The initial guess, overwritten with the solution.
+/// @param tolerance The relative residual `|b - A * x| / |b|` to reach.
+/// @param max_iterations The maximum number of iterations, zero means as many
+/// as the rows of the matrix.
+/// @param num_threads The number of threads used by the products in
+/// compressed state, zero means as many as the hardware supports.
+/// @return The number of iterations, the final relative residual and whether
+/// the tolerance was reached.
+MATRIX_TEMPLATE
+SolverResult bicgstab(MATRIX_TYPE const& a,
+                      std::type_identity_t<std::span<T const>> b,
+                      std::type_identity_t<std::span<T>> x,
+                      double tolerance = 1e-10, std::size_t max_iterations = 0,
+                      unsigned num_threads = 1);
+
+}  // namespace algebra
+
+#endif
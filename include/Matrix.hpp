@@ -1,8 +1,18 @@
 #ifndef MATRIX_HPP
 #define MATRIX_HPP
 
+#include <array>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <vector>
+
 #include "Comparators.hpp"
 #include "Concepts.hpp"
+#include "Device.hpp"
+#include "Expressions.hpp"
 
 #define MATRIX_TEMPLATE                                           \
     template <NumericOrComplex T,                                 \
@@ -20,11 +30,57 @@ struct UseDynamic {};
 /// @brief Type to flag compressed building.
 struct UseCompressed {};
 
+/// @brief Structural properties of a matrix.
+struct MatrixStats {
+    size_t num_elements = 0;          ///< Number of non-zero elements.
+    std::vector<size_t> row_lengths;  ///< Number of elements of each row.
+    size_t max_row_length = 0;        ///< Number of elements of longest row.
+    size_t bandwidth = 0;             ///< Largest distance from the diagonal.
+    size_t num_diagonal = 0;          ///< Number of elements on the diagonal.
+};
+
 MATRIX_TEMPLATE
 class Matrix;
 
 MATRIX_TEMPLATE
-std::vector<T> operator*(MATRIX_TYPE const& m, std::vector<T> const& v);
+class MatrixView;
+
+MATRIX_TEMPLATE
+LinearCombination<T, ProductTerm<T, MATRIX_TYPE>> operator*(
+    MATRIX_TYPE const& m, std::vector<T> const& v);
+
+MATRIX_TEMPLATE
+LinearCombination<T, ProductTerm<T, MATRIX_TYPE>> operator*(
+    MATRIX_TYPE const& m, std::vector<T>&& v) = delete;
+
+MATRIX_TEMPLATE
+LinearCombination<T, ProductTerm<T, MATRIX_TYPE>> operator*(
+    MATRIX_TYPE&& m, std::vector<T> const& v) = delete;
+
+MATRIX_TEMPLATE
+LinearCombination<T, ProductTerm<T, MATRIX_TYPE>> operator*(
+    MATRIX_TYPE&& m, std::vector<T>&& v) = delete;
+
+template <NumericOrComplex T,
+          template <typename, StorageOrder> class Compressed,
+          template <typename, StorageOrder> class Dynamic, StorageOrder S,
+          StorageOrder S2>
+MATRIX_TYPE operator*(MATRIX_TYPE const& a,
+                      Matrix<T, Compressed, Dynamic, S2> const& b);
+
+template <NumericOrComplex T,
+          template <typename, StorageOrder> class Compressed,
+          template <typename, StorageOrder> class Dynamic, StorageOrder S,
+          StorageOrder S2>
+MATRIX_TYPE operator+(MATRIX_TYPE const& a,
+                      Matrix<T, Compressed, Dynamic, S2> const& b);
+
+template <NumericOrComplex T,
+          template <typename, StorageOrder> class Compressed,
+          template <typename, StorageOrder> class Dynamic, StorageOrder S,
+          StorageOrder S2>
+MATRIX_TYPE operator-(MATRIX_TYPE const& a,
+                      Matrix<T, Compressed, Dynamic, S2> const& b);
 
 /// @brief Represents a matrix that supports both compressed and dynamic storage
 /// formats.
@@ -94,12 +150,62 @@ class Matrix : public Compressed<T, S>, public Dynamic<T, S> {
     /// @return The value at the specified position.
     T operator()(std::size_t i, std::size_t j) const;
 
-    /// @brief Accesses the element at the specified position (read-write).
+    /// @brief Accesses the element at the specified position (read-write),
+    /// inserting a zero if it's not stored, the same as `at_or_insert`.
     /// @param i The row index.
     /// @param j The column index.
     /// @return A reference to the value at the specified position.
     T& operator()(std::size_t i, std::size_t j);
 
+    /// @brief Accesses the element at the specified position (read-write),
+    /// inserting a zero if it's not stored.
+    /// @param i The row index.
+    /// @param j The column index.
+    /// @return A reference to the value at the specified position.
+    T& at_or_insert(std::size_t i, std::size_t j);
+
+    /// @brief Sets the element at the specified position, inserting it if
+    /// it's not stored.
+    /// @param i The row index.
+    /// @param j The column index.
+    /// @param value The value of the element.
+    void insert(std::size_t i, std::size_t j, T const& value);
+
+    /// @brief Calls a function on every stored element, without modifying
+    /// the matrix.
+    /// @tparam F The type of the function.
+    /// @param f A callable taking the row index, the column index and the
+    /// value of each element.
+    template <typename F>
+    void for_each(F&& f) const;
+
+    /// @brief Gets the range of the elements of a row of a row-major matrix,
+    /// compressed in a YALE-like format.
+    /// @param i The row index.
+    /// @return The range of the column indexes and of the values, e.g. `for
+    /// (auto [j, v] : m.row(i))`, holding spans into the compressed arrays.
+    auto row(std::size_t i) const
+        requires(S == rowMajor);
+
+    /// @brief Gets the range of the elements of a column of a column-major
+    /// matrix, compressed in a YALE-like format.
+    /// @param j The column index.
+    /// @return The range of the row indexes and of the values, e.g. `for
+    /// (auto [i, v] : m.column(j))`, holding spans into the compressed arrays.
+    auto column(std::size_t j) const
+        requires(S == columnMajor);
+
+    /// @brief Gets the range of the elements of a matrix compressed in a
+    /// YALE-like format, line by line.
+    /// @return The range of the rows, the columns and the values, e.g. `for
+    /// (auto [i, j, v] : m.nonzeros())`.
+    auto nonzeros() const;
+
+    /// @brief Gets a read-only view of the matrix, which can be shared by
+    /// several threads.
+    /// @return The view, valid as long as the matrix isn't modified.
+    MatrixView<T, Compressed, Dynamic, S> freeze() const;
+
     /// @brief Checks if the matrix is in compressed storage format.
     /// @return True if the matrix is compressed, false otherwise.
     bool is_compressed() const;
@@ -115,8 +221,154 @@ class Matrix : public Compressed<T, S>, public Dynamic<T, S> {
     template <NormType N>
     double norm() const;
 
-    friend std::vector<T> operator*
-        <>(MATRIX_TYPE const&, std::vector<T> const&);
+    /// @brief Gets the structural properties of the matrix.
+    /// @return The number of elements, the length of each row and of the
+    /// longest one, the bandwidth and the number of elements on the diagonal.
+    MatrixStats const& stats() const;
+
+    /// @brief Extracts the diagonal of the matrix, e.g. for a Jacobi
+    /// preconditioner.
+    /// @return The elements `(i, i)`, zero if not stored, for `i` up to the
+    /// smaller dimension.
+    std::vector<T> diagonal() const;
+
+    /// @brief Performs the matrix-vector product `y = alpha * A * x + beta *
+    /// y` writing into a buffer owned by the caller.
+    /// @param x The vector, i.e. the rhs.
+    /// @param y The output buffer, it must hold `get_rows()` elements.
+    /// @param alpha The scaling factor of the product.
+    /// @param beta The scaling factor of the previous content of `y`.
+    /// @param num_threads The number of threads used in compressed state, zero
+    /// means as many as the hardware supports.
+    void multiply_into(std::span<T const> x, std::span<T> y, T alpha = T{1},
+                       T beta = T{0}, unsigned num_threads = 1) const;
+
+    /// @brief Performs the product `Y = alpha * A * X + beta * Y` with a dense
+    /// block of `k` vectors, writing into a buffer owned by the caller.
+    /// @param x The rhs block, row-major with `k` columns: element `c` of the
+    /// vector multiplying column `j` is `x[j * k + c]`.
+    /// @param y The output block, row-major with `k` columns, it must hold `k
+    /// * get_rows()` elements.
+    /// @param k The number of vectors in the blocks.
+    /// @param alpha The scaling factor of the product.
+    /// @param beta The scaling factor of the previous content of `y`.
+    void multiply_block(std::span<T const> x, std::span<T> y, size_t k,
+                        T alpha = T{1}, T beta = T{0}) const;
+
+    /// @brief Uploads the compressed arrays of a YALE-like matrix to a
+    /// device, where they stay until the matrix is modified.
+    /// @param stream The stream running the products on the device.
+    void to_device(DeviceStream& stream = default_device_stream());
+
+    /// @brief Checks if the matrix has a copy on a device.
+    /// @return True after `to_device`, until the matrix is modified.
+    bool is_on_device() const;
+
+    /// @brief Frees the copy of the matrix on the device.
+    void release_device();
+
+    /// @brief Enqueues the product `y = alpha * A * x + beta * y` on the
+    /// stream of the copy on the device.
+    /// @param x The vector, i.e. the rhs.
+    /// @param y The output buffer, it must hold `get_rows()` elements.
+    /// @param alpha The scaling factor of the product.
+    /// @param beta The scaling factor of the previous content of `y`.
+    /// @return The future completed when `y` is written. Until then `x`
+    /// and `y` must stay alive and `y` mustn't be accessed.
+    std::future<void> multiply_async(std::span<T const> x, std::span<T> y,
+                                     T alpha = T{1}, T beta = T{0}) const;
+
+    /// @brief Enqueues the product `Y = alpha * A * X + beta * Y` with a
+    /// dense block of `k` vectors on the stream of the copy on the device.
+    /// @param x The rhs block, row-major with `k` columns.
+    /// @param y The output block, row-major with `k` columns, it must hold `k
+    /// * get_rows()` elements.
+    /// @param k The number of vectors in the blocks.
+    /// @param alpha The scaling factor of the product.
+    /// @param beta The scaling factor of the previous content of `y`.
+    /// @return The future completed when `y` is written. Until then `x`
+    /// and `y` must stay alive and `y` mustn't be accessed.
+    std::future<void> multiply_block_async(std::span<T const> x,
+                                           std::span<T> y, size_t k,
+                                           T alpha = T{1},
+                                           T beta = T{0}) const;
+
+    /// @brief Performs the transpose product `y = alpha * A^T * x + beta * y`
+    /// writing into a buffer owned by the caller, without building the
+    /// transpose. Complex elements are not conjugated.
+    /// @param x The vector, it must hold `get_rows()` elements.
+    /// @param y The output buffer, it must hold `get_columns()` elements.
+    /// @param alpha The scaling factor of the product.
+    /// @param beta The scaling factor of the previous content of `y`.
+    /// @param num_threads The number of threads used in compressed state, zero
+    /// means as many as the hardware supports.
+    void multiply_transpose(std::span<T const> x, std::span<T> y,
+                            T alpha = T{1}, T beta = T{0},
+                            unsigned num_threads = 1) const;
+
+    /// @brief Performs the matrix-vector product `y = A * x` of a square
+    /// matrix and computes `x^H * y` in the same sweep, e.g. `p^H * A * p`
+    /// in the conjugate gradient method.
+    /// @param x The vector, i.e. the rhs.
+    /// @param y The output buffer, it must hold `get_rows()` elements.
+    /// @param num_threads The number of threads used in compressed state, zero
+    /// means as many as the hardware supports.
+    /// @return The dot product `x^H * y`, conjugating `x`.
+    T multiply_dot(std::span<T const> x, std::span<T> y,
+                   unsigned num_threads = 1) const;
+
+    /// @brief Updates a residual, `r -= alpha * A * p`, and computes its
+    /// squared norm in the same sweep, e.g. `r = b - A * x` with `alpha` one.
+    /// @param p The vector, i.e. the rhs.
+    /// @param r The residual, it must hold `get_rows()` elements.
+    /// @param alpha The scaling factor of the product.
+    /// @param num_threads The number of threads used in compressed state, zero
+    /// means as many as the hardware supports.
+    /// @return The squared euclidean norm of the updated `r`.
+    double multiply_residual(std::span<T const> p, std::span<T> r,
+                             T alpha = T{1}, unsigned num_threads = 1) const;
+
+    /// @brief Builds the transpose of the matrix, with the same formats and
+    /// storage order. Complex elements are not conjugated.
+    /// @return The transpose, in the same state as the matrix.
+    Matrix transpose() const;
+
+    /// @brief Computes the sparse matrix-matrix product `A * B`, both
+    /// matrices must be compressed.
+    /// @tparam S2 The storage order of `B`.
+    /// @param other The matrix `B`, i.e. the rhs.
+    /// @param num_threads The number of threads, zero means as many as the
+    /// hardware supports.
+    /// @return The product, compressed and in the storage order of `A`.
+    template <StorageOrder S2>
+    Matrix multiply(Matrix<T, Compressed, Dynamic, S2> const& other,
+                    unsigned num_threads = 1) const;
+
+    /// @brief Computes the sparse linear combination `alpha * A + beta * B`,
+    /// both matrices must be compressed and have the same dimensions.
+    /// @tparam S2 The storage order of `B`.
+    /// @param other The matrix `B`.
+    /// @param alpha The scaling factor of `A`.
+    /// @param beta The scaling factor of `B`.
+    /// @return The combination, compressed and in the storage order of `A`.
+    template <StorageOrder S2>
+    Matrix add(Matrix<T, Compressed, Dynamic, S2> const& other,
+               T alpha = T{1}, T beta = T{1}) const;
+
+    /// @brief Computes a reverse Cuthill-McKee ordering of a square matrix,
+    /// which must be compressed, to reduce its bandwidth.
+    /// @return The permutation `perm`, where `perm[i]` is the old index of
+    /// the row and column that become row and column `i`.
+    std::vector<size_t> reverse_cuthill_mckee() const;
+
+    /// @brief Builds the symmetric permutation `P * A * P^T` of a square
+    /// matrix, which must be compressed, i.e. the matrix `B` with `B(i, j) =
+    /// A(perm[i], perm[j])`.
+    /// @param perm The permutation, e.g. the one computed by
+    /// `reverse_cuthill_mckee`.
+    /// @return The permuted matrix, compressed.
+    Matrix permute(std::span<size_t const> perm) const;
+
     ///
     /// @brief Removes the element at the specified position.
     /// @param i The row index.
@@ -124,6 +376,61 @@ class Matrix : public Compressed<T, S>, public Dynamic<T, S> {
     /// @return True if the element was removed, false otherwise.
     bool remove(size_t i, size_t j);
 
+    /// @brief Removes all the elements satisfying a predicate.
+    /// @tparam F The type of the predicate.
+    /// @param pred A callable taking the row index, the column index and the
+    /// value of each element, and returning true if it has to be removed.
+    /// @return The number of removed elements.
+    template <typename F>
+    size_t remove_if(F&& pred);
+
+    /// @brief Removes the elements whose absolute value doesn't exceed a
+    /// tolerance, e.g. to sparsify the matrix.
+    /// @param tolerance The tolerance, by default only zeros are removed.
+    /// @return The number of removed elements.
+    size_t prune(double tolerance = 0.0);
+
+    /// @brief Starts a batched assembly, elements are inserted by
+    /// `insert_batch` until `assembly_end` is called.
+    /// @param mode How an inserted element is combined with the one already
+    /// stored at the same position.
+    void assembly_begin(InsertMode mode = Add);
+
+    /// @brief Inserts a batch of elements during an assembly.
+    /// @param indexes The container of the positions, as pairs of row and
+    /// column indexes.
+    /// @param values The container of the values.
+    void insert_batch(SizetPairContainer auto const& indexes,
+                      NumericContainer auto const& values);
+
+    /// @brief Ends the assembly, after it all the inserted elements can be
+    /// read.
+    void assembly_end();
+
+    /// @brief Finds the positions of elements in the values array of a
+    /// matrix compressed in a YALE-like format, e.g. once for a sparsity
+    /// pattern reused by many numeric updates.
+    /// @param indexes The container of the positions, as pairs of row and
+    /// column indexes.
+    /// @return The position of each element, or `no_position` if it's not
+    /// stored, valid until the sparsity pattern changes.
+    std::vector<size_t> value_positions(
+        SizetPairContainer auto const& indexes) const;
+
+    /// @brief Sets all the stored values of a compressed matrix to zero,
+    /// keeping its sparsity pattern.
+    void zero_values();
+
+    /// @brief Adds contributions to stored elements of a compressed matrix,
+    /// at the positions found by `value_positions`.
+    /// @param positions The position of each contribution, none of them
+    /// `no_position`. The same position can appear many times.
+    /// @param values The contributions.
+    /// @param num_threads The number of threads, zero means as many as the
+    /// hardware supports.
+    void add_values(std::span<size_t const> positions,
+                    std::span<T const> values, unsigned num_threads = 1);
+
     /// @brief Compresses the matrix into a compact storage format.
     void compress();
     /// @brief Uncompresses the matrix into a dynamic storage format.
@@ -135,6 +442,55 @@ class Matrix : public Compressed<T, S>, public Dynamic<T, S> {
    private:
     /// @brief Indicates whether the matrix is in compressed storage format.
     bool isCompressed;
+    /// @brief Indicates whether an assembly is in progress.
+    bool isAssembling = false;
+    /// @brief How elements are combined during the assembly.
+    InsertMode insertMode = Add;
+
+    /// @brief Indicates whether references to the values were handed out by
+    /// the read-write `operator()`, so the norms can change at any time.
+    bool hasWritableReferences = false;
+
+    /// @brief Properties computed on first use and kept until the matrix is
+    /// modified. The const methods read and fill them holding the mutex, so
+    /// they can be called by several threads at once.
+    struct Cache {
+        std::array<std::optional<double>, 3> norms;  ///< Norms, by type.
+        std::optional<MatrixStats> stats;  ///< Structural properties.
+        std::optional<std::vector<size_t>>
+            diagonal_positions;  ///< Position of the diagonal elements in the
+                                 ///< compressed values.
+        mutable std::mutex mutex;  ///< Serializes the accesses.
+
+        /// @brief Constructs an empty cache.
+        Cache() = default;
+
+        /// @brief Moves the cached properties of another matrix.
+        /// @param other The cache to move.
+        Cache(Cache&& other) noexcept;
+
+        /// @brief Moves the cached properties of another matrix.
+        /// @param other The cache to move.
+        /// @return This cache.
+        Cache& operator=(Cache&& other) noexcept;
+    };
+    /// @brief The cached properties.
+    mutable Cache cache;
+
+    /// @brief The copy on the device, shared with the enqueued products so
+    /// that releasing it doesn't free the buffers they are reading.
+    std::shared_ptr<DeviceMatrix<T> const> device;
+    /// @brief The stream running the products of the copy on the device.
+    DeviceStream* device_stream = nullptr;
+
+    /// @brief Clears the cached properties and the copy on the device,
+    /// called by every modification.
+    void invalidate_cache();
+
+    /// @brief Clears the cached properties depending on the values and the
+    /// copy on the device, called by the modifications keeping the sparsity
+    /// pattern.
+    void invalidate_values();
 };
 
 }  // namespace algebra
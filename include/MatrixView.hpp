@@ -0,0 +1,140 @@
+#ifndef MATRIXVIEW_HPP
+#define MATRIXVIEW_HPP
+
+#include <cstddef>
+#include <span>
+
+#include "Matrix.hpp"
+
+namespace algebra {
+
+/// @brief Read-only view of a matrix, exposing only the lookups, the traversal
+/// of the elements and the products.
+/// @tparam T The type of the matrix elements (e.g., numeric or complex).
+/// @tparam Compressed The class template for compressed storage.
+/// @tparam Dynamic The class template for dynamic storage.
+/// @tparam S The storage order (row-major or column-major).
+/// @details `operator()` of a non-const matrix inserts the missing elements,
+/// and `norm`, `stats` and `diagonal` fill a cache, so neither can be called
+/// by several threads at once. None of the methods of the view write to the
+/// matrix, not even to its cache, so a view can be copied into any number of
+/// threads and used by all of them without locks. The view doesn't own the
+/// matrix, which mustn't be modified or destroyed while the view is in use.
+MATRIX_TEMPLATE
+class MatrixView {
+   public:
+    /// @brief Constructs a view of a matrix.
+    /// @param matrix The matrix to view.
+    explicit MatrixView(MATRIX_TYPE const& matrix);
+
+    /// @brief Reads the element at the specified position, zero if it's not
+    /// stored.
+    /// @param i The row index.
+    /// @param j The column index.
+    /// @return The value at the specified position.
+    T operator()(std::size_t i, std::size_t j) const;
+
+    /// @brief Gets the number of rows.
+    /// @return The number of rows.
+    size_t get_rows() const;
+
+    /// @brief Gets the number of columns.
+    /// @return The number of columns.
+    size_t get_columns() const;
+
+    /// @brief Gets the number of non-zero elements in the matrix.
+    /// @return The number of non-zero elements.
+    size_t get_num_elements() const;
+
+    /// @brief Checks if the matrix is in compressed storage format.
+    /// @return True if the matrix is compressed, false otherwise.
+    bool is_compressed() const;
+
+    /// @brief Calls a function on every stored element.
+    /// @tparam F The type of the function.
+    /// @param f A callable taking the row index, the column index and the
+    /// value of each element.
+    template <typename F>
+    void for_each(F&& f) const;
+
+    /// @brief Gets the range of the elements of a row of a row-major matrix,
+    /// compressed in a YALE-like format.
+    /// @param i The row index.
+    /// @return The range of the column indexes and of the values.
+    auto row(std::size_t i) const
+        requires(S == rowMajor);
+
+    /// @brief Gets the range of the elements of a column of a column-major
+    /// matrix, compressed in a YALE-like format.
+    /// @param j The column index.
+    /// @return The range of the row indexes and of the values.
+    auto column(std::size_t j) const
+        requires(S == columnMajor);
+
+    /// @brief Gets the range of the elements of a matrix compressed in a
+    /// YALE-like format, line by line.
+    /// @return The range of the rows, the columns and the values.
+    auto nonzeros() const;
+
+    /// @brief Performs the matrix-vector product `y = alpha * A * x + beta *
+    /// y` writing into a buffer owned by the caller.
+    /// @param x The vector, i.e. the rhs.
+    /// @param y The output buffer, it must hold `get_rows()` elements.
+    /// @param alpha The scaling factor of the product.
+    /// @param beta The scaling factor of the previous content of `y`.
+    /// @param num_threads The number of threads used in compressed state, zero
+    /// means as many as the hardware supports.
+    void multiply_into(std::span<T const> x, std::span<T> y, T alpha = T{1},
+                       T beta = T{0}, unsigned num_threads = 1) const;
+
+    /// @brief Performs the product `Y = alpha * A * X + beta * Y` with a dense
+    /// block of `k` vectors, writing into a buffer owned by the caller.
+    /// @param x The rhs block, row-major with `k` columns.
+    /// @param y The output block, row-major with `k` columns, it must hold `k
+    /// * get_rows()` elements.
+    /// @param k The number of vectors in the blocks.
+    /// @param alpha The scaling factor of the product.
+    /// @param beta The scaling factor of the previous content of `y`.
+    void multiply_block(std::span<T const> x, std::span<T> y, size_t k,
+                        T alpha = T{1}, T beta = T{0}) const;
+
+    /// @brief Performs the transpose product `y = alpha * A^T * x + beta * y`
+    /// writing into a buffer owned by the caller. Complex elements are not
+    /// conjugated.
+    /// @param x The vector, it must hold `get_rows()` elements.
+    /// @param y The output buffer, it must hold `get_columns()` elements.
+    /// @param alpha The scaling factor of the product.
+    /// @param beta The scaling factor of the previous content of `y`.
+    /// @param num_threads The number of threads used in compressed state, zero
+    /// means as many as the hardware supports.
+    void multiply_transpose(std::span<T const> x, std::span<T> y,
+                            T alpha = T{1}, T beta = T{0},
+                            unsigned num_threads = 1) const;
+
+    /// @brief Performs the matrix-vector product `y = A * x` of a square
+    /// matrix and computes `x^H * y` in the same sweep.
+    /// @param x The vector, i.e. the rhs.
+    /// @param y The output buffer, it must hold `get_rows()` elements.
+    /// @param num_threads The number of threads used in compressed state, zero
+    /// means as many as the hardware supports.
+    /// @return The dot product `x^H * y`, conjugating `x`.
+    T multiply_dot(std::span<T const> x, std::span<T> y,
+                   unsigned num_threads = 1) const;
+
+    /// @brief Updates a residual, `r -= alpha * A * p`, and computes its
+    /// squared norm in the same sweep.
+    /// @param p The vector, i.e. the rhs.
+    /// @param r The residual, it must hold `get_rows()` elements.
+    /// @param alpha The scaling factor of the product.
+    /// @param num_threads The number of threads used in compressed state, zero
+    /// means as many as the hardware supports.
+    /// @return The squared euclidean norm of the updated `r`.
+    double multiply_residual(std::span<T const> p, std::span<T> r,
+                             T alpha = T{1}, unsigned num_threads = 1) const;
+
+   private:
+    MATRIX_TYPE const* matrix;  ///< The viewed matrix.
+};
+
+}  // namespace algebra
+#endif
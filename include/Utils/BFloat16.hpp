@@ -0,0 +1,62 @@
+#ifndef BFLOAT16_HPP
+#define BFLOAT16_HPP
+
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+
+namespace algebra {
+
+/// @brief Brain floating point number, i.e. the upper 16 bits of a `float`:
+/// same exponent range, 8 bits of precision. Only meant for storage, the
+/// arithmetic is done after converting it to `float`.
+class bfloat16 {
+    std::uint16_t bits = 0;  ///< The upper 16 bits of the `float`.
+
+   public:
+    /// @brief Default constructor, zero.
+    bfloat16() = default;
+
+    /// @brief Converts a `float`, rounding to the nearest representable value
+    /// and ties to even.
+    /// @param value The value to convert.
+    explicit bfloat16(float value) {
+        std::uint32_t word = std::bit_cast<std::uint32_t>(value);
+        if (std::isnan(value)) {
+            bits = static_cast<std::uint16_t>((word >> 16) | 0x40);
+        }
+        else {
+            word += 0x7fff + ((word >> 16) & 1);
+            bits = static_cast<std::uint16_t>(word >> 16);
+        }
+    }
+
+    /// @brief Converts a `double`, going through `float`.
+    /// @param value The value to convert.
+    explicit bfloat16(double value) : bfloat16(static_cast<float>(value)) {}
+
+    /// @brief Converts the value to `float`, exactly.
+    /// @return The value as a `float`.
+    operator float() const {
+        return std::bit_cast<float>(static_cast<std::uint32_t>(bits) << 16);
+    }
+};
+
+/// @brief Computes the absolute value of a `bfloat16`.
+/// @param value The value.
+/// @return The absolute value, as a `double`.
+inline double magnitude(bfloat16 value) {
+    return std::abs(static_cast<double>(static_cast<float>(value)));
+}
+
+/// @brief Prints a `bfloat16` as a `float`.
+/// @param os The output stream.
+/// @param value The value to print.
+/// @return The output stream.
+inline std::ostream& operator<<(std::ostream& os, bfloat16 value) {
+    return os << static_cast<float>(value);
+}
+
+}  // namespace algebra
+#endif
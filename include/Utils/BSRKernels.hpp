@@ -0,0 +1,204 @@
+#ifndef BSRKERNELS_HPP
+#define BSRKERNELS_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "BlockKernels.hpp"
+#include "Concepts.hpp"
+#include "Parallel.hpp"
+
+namespace algebra {
+
+/// @brief Multiplies the block lines of block compressed arrays by a vector,
+/// `result = alpha * m * v + beta * result`, each block line writing its own
+/// slice of `result`.
+/// @tparam L The number of lines of a block.
+/// @tparam W The number of indexes of a block.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @param inner The inner index array, i.e. the first block of each block
+/// line.
+/// @param outer The block index of each block.
+/// @param values The values of the blocks, `L * W` for each one, line by line.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @param first The first block line.
+/// @param last The block line after the last one.
+/// @details The block dimensions are known at compile time, so the loops
+/// over a block are unrolled and its `L` sums are kept in registers: every
+/// block reads one index and `W` elements of `v` for `L * W` products.
+template <std::size_t L, std::size_t W, NumericOrComplex T>
+void bsr_gather(std::span<std::size_t const> inner,
+                std::span<std::size_t const> outer, std::span<T const> values,
+                std::span<T const> v, std::span<T> result, T alpha, T beta,
+                std::size_t first, std::size_t last) {
+    const bool overwrite = (beta == T{});
+
+    for (std::size_t line = first; line < last; ++line) {
+        std::array<T, L> sums{};
+        for (std::size_t k = inner[line]; k < inner[line + 1]; ++k) {
+            T const* block = values.data() + k * L * W;
+            T const* x = v.data() + outer[k] * W;
+            for (std::size_t r = 0; r < L; ++r) {
+                for (std::size_t c = 0; c < W; ++c) {
+                    sums[r] += block[r * W + c] * x[c];
+                }
+            }
+        }
+
+        T* y = result.data() + line * L;
+        for (std::size_t r = 0; r < L; ++r) {
+            y[r] = overwrite ? alpha * sums[r] : alpha * sums[r] + beta * y[r];
+        }
+    }
+}
+
+/// @brief Adds the product of the transpose of some block lines of block
+/// compressed arrays by a vector to `result`, i.e. `result += alpha * m^T *
+/// v`.
+/// @tparam L The number of lines of a block.
+/// @tparam W The number of indexes of a block.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @param inner The inner index array, i.e. the first block of each block
+/// line.
+/// @param outer The block index of each block.
+/// @param values The values of the blocks, `L * W` for each one, line by line.
+/// @param v The vector.
+/// @param result The output buffer.
+/// @param alpha The scaling factor of `v`.
+/// @param first The first block line.
+/// @param last The block line after the last one.
+template <std::size_t L, std::size_t W, NumericOrComplex T>
+void bsr_scatter(std::span<std::size_t const> inner,
+                 std::span<std::size_t const> outer, std::span<T const> values,
+                 std::span<T const> v, std::span<T> result, T alpha,
+                 std::size_t first, std::size_t last) {
+    for (std::size_t line = first; line < last; ++line) {
+        std::array<T, L> x;
+        for (std::size_t r = 0; r < L; ++r) x[r] = alpha * v[line * L + r];
+
+        for (std::size_t k = inner[line]; k < inner[line + 1]; ++k) {
+            T const* block = values.data() + k * L * W;
+            T* y = result.data() + outer[k] * W;
+            for (std::size_t c = 0; c < W; ++c) {
+                T sum{};
+                for (std::size_t r = 0; r < L; ++r) {
+                    sum += block[r * W + c] * x[r];
+                }
+                y[c] += sum;
+            }
+        }
+    }
+}
+
+/// @brief Performs the product `result = alpha * m * v + beta * result` on
+/// block compressed arrays, or the one with the transpose of `m`.
+/// @tparam L The number of lines of a block.
+/// @tparam W The number of indexes of a block.
+/// @tparam Transposed True to multiply by the transpose of the arrays, i.e.
+/// when the lines are the columns of the matrix.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @param inner The inner index array, i.e. the first block of each block
+/// line.
+/// @param outer The block index of each block.
+/// @param values The values of the blocks, `L * W` for each one, line by line.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+template <std::size_t L, std::size_t W, bool Transposed, NumericOrComplex T>
+void bsr_product(std::span<std::size_t const> inner,
+                 std::span<std::size_t const> outer, std::span<T const> values,
+                 std::span<T const> v, std::span<T> result, T alpha, T beta) {
+    const std::size_t num_lines = inner.empty() ? 0 : inner.size() - 1;
+
+    if constexpr (!Transposed) {
+        bsr_gather<L, W>(inner, outer, values, v, result, alpha, beta, 0,
+                         num_lines);
+    }
+    else {
+        block_scale(result, beta);
+        bsr_scatter<L, W>(inner, outer, values, v, result, alpha, 0,
+                          num_lines);
+    }
+}
+
+/// @brief Performs the product `result = alpha * m * v + beta * result` on
+/// block compressed arrays, or the one with the transpose of `m`, using
+/// multiple threads.
+/// @tparam L The number of lines of a block.
+/// @tparam W The number of indexes of a block.
+/// @tparam Transposed True to multiply by the transpose of the arrays, i.e.
+/// when the lines are the columns of the matrix.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @param inner The inner index array, i.e. the first block of each block
+/// line.
+/// @param outer The block index of each block.
+/// @param values The values of the blocks, `L * W` for each one, line by line.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @details As in `compressed_product_parallel`, the block lines are split
+/// in contiguous parts with roughly the same number of blocks. Each part of
+/// the direct product writes its own slice of `result`, while the parts of
+/// the transposed one accumulate into private vectors which are then summed.
+template <std::size_t L, std::size_t W, bool Transposed, NumericOrComplex T>
+void bsr_product_parallel(std::span<std::size_t const> inner,
+                          std::span<std::size_t const> outer,
+                          std::span<T const> values, std::span<T const> v,
+                          std::span<T> result, T alpha, T beta,
+                          unsigned num_threads) {
+    std::size_t num_parts = std::min<std::size_t>(
+        resolve_threads(num_threads), values.size() / parallel_grain);
+    if (num_parts <= 1) {
+        bsr_product<L, W, Transposed>(inner, outer, values, v, result, alpha,
+                                      beta);
+        return;
+    }
+
+    const std::vector<std::size_t> bounds =
+        balanced_partition(inner, num_parts);
+
+    if constexpr (!Transposed) {
+        parallel_for(num_parts, [&](std::size_t p) {
+            bsr_gather<L, W>(inner, outer, values, v, result, alpha, beta,
+                             bounds[p], bounds[p + 1]);
+        });
+    }
+    else {
+        const bool overwrite = (beta == T{});
+        const std::size_t size = result.size();
+        std::vector<std::vector<T>> partials(num_parts);
+
+        parallel_for(num_parts, [&](std::size_t p) {
+            partials[p].assign(size, T{});
+            bsr_scatter<L, W>(inner, outer, values, v,
+                              std::span<T>(partials[p]), T{1}, bounds[p],
+                              bounds[p + 1]);
+        });
+
+        parallel_for(num_parts, [&](std::size_t p) {
+            std::size_t first = size * p / num_parts;
+            std::size_t last = size * (p + 1) / num_parts;
+
+            for (std::size_t i = first; i < last; ++i) {
+                T sum{};
+                for (auto const& partial : partials) sum += partial[i];
+
+                result[i] =
+                    overwrite ? alpha * sum : alpha * sum + beta * result[i];
+            }
+        });
+    }
+}
+
+}  // namespace algebra
+#endif
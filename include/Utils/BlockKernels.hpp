@@ -0,0 +1,148 @@
+#ifndef BLOCKKERNELS_HPP
+#define BLOCKKERNELS_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+
+#include "Comparators.hpp"
+#include "Concepts.hpp"
+
+using namespace comparators;
+namespace algebra {
+
+/// @brief Splits the columns of a dense block in panels of fixed width and
+/// calls a function on each one.
+/// @tparam F The type of the function.
+/// @param k The number of columns of the block.
+/// @param f A callable taking the width of the panel, as a
+/// `std::integral_constant` holding 16, 8, 4, 2 or 1, and its first column.
+/// @details Blocks of 4, 8 or 16 columns are a single panel. Fixed widths let
+/// the compiler unroll the loops over the columns of a panel and keep the
+/// accumulators in vector registers; the matrix is read once per panel.
+template <typename F>
+void block_panels(std::size_t k, F&& f) {
+    std::size_t first = 0;
+    for (; k - first >= 16; first += 16) {
+        f(std::integral_constant<std::size_t, 16>{}, first);
+    }
+    if (k - first >= 8) {
+        f(std::integral_constant<std::size_t, 8>{}, first);
+        first += 8;
+    }
+    if (k - first >= 4) {
+        f(std::integral_constant<std::size_t, 4>{}, first);
+        first += 4;
+    }
+    if (k - first >= 2) {
+        f(std::integral_constant<std::size_t, 2>{}, first);
+        first += 2;
+    }
+    if (k - first >= 1) {
+        f(std::integral_constant<std::size_t, 1>{}, first);
+    }
+}
+
+/// @brief Adds a scaled row of a panel to another one, `y += scale * x`.
+/// @tparam W The width of the panel.
+/// @tparam T The type of the elements (numeric or complex).
+/// @param x The row to add.
+/// @param y The row to update.
+/// @param scale The scaling factor.
+template <std::size_t W, NumericOrComplex T>
+inline void block_axpy(T const* x, T* y, T scale) {
+    for (std::size_t c = 0; c < W; ++c) {
+        y[c] += scale * x[c];
+    }
+}
+
+/// @brief Scales a dense block, `y = beta * y`.
+/// @tparam T The type of the elements (numeric or complex).
+/// @param y The block.
+/// @param beta The scaling factor.
+/// @details When `beta` is zero the block is overwritten with zeros, so that
+/// its previous content is never read.
+template <NumericOrComplex T>
+void block_scale(std::span<T> y, T beta) {
+    if (beta == T{}) {
+        std::fill(y.begin(), y.end(), T{});
+    }
+    else if (beta != T{1}) {
+        for (auto& el : y) el *= beta;
+    }
+}
+
+/// @brief Performs the product `y = alpha * m * x + beta * y` between
+/// YALE-like compressed arrays and a dense block of `k` vectors.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam P The type of the inner indexes.
+/// @tparam I The type of the outer indexes.
+/// @tparam V The type of the stored values, converted to `T` as they are
+/// read.
+/// @param inner The inner index array, i.e. the beginning of each line.
+/// @param outer The outer index array.
+/// @param values The values array.
+/// @param x The rhs block, row-major with `k` columns: element `c` of the
+/// vector multiplying column `j` is `x[j * k + c]`.
+/// @param y The output block, row-major with `k` columns and as many rows as
+/// the matrix.
+/// @param k The number of vectors in the blocks.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `y`.
+/// @details Each element of the matrix updates a contiguous row of a panel,
+/// see `block_panels`. In row-major order a row of the result is accumulated
+/// locally and written once.
+template <StorageOrder S, NumericOrComplex T, typename P, typename I,
+          typename V>
+void compressed_product_block(std::span<P const> inner,
+                              std::span<I const> outer,
+                              std::span<V const> values, std::span<T const> x,
+                              std::span<T> y, std::size_t k, T alpha, T beta) {
+    const std::size_t num_lines = inner.empty() ? 0 : inner.size() - 1;
+
+    if constexpr (S == rowMajor) {
+        const bool overwrite = (beta == T{});
+
+        block_panels(k, [&](auto width, std::size_t first) {
+            constexpr std::size_t W = decltype(width)::value;
+
+            for (std::size_t i = 0; i < num_lines; ++i) {
+                std::array<T, W> sum{};
+                for (std::size_t j = inner[i]; j < inner[i + 1]; ++j) {
+                    T const* xrow = x.data() + outer[j] * k + first;
+                    const T value = static_cast<T>(values[j]);
+                    for (std::size_t c = 0; c < W; ++c) {
+                        sum[c] += value * xrow[c];
+                    }
+                }
+
+                T* row = y.data() + i * k + first;
+                for (std::size_t c = 0; c < W; ++c) {
+                    row[c] = overwrite ? alpha * sum[c]
+                                       : alpha * sum[c] + beta * row[c];
+                }
+            }
+        });
+    }
+    else {
+        block_scale(y, beta);
+
+        block_panels(k, [&](auto width, std::size_t first) {
+            constexpr std::size_t W = decltype(width)::value;
+
+            for (std::size_t i = 0; i < num_lines; ++i) {
+                T const* column = x.data() + i * k + first;
+                for (std::size_t j = inner[i]; j < inner[i + 1]; ++j) {
+                    block_axpy<W>(column, y.data() + outer[j] * k + first,
+                                  alpha * static_cast<T>(values[j]));
+                }
+            }
+        });
+    }
+}
+
+}  // namespace algebra
+#endif
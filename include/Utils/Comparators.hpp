@@ -13,6 +13,18 @@ enum NormType { One, Infinity, Frobenius };
 /// @brief Enum representing the storage order of a matrix.
 enum StorageOrder { rowMajor, columnMajor };
 
+/// @brief Gets the storage order in which the arrays of a matrix store its
+/// transpose.
+/// @param s The storage order.
+/// @return The other storage order.
+constexpr StorageOrder opposite_order(StorageOrder s) {
+    return (s == rowMajor) ? columnMajor : rowMajor;
+}
+
+/// @brief Enum representing how an inserted element is combined with the one
+/// already stored at the same position.
+enum InsertMode { Add, Overwrite };
+
 /// @brief Comparator for comparing matrix indices based on the storage order.
 /// @tparam S The storage order (row-major or column-major).
 template <StorageOrder S>
@@ -84,5 +96,16 @@ void apply_permutation(std::vector<T>& vec, std::vector<std::size_t> const& p) {
     }
 }
 
+/// @brief Computes the inverse of a permutation.
+/// @param p The permutation vector.
+/// @return The permutation `q` such that `q[p[i]] == i`.
+/// @details Applying `q` with `apply_permutation` undoes `p`.
+inline std::vector<std::size_t> invert_permutation(
+    std::vector<std::size_t> const& p) {
+    std::vector<std::size_t> q(p.size());
+    for (std::size_t i = 0; i < p.size(); ++i) q[p[i]] = i;
+    return q;
+}
+
 }  // namespace comparators
 #endif
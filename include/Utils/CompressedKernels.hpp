@@ -0,0 +1,618 @@
+#ifndef COMPRESSEDKERNELS_HPP
+#define COMPRESSEDKERNELS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "Comparators.hpp"
+#include "Concepts.hpp"
+#include "Parallel.hpp"
+#include "VectorKernels.hpp"
+
+using namespace comparators;
+namespace algebra {
+
+/// @brief Performs the matrix-vector product `result = alpha * m * v + beta *
+/// result` on YALE-like compressed arrays.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam P The type of the inner indexes.
+/// @tparam I The type of the outer indexes.
+/// @tparam V The type of the stored values, converted to `T` as they are
+/// read.
+/// @param inner The inner index array, i.e. the beginning of each line.
+/// @param outer The outer index array.
+/// @param values The values array.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer, it must hold as many elements as the
+/// matrix has rows.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @details The arrays are only read, so they can live anywhere, for example
+/// in a memory mapped file.
+template <StorageOrder S, NumericOrComplex T, typename P, typename I,
+          typename V>
+void compressed_product(std::span<P const> inner, std::span<I const> outer,
+                        std::span<V const> values, std::span<T const> v,
+                        std::span<T> result, T alpha, T beta) {
+    const size_t num_lines = inner.empty() ? 0 : inner.size() - 1;
+
+    if constexpr (S == rowMajor) {
+        const bool overwrite = (beta == T{});
+
+        for (size_t i = 0; i < num_lines; ++i) {
+            T sum{};
+            for (size_t j = inner[i]; j < inner[i + 1]; ++j) {
+                sum += static_cast<T>(values[j]) * v[outer[j]];
+            }
+
+            result[i] =
+                overwrite ? alpha * sum : alpha * sum + beta * result[i];
+        }
+    }
+    else {
+        if (beta == T{}) {
+            std::fill(result.begin(), result.end(), T{});
+        }
+        else if (beta != T{1}) {
+            for (auto& el : result) el *= beta;
+        }
+
+        for (size_t i = 0; i < num_lines; ++i) {
+            const T scaled = alpha * v[i];
+            for (size_t j = inner[i]; j < inner[i + 1]; ++j) {
+                result[outer[j]] += static_cast<T>(values[j]) * scaled;
+            }
+        }
+    }
+}
+
+/// @brief Performs the matrix-vector product `result = alpha * m * v + beta *
+/// result` on YALE-like compressed arrays using multiple threads.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam P The type of the inner indexes.
+/// @tparam I The type of the outer indexes.
+/// @tparam V The type of the stored values, converted to `T` as they are
+/// read.
+/// @param inner The inner index array, i.e. the beginning of each line.
+/// @param outer The outer index array.
+/// @param values The values array.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer, it must hold as many elements as the
+/// matrix has rows.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @details The lines are split among the threads in contiguous blocks with
+/// roughly the same number of non-zero elements. In row-major order each
+/// thread owns the rows of its block and writes them directly. In
+/// column-major order the columns of a block scatter into arbitrary rows, so
+/// each thread accumulates into a private vector and the partial vectors are
+/// then summed, again in parallel, by row blocks. Matrices too small to be
+/// worth the threads fall back to `compressed_product`.
+template <StorageOrder S, NumericOrComplex T, typename P, typename I,
+          typename V>
+void compressed_product_parallel(std::span<P const> inner,
+                                 std::span<I const> outer,
+                                 std::span<V const> values,
+                                 std::span<T const> v, std::span<T> result,
+                                 T alpha, T beta, unsigned num_threads) {
+    size_t num_parts = std::min<size_t>(resolve_threads(num_threads),
+                                        values.size() / parallel_grain);
+    if (num_parts <= 1) {
+        compressed_product<S>(inner, outer, values, v, result, alpha, beta);
+        return;
+    }
+
+    const std::vector<size_t> bounds = balanced_partition(inner, num_parts);
+    const bool overwrite = (beta == T{});
+
+    if constexpr (S == rowMajor) {
+        parallel_for(num_parts, [&](size_t k) {
+            for (size_t i = bounds[k]; i < bounds[k + 1]; ++i) {
+                T sum{};
+                for (size_t j = inner[i]; j < inner[i + 1]; ++j) {
+                    sum += static_cast<T>(values[j]) * v[outer[j]];
+                }
+
+                result[i] =
+                    overwrite ? alpha * sum : alpha * sum + beta * result[i];
+            }
+        });
+    }
+    else {
+        const size_t rows = result.size();
+        std::vector<std::vector<T>> partials(num_parts);
+
+        parallel_for(num_parts, [&](size_t k) {
+            partials[k].assign(rows, T{});
+            for (size_t i = bounds[k]; i < bounds[k + 1]; ++i) {
+                for (size_t j = inner[i]; j < inner[i + 1]; ++j) {
+                    partials[k][outer[j]] +=
+                        static_cast<T>(values[j]) * v[i];
+                }
+            }
+        });
+
+        parallel_for(num_parts, [&](size_t k) {
+            size_t first = rows * k / num_parts;
+            size_t last = rows * (k + 1) / num_parts;
+
+            for (size_t i = first; i < last; ++i) {
+                T sum{};
+                for (auto const& partial : partials) sum += partial[i];
+
+                result[i] =
+                    overwrite ? alpha * sum : alpha * sum + beta * result[i];
+            }
+        });
+    }
+}
+
+/// @brief Performs the matrix-vector product `y = m * x` on YALE-like
+/// compressed arrays of a square matrix and computes `x^H * y` in the same
+/// sweep.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam P The type of the inner indexes.
+/// @tparam I The type of the outer indexes.
+/// @tparam V The type of the stored values, converted to `T` as they are
+/// read.
+/// @param inner The inner index array, i.e. the beginning of each line.
+/// @param outer The outer index array.
+/// @param values The values array.
+/// @param x The vector, i.e. the rhs.
+/// @param y The output buffer, as long as `x`.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @return The dot product `x^H * y`, i.e. `x^H * m * x`.
+/// @details In row-major order each row adds `conj(x[i]) * y[i]` as soon as
+/// `y[i]` is known, so neither vector is read again after the sweep; the
+/// threads are used as in `compressed_product_parallel`, each one with its
+/// own partial sum. In column-major order `y` is only complete at the end of
+/// the sweep, so the dot product takes one more, sequential, pass: folding it
+/// into the sweep would need a second random access to `x` per element,
+/// which costs more than the pass.
+template <StorageOrder S, NumericOrComplex T, typename P, typename I,
+          typename V>
+T compressed_product_dot(std::span<P const> inner, std::span<I const> outer,
+                         std::span<V const> values, std::span<T const> x,
+                         std::span<T> y, unsigned num_threads) {
+    if constexpr (S == rowMajor) {
+        size_t num_parts =
+            std::clamp<size_t>(values.size() / parallel_grain, 1,
+                               resolve_threads(num_threads));
+        const std::vector<size_t> bounds =
+            balanced_partition(inner, num_parts);
+        std::vector<T> dots(num_parts, T{});
+
+        parallel_for(num_parts, [&](size_t k) {
+            T partial{};
+            for (size_t i = bounds[k]; i < bounds[k + 1]; ++i) {
+                T sum{};
+                for (size_t j = inner[i]; j < inner[i + 1]; ++j) {
+                    sum += static_cast<T>(values[j]) * x[outer[j]];
+                }
+                y[i] = sum;
+                partial += conjugate(x[i]) * sum;
+            }
+            dots[k] = partial;
+        });
+
+        T sum{};
+        for (auto const& el : dots) sum += el;
+        return sum;
+    }
+    else {
+        compressed_product_parallel<S>(inner, outer, values, x, y, T{1}, T{0},
+                                       num_threads);
+        return dot(x, std::span<T const>(y));
+    }
+}
+
+/// @brief Updates a residual, `r -= alpha * m * p`, on YALE-like compressed
+/// arrays and computes the squared norm of the result.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam P The type of the inner indexes.
+/// @tparam I The type of the outer indexes.
+/// @tparam V The type of the stored values, converted to `T` as they are
+/// read.
+/// @param inner The inner index array, i.e. the beginning of each line.
+/// @param outer The outer index array.
+/// @param values The values array.
+/// @param p The vector, i.e. the rhs.
+/// @param r The residual, as many elements as the matrix has rows.
+/// @param alpha The scaling factor of the product.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @return The squared euclidean norm of the updated `r`.
+/// @details In row-major order each element of `r` is updated and added to
+/// the norm in the sweep over the matrix. In column-major order the elements
+/// of `r` are only final at the end of the sweep, so the norm takes one more
+/// pass over `r`.
+template <StorageOrder S, NumericOrComplex T, typename P, typename I,
+          typename V>
+double compressed_residual(std::span<P const> inner, std::span<I const> outer,
+                           std::span<V const> values, std::span<T const> p,
+                           std::span<T> r, T alpha, unsigned num_threads) {
+    if constexpr (S == rowMajor) {
+        size_t num_parts =
+            std::clamp<size_t>(values.size() / parallel_grain, 1,
+                               resolve_threads(num_threads));
+        const std::vector<size_t> bounds =
+            balanced_partition(inner, num_parts);
+        std::vector<double> norms(num_parts, 0.0);
+
+        parallel_for(num_parts, [&](size_t k) {
+            double partial = 0.0;
+            for (size_t i = bounds[k]; i < bounds[k + 1]; ++i) {
+                T sum{};
+                for (size_t j = inner[i]; j < inner[i + 1]; ++j) {
+                    sum += static_cast<T>(values[j]) * p[outer[j]];
+                }
+                r[i] -= alpha * sum;
+                partial += squared_magnitude(r[i]);
+            }
+            norms[k] = partial;
+        });
+
+        double sum = 0.0;
+        for (auto const& el : norms) sum += el;
+        return sum;
+    }
+    else {
+        compressed_product_parallel<S>(inner, outer, values, p, r, -alpha,
+                                       T{1}, num_threads);
+        return squared_norm(std::span<T const>(r));
+    }
+}
+
+/// @brief Performs the matrix-vector product `result = alpha * m * v + beta *
+/// result` on YALE-like compressed arrays storing one triangle of a symmetric
+/// matrix.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam P The type of the inner indexes.
+/// @tparam I The type of the outer indexes.
+/// @param inner The inner index array, i.e. the beginning of each line.
+/// @param outer The outer index array.
+/// @param values The values array.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer, it must hold as many elements as the
+/// matrix has rows.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @details Every stored element is read once and applied twice: gathered
+/// into the element of `result` of its line and, if it's off the diagonal,
+/// scattered into the element of its mirrored line. Rows and columns play the
+/// same role, so the storage order doesn't matter.
+template <NumericOrComplex T, typename P, typename I>
+void compressed_symmetric_product(std::span<P const> inner,
+                                  std::span<I const> outer,
+                                  std::span<T const> values,
+                                  std::span<T const> v, std::span<T> result,
+                                  T alpha, T beta) {
+    const size_t num_lines = inner.empty() ? 0 : inner.size() - 1;
+
+    if (beta == T{}) {
+        std::fill(result.begin(), result.end(), T{});
+    }
+    else if (beta != T{1}) {
+        for (auto& el : result) el *= beta;
+    }
+
+    for (size_t line = 0; line < num_lines; ++line) {
+        T sum{};
+        const T scaled = alpha * v[line];
+        for (size_t k = inner[line]; k < inner[line + 1]; ++k) {
+            const size_t index = outer[k];
+            sum += values[k] * v[index];
+            if (index != line) result[index] += values[k] * scaled;
+        }
+        result[line] += alpha * sum;
+    }
+}
+
+/// @brief Performs the matrix-vector product `result = alpha * m * v + beta *
+/// result` on YALE-like compressed arrays storing one triangle of a symmetric
+/// matrix, on multiple threads.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam P The type of the inner indexes.
+/// @tparam I The type of the outer indexes.
+/// @param inner The inner index array, i.e. the beginning of each line.
+/// @param outer The outer index array.
+/// @param values The values array.
+/// @param v The vector, i.e. the rhs.
+/// @param result The output buffer, it must hold as many elements as the
+/// matrix has rows.
+/// @param alpha The scaling factor of the product.
+/// @param beta The scaling factor of the previous content of `result`.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @details The scatter of the mirrored elements can hit any line, so, as for
+/// the column-major product, each thread accumulates its block of lines into
+/// a private vector and the vectors are then summed in parallel. Products
+/// too small to be worth the threads fall back to
+/// `compressed_symmetric_product`.
+template <NumericOrComplex T, typename P, typename I>
+void compressed_symmetric_product_parallel(
+    std::span<P const> inner, std::span<I const> outer,
+    std::span<T const> values, std::span<T const> v, std::span<T> result,
+    T alpha, T beta, unsigned num_threads) {
+    size_t num_parts = std::min<size_t>(resolve_threads(num_threads),
+                                        values.size() / parallel_grain);
+    if (num_parts <= 1) {
+        compressed_symmetric_product(inner, outer, values, v, result, alpha,
+                                     beta);
+        return;
+    }
+
+    const std::vector<size_t> bounds = balanced_partition(inner, num_parts);
+    const bool overwrite = (beta == T{});
+    const size_t rows = result.size();
+    std::vector<std::vector<T>> partials(num_parts);
+
+    parallel_for(num_parts, [&](size_t p) {
+        auto& partial = partials[p];
+        partial.assign(rows, T{});
+        for (size_t line = bounds[p]; line < bounds[p + 1]; ++line) {
+            T sum{};
+            for (size_t k = inner[line]; k < inner[line + 1]; ++k) {
+                const size_t index = outer[k];
+                sum += values[k] * v[index];
+                if (index != line) partial[index] += values[k] * v[line];
+            }
+            partial[line] += sum;
+        }
+    });
+
+    parallel_for(num_parts, [&](size_t p) {
+        size_t first = rows * p / num_parts;
+        size_t last = rows * (p + 1) / num_parts;
+
+        for (size_t i = first; i < last; ++i) {
+            T sum{};
+            for (auto const& partial : partials) sum += partial[i];
+
+            result[i] =
+                overwrite ? alpha * sum : alpha * sum + beta * result[i];
+        }
+    });
+}
+
+/// @brief Transposes YALE-like compressed arrays, i.e. converts them to the
+/// opposite storage order.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam P The type of the inner indexes.
+/// @tparam I The type of the outer indexes.
+/// @tparam P2 The type of the inner indexes of the result.
+/// @tparam I2 The type of the outer indexes of the result.
+/// @param inner The inner index array, i.e. the beginning of each line.
+/// @param outer The outer index array.
+/// @param values The values array.
+/// @param outer_extent The number of columns in row-major order, of rows in
+/// column-major order.
+/// @param t_inner The inner index array of the result, overwritten.
+/// @param t_outer The outer index array of the result, overwritten.
+/// @param t_values The values array of the result, overwritten.
+/// @details A counting sort on the outer index: one pass counts the elements
+/// of every line of the result and one scatters them. The lines are visited
+/// in order, so the elements of each line of the result stay sorted and the
+/// cost is `O(nnz + n)`.
+template <NumericOrComplex T, typename P, typename I, typename P2,
+          typename I2>
+void compressed_transpose(std::span<P const> inner, std::span<I const> outer,
+                          std::span<T const> values, size_t outer_extent,
+                          std::vector<P2>& t_inner, std::vector<I2>& t_outer,
+                          std::vector<T>& t_values) {
+    const size_t num_lines = inner.empty() ? 0 : inner.size() - 1;
+
+    t_inner.assign(outer_extent + 1, 0);
+    for (auto const& index : outer) t_inner[index + 1]++;
+    for (size_t index = 0; index < outer_extent; ++index) {
+        t_inner[index + 1] += t_inner[index];
+    }
+
+    t_outer.resize(values.size());
+    t_values.resize(values.size());
+
+    std::vector<size_t> next(t_inner.begin(), t_inner.end() - 1);
+    for (size_t line = 0; line < num_lines; ++line) {
+        for (size_t k = inner[line]; k < inner[line + 1]; ++k) {
+            size_t position = next[outer[k]]++;
+            t_outer[position] = static_cast<I2>(line);
+            t_values[position] = values[k];
+        }
+    }
+}
+
+/// @brief Finds the value at the specified position in YALE-like compressed
+/// arrays.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam P The type of the inner indexes.
+/// @tparam I The type of the outer indexes.
+/// @param inner The inner index array, i.e. the beginning of each line.
+/// @param outer The outer index array.
+/// @param values The values array.
+/// @param i The row index.
+/// @param j The column index.
+/// @return The value at the specified position, 0 if it's not stored.
+template <StorageOrder S, typename V, typename P, typename I>
+V compressed_find(std::span<P const> inner, std::span<I const> outer,
+                  std::span<V const> values, size_t i, size_t j) {
+    size_t line = (S == rowMajor) ? i : j;
+    size_t index = (S == rowMajor) ? j : i;
+
+    auto first = outer.begin() + inner[line];
+    auto last = outer.begin() + inner[line + 1];
+    auto lower = std::lower_bound(first, last, index);
+
+    if (lower != last && static_cast<size_t>(*lower) == index) {
+        return values[lower - outer.begin()];
+    }
+    return V{};
+}
+
+/// @brief Position returned by `compressed_diagonal_positions` for the
+/// diagonal elements which are not stored.
+inline constexpr size_t no_position = std::numeric_limits<size_t>::max();
+
+/// @brief Finds the positions of the diagonal elements in YALE-like
+/// compressed arrays.
+/// @tparam P The type of the inner indexes.
+/// @tparam I The type of the outer indexes.
+/// @param inner The inner index array, i.e. the beginning of each line.
+/// @param outer The outer index array.
+/// @param num_diagonal The length of the diagonal, i.e. the smaller
+/// dimension.
+/// @return The position of element `(i, i)` in the values array, or
+/// `no_position` if it's not stored.
+/// @details Element `(i, i)` belongs to line `i` in both storage orders, so
+/// each line is binary searched once.
+template <typename P, typename I>
+std::vector<size_t> compressed_diagonal_positions(std::span<P const> inner,
+                                                  std::span<I const> outer,
+                                                  size_t num_diagonal) {
+    std::vector<size_t> positions(num_diagonal, no_position);
+    for (size_t line = 0; line < num_diagonal; ++line) {
+        auto first = outer.begin() + inner[line];
+        auto last = outer.begin() + inner[line + 1];
+        auto lower = std::lower_bound(first, last, line);
+
+        if (lower != last && static_cast<size_t>(*lower) == line) {
+            positions[line] = static_cast<size_t>(lower - outer.begin());
+        }
+    }
+    return positions;
+}
+
+/// @brief Finds the positions of elements in YALE-like compressed arrays.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam P The type of the inner indexes.
+/// @tparam I The type of the outer indexes.
+/// @param inner The inner index array, i.e. the beginning of each line.
+/// @param outer The outer index array.
+/// @param indexes The container of the positions, as pairs of row and column
+/// indexes.
+/// @return The position of each element in the values array, or
+/// `no_position` if it's not stored.
+template <StorageOrder S, typename P, typename I>
+std::vector<size_t> compressed_positions(
+    std::span<P const> inner, std::span<I const> outer,
+    SizetPairContainer auto const& indexes) {
+    std::vector<size_t> positions;
+    positions.reserve(indexes.size());
+
+    for (auto const& [i, j] : indexes) {
+        const size_t line = (S == rowMajor) ? i : j;
+        const size_t index = (S == rowMajor) ? j : i;
+        auto first = outer.begin() + inner[line];
+        auto last = outer.begin() + inner[line + 1];
+        auto lower = std::lower_bound(first, last, index);
+
+        if (lower != last && static_cast<size_t>(*lower) == index) {
+            positions.push_back(static_cast<size_t>(lower - outer.begin()));
+        }
+        else {
+            positions.push_back(no_position);
+        }
+    }
+    return positions;
+}
+
+/// @brief Adds contributions to the values of YALE-like compressed arrays at
+/// known positions.
+/// @tparam T The type of the contributions (numeric or complex).
+/// @tparam V The type of the stored values.
+/// @param values The values array.
+/// @param positions The position in `values` of each contribution, e.g.
+/// found by `compressed_positions`. The same position can appear many times.
+/// @param contributions The contributions.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @details The contributions are split into contiguous blocks, one per
+/// thread. With more than one thread two of them can hit the same element,
+/// so the additions are atomic; smaller workloads are added by the calling
+/// thread with plain additions.
+template <NumericOrComplex T, typename V>
+void compressed_scatter_add(std::span<V> values,
+                            std::span<size_t const> positions,
+                            std::span<T const> contributions,
+                            unsigned num_threads) {
+    size_t num_parts = std::min<size_t>(resolve_threads(num_threads),
+                                        positions.size() / parallel_grain);
+    if (num_parts <= 1) {
+        for (size_t k = 0; k < positions.size(); ++k) {
+            values[positions[k]] += static_cast<V>(contributions[k]);
+        }
+        return;
+    }
+
+    parallel_for(num_parts, [&](size_t part) {
+        const size_t first = positions.size() * part / num_parts;
+        const size_t last = positions.size() * (part + 1) / num_parts;
+        for (size_t k = first; k < last; ++k) {
+            atomic_add(values[positions[k]],
+                       static_cast<V>(contributions[k]));
+        }
+    });
+}
+
+/// @brief Computes the norm of a matrix stored in YALE-like compressed
+/// arrays.
+/// @tparam N The type of norm to compute (Infinity, One, or Frobenius).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values.
+/// @tparam P The type of the inner indexes.
+/// @tparam I The type of the outer indexes.
+/// @param inner The inner index array, i.e. the beginning of each line.
+/// @param outer The outer index array.
+/// @param values The values array.
+/// @param rows The number of rows.
+/// @param columns The number of columns.
+/// @return The computed norm value.
+/// @details Norms summing along lines are computed one line at a time, the
+/// other ones accumulate into a vector indexed by the outer index.
+template <NormType N, StorageOrder S, typename V, typename P, typename I>
+double compressed_norm(std::span<P const> inner, std::span<I const> outer,
+                       std::span<V const> values, size_t rows,
+                       size_t columns) {
+    if constexpr ((N == One && S == rowMajor) ||
+                  (N == Infinity && S == columnMajor)) {
+        std::vector<double> par(N == One ? columns : rows, 0);
+
+        for (size_t k = 0; k < values.size(); ++k) {
+            par[outer[k]] += magnitude(values[k]);
+        }
+        return par.empty() ? 0.0 : *std::max_element(par.begin(), par.end());
+    }
+    else if constexpr (N == Infinity || N == One) {
+        double res = 0.0;
+
+        for (size_t l = 0; l + 1 < inner.size(); ++l) {
+            double sum = 0.0;
+            for (size_t k = inner[l]; k < inner[l + 1]; ++k) {
+                sum += magnitude(values[k]);
+            }
+            res = std::max(res, sum);
+        }
+        return res;
+    }
+    else {
+        double sum = 0.0;
+        for (auto const& el : values) {
+            sum += magnitude(el) * magnitude(el);
+        }
+        return std::sqrt(sum);
+    }
+}
+
+}  // namespace algebra
+#endif
@@ -64,11 +64,36 @@ concept SizetContainer =
     std::is_same_v<typename T::value_type,
                    std::decay_t<decltype(std::declval<size_t>())>>;
 
+/// @brief Concept to check if a type can be used for the indexes of a
+/// compressed format, e.g. `std::uint32_t` or `std::uint64_t`.
+/// @tparam T The type to check.
+template <typename T>
+concept IndexType = std::unsigned_integral<T> && !std::same_as<T, bool>;
+
+/// @brief Concept to check if a type can store the elements of a matrix of
+/// type `T`, possibly with less precision, e.g. `float` for `double`.
+/// @tparam V The type to check.
+/// @tparam T The type of the matrix elements.
+template <typename V, typename T>
+concept StorageFor = NumericOrComplex<T> &&
+                     std::is_constructible_v<V, T const&> &&
+                     std::is_convertible_v<V const&, T>;
+
 /// @brief Concept to check if a type is a container of `size_t` pairs.
 /// @tparam T The type to check.
 template <typename T>
 concept SizetPairContainer =
     ValidContainer<T> && SizetPair<typename T::value_type>;
 
+/// @brief Checks if a type is a `std::complex`.
+/// @tparam T The type to check.
+template <typename T>
+struct is_complex : std::false_type {};
+
+/// @brief Checks if a type is a `std::complex`.
+/// @tparam T The type of the real and imaginary parts.
+template <typename T>
+struct is_complex<std::complex<T>> : std::true_type {};
+
 }  // namespace algebra
 #endif
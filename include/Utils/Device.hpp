@@ -0,0 +1,175 @@
+#ifndef DEVICE_HPP
+#define DEVICE_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "BlockKernels.hpp"
+#include "Comparators.hpp"
+#include "CompressedKernels.hpp"
+#include "Concepts.hpp"
+
+namespace algebra {
+
+/// @brief Ordered queue of work on a device, e.g. the products of matrices
+/// uploaded by `Matrix::to_device`.
+/// @details The tasks run one at a time in the order they were enqueued, and
+/// each one completes a future when it's done, like the operations on a
+/// stream of a GPU. This tree only has the host backend, which runs the tasks
+/// on a worker thread owned by the stream; a GPU backend implements the
+/// same interface on top of a device stream.
+class DeviceStream {
+   public:
+    /// @brief Starts the stream.
+    DeviceStream();
+
+    DeviceStream(DeviceStream const&) = delete;
+    DeviceStream& operator=(DeviceStream const&) = delete;
+
+    /// @brief Waits for the enqueued tasks, then stops the stream.
+    ~DeviceStream();
+
+    /// @brief Enqueues a task after all the previous ones.
+    /// @param task The task.
+    /// @return The future completed when the task is done, holding the
+    /// exception it threw, if any.
+    std::future<void> enqueue(std::function<void()> task);
+
+    /// @brief Waits for all the tasks enqueued so far.
+    void synchronize();
+
+   private:
+    /// @brief Runs the tasks until the stream is stopped.
+    void run();
+
+    std::mutex mutex;                    ///< Guards the queue.
+    std::condition_variable wake;        ///< Signals new tasks.
+    std::deque<std::packaged_task<void()>> tasks;  ///< The pending tasks.
+    bool stopping = false;  ///< True when the stream is being destroyed.
+    std::thread worker;     ///< Runs the tasks.
+};
+
+/// @brief Gets the stream used by default by `Matrix::to_device`.
+/// @return The stream, alive until the end of the program.
+DeviceStream& default_device_stream();
+
+/// @brief Buffer in the memory of the device, filled by copying an array of
+/// the host once.
+/// @tparam U The type of the elements.
+/// @details The content can only be read by the tasks of a stream. In the
+/// host backend the device memory is the memory of the host.
+template <typename U>
+class DeviceBuffer {
+   public:
+    /// @brief Uploads an array.
+    /// @param host The array to copy.
+    explicit DeviceBuffer(std::span<U const> host)
+        : storage(host.begin(), host.end()) {}
+
+    /// @brief Gets the address range of the buffer on the device.
+    /// @return The range.
+    std::span<U const> view() const { return storage; }
+
+    /// @brief Gets the size of the buffer.
+    /// @return The number of bytes.
+    size_t bytes() const { return storage.size() * sizeof(U); }
+
+   private:
+    std::vector<U> storage;  ///< The content of the buffer.
+};
+
+/// @brief Copy of a compressed matrix in the memory of a device, whose
+/// products run as tasks of a `DeviceStream`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+template <NumericOrComplex T>
+class DeviceMatrix {
+   public:
+    virtual ~DeviceMatrix() = default;
+
+    /// @brief Performs the product `y = alpha * A * x + beta * y`.
+    /// @param x The vector, i.e. the rhs.
+    /// @param y The output buffer.
+    /// @param alpha The scaling factor of the product.
+    /// @param beta The scaling factor of the previous content of `y`.
+    virtual void multiply(std::span<T const> x, std::span<T> y, T alpha,
+                          T beta) const = 0;
+
+    /// @brief Performs the product `Y = alpha * A * X + beta * Y` with a
+    /// dense block of `k` vectors.
+    /// @param x The rhs block, row-major with `k` columns.
+    /// @param y The output block, row-major with `k` columns.
+    /// @param k The number of vectors in the blocks.
+    /// @param alpha The scaling factor of the product.
+    /// @param beta The scaling factor of the previous content of `y`.
+    virtual void multiply_block(std::span<T const> x, std::span<T> y,
+                                size_t k, T alpha, T beta) const = 0;
+
+    /// @brief Gets the device memory used by the matrix.
+    /// @return The number of bytes.
+    virtual size_t bytes() const = 0;
+};
+
+/// @brief Copy of the arrays of a YALE-like compressed matrix in the memory
+/// of a device.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values, converted to `T` when read.
+/// @tparam P The type of the inner indexes.
+/// @tparam I The type of the outer indexes.
+template <NumericOrComplex T, StorageOrder S, typename V, typename P,
+          typename I>
+class DeviceYALE final : public DeviceMatrix<T> {
+   public:
+    /// @brief Uploads the compressed arrays of a matrix.
+    /// @param inner The inner index array, i.e. the beginning of each line.
+    /// @param outer The outer index array.
+    /// @param values The values array.
+    DeviceYALE(std::span<P const> inner, std::span<I const> outer,
+               std::span<V const> values)
+        : inner(inner), outer(outer), values(values) {}
+
+    /// @brief Performs the product `y = alpha * A * x + beta * y`.
+    /// @param x The vector, i.e. the rhs.
+    /// @param y The output buffer.
+    /// @param alpha The scaling factor of the product.
+    /// @param beta The scaling factor of the previous content of `y`.
+    void multiply(std::span<T const> x, std::span<T> y, T alpha,
+                  T beta) const override {
+        compressed_product<S>(inner.view(), outer.view(), values.view(), x, y,
+                              alpha, beta);
+    }
+
+    /// @brief Performs the product `Y = alpha * A * X + beta * Y` with a
+    /// dense block of `k` vectors.
+    /// @param x The rhs block, row-major with `k` columns.
+    /// @param y The output block, row-major with `k` columns.
+    /// @param k The number of vectors in the blocks.
+    /// @param alpha The scaling factor of the product.
+    /// @param beta The scaling factor of the previous content of `y`.
+    void multiply_block(std::span<T const> x, std::span<T> y, size_t k,
+                        T alpha, T beta) const override {
+        compressed_product_block<S>(inner.view(), outer.view(), values.view(),
+                                    x, y, k, alpha, beta);
+    }
+
+    /// @brief Gets the device memory used by the matrix.
+    /// @return The number of bytes.
+    size_t bytes() const override {
+        return inner.bytes() + outer.bytes() + values.bytes();
+    }
+
+   private:
+    DeviceBuffer<P> inner;   ///< The inner index array.
+    DeviceBuffer<I> outer;   ///< The outer index array.
+    DeviceBuffer<V> values;  ///< The values array.
+};
+
+}  // namespace algebra
+#endif
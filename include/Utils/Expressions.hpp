@@ -0,0 +1,435 @@
+#ifndef EXPRESSIONS_HPP
+#define EXPRESSIONS_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Comparators.hpp"
+#include "Concepts.hpp"
+
+namespace algebra {
+
+/// @brief Term `scale * A * x` of a lazy linear combination.
+/// @tparam T The type of the elements (numeric or complex).
+/// @tparam M The type of the matrix.
+template <NumericOrComplex T, typename M>
+struct ProductTerm {
+    using matrix_type = M;  ///< The type of the matrix.
+
+    M const* matrix;       ///< The matrix `A`.
+    std::span<T const> x;  ///< The vector `x`.
+    T scale;               ///< The scaling factor.
+};
+
+/// @brief Term `scale * w` of a lazy linear combination.
+/// @tparam T The type of the elements (numeric or complex).
+template <NumericOrComplex T>
+struct VectorTerm {
+    std::span<T const> x;  ///< The vector `w`.
+    T scale;               ///< The scaling factor.
+};
+
+/// @brief Checks if the rows of a matrix can be read one at a time from its
+/// compressed arrays, i.e. it's row-major and its compressed format provides
+/// `lines_compressed`.
+template <typename M>
+concept RowReadable =
+    requires(M const& m) { lines_compressed(m); } &&
+    std::remove_cvref_t<decltype(lines_compressed(
+        std::declval<M const&>()))>::storage_order == rowMajor;
+
+/// @brief Checks if a term of a linear combination can be read one row at a
+/// time, i.e. it's a vector or the product by a `RowReadable` matrix.
+template <typename Term>
+concept ReadableByRows = !requires { typename Term::matrix_type; } ||
+                         RowReadable<typename Term::matrix_type>;
+
+/// @brief Lazy linear combination of matrix-vector products and vectors,
+/// e.g. `A * x + B * z - 2.0 * w`, evaluated only when it's assigned.
+/// @tparam T The type of the elements (numeric or complex).
+/// @tparam Terms The types of the terms, `ProductTerm` or `VectorTerm`.
+/// @details Building the expression only records the operands, which must
+/// outlive it, so temporary matrices and vectors are rejected at compile
+/// time. It's evaluated by converting it to `std::vector<T>` or by
+/// `evaluate_into`; kept in an `auto` variable, it stays lazy until an
+/// element is read with `[]` or by iterating over it, which evaluates it once
+/// into a vector it owns, from the operands as they are at that moment. The
+/// output mustn't overlap any operand.
+template <NumericOrComplex T, typename... Terms>
+class LinearCombination {
+   public:
+    /// @brief Constructs the combination of the given terms.
+    /// @param terms The terms.
+    explicit LinearCombination(std::tuple<Terms...> terms)
+        : terms(std::move(terms)) {}
+
+    /// @brief Gets the terms of the combination.
+    /// @return The terms.
+    std::tuple<Terms...> const& get_terms() const { return terms; }
+
+    /// @brief Gets the length of the result.
+    /// @return The number of rows of the matrices, i.e. the length of the
+    /// vectors.
+    size_t size() const;
+
+    /// @brief Evaluates the combination into a buffer owned by the caller.
+    /// @param y The output buffer, it must hold `size()` elements.
+    void evaluate_into(std::span<T> y) const;
+
+    /// @brief Evaluates the combination into a new vector.
+    /// @return The result.
+    operator std::vector<T>() const {
+        std::vector<T> y(size());
+        evaluate_into(y);
+        return y;
+    }
+
+    /// @brief Gets an element of the result, evaluating the combination the
+    /// first time it's read.
+    /// @param i The index of the element.
+    /// @return A reference to the element.
+    T const& operator[](size_t i) { return evaluated()[i]; }
+
+    /// @brief Gets an iterator to the first element of the result,
+    /// evaluating the combination the first time it's read.
+    /// @return The iterator.
+    auto begin() { return evaluated().begin(); }
+
+    /// @brief Gets an iterator past the last element of the result,
+    /// evaluating the combination the first time it's read.
+    /// @return The iterator.
+    auto end() { return evaluated().end(); }
+
+   private:
+    /// @brief Evaluates the combination into the owned vector, once.
+    /// @return The result.
+    std::vector<T> const& evaluated();
+
+    std::tuple<Terms...> terms;  ///< The terms of the combination.
+    std::vector<T> result;       ///< The result, once it has been read.
+    bool is_evaluated = false;   ///< True if `result` holds the result.
+};
+
+/// @brief Gets the length of the result of a term.
+/// @param term The term.
+/// @return The number of rows of the matrix.
+template <NumericOrComplex T, typename M>
+size_t term_size(ProductTerm<T, M> const& term) {
+    return term.matrix->get_rows();
+}
+
+/// @brief Gets the length of the result of a term.
+/// @param term The term.
+/// @return The length of the vector.
+template <NumericOrComplex T>
+size_t term_size(VectorTerm<T> const& term) {
+    return term.x.size();
+}
+
+/// @brief Scales a term.
+/// @param term The term.
+/// @param scale The scaling factor.
+/// @return The scaled term.
+template <NumericOrComplex T, typename M>
+ProductTerm<T, M> scale_term(ProductTerm<T, M> const& term, T scale) {
+    return {term.matrix, term.x, scale * term.scale};
+}
+
+/// @brief Scales a term.
+/// @param term The term.
+/// @param scale The scaling factor.
+/// @return The scaled term.
+template <NumericOrComplex T>
+VectorTerm<T> scale_term(VectorTerm<T> const& term, T scale) {
+    return {term.x, scale * term.scale};
+}
+
+/// @brief Adds a term to the output, or writes it if it's the first one.
+/// @param term The term.
+/// @param y The output buffer.
+/// @param first True if the previous content of `y` is to be overwritten.
+template <NumericOrComplex T, typename M>
+void accumulate_term(ProductTerm<T, M> const& term, std::span<T> y,
+                     bool first) {
+    term.matrix->multiply_into(term.x, y, term.scale, first ? T{0} : T{1});
+}
+
+/// @brief Adds a term to the output, or writes it if it's the first one.
+/// @param term The term.
+/// @param y The output buffer.
+/// @param first True if the previous content of `y` is to be overwritten.
+template <NumericOrComplex T>
+void accumulate_term(VectorTerm<T> const& term, std::span<T> y, bool first) {
+    for (size_t i = 0; i < y.size(); ++i) {
+        y[i] = first ? term.scale * term.x[i] : y[i] + term.scale * term.x[i];
+    }
+}
+
+/// @brief Checks if the matrix of a term is compressed.
+/// @param term The term.
+/// @return True if the matrix is compressed.
+template <NumericOrComplex T, typename M>
+bool term_compressed(ProductTerm<T, M> const& term) {
+    return term.matrix->is_compressed();
+}
+
+/// @brief Checks if the matrix of a term is compressed.
+/// @return Always true, as the term has no matrix.
+template <NumericOrComplex T>
+bool term_compressed(VectorTerm<T> const&) {
+    return true;
+}
+
+/// @brief Builds the function reading a row of a term.
+/// @param term The term, whose matrix must be compressed.
+/// @return A callable taking a row index and returning the element of the
+/// term in that row.
+template <NumericOrComplex T, typename M>
+auto term_row_reader(ProductTerm<T, M> const& term) {
+    return [lines = lines_compressed(*term.matrix), x = term.x,
+            scale = term.scale](size_t i) {
+        auto line = lines.line(i);
+        auto indexes = line.indexes();
+        auto values = line.values();
+        T sum{};
+        for (size_t k = 0; k < indexes.size(); ++k) {
+            sum += static_cast<T>(values[k]) * x[indexes[k]];
+        }
+        return scale * sum;
+    };
+}
+
+/// @brief Builds the function reading a row of a term.
+/// @param term The term.
+/// @return A callable taking a row index and returning the element of the
+/// term in that row.
+template <NumericOrComplex T>
+auto term_row_reader(VectorTerm<T> const& term) {
+    return [x = term.x, scale = term.scale](size_t i) { return scale * x[i]; };
+}
+
+/// @brief Checks that a term matches the output and doesn't overlap it.
+/// @param term The term.
+/// @param y The output buffer.
+/// @return True if the term can be evaluated into `y`.
+template <typename Term, NumericOrComplex T>
+bool term_fits(Term const& term, std::span<T const> y) {
+    std::less<T const*> before;
+    bool disjoint = !before(y.data(), term.x.data() + term.x.size()) ||
+                    !before(term.x.data(), y.data() + y.size());
+    if constexpr (requires { term.matrix; }) {
+        return disjoint && term.matrix->get_rows() == y.size() &&
+               term.matrix->get_columns() == term.x.size();
+    }
+    else {
+        return disjoint && term.x.size() == y.size();
+    }
+}
+
+/// @brief Gets the length of the result.
+/// @return The number of rows of the matrices, i.e. the length of the
+/// vectors.
+template <NumericOrComplex T, typename... Terms>
+size_t LinearCombination<T, Terms...>::size() const {
+    return term_size(std::get<0>(terms));
+}
+
+/// @brief Evaluates the combination into the owned vector, once.
+/// @return The result.
+/// @details The later reads return the same vector, even if the operands
+/// have changed in the meantime.
+template <NumericOrComplex T, typename... Terms>
+std::vector<T> const& LinearCombination<T, Terms...>::evaluated() {
+    if (!is_evaluated) {
+        result = *this;
+        is_evaluated = true;
+    }
+    return result;
+}
+
+/// @brief Evaluates the combination into a buffer owned by the caller.
+/// @param y The output buffer, it must hold `size()` elements.
+/// @details When every matrix is compressed in a row-major format providing
+/// `lines_compressed`, each element of `y` is computed by a single loop over
+/// the rows, reading every row of every term once and writing `y` once.
+/// Otherwise the first term is written into `y` and the others added to it,
+/// each product by `multiply_into`; either way no temporary vector is
+/// allocated.
+template <NumericOrComplex T, typename... Terms>
+void LinearCombination<T, Terms...>::evaluate_into(std::span<T> y) const {
+#ifdef DEBUG
+    std::apply(
+        [&](auto const&... term) {
+            assert((term_fits(term, std::span<T const>(y)) && ...) &&
+                   "Error in call to evaluate_into: non-matching dimensions "
+                   "or overlapping output.\n");
+        },
+        terms);
+#endif
+
+    if constexpr ((ReadableByRows<Terms> && ...)) {
+        bool compressed = std::apply(
+            [](auto const&... term) { return (term_compressed(term) && ...); },
+            terms);
+        if (compressed) {
+            auto readers = std::apply(
+                [](auto const&... term) {
+                    return std::make_tuple(term_row_reader(term)...);
+                },
+                terms);
+            for (size_t i = 0; i < y.size(); ++i) {
+                y[i] = std::apply(
+                    [i](auto const&... reader) { return (reader(i) + ...); },
+                    readers);
+            }
+            return;
+        }
+    }
+
+    bool first = true;
+    std::apply(
+        [&](auto const&... term) {
+            ((accumulate_term(term, y, first), first = false), ...);
+        },
+        terms);
+}
+
+/// @brief Adds two linear combinations.
+/// @param a The lhs.
+/// @param b The rhs.
+/// @return The combination of the terms of both.
+template <NumericOrComplex T, typename... A, typename... B>
+LinearCombination<T, A..., B...> operator+(
+    LinearCombination<T, A...> const& a, LinearCombination<T, B...> const& b) {
+    return LinearCombination<T, A..., B...>(
+        std::tuple_cat(a.get_terms(), b.get_terms()));
+}
+
+/// @brief Scales a linear combination.
+/// @param scale The scaling factor.
+/// @param a The combination.
+/// @return The combination with every term scaled.
+template <NumericOrComplex T, typename... A>
+LinearCombination<T, A...> operator*(std::type_identity_t<T> scale,
+                                     LinearCombination<T, A...> const& a) {
+    return LinearCombination<T, A...>(std::apply(
+        [scale](auto const&... term) {
+            return std::make_tuple(scale_term(term, scale)...);
+        },
+        a.get_terms()));
+}
+
+/// @brief Scales a linear combination.
+/// @param a The combination.
+/// @param scale The scaling factor.
+/// @return The combination with every term scaled.
+template <NumericOrComplex T, typename... A>
+LinearCombination<T, A...> operator*(LinearCombination<T, A...> const& a,
+                                     std::type_identity_t<T> scale) {
+    return scale * a;
+}
+
+/// @brief Negates a linear combination.
+/// @param a The combination.
+/// @return The combination with every term negated.
+template <NumericOrComplex T, typename... A>
+LinearCombination<T, A...> operator-(LinearCombination<T, A...> const& a) {
+    return T{-1} * a;
+}
+
+/// @brief Subtracts two linear combinations.
+/// @param a The lhs.
+/// @param b The rhs.
+/// @return The combination of the terms of `a` and of the negated terms of
+/// `b`.
+template <NumericOrComplex T, typename... A, typename... B>
+LinearCombination<T, A..., B...> operator-(
+    LinearCombination<T, A...> const& a, LinearCombination<T, B...> const& b) {
+    return a + (-b);
+}
+
+/// @brief Scales a vector lazily, as a term of a linear combination.
+/// @param scale The scaling factor.
+/// @param w The vector, which must outlive the combination.
+/// @return The combination made of `scale * w`.
+template <NumericOrComplex T>
+LinearCombination<T, VectorTerm<T>> operator*(std::type_identity_t<T> scale,
+                                              std::vector<T> const& w) {
+    return LinearCombination<T, VectorTerm<T>>(
+        std::make_tuple(VectorTerm<T>{std::span<T const>(w), scale}));
+}
+
+/// @brief Rejects a temporary vector, which would dangle.
+template <NumericOrComplex T>
+LinearCombination<T, VectorTerm<T>> operator*(std::type_identity_t<T> scale,
+                                              std::vector<T>&& w) = delete;
+
+/// @brief Adds a vector to a linear combination.
+/// @param a The combination.
+/// @param w The vector, which must outlive the combination.
+/// @return The combination with the term `w` appended.
+template <NumericOrComplex T, typename... A>
+LinearCombination<T, A..., VectorTerm<T>> operator+(
+    LinearCombination<T, A...> const& a, std::vector<T> const& w) {
+    return a + T{1} * w;
+}
+
+/// @brief Rejects a temporary vector, which would dangle.
+template <NumericOrComplex T, typename... A>
+LinearCombination<T, A..., VectorTerm<T>> operator+(
+    LinearCombination<T, A...> const& a, std::vector<T>&& w) = delete;
+
+/// @brief Adds a linear combination to a vector.
+/// @param w The vector, which must outlive the combination.
+/// @param a The combination.
+/// @return The combination with the term `w` prepended.
+template <NumericOrComplex T, typename... A>
+LinearCombination<T, VectorTerm<T>, A...> operator+(
+    std::vector<T> const& w, LinearCombination<T, A...> const& a) {
+    return T{1} * w + a;
+}
+
+/// @brief Rejects a temporary vector, which would dangle.
+template <NumericOrComplex T, typename... A>
+LinearCombination<T, VectorTerm<T>, A...> operator+(
+    std::vector<T>&& w, LinearCombination<T, A...> const& a) = delete;
+
+/// @brief Subtracts a vector from a linear combination.
+/// @param a The combination.
+/// @param w The vector, which must outlive the combination.
+/// @return The combination with the term `-w` appended.
+template <NumericOrComplex T, typename... A>
+LinearCombination<T, A..., VectorTerm<T>> operator-(
+    LinearCombination<T, A...> const& a, std::vector<T> const& w) {
+    return a + T{-1} * w;
+}
+
+/// @brief Rejects a temporary vector, which would dangle.
+template <NumericOrComplex T, typename... A>
+LinearCombination<T, A..., VectorTerm<T>> operator-(
+    LinearCombination<T, A...> const& a, std::vector<T>&& w) = delete;
+
+/// @brief Subtracts a linear combination from a vector.
+/// @param w The vector, which must outlive the combination.
+/// @param a The combination.
+/// @return The combination with the term `w` prepended, and the terms of `a`
+/// negated.
+template <NumericOrComplex T, typename... A>
+LinearCombination<T, VectorTerm<T>, A...> operator-(
+    std::vector<T> const& w, LinearCombination<T, A...> const& a) {
+    return T{1} * w - a;
+}
+
+/// @brief Rejects a temporary vector, which would dangle.
+template <NumericOrComplex T, typename... A>
+LinearCombination<T, VectorTerm<T>, A...> operator-(
+    std::vector<T>&& w, LinearCombination<T, A...> const& a) = delete;
+
+}  // namespace algebra
+#endif
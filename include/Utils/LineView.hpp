@@ -0,0 +1,254 @@
+#ifndef LINEVIEW_HPP
+#define LINEVIEW_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <span>
+
+#include "Comparators.hpp"
+#include "Concepts.hpp"
+
+namespace algebra {
+
+/// @brief Range over the elements of a line, i.e. of a row in row-major order
+/// or of a column in column-major order, of YALE-like compressed arrays.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam V The type of the stored values, converted to `T` when read.
+/// @tparam I The type of the outer indexes.
+/// @details The range holds two spans into the arrays of the matrix, so it's
+/// as cheap as a loop over them and it's invalidated by any modification of
+/// the matrix. Iterating yields pairs of the index along the line and the
+/// value, e.g. `for (auto [j, v] : m.row(i))`; the spans themselves are
+/// returned by `indexes` and `values` for kernels that want the raw arrays.
+template <NumericOrComplex T, typename V, typename I>
+class LineView {
+   public:
+    /// @brief An element of the line.
+    struct Entry {
+        size_t index;  ///< The column in row-major order, else the row.
+        T value;       ///< The value.
+    };
+
+    /// @brief Iterator over the elements of the line.
+    class iterator {
+       public:
+        using value_type = Entry;                ///< The type of the elements.
+        using difference_type = std::ptrdiff_t;  ///< The type of distances.
+
+        /// @brief Default constructor, a singular iterator.
+        iterator() = default;
+
+        /// @brief Constructs an iterator at the given position.
+        /// @param index Pointer to the index of the element.
+        /// @param value Pointer to the value of the element.
+        iterator(I const* index, V const* value)
+            : index(index), value(value) {}
+
+        /// @brief Reads the element.
+        /// @return The index and the value, converted to `T`.
+        Entry operator*() const {
+            return {static_cast<size_t>(*index), static_cast<T>(*value)};
+        }
+
+        /// @brief Moves to the next element.
+        /// @return The iterator.
+        iterator& operator++() {
+            ++index;
+            ++value;
+            return *this;
+        }
+
+        /// @brief Moves to the next element.
+        /// @return The iterator before moving.
+        iterator operator++(int) {
+            iterator copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        /// @brief Compares two iterators of the same line.
+        /// @param other The other iterator.
+        /// @return True if they point to the same element.
+        bool operator==(iterator const& other) const {
+            return index == other.index;
+        }
+
+       private:
+        I const* index = nullptr;  ///< The index of the element.
+        V const* value = nullptr;  ///< The value of the element.
+    };
+
+    /// @brief Constructs the range of a line.
+    /// @param indexes The indexes of the elements of the line.
+    /// @param values The values of the elements of the line.
+    LineView(std::span<I const> indexes, std::span<V const> values)
+        : line_indexes(indexes), line_values(values) {}
+
+    /// @brief Gets an iterator to the first element.
+    /// @return The iterator.
+    iterator begin() const {
+        return iterator(line_indexes.data(), line_values.data());
+    }
+
+    /// @brief Gets an iterator past the last element.
+    /// @return The iterator.
+    iterator end() const {
+        return iterator(line_indexes.data() + line_indexes.size(),
+                        line_values.data() + line_values.size());
+    }
+
+    /// @brief Gets the number of elements of the line.
+    /// @return The number of elements.
+    size_t size() const { return line_indexes.size(); }
+
+    /// @brief Checks if the line has no elements.
+    /// @return True if the line is empty.
+    bool empty() const { return line_indexes.empty(); }
+
+    /// @brief Gets the indexes of the elements, sorted.
+    /// @return The span of the indexes.
+    std::span<I const> indexes() const { return line_indexes; }
+
+    /// @brief Gets the values of the elements, as stored.
+    /// @return The span of the values.
+    std::span<V const> values() const { return line_values; }
+
+   private:
+    std::span<I const> line_indexes;  ///< The indexes of the elements.
+    std::span<V const> line_values;   ///< The values of the elements.
+};
+
+/// @brief Range over the lines and the elements of YALE-like compressed
+/// arrays.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam V The type of the stored values, converted to `T` when read.
+/// @tparam P The type of the inner indexes.
+/// @tparam I The type of the outer indexes.
+/// @details `line(k)` gives the range of a line, iterating the object itself
+/// visits every element line by line, yielding its row, column and value.
+/// Like `LineView`, it's invalidated by any modification of the matrix.
+template <NumericOrComplex T, StorageOrder S, typename V, typename P,
+          typename I>
+class CompressedLines {
+   public:
+    static constexpr StorageOrder storage_order = S;  ///< The storage order.
+
+    /// @brief An element of the matrix.
+    struct Entry {
+        size_t row;     ///< The row index.
+        size_t column;  ///< The column index.
+        T value;        ///< The value.
+    };
+
+    /// @brief Iterator over the elements of the matrix, line by line.
+    class iterator {
+       public:
+        using value_type = Entry;                ///< The type of the elements.
+        using difference_type = std::ptrdiff_t;  ///< The type of distances.
+
+        /// @brief Default constructor, a singular iterator.
+        iterator() = default;
+
+        /// @brief Constructs an iterator at the given position, which must
+        /// be either an element or the end.
+        /// @param lines The range of the arrays.
+        /// @param line The line of the element.
+        /// @param position The position of the element in the arrays.
+        iterator(CompressedLines const* lines, size_t line, size_t position)
+            : lines(lines), line(line), position(position) {
+            skip_empty_lines();
+        }
+
+        /// @brief Reads the element.
+        /// @return The row, the column and the value, converted to `T`.
+        Entry operator*() const {
+            size_t index = static_cast<size_t>(lines->outer[position]);
+            T value = static_cast<T>(lines->values[position]);
+            if constexpr (S == rowMajor) {
+                return {line, index, value};
+            }
+            else {
+                return {index, line, value};
+            }
+        }
+
+        /// @brief Moves to the next element.
+        /// @return The iterator.
+        iterator& operator++() {
+            ++position;
+            skip_empty_lines();
+            return *this;
+        }
+
+        /// @brief Moves to the next element.
+        /// @return The iterator before moving.
+        iterator operator++(int) {
+            iterator copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        /// @brief Compares two iterators of the same matrix.
+        /// @param other The other iterator.
+        /// @return True if they point to the same element.
+        bool operator==(iterator const& other) const {
+            return position == other.position;
+        }
+
+       private:
+        /// @brief Moves to the line of the current position.
+        void skip_empty_lines() {
+            while (line < lines->num_lines() &&
+                   position == static_cast<size_t>(lines->inner[line + 1])) {
+                ++line;
+            }
+        }
+
+        CompressedLines const* lines = nullptr;  ///< The range of the arrays.
+        size_t line = 0;                         ///< The current line.
+        size_t position = 0;  ///< The position in the arrays.
+    };
+
+    /// @brief Constructs the range of compressed arrays.
+    /// @param inner The inner index array, i.e. the beginning of each line.
+    /// @param outer The outer index array.
+    /// @param values The values array.
+    CompressedLines(std::span<P const> inner, std::span<I const> outer,
+                    std::span<V const> values)
+        : inner(inner), outer(outer), values(values) {}
+
+    /// @brief Gets the range of a line.
+    /// @param k The line, i.e. a row in row-major order, else a column.
+    /// @return The range of the elements of the line.
+    LineView<T, V, I> line(size_t k) const {
+        size_t first = inner[k];
+        size_t count = inner[k + 1] - inner[k];
+        return LineView<T, V, I>(outer.subspan(first, count),
+                                 values.subspan(first, count));
+    }
+
+    /// @brief Gets the number of lines.
+    /// @return The number of rows in row-major order, else of columns.
+    size_t num_lines() const { return inner.empty() ? 0 : inner.size() - 1; }
+
+    /// @brief Gets the number of elements.
+    /// @return The number of elements.
+    size_t size() const { return values.size(); }
+
+    /// @brief Gets an iterator to the first element.
+    /// @return The iterator.
+    iterator begin() const { return iterator(this, 0, 0); }
+
+    /// @brief Gets an iterator past the last element.
+    /// @return The iterator.
+    iterator end() const { return iterator(this, num_lines(), size()); }
+
+   private:
+    std::span<P const> inner;   ///< The inner index array.
+    std::span<I const> outer;   ///< The outer index array.
+    std::span<V const> values;  ///< The values array.
+};
+
+}  // namespace algebra
+#endif
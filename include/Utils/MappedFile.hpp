@@ -0,0 +1,37 @@
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace algebra {
+
+/// @brief Maps a file read-only in memory for the lifetime of the object.
+/// @details The mapping is shared, so several processes mapping the same file
+/// use the same copy of it in the page cache.
+class MappedFile {
+   public:
+    /// @brief Maps the given file, an empty view is exposed if it fails.
+    /// @param file_name The name of the file.
+    /// @param sequential Hints the kernel that the file will be read once from
+    /// the beginning to the end.
+    explicit MappedFile(std::string const& file_name, bool sequential = false);
+
+    /// @brief Unmaps the file.
+    ~MappedFile();
+
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+
+    /// @brief Gets the content of the file.
+    /// @return A view over the mapped bytes.
+    std::string_view view() const;
+
+   private:
+    void* address = nullptr;  ///< Address of the mapping.
+    size_t length = 0;        ///< Length of the mapping.
+};
+
+}  // namespace algebra
+#endif
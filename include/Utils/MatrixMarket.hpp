@@ -0,0 +1,420 @@
+#ifndef MATRIXMARKET_HPP
+#define MATRIXMARKET_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <charconv>
+#include <complex>
+#include <cstddef>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Comparators.hpp"
+#include "Concepts.hpp"
+#include "MappedFile.hpp"
+#include "Parallel.hpp"
+
+using namespace comparators;
+namespace algebra {
+
+/// @brief Enum representing the kind of values stored in a Matrix Market file.
+enum class MarketField { Real, Integer, Complex, Pattern };
+
+/// @brief Enum representing the symmetry of a Matrix Market file.
+enum class MarketSymmetry { General, Symmetric, SkewSymmetric, Hermitian };
+
+/// @brief Holds the information found in the header of a Matrix Market file.
+struct MarketHeader {
+    MarketField field = MarketField::Real;  ///< Kind of the values.
+    MarketSymmetry symmetry =
+        MarketSymmetry::General;  ///< Symmetry of the matrix.
+    size_t rows = 0;              ///< Number of rows.
+    size_t columns = 0;           ///< Number of columns.
+    size_t entries = 0;           ///< Number of entries stored in the file.
+};
+
+/// @brief Holds the entries of a Matrix Market file as parsed, i.e. with
+/// zero-based indexes and without the entries implied by the symmetry.
+/// @tparam T The type of the matrix elements (numeric or complex).
+template <NumericOrComplex T>
+struct MarketData {
+    MarketHeader header;         ///< The header of the file.
+    std::vector<size_t> rows;    ///< Row index of each entry.
+    std::vector<size_t> columns;  ///< Column index of each entry.
+    std::vector<T> values;       ///< Value of each entry.
+};
+
+/// @brief Parses the banner, the comments and the size line of a Matrix
+/// Market file.
+/// @param text The content of the file.
+/// @param header The header to fill.
+/// @return The offset of the first entry in `text`.
+size_t parse_market_header(std::string_view text, MarketHeader& header);
+
+/// @brief Skips blanks, i.e. spaces, tabulations and carriage returns.
+/// @param p The current position, advanced past the blanks.
+/// @param end The end of the text.
+inline void skip_blanks(char const*& p, char const* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+}
+
+/// @brief Parses a number and advances past it.
+/// @tparam N The type of the number.
+/// @param p The current position, advanced past the number.
+/// @param end The end of the text.
+/// @return The parsed number.
+/// @details A missing or malformed number throws `std::invalid_argument`.
+template <typename N>
+N parse_number(char const*& p, char const* end) {
+    N number{};
+    skip_blanks(p, end);
+    if (p < end && *p == '+') ++p;
+    auto [next, ec] = std::from_chars(p, end, number);
+    if (ec != std::errc{}) {
+        throw std::invalid_argument(
+            "Error in Matrix Market reader: malformed number.");
+    }
+    p = next;
+    return number;
+}
+
+/// @brief Parses the value of an entry according to the field of the file.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @param p The current position, advanced past the value.
+/// @param end The end of the text.
+/// @param field The kind of values stored in the file.
+/// @return The parsed value.
+template <NumericOrComplex T>
+T parse_market_value(char const*& p, char const* end, MarketField field) {
+    switch (field) {
+        case MarketField::Pattern:
+            return T{1};
+        case MarketField::Integer:
+            return static_cast<T>(parse_number<long long>(p, end));
+        case MarketField::Complex: {
+            double re = parse_number<double>(p, end);
+            double im = parse_number<double>(p, end);
+            if constexpr (is_complex<T>::value) {
+                return T(re, im);
+            }
+            else {
+#ifdef DEBUG
+                assert(im == 0 &&
+                       "Error in Matrix Market reader: complex values can't be "
+                       "stored in a real matrix.\n");
+#endif
+                return static_cast<T>(re);
+            }
+        }
+        default:
+            return static_cast<T>(parse_number<double>(p, end));
+    }
+}
+
+/// @brief Counts the entries of a chunk of a Matrix Market file.
+/// @param first The beginning of the chunk, at the beginning of a line.
+/// @param last The end of the chunk, at the beginning of a line.
+/// @return The number of lines that are neither blank nor comments.
+inline size_t count_market_entries(char const* first, char const* last) {
+    size_t count = 0;
+
+    while (first < last) {
+        char const* eol =
+            static_cast<char const*>(std::memchr(first, '\n', last - first));
+        if (!eol) eol = last;
+
+        char const* p = first;
+        skip_blanks(p, eol);
+        if (p < eol && *p != '%') ++count;
+
+        first = eol + 1;
+    }
+    return count;
+}
+
+/// @brief Parses the entries of a chunk of a Matrix Market file.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @param first The beginning of the chunk, at the beginning of a line.
+/// @param last The end of the chunk, at the beginning of a line.
+/// @param data The parsed data, the entries are written starting from
+/// `offset`.
+/// @param offset The position of the first entry of the chunk.
+/// @details Indexes outside the dimensions of the header throw
+/// `std::invalid_argument`, before the entry is written.
+template <NumericOrComplex T>
+void parse_market_entries(char const* first, char const* last,
+                          MarketData<T>& data, size_t offset) {
+    while (first < last) {
+        char const* eol =
+            static_cast<char const*>(std::memchr(first, '\n', last - first));
+        if (!eol) eol = last;
+
+        char const* p = first;
+        skip_blanks(p, eol);
+        if (p < eol && *p != '%') {
+            size_t i = parse_number<size_t>(p, eol);
+            size_t j = parse_number<size_t>(p, eol);
+            if (i < 1 || i > data.header.rows || j < 1 ||
+                j > data.header.columns) {
+                throw std::invalid_argument(
+                    "Error in Matrix Market reader: indexes out of bounds.");
+            }
+            data.rows[offset] = i - 1;
+            data.columns[offset] = j - 1;
+            data.values[offset] =
+                parse_market_value<T>(p, eol, data.header.field);
+            ++offset;
+        }
+
+        first = eol + 1;
+    }
+}
+
+/// @brief Splits the entries of a Matrix Market file into chunks of about
+/// the same length, at line boundaries.
+/// @param begin The beginning of the first entry.
+/// @param end The end of the file.
+/// @param num_parts The number of chunks.
+/// @return The `num_parts + 1` boundaries of the chunks.
+inline std::vector<char const*> split_market_entries(char const* begin,
+                                                     char const* end,
+                                                     size_t num_parts) {
+    size_t length = static_cast<size_t>(end - begin);
+    std::vector<char const*> bounds(num_parts + 1, end);
+    bounds[0] = begin;
+
+    for (size_t k = 1; k < num_parts; ++k) {
+        char const* p = std::max(bounds[k - 1], begin + length / num_parts * k);
+        char const* eol =
+            static_cast<char const*>(std::memchr(p, '\n', end - p));
+        bounds[k] = eol ? eol + 1 : end;
+    }
+    return bounds;
+}
+
+/// @brief Reads a Matrix Market file in coordinate format.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @param file_name The name of the file.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @return The parsed header and entries.
+/// @details The file is memory mapped and split into chunks at line
+/// boundaries. The entries of each chunk are counted in parallel, so that each
+/// chunk knows where its entries go, then the chunks are parsed in parallel
+/// with `std::from_chars` directly into the output vectors. A malformed number
+/// or an index outside the dimensions of the header throws
+/// `std::invalid_argument` in every build, so the formats built from the
+/// entries can trust them.
+template <NumericOrComplex T>
+MarketData<T> read_market(std::string const& file_name,
+                          unsigned num_threads = 0) {
+    MappedFile file(file_name, true);
+    std::string_view text = file.view();
+#ifdef DEBUG
+    assert(!text.empty() &&
+           "Error in Matrix Market reader: cannot open file.\n");
+#endif
+
+    MarketData<T> data;
+    size_t body = parse_market_header(text, data.header);
+
+    char const* begin = text.data() + body;
+    char const* end = text.data() + text.size();
+    size_t length = static_cast<size_t>(end - begin);
+
+    // A chunk is worth a thread only if it holds a few thousand entries.
+    size_t num_parts = std::min<size_t>(resolve_threads(num_threads),
+                                        length / (32 * parallel_grain) + 1);
+    std::vector<char const*> bounds =
+        split_market_entries(begin, end, num_parts);
+
+    std::vector<size_t> offsets(num_parts + 1, 0);
+    parallel_for(num_parts, [&](size_t k) {
+        offsets[k + 1] = count_market_entries(bounds[k], bounds[k + 1]);
+    });
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+#ifdef DEBUG
+    assert(offsets.back() == data.header.entries &&
+           "Error in Matrix Market reader: wrong number of entries.\n");
+#endif
+
+    data.rows.resize(offsets.back());
+    data.columns.resize(offsets.back());
+    data.values.resize(offsets.back());
+
+    parallel_for(num_parts, [&](size_t k) {
+        parse_market_entries(bounds[k], bounds[k + 1], data, offsets[k]);
+    });
+
+    return data;
+}
+
+/// @brief Reads one of the parts of a Matrix Market file in coordinate
+/// format, e.g. the share of a process of a distributed reader.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @param file_name The name of the file.
+/// @param part The index of the part to read.
+/// @param num_parts The number of parts.
+/// @return The header and the entries of the part.
+/// @details The entries are split as by `split_market_entries`, so the parts
+/// have about the same length and together hold every entry once. The file
+/// is memory mapped and only the header and the part are read, so each of
+/// `num_parts` readers touches about `1 / num_parts` of the file.
+template <NumericOrComplex T>
+MarketData<T> read_market_part(std::string const& file_name, size_t part,
+                               size_t num_parts) {
+    MappedFile file(file_name, true);
+    std::string_view text = file.view();
+#ifdef DEBUG
+    assert(!text.empty() &&
+           "Error in Matrix Market reader: cannot open file.\n");
+    assert(part < num_parts &&
+           "Error in Matrix Market reader: part out of bounds.\n");
+#endif
+
+    MarketData<T> data;
+    size_t body = parse_market_header(text, data.header);
+
+    std::vector<char const*> bounds = split_market_entries(
+        text.data() + body, text.data() + text.size(), num_parts);
+
+    size_t count = count_market_entries(bounds[part], bounds[part + 1]);
+    data.rows.resize(count);
+    data.columns.resize(count);
+    data.values.resize(count);
+    parse_market_entries(bounds[part], bounds[part + 1], data, 0);
+
+    return data;
+}
+
+/// @brief Gets the value of the entry implied by the symmetry of the file.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @param value The value of the stored entry.
+/// @param symmetry The symmetry of the file.
+/// @return The value of the mirrored entry.
+template <NumericOrComplex T>
+T mirrored_value(T const& value, MarketSymmetry symmetry) {
+    if (symmetry == MarketSymmetry::SkewSymmetric) return -value;
+    if constexpr (is_complex<T>::value) {
+        if (symmetry == MarketSymmetry::Hermitian) return std::conj(value);
+    }
+    return value;
+}
+
+/// @brief Builds YALE-like compressed vectors from the entries of a Matrix
+/// Market file.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam P The type of the inner indexes.
+/// @tparam I The type of the outer indexes.
+/// @param data The parsed entries.
+/// @param num_lines The number of lines of the matrix.
+/// @param inner The inner index vector, i.e. the beginning of each line.
+/// @param outer The outer index vector.
+/// @param values The values vector.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @details The entries are placed with a counting sort on their line, adding
+/// the mirrored entries if the file is not general, then the lines that are
+/// not already sorted are sorted in parallel, split so that each thread gets
+/// the same number of elements.
+template <NumericOrComplex T, StorageOrder S, typename P, typename I>
+void market_to_compressed(MarketData<T> const& data, size_t num_lines,
+                          std::vector<P>& inner, std::vector<I>& outer,
+                          std::vector<T>& values, unsigned num_threads = 0) {
+    bool general = data.header.symmetry == MarketSymmetry::General;
+    auto const& lines = (S == rowMajor) ? data.rows : data.columns;
+    auto const& others = (S == rowMajor) ? data.columns : data.rows;
+
+    inner.assign(num_lines + 1, 0);
+    for (size_t k = 0; k < lines.size(); ++k) {
+        inner[lines[k] + 1]++;
+        if (!general && lines[k] != others[k]) inner[others[k] + 1]++;
+    }
+    std::partial_sum(inner.begin(), inner.end(), inner.begin());
+
+    outer.resize(inner.back());
+    values.resize(inner.back());
+
+    std::vector<size_t> next(inner.begin(), inner.end() - 1);
+    for (size_t k = 0; k < lines.size(); ++k) {
+        size_t position = next[lines[k]]++;
+        outer[position] = static_cast<I>(others[k]);
+        values[position] = data.values[k];
+
+        if (!general && lines[k] != others[k]) {
+            position = next[others[k]]++;
+            outer[position] = static_cast<I>(lines[k]);
+            values[position] =
+                mirrored_value(data.values[k], data.header.symmetry);
+        }
+    }
+
+    size_t num_parts =
+        std::min<size_t>(resolve_threads(num_threads),
+                         inner.back() / parallel_grain + 1);
+    auto parts =
+        balanced_partition(std::span<P const>(inner), num_parts);
+
+    parallel_for(num_parts, [&](size_t part) {
+        std::vector<size_t> p;
+        std::vector<I> tempouter;
+        std::vector<T> tempvalues;
+
+        for (size_t l = parts[part]; l < parts[part + 1]; ++l) {
+            auto first = outer.begin() + inner[l];
+            auto last = outer.begin() + inner[l + 1];
+            if (std::is_sorted(first, last)) continue;
+
+            p.resize(last - first);
+            std::iota(p.begin(), p.end(), inner[l]);
+            std::sort(p.begin(), p.end(), [&](size_t a, size_t b) {
+                return outer[a] < outer[b];
+            });
+
+            tempouter.clear();
+            tempvalues.clear();
+            for (size_t k : p) {
+                tempouter.push_back(outer[k]);
+                tempvalues.push_back(values[k]);
+            }
+            std::copy(tempouter.begin(), tempouter.end(), first);
+            std::copy(tempvalues.begin(), tempvalues.end(),
+                      values.begin() + inner[l]);
+        }
+    });
+}
+
+/// @brief Calls a function on every element of YALE-like compressed vectors,
+/// coherently with the storage order.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam F The type of the function.
+/// @param inner The inner index vector, i.e. the beginning of each line.
+/// @param outer The outer index vector.
+/// @param values The values vector.
+/// @param f A callable taking the row index, the column index and the value of
+/// each element.
+template <StorageOrder S, NumericOrComplex T, typename F>
+void for_each_compressed(std::vector<size_t> const& inner,
+                         std::vector<size_t> const& outer,
+                         std::vector<T> const& values, F&& f) {
+    for (size_t line = 0; line + 1 < inner.size(); ++line) {
+        for (size_t k = inner[line]; k < inner[line + 1]; ++k) {
+            if constexpr (S == rowMajor) {
+                f(line, outer[k], values[k]);
+            }
+            else {
+                f(outer[k], line, values[k]);
+            }
+        }
+    }
+}
+
+}  // namespace algebra
+#endif
@@ -0,0 +1,98 @@
+#ifndef NODEARENA_HPP
+#define NODEARENA_HPP
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace algebra {
+
+/// @brief Memory resource carving small blocks from large slabs.
+/// @details Blocks are grouped in classes by their size, rounded up to the
+/// maximum alignment, and freed blocks are kept in a list per class to be
+/// reused by the following allocations of the same class. Slabs grow
+/// geometrically and are only returned to the system by `release`. Larger
+/// or over-aligned blocks are forwarded to the global allocator.
+class NodePool final : public std::pmr::memory_resource {
+   public:
+    NodePool() = default;
+    NodePool(NodePool const&) = delete;
+    NodePool& operator=(NodePool const&) = delete;
+
+    /// @brief Returns all the slabs to the system.
+    ~NodePool() override;
+
+    /// @brief Returns all the slabs to the system, invalidating the blocks
+    /// allocated from them.
+    void release();
+
+   private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void* p, std::size_t bytes,
+                       std::size_t alignment) override;
+    bool do_is_equal(
+        std::pmr::memory_resource const& other) const noexcept override;
+
+    static constexpr std::size_t granularity =
+        alignof(std::max_align_t);  ///< Size and alignment unit of blocks.
+    static constexpr std::size_t num_classes = 16;  ///< Size classes.
+    static constexpr std::size_t first_slab = 1 << 12;  ///< Smallest slab.
+    static constexpr std::size_t last_slab = 1 << 23;   ///< Largest slab.
+
+    std::array<void*, num_classes> free_lists{};  ///< Freed blocks per class.
+    std::vector<void*> slabs;      ///< Slabs allocated so far.
+    std::byte* cursor = nullptr;   ///< First free byte of the current slab.
+    std::byte* limit = nullptr;    ///< End of the current slab.
+    std::size_t next_slab = first_slab;  ///< Size of the next slab.
+};
+
+/// @brief Deleter of the containers built by a `NodeArena`: it does nothing,
+/// since their memory is freed all together by `NodeArena::release`.
+struct ArenaDeleter {
+    /// @brief Does nothing.
+    template <typename C>
+    void operator()(C*) const noexcept {}
+};
+
+/// @brief Arena the nodes of the dynamic formats are carved from.
+/// @details Nodes come from the slabs of a `NodePool`, so building a matrix
+/// with millions of elements takes a few calls to the system allocator. The
+/// containers themselves live in the arena: releasing it frees all the slabs
+/// at once without visiting the nodes, which is safe as long as they hold
+/// trivially destructible elements.
+class NodeArena {
+   public:
+    /// @brief Creates an empty arena.
+    NodeArena();
+
+    NodeArena(NodeArena&&) noexcept = default;
+    NodeArena& operator=(NodeArena&&) noexcept = default;
+
+    /// @brief Builds a container whose nodes are carved from the arena.
+    /// @tparam C The type of the container, using a polymorphic allocator.
+    /// @tparam Args The types of the arguments of the constructor.
+    /// @param args The arguments of the constructor, the allocator excluded.
+    /// @return A pointer to the container, valid until `release` is called.
+    template <typename C, typename... Args>
+    C* create(Args&&... args) {
+        static_assert(
+            std::is_trivially_destructible_v<typename C::value_type>,
+            "Error in NodeArena: the elements must be trivially "
+            "destructible.");
+        std::pmr::polymorphic_allocator<> allocator{pool.get()};
+        return allocator.new_object<C>(std::forward<Args>(args)...);
+    }
+
+    /// @brief Frees all the slabs, invalidating the containers built so far.
+    void release();
+
+   private:
+    std::unique_ptr<NodePool> pool;  ///< Pool the nodes are taken from.
+};
+
+}  // namespace algebra
+#endif
@@ -0,0 +1,122 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "Concepts.hpp"
+
+namespace algebra {
+
+/// @brief Minimum number of non-zero elements assigned to a thread, smaller
+/// workloads are not worth the cost of spawning it.
+inline constexpr std::size_t parallel_grain = 4096;
+
+/// @brief Resolves the number of threads requested by the user.
+/// @param num_threads The requested number of threads, zero means as many as
+/// the hardware supports.
+/// @return The number of threads to use, always at least one.
+inline unsigned resolve_threads(unsigned num_threads) {
+    if (num_threads == 0) {
+        num_threads = std::thread::hardware_concurrency();
+    }
+    return std::max(num_threads, 1u);
+}
+
+/// @brief Splits the lines of a compressed matrix into contiguous blocks
+/// holding roughly the same number of non-zero elements.
+/// @tparam I The type of the inner indexes.
+/// @param inner_indices The inner index vector, i.e. the prefix sums of the
+/// line lengths.
+/// @param num_parts The number of blocks.
+/// @return A vector of `num_parts + 1` boundaries, block `k` covers the lines
+/// in `[b[k], b[k + 1])`.
+/// @details The boundaries are found by binary searching the prefix sums, so
+/// long lines don't leave the other threads idle as a split by line count
+/// would.
+template <typename I>
+std::vector<std::size_t> balanced_partition(std::span<I const> inner_indices,
+                                            std::size_t num_parts) {
+    std::size_t num_lines =
+        inner_indices.empty() ? 0 : inner_indices.size() - 1;
+    std::size_t nnz = inner_indices.empty() ? 0 : inner_indices.back();
+    std::vector<std::size_t> bounds(num_parts + 1, num_lines);
+    bounds[0] = 0;
+
+    for (std::size_t k = 1; k < num_parts; ++k) {
+        // Same as nnz * k / num_parts, without the risk of overflowing.
+        std::size_t target =
+            nnz / num_parts * k + nnz % num_parts * k / num_parts;
+        auto it = std::lower_bound(inner_indices.begin(),
+                                   inner_indices.begin() + num_lines, target);
+        std::size_t line = static_cast<std::size_t>(it - inner_indices.begin());
+        bounds[k] = std::max(bounds[k - 1], line);
+    }
+
+    return bounds;
+}
+
+/// @brief Runs `f(k)` for every `k` in `[0, num_parts)`, each on its own
+/// thread.
+/// @tparam F The type of the callable.
+/// @param num_parts The number of tasks.
+/// @param f The callable taking the index of the task.
+/// @details Task zero runs on the calling thread, the function returns when
+/// all the tasks are completed. An exception thrown by a task is caught on
+/// its thread and rethrown once every task is completed, the one of the
+/// lowest task first.
+template <typename F>
+void parallel_for(std::size_t num_parts, F&& f) {
+    std::vector<std::exception_ptr> errors(num_parts);
+    auto run = [&f, &errors](std::size_t k) {
+        try {
+            f(k);
+        } catch (...) {
+            errors[k] = std::current_exception();
+        }
+    };
+
+    {
+        std::vector<std::jthread> workers;
+        workers.reserve(num_parts > 0 ? num_parts - 1 : 0);
+
+        for (std::size_t k = 1; k < num_parts; ++k) {
+            workers.emplace_back([&run, k]() { run(k); });
+        }
+        if (num_parts > 0) run(0);
+    }
+
+    for (std::exception_ptr const& error : errors) {
+        if (error) std::rethrow_exception(error);
+    }
+}
+
+/// @brief Adds a value to an element shared by several threads, e.g. the
+/// value of a matrix element receiving contributions from many of them.
+/// @tparam T The type of the element (numeric or complex).
+/// @param target The element.
+/// @param value The value to add.
+/// @details Complex elements are updated one part at a time, which is enough
+/// for sums: each part is only ever read and written by atomic operations.
+/// The order is relaxed, the threads are joined before the result is read.
+template <typename T>
+void atomic_add(T& target, T const& value) {
+    if constexpr (is_complex<T>::value) {
+        using R = typename T::value_type;
+        R* parts = reinterpret_cast<R*>(&target);
+        atomic_add(parts[0], value.real());
+        atomic_add(parts[1], value.imag());
+    }
+    else {
+        std::atomic_ref<T>(target).fetch_add(value,
+                                             std::memory_order_relaxed);
+    }
+}
+
+}  // namespace algebra
+#endif
@@ -0,0 +1,105 @@
+#ifndef PROFILING_HPP
+#define PROFILING_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace algebra {
+
+/// @brief Counters of an operation of a format, updated by the instrumented
+/// code when `PROFILE` is defined.
+struct ProfileCounter {
+    char const* operation = nullptr;  ///< The name of the operation.
+    char const* format = nullptr;     ///< The name of the format.
+    std::atomic<std::uint64_t> calls{0};        ///< Number of calls.
+    std::atomic<std::uint64_t> nanoseconds{0};  ///< Time spent in the calls.
+    std::atomic<std::uint64_t> bytes{0};        ///< Bytes read or written.
+};
+
+/// @brief Copy of the counters of an operation of a format.
+struct ProfileEntry {
+    std::string operation;          ///< The name of the operation.
+    std::string format;             ///< The name of the format.
+    std::uint64_t calls = 0;        ///< Number of calls.
+    std::uint64_t nanoseconds = 0;  ///< Time spent in the calls.
+    std::uint64_t bytes = 0;        ///< Estimate of the bytes touched.
+};
+
+/// @brief Copy of all the counters, taken at once.
+struct ProfileSnapshot {
+    std::vector<ProfileEntry> entries;  ///< The counters, by operation.
+
+    /// @brief Formats the counters as a JSON array of objects, one for each
+    /// operation of each format.
+    /// @return The JSON text.
+    std::string to_json() const;
+};
+
+/// @brief Gets the counters of an operation of a format, creating them on
+/// the first call.
+/// @param operation The name of the operation, a string literal.
+/// @param format The name of the format, a string literal.
+/// @return The counters, alive until the end of the program.
+ProfileCounter& profile_counter(char const* operation, char const* format);
+
+/// @brief Copies all the counters.
+/// @return The snapshot, empty if the code wasn't built with `PROFILE`.
+ProfileSnapshot profile_snapshot();
+
+/// @brief Sets all the counters to zero.
+void profile_reset();
+
+/// @brief Adds the elapsed time and the bytes of a call to its counters when
+/// it goes out of scope.
+class ProfileScope {
+   public:
+    /// @brief Starts timing a call.
+    /// @param counter The counters of the operation.
+    explicit ProfileScope(ProfileCounter& counter)
+        : counter(counter), start(std::chrono::steady_clock::now()) {}
+
+    ProfileScope(ProfileScope const&) = delete;
+    ProfileScope& operator=(ProfileScope const&) = delete;
+
+    /// @brief Adds the call to the counters.
+    ~ProfileScope() {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        counter.calls.fetch_add(1, std::memory_order_relaxed);
+        counter.nanoseconds.fetch_add(
+            static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                    .count()),
+            std::memory_order_relaxed);
+        counter.bytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    /// @brief Adds bytes touched by the call.
+    /// @param count The number of bytes.
+    void add_bytes(std::uint64_t count) { bytes += count; }
+
+   private:
+    ProfileCounter& counter;  ///< The counters of the operation.
+    std::chrono::steady_clock::time_point start;  ///< Start of the call.
+    std::uint64_t bytes = 0;  ///< Bytes touched so far.
+};
+
+}  // namespace algebra
+
+#ifdef PROFILE
+/// @brief Times the rest of the enclosing block as a call of an operation of
+/// a format.
+#define PROFILE_SCOPE(operation, format)                  \
+    static ::algebra::ProfileCounter& profile_counter_ =  \
+        ::algebra::profile_counter(operation, format);    \
+    ::algebra::ProfileScope profile_scope_(profile_counter_)
+/// @brief Adds bytes to the call timed by `PROFILE_SCOPE` in the same block.
+#define PROFILE_BYTES(count) profile_scope_.add_bytes(count)
+#else
+#define PROFILE_SCOPE(operation, format) ((void)0)
+#define PROFILE_BYTES(count) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,245 @@
+#ifndef REORDERING_HPP
+#define REORDERING_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "CompressedKernels.hpp"
+#include "Concepts.hpp"
+
+namespace algebra {
+
+/// @brief Builds the adjacency structure of the graph of `A + A^T`, without
+/// self loops, from the YALE-like compressed arrays of a square matrix.
+/// @tparam P The type of the inner indexes.
+/// @tparam I The type of the outer indexes.
+/// @param inner The inner index array, i.e. the beginning of each line.
+/// @param outer The outer index array.
+/// @param adj_inner The beginning of the neighbours of each vertex,
+/// overwritten.
+/// @param adj_outer The neighbours of each vertex, sorted, overwritten.
+/// @details The pattern is transposed by a counting sort, then each line is
+/// merged with the same line of the transpose, so the cost is `O(nnz + n)`.
+/// The graph is the same in both storage orders.
+template <typename P, typename I>
+void symmetric_adjacency(std::span<P const> inner, std::span<I const> outer,
+                         std::vector<size_t>& adj_inner,
+                         std::vector<size_t>& adj_outer) {
+    const size_t n = inner.empty() ? 0 : inner.size() - 1;
+
+    std::vector<size_t> t_inner(n + 1, 0), t_outer(outer.size());
+    for (auto const& index : outer) t_inner[index + 1]++;
+    for (size_t v = 0; v < n; ++v) t_inner[v + 1] += t_inner[v];
+
+    std::vector<size_t> next(t_inner.begin(), t_inner.end() - 1);
+    for (size_t line = 0; line < n; ++line) {
+        for (size_t k = inner[line]; k < inner[line + 1]; ++k) {
+            t_outer[next[outer[k]]++] = line;
+        }
+    }
+
+    adj_inner.assign(n + 1, 0);
+    adj_outer.clear();
+    adj_outer.reserve(2 * outer.size());
+    for (size_t v = 0; v < n; ++v) {
+        size_t a = inner[v], a_end = inner[v + 1];
+        size_t b = t_inner[v], b_end = t_inner[v + 1];
+
+        while (a < a_end || b < b_end) {
+            size_t u;
+            if (b == b_end || (a < a_end && outer[a] < t_outer[b])) {
+                u = outer[a++];
+            }
+            else if (a == a_end || t_outer[b] < outer[a]) {
+                u = t_outer[b++];
+            }
+            else {
+                u = t_outer[b++];
+                ++a;
+            }
+            if (u != v) adj_outer.push_back(u);
+        }
+        adj_inner[v + 1] = adj_outer.size();
+    }
+}
+
+/// @brief Computes a reverse Cuthill-McKee ordering of a square matrix from
+/// its YALE-like compressed arrays.
+/// @tparam P The type of the inner indexes.
+/// @tparam I The type of the outer indexes.
+/// @param inner The inner index array, i.e. the beginning of each line.
+/// @param outer The outer index array.
+/// @return The permutation `perm`, where `perm[i]` is the old index of the
+/// line that becomes line `i`.
+/// @details The ordering is computed on the graph of `A + A^T`, so the
+/// pattern needn't be symmetric. Each connected component is visited
+/// breadth first, adding the neighbours of each vertex by increasing
+/// degree, from a pseudo-peripheral vertex found with the heuristic of
+/// George and Liu: starting from the first vertex of the component, the
+/// search moves to a vertex of minimum degree in the last level of the
+/// current one as long as this increases the number of levels. The ordering
+/// is then reversed, which usually reduces the fill and keeps the same
+/// bandwidth. The cost is `O(nnz log d)`, `d` being the maximum degree.
+template <typename P, typename I>
+std::vector<size_t> reverse_cuthill_mckee(std::span<P const> inner,
+                                          std::span<I const> outer) {
+    const size_t n = inner.empty() ? 0 : inner.size() - 1;
+    std::vector<size_t> adj_inner, adj_outer;
+    symmetric_adjacency(inner, outer, adj_inner, adj_outer);
+
+    auto degree = [&](size_t v) { return adj_inner[v + 1] - adj_inner[v]; };
+
+    // Breadth first search from root writing the visited vertexes into
+    // levels, marking them with stamp; returns the number of levels and
+    // leaves the last one at the end of levels from position last.
+    std::vector<size_t> mark(n, 0), levels;
+    size_t stamp = 0;
+    auto level_structure = [&](size_t root, size_t& last) {
+        ++stamp;
+        levels.clear();
+        levels.push_back(root);
+        mark[root] = stamp;
+
+        size_t num_levels = 0, begin = 0;
+        while (begin < levels.size()) {
+            size_t end = levels.size();
+            for (size_t k = begin; k < end; ++k) {
+                size_t v = levels[k];
+                for (size_t a = adj_inner[v]; a < adj_inner[v + 1]; ++a) {
+                    size_t u = adj_outer[a];
+                    if (mark[u] != stamp) {
+                        mark[u] = stamp;
+                        levels.push_back(u);
+                    }
+                }
+            }
+            last = begin;
+            begin = end;
+            ++num_levels;
+        }
+        return num_levels;
+    };
+
+    std::vector<size_t> perm;
+    perm.reserve(n);
+    std::vector<bool> visited(n, false);
+
+    for (size_t first = 0; first < n; ++first) {
+        if (visited[first]) continue;
+
+        size_t root = first, last = 0;
+        size_t num_levels = level_structure(root, last);
+        while (true) {
+            size_t candidate = levels[last];
+            for (size_t k = last; k < levels.size(); ++k) {
+                if (degree(levels[k]) < degree(candidate)) {
+                    candidate = levels[k];
+                }
+            }
+            size_t candidate_levels = level_structure(candidate, last);
+            if (candidate_levels <= num_levels) break;
+            root = candidate;
+            num_levels = candidate_levels;
+        }
+
+        size_t begin = perm.size();
+        perm.push_back(root);
+        visited[root] = true;
+        for (size_t k = begin; k < perm.size(); ++k) {
+            size_t v = perm[k];
+            size_t added = perm.size();
+            for (size_t a = adj_inner[v]; a < adj_inner[v + 1]; ++a) {
+                size_t u = adj_outer[a];
+                if (!visited[u]) {
+                    visited[u] = true;
+                    perm.push_back(u);
+                }
+            }
+            std::stable_sort(perm.begin() + added, perm.end(),
+                             [&](size_t a, size_t b) {
+                                 return degree(a) < degree(b);
+                             });
+        }
+    }
+
+    std::reverse(perm.begin(), perm.end());
+    return perm;
+}
+
+/// @brief Applies a symmetric permutation to YALE-like compressed arrays of a
+/// square matrix, i.e. computes the arrays of `B = P * A * P^T`, with `B(i,
+/// j) = A(perm[i], perm[j])`.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam P The type of the inner indexes.
+/// @tparam I The type of the outer indexes.
+/// @tparam P2 The type of the inner indexes of the result.
+/// @tparam I2 The type of the outer indexes of the result.
+/// @param inner The inner index array, i.e. the beginning of each line.
+/// @param outer The outer index array.
+/// @param values The values array.
+/// @param perm The permutation, `perm[i]` is the old index of line `i`.
+/// @param p_inner The inner index array of the result, overwritten.
+/// @param p_outer The outer index array of the result, overwritten.
+/// @param p_values The values array of the result, overwritten.
+/// @details Rows and columns are permuted alike, so the storage order doesn't
+/// matter. The lines are visited in their new order and their elements
+/// scattered, by counting sort on the new index, into the arrays of `B` in
+/// the opposite storage order, whose lines come out sorted; transposing them
+/// back with `compressed_transpose` sorts the lines of `B`. Both passes cost
+/// `O(nnz + n)` and no comparison sort is needed.
+template <NumericOrComplex T, typename P, typename I, typename P2,
+          typename I2>
+void compressed_permute(std::span<P const> inner, std::span<I const> outer,
+                        std::span<T const> values,
+                        std::span<size_t const> perm, std::vector<P2>& p_inner,
+                        std::vector<I2>& p_outer, std::vector<T>& p_values) {
+    const size_t n = perm.size();
+    std::vector<size_t> inverse(n);
+    for (size_t i = 0; i < n; ++i) inverse[perm[i]] = i;
+
+    std::vector<size_t> t_inner(n + 1, 0), t_outer(values.size());
+    std::vector<T> t_values(values.size());
+    for (auto const& index : outer) t_inner[inverse[index] + 1]++;
+    for (size_t i = 0; i < n; ++i) t_inner[i + 1] += t_inner[i];
+
+    std::vector<size_t> next(t_inner.begin(), t_inner.end() - 1);
+    for (size_t i = 0; i < n; ++i) {
+        size_t line = perm[i];
+        for (size_t k = inner[line]; k < inner[line + 1]; ++k) {
+            size_t position = next[inverse[outer[k]]]++;
+            t_outer[position] = i;
+            t_values[position] = values[k];
+        }
+    }
+
+    compressed_transpose(std::span<size_t const>(t_inner),
+                         std::span<size_t const>(t_outer),
+                         std::span<T const>(t_values), n, p_inner, p_outer,
+                         p_values);
+}
+
+/// @brief Computes the bandwidth of a matrix from its YALE-like compressed
+/// arrays, i.e. the largest distance of an element from the diagonal.
+/// @tparam P The type of the inner indexes.
+/// @tparam I The type of the outer indexes.
+/// @param inner The inner index array, i.e. the beginning of each line.
+/// @param outer The outer index array.
+/// @return The bandwidth, zero for a diagonal or empty matrix.
+template <typename P, typename I>
+size_t compressed_bandwidth(std::span<P const> inner,
+                            std::span<I const> outer) {
+    size_t bandwidth = 0;
+    for (size_t line = 0; line + 1 < inner.size(); ++line) {
+        for (size_t k = inner[line]; k < inner[line + 1]; ++k) {
+            size_t index = outer[k];
+            bandwidth = std::max(bandwidth,
+                                 index > line ? index - line : line - index);
+        }
+    }
+    return bandwidth;
+}
+
+}  // namespace algebra
+#endif
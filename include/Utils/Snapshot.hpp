@@ -0,0 +1,222 @@
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "Comparators.hpp"
+#include "Concepts.hpp"
+
+using namespace comparators;
+namespace algebra {
+
+/// @brief Version of the binary snapshot format written by `write_snapshot`.
+inline constexpr std::uint32_t snapshot_version = 1;
+
+/// @brief Alignment in bytes of the arrays inside a snapshot, the file is
+/// mapped at a page boundary so the arrays end up aligned in memory too.
+inline constexpr std::size_t snapshot_alignment = 64;
+
+/// @brief Value written in the header by the producer to detect files written
+/// on a machine with a different byte order.
+inline constexpr std::uint32_t snapshot_byte_order = 0x01020304;
+
+/// @brief Header of a binary snapshot of a YALE matrix.
+/// @details The header is followed by the inner index, outer index and values
+/// arrays, each one starting at the given offset from the beginning of the
+/// file.
+struct SnapshotHeader {
+    char magic[8];                ///< Always "YALESNP".
+    std::uint32_t version;        ///< Version of the format.
+    std::uint32_t byte_order;     ///< Always `snapshot_byte_order`.
+    std::uint32_t storage_order;  ///< The `StorageOrder` of the matrix.
+    std::uint32_t value_type;     ///< Code of the type of the values.
+    std::uint32_t inner_width;    ///< Size in bytes of an inner index.
+    std::uint32_t outer_width;    ///< Size in bytes of an outer index.
+    std::uint64_t rows;           ///< Number of rows.
+    std::uint64_t columns;        ///< Number of columns.
+    std::uint64_t nnz;            ///< Number of non-zero elements.
+    std::uint64_t inner_offset;   ///< Offset of the inner index array.
+    std::uint64_t outer_offset;   ///< Offset of the outer index array.
+    std::uint64_t values_offset;  ///< Offset of the values array.
+    std::uint64_t file_size;      ///< Size of the whole file.
+};
+
+/// @brief Gets the code identifying a value type inside a snapshot.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @return The kind of the type (floating point, signed, unsigned, complex)
+/// in the second byte and its size in the first one.
+template <NumericOrComplex T>
+constexpr std::uint32_t snapshot_value_type() {
+    if constexpr (is_complex<T>::value) {
+        return 0x400 | sizeof(typename T::value_type);
+    }
+    else if constexpr (std::is_floating_point_v<T>) {
+        return 0x100 | sizeof(T);
+    }
+    else if constexpr (std::is_signed_v<T>) {
+        return 0x200 | sizeof(T);
+    }
+    else {
+        return 0x300 | sizeof(T);
+    }
+}
+
+/// @brief Rounds an offset up to the alignment of the snapshot arrays.
+/// @param offset The offset to round.
+/// @return The smallest aligned offset not smaller than `offset`.
+constexpr std::uint64_t snapshot_align(std::uint64_t offset) {
+    return (offset + snapshot_alignment - 1) / snapshot_alignment *
+           snapshot_alignment;
+}
+
+/// @brief Builds the header of a snapshot.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam P The type of the inner indexes.
+/// @tparam I The type of the outer indexes.
+/// @param rows The number of rows.
+/// @param columns The number of columns.
+/// @param inner_size The number of inner indexes.
+/// @param nnz The number of non-zero elements.
+/// @return The header, with the offsets of the arrays filled in.
+template <StorageOrder S, NumericOrComplex T, typename P, typename I>
+SnapshotHeader make_snapshot_header(std::size_t rows, std::size_t columns,
+                                    std::size_t inner_size, std::size_t nnz) {
+    SnapshotHeader header{};
+    std::memcpy(header.magic, "YALESNP", 8);
+    header.version = snapshot_version;
+    header.byte_order = snapshot_byte_order;
+    header.storage_order = static_cast<std::uint32_t>(S);
+    header.value_type = snapshot_value_type<T>();
+    header.inner_width = sizeof(P);
+    header.outer_width = sizeof(I);
+    header.rows = rows;
+    header.columns = columns;
+    header.nnz = nnz;
+    header.inner_offset = snapshot_align(sizeof(SnapshotHeader));
+    header.outer_offset =
+        snapshot_align(header.inner_offset + inner_size * sizeof(P));
+    header.values_offset =
+        snapshot_align(header.outer_offset + nnz * sizeof(I));
+    header.file_size = header.values_offset + nnz * sizeof(T);
+    return header;
+}
+
+/// @brief Checks that the header of a snapshot matches the given types.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam P The type of the inner indexes.
+/// @tparam I The type of the outer indexes.
+/// @param header The header read from the file.
+/// @param size The size in bytes of the file.
+/// @return True if the header matches the types and the file is complete.
+template <StorageOrder S, NumericOrComplex T, typename P, typename I>
+bool check_snapshot_header(SnapshotHeader const& header, std::size_t size) {
+    size_t num_lines = (S == rowMajor) ? header.rows : header.columns;
+    SnapshotHeader expected = make_snapshot_header<S, T, P, I>(
+        header.rows, header.columns, num_lines + 1, header.nnz);
+
+    return std::memcmp(header.magic, expected.magic, 8) == 0 &&
+           header.version == expected.version &&
+           header.byte_order == expected.byte_order &&
+           header.storage_order == expected.storage_order &&
+           header.value_type == expected.value_type &&
+           header.inner_width == expected.inner_width &&
+           header.outer_width == expected.outer_width &&
+           header.inner_offset == expected.inner_offset &&
+           header.outer_offset == expected.outer_offset &&
+           header.values_offset == expected.values_offset &&
+           header.file_size == expected.file_size && size >= header.file_size;
+}
+
+/// @brief Checks that a snapshot can be used in place as a matrix of the
+/// given types.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam P The type of the inner indexes.
+/// @tparam I The type of the outer indexes.
+/// @param text The content of the file.
+/// @return True if the header matches the types and the file is complete.
+template <StorageOrder S, NumericOrComplex T, typename P, typename I>
+bool check_snapshot(std::string_view text) {
+    if (text.size() < sizeof(SnapshotHeader)) return false;
+
+    SnapshotHeader header;
+    std::memcpy(&header, text.data(), sizeof(SnapshotHeader));
+    return check_snapshot_header<S, T, P, I>(header, text.size());
+}
+
+/// @brief Checks that the inner index array of a snapshot is consistent with
+/// its header.
+/// @tparam P The type of the inner indexes.
+/// @param inner The inner index array, i.e. the beginning of each line.
+/// @param nnz The number of non-zero elements declared in the header.
+/// @return True if the array starts at zero, ends at `nnz` and never
+/// decreases, so that every line lies inside the other two arrays.
+/// @details The check is linear in the number of lines. The outer indexes
+/// and the values are trusted: they are not read, since that would cost as
+/// much as loading the matrix.
+template <typename P>
+bool check_snapshot_lines(std::span<P const> inner, std::uint64_t nnz) {
+    return !inner.empty() && inner.front() == 0 && inner.back() == nnz &&
+           std::is_sorted(inner.begin(), inner.end());
+}
+
+/// @brief Writes a binary snapshot of YALE-like compressed arrays.
+/// @tparam S The storage order (row-major or column-major).
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam P The type of the inner indexes.
+/// @tparam I The type of the outer indexes.
+/// @param file_name The name of the file to write.
+/// @param rows The number of rows.
+/// @param columns The number of columns.
+/// @param inner The inner index array.
+/// @param outer The outer index array.
+/// @param values The values array.
+/// @details The arrays are written as they are in memory, after the header
+/// and padded to `snapshot_alignment`, so that they can be mapped and used in
+/// place.
+template <StorageOrder S, NumericOrComplex T, typename P, typename I>
+void write_snapshot(std::string const& file_name, std::size_t rows,
+                    std::size_t columns, std::span<P const> inner,
+                    std::span<I const> outer, std::span<T const> values) {
+    SnapshotHeader header = make_snapshot_header<S, T, P, I>(
+        rows, columns, inner.size(), values.size());
+
+    std::ofstream file(file_name, std::ios::binary | std::ios::trunc);
+#ifdef DEBUG
+    assert(file && "Error in snapshot writer: cannot open file.\n");
+#endif
+
+    auto pad_to = [&](std::uint64_t offset) {
+        static constexpr char zeros[snapshot_alignment] = {};
+        std::uint64_t position = static_cast<std::uint64_t>(file.tellp());
+        file.write(zeros, static_cast<std::streamsize>(offset - position));
+    };
+
+    file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+    pad_to(header.inner_offset);
+    file.write(reinterpret_cast<char const*>(inner.data()),
+               static_cast<std::streamsize>(inner.size_bytes()));
+    pad_to(header.outer_offset);
+    file.write(reinterpret_cast<char const*>(outer.data()),
+               static_cast<std::streamsize>(outer.size_bytes()));
+    pad_to(header.values_offset);
+    file.write(reinterpret_cast<char const*>(values.data()),
+               static_cast<std::streamsize>(values.size_bytes()));
+
+#ifdef DEBUG
+    assert(file && "Error in snapshot writer: write failed.\n");
+#endif
+}
+
+}  // namespace algebra
+#endif
@@ -0,0 +1,300 @@
+#ifndef SPGEMMKERNELS_HPP
+#define SPGEMMKERNELS_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "Concepts.hpp"
+#include "Parallel.hpp"
+
+namespace algebra {
+
+/// @brief Sparse accumulator for one row of a sparse matrix-matrix product.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @details Rows producing many products, compared to the number of columns,
+/// are accumulated in a dense array indexed by the column, the other ones in
+/// a small open addressing hash table sized on the number of products, so
+/// that short rows don't pay for the width of the matrix. The dense array is
+/// allocated the first time it is needed and never cleared: a marker, unique
+/// to each row, tells the columns touched by the current row.
+template <NumericOrComplex T>
+class RowAccumulator {
+   public:
+    /// @brief Constructs an empty accumulator.
+    /// @param num_columns The number of columns of the product.
+    explicit RowAccumulator(size_t num_columns) : num_columns(num_columns) {}
+
+    /// @brief Starts a new row, discarding the previous one.
+    /// @param work An upper bound of the number of products of the row.
+    void begin(size_t work) {
+        touched.clear();
+        dense = work > num_columns / dense_ratio;
+
+        if (dense) {
+            if (marker.empty()) {
+                marker.assign(num_columns, npos);
+                dense_values.resize(num_columns);
+            }
+            ++tag;
+        }
+        else {
+            size_t capacity = std::bit_ceil(std::max<size_t>(2 * work, 16));
+            shift = 64 - static_cast<unsigned>(std::countr_zero(capacity));
+            keys.assign(capacity, npos);
+            hash_values.resize(capacity);
+        }
+    }
+
+    /// @brief Marks a column as stored, without computing any value.
+    /// @param j The column index.
+    void mark(size_t j) { insert<false>(j, T{}); }
+
+    /// @brief Adds a product to the element of a column.
+    /// @param j The column index.
+    /// @param value The product.
+    void add(size_t j, T const& value) { insert<true>(j, value); }
+
+    /// @brief Gets the number of columns stored by the current row.
+    /// @return The number of columns.
+    size_t size() const { return touched.size(); }
+
+    /// @brief Writes the current row sorted by column, the values stored in
+    /// the hash table are found by probing it again.
+    /// @tparam I The type of the column indexes.
+    /// @param outer The output column indexes, `size()` of them.
+    /// @param values The output values, `size()` of them.
+    template <typename I>
+    void flush(I* outer, T* values) {
+        std::sort(touched.begin(), touched.end());
+        for (size_t k = 0; k < touched.size(); ++k) {
+            outer[k] = static_cast<I>(touched[k]);
+            values[k] = dense ? dense_values[touched[k]]
+                              : hash_values[find_slot(touched[k])];
+        }
+    }
+
+   private:
+    /// @brief Inserts a column, adding the value if it's needed.
+    /// @tparam Numeric True if the value has to be accumulated.
+    /// @param j The column index.
+    /// @param value The product.
+    template <bool Numeric>
+    void insert(size_t j, T const& value) {
+        if (dense) {
+            if (marker[j] != tag) {
+                marker[j] = tag;
+                touched.push_back(j);
+                if constexpr (Numeric) dense_values[j] = value;
+            }
+            else if constexpr (Numeric) {
+                dense_values[j] += value;
+            }
+            return;
+        }
+
+        size_t slot = find_slot(j);
+        if (keys[slot] == npos) {
+            keys[slot] = j;
+            touched.push_back(j);
+            if constexpr (Numeric) hash_values[slot] = value;
+        }
+        else if constexpr (Numeric) {
+            hash_values[slot] += value;
+        }
+    }
+
+    /// @brief Finds the hash table slot of a column.
+    /// @param j The column index.
+    /// @return The slot holding the column or, if it's not stored, the empty
+    /// slot ending its cluster.
+    size_t find_slot(size_t j) const {
+        const size_t mask = keys.size() - 1;
+        size_t slot = static_cast<size_t>(
+            (static_cast<std::uint64_t>(j) * 0x9E3779B97F4A7C15ull) >> shift);
+        while (keys[slot] != npos && keys[slot] != j) {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+    /// @brief Rows with more products than the number of columns divided by
+    /// this ratio use the dense array.
+    static constexpr size_t dense_ratio = 16;
+    static constexpr size_t npos = ~size_t{0};  ///< Empty slot or marker.
+
+    size_t num_columns;              ///< Number of columns of the product.
+    bool dense = false;              ///< True if the row uses the dense array.
+    std::vector<size_t> touched;     ///< Columns of the row.
+    std::vector<size_t> marker;      ///< Last row touching each column.
+    std::vector<T> dense_values;     ///< Dense values, indexed by column.
+    size_t tag = 0;                  ///< Marker of the current row.
+    std::vector<size_t> keys;        ///< Columns of the hash table slots.
+    std::vector<T> hash_values;      ///< Values of the hash table slots.
+    unsigned shift = 64;  ///< 64 minus the log2 of the hash table capacity.
+};
+
+/// @brief Computes the sparse matrix-matrix product `C = A * B` on row-major
+/// YALE-like compressed arrays with Gustavson's algorithm.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam PA The type of the inner indexes of `A`.
+/// @tparam IA The type of the outer indexes of `A`.
+/// @tparam PB The type of the inner indexes of `B`.
+/// @tparam IB The type of the outer indexes of `B`.
+/// @tparam PC The type of the inner indexes of `C`.
+/// @tparam IC The type of the outer indexes of `C`.
+/// @param a_inner The inner index array of `A`.
+/// @param a_outer The outer index array of `A`.
+/// @param a_values The values array of `A`.
+/// @param b_inner The inner index array of `B`.
+/// @param b_outer The outer index array of `B`.
+/// @param b_values The values array of `B`.
+/// @param num_columns The number of columns of `B`.
+/// @param c_inner The inner index array of `C`, overwritten.
+/// @param c_outer The outer index array of `C`, overwritten.
+/// @param c_values The values array of `C`, overwritten.
+/// @param num_threads The number of threads, zero means as many as the
+/// hardware supports.
+/// @details Row `i` of `C` is the combination of the rows of `B` selected by
+/// the elements of row `i` of `A`. A symbolic phase counts the columns of
+/// every row of `C`, so that its arrays are allocated once with their exact
+/// size, and a numeric phase computes the values and writes each row sorted
+/// in place. Both phases are split over the rows of `C` in blocks holding
+/// roughly the same number of products, each thread with its own
+/// `RowAccumulator`. Elements cancelling out are kept as explicit zeros.
+/// The same arrays read in column-major order give `C^T = B^T * A^T`.
+template <NumericOrComplex T, typename PA, typename IA, typename PB,
+          typename IB, typename PC, typename IC>
+void compressed_spgemm(std::span<PA const> a_inner, std::span<IA const> a_outer,
+                       std::span<T const> a_values,
+                       std::span<PB const> b_inner, std::span<IB const> b_outer,
+                       std::span<T const> b_values, size_t num_columns,
+                       std::vector<PC>& c_inner, std::vector<IC>& c_outer,
+                       std::vector<T>& c_values, unsigned num_threads) {
+    const size_t num_rows = a_inner.empty() ? 0 : a_inner.size() - 1;
+
+    std::vector<size_t> work(num_rows + 1, 0);
+    for (size_t i = 0; i < num_rows; ++i) {
+        size_t products = 0;
+        for (size_t k = a_inner[i]; k < a_inner[i + 1]; ++k) {
+            size_t line = a_outer[k];
+            products += b_inner[line + 1] - b_inner[line];
+        }
+        work[i + 1] = work[i] + products;
+    }
+
+    size_t num_parts = std::clamp<size_t>(work.back() / parallel_grain, 1,
+                                          resolve_threads(num_threads));
+    const std::vector<size_t> bounds =
+        balanced_partition(std::span<size_t const>(work), num_parts);
+    std::vector<RowAccumulator<T>> accumulators(
+        num_parts, RowAccumulator<T>(num_columns));
+
+    auto multiply_row = [&](auto numeric, RowAccumulator<T>& acc, size_t i) {
+        acc.begin(work[i + 1] - work[i]);
+        for (size_t k = a_inner[i]; k < a_inner[i + 1]; ++k) {
+            size_t line = a_outer[k];
+            for (size_t q = b_inner[line]; q < b_inner[line + 1]; ++q) {
+                if constexpr (decltype(numeric)::value) {
+                    acc.add(b_outer[q], a_values[k] * b_values[q]);
+                }
+                else {
+                    acc.mark(b_outer[q]);
+                }
+            }
+        }
+    };
+
+    c_inner.assign(num_rows + 1, 0);
+    parallel_for(num_parts, [&](size_t p) {
+        for (size_t i = bounds[p]; i < bounds[p + 1]; ++i) {
+            multiply_row(std::false_type{}, accumulators[p], i);
+            c_inner[i + 1] = static_cast<PC>(accumulators[p].size());
+        }
+    });
+
+    for (size_t i = 0; i < num_rows; ++i) {
+        c_inner[i + 1] += c_inner[i];
+    }
+    c_outer.resize(c_inner.back());
+    c_values.resize(c_inner.back());
+
+    parallel_for(num_parts, [&](size_t p) {
+        for (size_t i = bounds[p]; i < bounds[p + 1]; ++i) {
+            multiply_row(std::true_type{}, accumulators[p], i);
+            accumulators[p].flush(c_outer.data() + c_inner[i],
+                                  c_values.data() + c_inner[i]);
+        }
+    });
+}
+
+/// @brief Computes the sparse linear combination `C = alpha * A + beta * B`
+/// of YALE-like compressed arrays with the same storage order and shape.
+/// @tparam T The type of the matrix elements (numeric or complex).
+/// @tparam PA The type of the inner indexes of `A`.
+/// @tparam IA The type of the outer indexes of `A`.
+/// @tparam PB The type of the inner indexes of `B`.
+/// @tparam IB The type of the outer indexes of `B`.
+/// @tparam PC The type of the inner indexes of `C`.
+/// @tparam IC The type of the outer indexes of `C`.
+/// @param a_inner The inner index array of `A`.
+/// @param a_outer The outer index array of `A`.
+/// @param a_values The values array of `A`.
+/// @param b_inner The inner index array of `B`.
+/// @param b_outer The outer index array of `B`.
+/// @param b_values The values array of `B`.
+/// @param alpha The scaling factor of `A`.
+/// @param beta The scaling factor of `B`.
+/// @param c_inner The inner index array of `C`, overwritten.
+/// @param c_outer The outer index array of `C`, overwritten.
+/// @param c_values The values array of `C`, overwritten.
+/// @details The sorted lines of `A` and `B` are merged pairwise, so the lines
+/// of `C` come out sorted and the cost is `O(nnz(A) + nnz(B) + n)`. The
+/// arrays of `C` are reserved for the sum of the two sizes and written in a
+/// single pass. Elements cancelling out are kept as explicit zeros.
+template <NumericOrComplex T, typename PA, typename IA, typename PB,
+          typename IB, typename PC, typename IC>
+void compressed_add(std::span<PA const> a_inner, std::span<IA const> a_outer,
+                    std::span<T const> a_values, std::span<PB const> b_inner,
+                    std::span<IB const> b_outer, std::span<T const> b_values,
+                    T alpha, T beta, std::vector<PC>& c_inner,
+                    std::vector<IC>& c_outer, std::vector<T>& c_values) {
+    const size_t num_lines = a_inner.empty() ? 0 : a_inner.size() - 1;
+
+    c_inner.assign(num_lines + 1, 0);
+    c_outer.clear();
+    c_values.clear();
+    c_outer.reserve(a_values.size() + b_values.size());
+    c_values.reserve(a_values.size() + b_values.size());
+
+    for (size_t line = 0; line < num_lines; ++line) {
+        size_t ka = a_inner[line], kb = b_inner[line];
+        const size_t a_end = a_inner[line + 1], b_end = b_inner[line + 1];
+        while (ka < a_end || kb < b_end) {
+            if (kb == b_end ||
+                (ka < a_end && static_cast<size_t>(a_outer[ka]) <
+                                   static_cast<size_t>(b_outer[kb]))) {
+                c_outer.push_back(static_cast<IC>(a_outer[ka]));
+                c_values.push_back(alpha * a_values[ka++]);
+            }
+            else if (ka == a_end || static_cast<size_t>(b_outer[kb]) <
+                                        static_cast<size_t>(a_outer[ka])) {
+                c_outer.push_back(static_cast<IC>(b_outer[kb]));
+                c_values.push_back(beta * b_values[kb++]);
+            }
+            else {
+                c_outer.push_back(static_cast<IC>(a_outer[ka]));
+                c_values.push_back(alpha * a_values[ka++] +
+                                   beta * b_values[kb++]);
+            }
+        }
+        c_inner[line + 1] = static_cast<PC>(c_outer.size());
+    }
+}
+
+}  // namespace algebra
+#endif
@@ -0,0 +1,119 @@
+#ifndef VECTORKERNELS_HPP
+#define VECTORKERNELS_HPP
+
+#include <complex>
+#include <cstddef>
+#include <span>
+
+#include "Concepts.hpp"
+
+namespace algebra {
+
+/// @brief Conjugates a value, real values are returned as they are.
+/// @tparam T The type of the value (numeric or complex).
+/// @param value The value.
+/// @return The conjugate of the value, with the same type.
+template <NumericOrComplex T>
+inline T conjugate(T const& value) {
+    if constexpr (is_complex<T>::value) {
+        return std::conj(value);
+    }
+    else {
+        return value;
+    }
+}
+
+/// @brief Computes the absolute value of a value, as a `double`.
+/// @tparam T The type of the value (numeric or complex).
+/// @param value The value.
+/// @return The absolute value.
+/// @details Storage types which are not numeric, e.g. `bfloat16`, provide
+/// their own overload, found by argument dependent lookup.
+template <NumericOrComplex T>
+inline double magnitude(T const& value) {
+    return static_cast<double>(std::abs(value));
+}
+
+/// @brief Computes the squared magnitude of a value, `|value|^2`, without
+/// taking square roots.
+/// @tparam T The type of the value (numeric or complex).
+/// @param value The value.
+/// @return The squared magnitude.
+template <NumericOrComplex T>
+inline double squared_magnitude(T const& value) {
+    if constexpr (is_complex<T>::value) {
+        return static_cast<double>(std::norm(value));
+    }
+    else {
+        return static_cast<double>(value) * static_cast<double>(value);
+    }
+}
+
+/// @brief Computes the dot product `x^H * y`, conjugating `x`.
+/// @tparam T The type of the elements (numeric or complex).
+/// @param x The first vector.
+/// @param y The second vector, as long as `x`.
+/// @return The dot product.
+template <NumericOrComplex T>
+T dot(std::span<T const> x, std::span<T const> y) {
+    T sum{};
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        sum += conjugate(x[i]) * y[i];
+    }
+    return sum;
+}
+
+/// @brief Computes the squared euclidean norm of a vector.
+/// @tparam T The type of the elements (numeric or complex).
+/// @param x The vector.
+/// @return The squared norm.
+template <NumericOrComplex T>
+double squared_norm(std::span<T const> x) {
+    double sum = 0.0;
+    for (auto const& el : x) sum += squared_magnitude(el);
+    return sum;
+}
+
+/// @brief Adds a scaled vector to another one, `y += alpha * x`.
+/// @tparam T The type of the elements (numeric or complex).
+/// @param alpha The scaling factor.
+/// @param x The vector to add.
+/// @param y The vector to update, as long as `x`.
+template <NumericOrComplex T>
+void axpy(T alpha, std::span<T const> x, std::span<T> y) {
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        y[i] += alpha * x[i];
+    }
+}
+
+/// @brief Adds a scaled vector to another one, `y += alpha * x`, and computes
+/// the squared norm of the result in the same pass.
+/// @tparam T The type of the elements (numeric or complex).
+/// @param alpha The scaling factor.
+/// @param x The vector to add.
+/// @param y The vector to update, as long as `x`.
+/// @return The squared norm of the updated `y`.
+template <NumericOrComplex T>
+double axpy_norm(T alpha, std::span<T const> x, std::span<T> y) {
+    double sum = 0.0;
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        y[i] += alpha * x[i];
+        sum += squared_magnitude(y[i]);
+    }
+    return sum;
+}
+
+/// @brief Scales a vector and adds another one to it, `y = x + beta * y`.
+/// @tparam T The type of the elements (numeric or complex).
+/// @param x The vector to add.
+/// @param beta The scaling factor.
+/// @param y The vector to update, as long as `x`.
+template <NumericOrComplex T>
+void xpby(std::span<T const> x, T beta, std::span<T> y) {
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        y[i] = x[i] + beta * y[i];
+    }
+}
+
+}  // namespace algebra
+#endif
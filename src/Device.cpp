@@ -0,0 +1,62 @@
+#include "Device.hpp"
+
+namespace algebra {
+
+/// @brief Starts the stream.
+DeviceStream::DeviceStream() : worker([this] { run(); }) {}
+
+/// @brief Waits for the enqueued tasks, then stops the stream.
+DeviceStream::~DeviceStream() {
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+/// @brief Enqueues a task after all the previous ones.
+/// @param task The task.
+/// @return The future completed when the task is done, holding the exception
+/// it threw, if any.
+std::future<void> DeviceStream::enqueue(std::function<void()> task) {
+    std::packaged_task<void()> packaged(std::move(task));
+    std::future<void> done = packaged.get_future();
+    {
+        std::lock_guard lock(mutex);
+        tasks.push_back(std::move(packaged));
+    }
+    wake.notify_one();
+    return done;
+}
+
+/// @brief Waits for all the tasks enqueued so far.
+/// @details The tasks run in order, so waiting for an empty task enqueued
+/// last is enough.
+void DeviceStream::synchronize() { enqueue([] {}).wait(); }
+
+/// @brief Runs the tasks until the stream is stopped.
+/// @details The queue is drained before stopping, so no future is left
+/// without a value.
+void DeviceStream::run() {
+    for (;;) {
+        std::packaged_task<void()> task;
+        {
+            std::unique_lock lock(mutex);
+            wake.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) return;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+/// @brief Gets the stream used by default by `Matrix::to_device`.
+/// @return The stream, alive until the end of the program.
+DeviceStream& default_device_stream() {
+    static DeviceStream stream;
+    return stream;
+}
+
+}  // namespace algebra
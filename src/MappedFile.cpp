@@ -0,0 +1,44 @@
+#include "MappedFile.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace algebra {
+
+/// @brief Maps the given file, an empty view is exposed if it fails.
+/// @param file_name The name of the file.
+/// @param sequential Hints the kernel that the file will be read once from the
+/// beginning to the end.
+/// @details The file descriptor is closed right after mapping, the mapping
+/// stays valid until it is unmapped.
+MappedFile::MappedFile(std::string const& file_name, bool sequential) {
+    int fd = ::open(file_name.c_str(), O_RDONLY);
+    if (fd < 0) return;
+
+    struct stat info;
+    if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+        void* p = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ,
+                         MAP_SHARED, fd, 0);
+        if (p != MAP_FAILED) {
+            address = p;
+            length = static_cast<size_t>(info.st_size);
+            if (sequential) ::madvise(address, length, MADV_SEQUENTIAL);
+        }
+    }
+    ::close(fd);
+}
+
+/// @brief Unmaps the file.
+MappedFile::~MappedFile() {
+    if (address) ::munmap(address, length);
+}
+
+/// @brief Gets the content of the file.
+/// @return A view over the mapped bytes.
+std::string_view MappedFile::view() const {
+    return {static_cast<char const*>(address), length};
+}
+
+}  // namespace algebra
@@ -0,0 +1,82 @@
+#include "MatrixMarket.hpp"
+
+#include <cassert>
+#include <cctype>
+#include <sstream>
+#include <string>
+
+namespace algebra {
+
+/// @brief Parses the banner, the comments and the size line of a Matrix
+/// Market file.
+/// @param text The content of the file.
+/// @param header The header to fill.
+/// @return The offset of the first entry in `text`.
+/// @details The banner is matched case-insensitively, only the coordinate
+/// format is supported.
+size_t parse_market_header(std::string_view text, MarketHeader& header) {
+    auto next_line = [&](size_t& pos) {
+        size_t eol = text.find('\n', pos);
+        if (eol == std::string_view::npos) eol = text.size();
+        std::string line(text.substr(pos, eol - pos));
+        pos = std::min(eol + 1, text.size());
+        return line;
+    };
+
+    size_t pos = 0;
+    std::string banner = next_line(pos);
+    for (auto& c : banner) c = static_cast<char>(std::tolower(c));
+
+    std::istringstream tokens(banner);
+    std::string magic, object, format, field, symmetry;
+    tokens >> magic >> object >> format >> field >> symmetry;
+
+#ifdef DEBUG
+    assert(magic == "%%matrixmarket" && object == "matrix" &&
+           "Error in Matrix Market reader: invalid Matrix Market file.\n");
+    assert(format == "coordinate" &&
+           "Error in Matrix Market reader: only the coordinate format is "
+           "supported.\n");
+#endif
+
+    if (field == "integer") {
+        header.field = MarketField::Integer;
+    }
+    else if (field == "complex") {
+        header.field = MarketField::Complex;
+    }
+    else if (field == "pattern") {
+        header.field = MarketField::Pattern;
+    }
+    else {
+        header.field = MarketField::Real;
+    }
+
+    if (symmetry == "symmetric") {
+        header.symmetry = MarketSymmetry::Symmetric;
+    }
+    else if (symmetry == "skew-symmetric") {
+        header.symmetry = MarketSymmetry::SkewSymmetric;
+    }
+    else if (symmetry == "hermitian") {
+        header.symmetry = MarketSymmetry::Hermitian;
+    }
+    else {
+        header.symmetry = MarketSymmetry::General;
+    }
+
+    std::string line;
+    while (pos < text.size()) {
+        line = next_line(pos);
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first != std::string::npos && line[first] != '%') break;
+        line.clear();
+    }
+
+    std::istringstream dims(line);
+    dims >> header.rows >> header.columns >> header.entries;
+
+    return pos;
+}
+
+}  // namespace algebra
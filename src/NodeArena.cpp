@@ -0,0 +1,93 @@
+#include "NodeArena.hpp"
+
+#include <new>
+
+namespace algebra {
+
+/// @brief Returns all the slabs to the system.
+NodePool::~NodePool() { release(); }
+
+/// @brief Returns all the slabs to the system, invalidating the blocks
+/// allocated from them.
+void NodePool::release() {
+    for (void* slab : slabs) ::operator delete(slab);
+    slabs.clear();
+    free_lists.fill(nullptr);
+    cursor = limit = nullptr;
+    next_slab = first_slab;
+}
+
+/// @brief Allocates a block.
+/// @param bytes The size of the block.
+/// @param alignment The alignment of the block.
+/// @return A pointer to the block.
+/// @details Small blocks are taken from the list of their class or, if it is
+/// empty, from the current slab; a new slab, twice as large as the previous
+/// one up to `last_slab`, is allocated when the current one is exhausted.
+void* NodePool::do_allocate(std::size_t bytes, std::size_t alignment) {
+    std::size_t size_class = (bytes + granularity - 1) / granularity;
+    if (size_class == 0) size_class = 1;
+    if (size_class > num_classes || alignment > granularity) {
+        return ::operator new(bytes, std::align_val_t{alignment});
+    }
+
+    void*& head = free_lists[size_class - 1];
+    if (head) {
+        void* block = head;
+        head = *static_cast<void**>(block);
+        return block;
+    }
+
+    std::size_t size = size_class * granularity;
+    if (static_cast<std::size_t>(limit - cursor) < size) {
+        void* slab = ::operator new(next_slab);
+        slabs.push_back(slab);
+        cursor = static_cast<std::byte*>(slab);
+        limit = cursor + next_slab;
+        if (next_slab < last_slab) next_slab *= 2;
+    }
+
+    void* block = cursor;
+    cursor += size;
+    return block;
+}
+
+/// @brief Deallocates a block.
+/// @param p The pointer to the block.
+/// @param bytes The size of the block.
+/// @param alignment The alignment of the block.
+/// @details Small blocks are pushed on the list of their class, large ones are
+/// returned to the global allocator.
+void NodePool::do_deallocate(void* p, std::size_t bytes,
+                             std::size_t alignment) {
+    std::size_t size_class = (bytes + granularity - 1) / granularity;
+    if (size_class == 0) size_class = 1;
+    if (size_class > num_classes || alignment > granularity) {
+        ::operator delete(p, std::align_val_t{alignment});
+        return;
+    }
+
+    void*& head = free_lists[size_class - 1];
+    *static_cast<void**>(p) = head;
+    head = p;
+}
+
+/// @brief Checks if memory allocated by a resource can be deallocated by
+/// this one.
+/// @param other The other resource.
+/// @return True only if it is this pool.
+bool NodePool::do_is_equal(
+    std::pmr::memory_resource const& other) const noexcept {
+    return this == &other;
+}
+
+/// @brief Creates an empty arena.
+NodeArena::NodeArena() : pool{std::make_unique<NodePool>()} {}
+
+/// @brief Frees all the slabs, invalidating the containers built so far.
+/// @details An arena left empty by a move is ignored.
+void NodeArena::release() {
+    if (pool) pool->release();
+}
+
+}  // namespace algebra
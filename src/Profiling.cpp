@@ -0,0 +1,108 @@
+#include "Profiling.hpp"
+
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <sstream>
+
+namespace algebra {
+
+namespace {
+
+/// @brief The counters created so far, in a deque so that they never move.
+std::deque<ProfileCounter>& profile_counters() {
+    static std::deque<ProfileCounter> counters;
+    return counters;
+}
+
+/// @brief Guards the creation of the counters and the snapshots.
+std::mutex& profile_mutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+/// @brief Writes a string as a JSON string, escaping the quotes and the
+/// backslashes.
+/// @param os The output stream.
+/// @param text The string.
+void write_json_string(std::ostream& os, std::string const& text) {
+    os << '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') os << '\\';
+        os << c;
+    }
+    os << '"';
+}
+
+}  // namespace
+
+/// @brief Formats the counters as a JSON array of objects, one for each
+/// operation of each format.
+/// @return The JSON text.
+std::string ProfileSnapshot::to_json() const {
+    std::ostringstream os;
+    os << '[';
+    for (size_t k = 0; k < entries.size(); ++k) {
+        auto const& entry = entries[k];
+        os << (k == 0 ? "" : ",") << "{\"operation\":";
+        write_json_string(os, entry.operation);
+        os << ",\"format\":";
+        write_json_string(os, entry.format);
+        os << ",\"calls\":" << entry.calls
+           << ",\"nanoseconds\":" << entry.nanoseconds
+           << ",\"bytes\":" << entry.bytes << '}';
+    }
+    os << ']';
+    return os.str();
+}
+
+/// @brief Gets the counters of an operation of a format, creating them on the
+/// first call.
+/// @param operation The name of the operation, a string literal.
+/// @param format The name of the format, a string literal.
+/// @return The counters, alive until the end of the program.
+/// @details Called once by each instrumented site, which keeps the reference
+/// in a static variable, so the lookup is not on the hot path.
+ProfileCounter& profile_counter(char const* operation, char const* format) {
+    std::lock_guard lock(profile_mutex());
+    auto& counters = profile_counters();
+    for (auto& counter : counters) {
+        if (std::strcmp(counter.operation, operation) == 0 &&
+            std::strcmp(counter.format, format) == 0) {
+            return counter;
+        }
+    }
+    auto& counter = counters.emplace_back();
+    counter.operation = operation;
+    counter.format = format;
+    return counter;
+}
+
+/// @brief Copies all the counters.
+/// @return The snapshot, empty if the code wasn't built with `PROFILE`.
+/// @details Each counter is read atomically, but calls ending meanwhile can
+/// be counted in some counters of their operation and not in others.
+ProfileSnapshot profile_snapshot() {
+    std::lock_guard lock(profile_mutex());
+    ProfileSnapshot snapshot;
+    for (auto const& counter : profile_counters()) {
+        snapshot.entries.push_back(
+            {counter.operation, counter.format,
+             counter.calls.load(std::memory_order_relaxed),
+             counter.nanoseconds.load(std::memory_order_relaxed),
+             counter.bytes.load(std::memory_order_relaxed)});
+    }
+    return snapshot;
+}
+
+/// @brief Sets all the counters to zero.
+void profile_reset() {
+    std::lock_guard lock(profile_mutex());
+    for (auto& counter : profile_counters()) {
+        counter.calls = 0;
+        counter.nanoseconds = 0;
+        counter.bytes = 0;
+    }
+}
+
+}  // namespace algebra
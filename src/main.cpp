@@ -1,15 +1,24 @@
-#include <chrono>
 #include <random>
 
 #include "COOImpl.hpp"
 #include "COOmap.hpp"
 #include "MatrixImpl.hpp"
+#include "Profiling.hpp"
+#include "SELLImpl.hpp"
 #include "YALEImpl.hpp"
 
+#ifdef USE_MPI
+#include "DistributedMatrixImpl.hpp"
+#endif
+
 #ifdef TEST
 #include "tests.hpp"
 #endif
 
+#ifdef BENCH
+#include "bench.hpp"
+#endif
+
 using namespace algebra;
 
 std::vector<double> fillRandomVector(std::vector<double>& vec, double min,
@@ -25,47 +34,92 @@ std::vector<double> fillRandomVector(std::vector<double>& vec, double min,
     return vec;
 }
 
-int main() {
-#ifdef TEST
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv) {
+#ifdef USE_MPI
+    MPI_Init(&argc, &argv);
+#endif
+#if defined(TEST) && defined(USE_MPI)
+    test_distributed();
+#elif defined(TEST)
     run_tests();
-#else
-    std::cout << "TESTING EFFICIENCY OF THE MATRIX-VECTOR PRODUCT" << std::endl;
-
-    std::string s{"matrix.mtx"};
-    Matrix<double, YALE, COO, columnMajor> m(s);
-    std::vector<double> vec(m.get_columns());
-    fillRandomVector(vec, -100.0, 100.0);
+#elif defined(BENCH)
+    return run_benchmarks(argc, argv);
+#elif defined(USE_MPI)
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
 
-    std::cout << std::setprecision(20);
+    std::string s{argc > 1 ? argv[1] : "matrix.mtx"};
+    DistributedMatrix<double, COO> d(MPI_COMM_WORLD, s);
 
-    std::chrono::duration<double, std::milli> duration1;
-    for (size_t i = 0; i < 1000; ++i) {
-        auto start = std::chrono::high_resolution_clock::now();
-        std::vector<double> res1 = m * vec;
-        auto end = std::chrono::high_resolution_clock::now();
-        duration1 += end - start;
+    std::vector<double> x(d.get_column_end() - d.get_column_begin());
+    std::vector<double> y(d.get_row_end() - d.get_row_begin());
+    for (size_t j = 0; j < x.size(); ++j) {
+        x[j] = 1.0 + (d.get_column_begin() + j) % 7;
     }
 
-    std::cout
-        << "Matrix-vector product (1000 iteartions) in uncompressed state "
-           "took:\t"
-        << duration1.count() << " ms\n";
+    MPI_Barrier(MPI_COMM_WORLD);
+    double start = MPI_Wtime();
+    const int repetitions = 100;
+    for (int k = 0; k < repetitions; ++k) d.multiply_into(x, y);
+    double elapsed = (MPI_Wtime() - start) / repetitions;
 
-    m.compress();
+    std::vector<int> counts(size), displs(size + 1, 0);
+    int count = static_cast<int>(y.size());
+    MPI_Gather(&count, 1, MPI_INT, counts.data(), 1, MPI_INT, 0,
+               MPI_COMM_WORLD);
+    std::partial_sum(counts.begin(), counts.end(), displs.begin() + 1);
+    std::vector<double> result(rank == 0 ? displs.back() : 0);
+    MPI_Gatherv(y.data(), count, MPI_DOUBLE, result.data(), counts.data(),
+                displs.data(), MPI_DOUBLE, 0, MPI_COMM_WORLD);
 
-    std::chrono::duration<double, std::milli> duration2;
-    for (size_t i = 0; i < 1000; ++i) {
-        auto start2 = std::chrono::high_resolution_clock::now();
-        std::vector<double> res2 = m * vec;
-        auto end2 = std::chrono::high_resolution_clock::now();
-        duration2 += end2 - start2;
+    if (rank == 0) {
+        std::cout << "COMPARING THE DISTRIBUTED AND THE SERIAL MATRIX-VECTOR "
+                     "PRODUCT ON "
+                  << size << " PROCESSES" << std::endl;
+        Matrix<double, YALE, COO, rowMajor> m(s);
+        m.compress();
+        std::vector<double> v(m.get_columns());
+        for (size_t j = 0; j < v.size(); ++j) v[j] = 1.0 + j % 7;
+        std::vector<double> expected = m * v;
+        double diff = 0.0;
+        for (size_t i = 0; i < expected.size(); ++i) {
+            diff = std::max(diff, std::abs(result[i] - expected[i]) /
+                                      std::max(1.0, std::abs(expected[i])));
+        }
+        std::cout << "Maximum relative difference:\t" << diff << "\n"
+                  << "Distributed product took:\t" << elapsed * 1e3 << " ms"
+                  << std::endl;
     }
+#else
+    std::cout << "COMPARING THE MATRIX-VECTOR PRODUCT OF YALE AND SELL"
+              << std::endl;
 
-    std::cout << "Matrix-vector product (1000 iterations) in compressed state "
-                 "took:  \t"
-              << duration2.count() << " ms\n";
+    std::string s{argc > 1 ? argv[1] : "matrix.mtx"};
+    Matrix<double, YALE, COO, rowMajor> m(s);
+    m.compress();
+    Matrix<double, SELL, COO, rowMajor> m1(s);
+    m1.compress();
 
-    std::cout << std::setprecision(6);
-    std::cout << std::endl;
+    std::vector<double> vec(m.get_columns());
+    fillRandomVector(vec, -100.0, 100.0);
+
+    std::vector<double> res2 = m * vec;
+    std::vector<double> res3 = m1 * vec;
+    double diff = 0.0;
+    for (size_t i = 0; i < res2.size(); ++i) {
+        diff = std::max(diff, std::abs(res2[i] - res3[i]) /
+                                  std::max(1.0, std::abs(res2[i])));
+    }
+    std::cout << "Maximum relative difference between YALE and SELL results:\t"
+              << diff << "\n";
+    std::cout << "Build with `make bench` to measure the performance."
+              << std::endl;
+#ifdef PROFILE
+    std::cout << profile_snapshot().to_json() << std::endl;
+#endif
+#endif
+#ifdef USE_MPI
+    MPI_Finalize();
 #endif
 }
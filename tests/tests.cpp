@@ -1,19 +1,64 @@
 #include "tests.hpp"
 
+#include <BSRImpl.hpp>
 #include <COOImpl.hpp>
 #include <COOmapImpl.hpp>
+#include <COOhashImpl.hpp>
+#include <COOvecImpl.hpp>
+#ifdef USE_MPI
+#include <DistributedMatrixImpl.hpp>
+#endif
+#include <KrylovImpl.hpp>
+#include <MappedYALEImpl.hpp>
 #include <MatrixImpl.hpp>
+#include <MatrixViewImpl.hpp>
+#include <MixedYALEImpl.hpp>
+#include <SELLImpl.hpp>
+#include <StreamingYALEImpl.hpp>
+#include <SymYALEImpl.hpp>
 #include <YALEImpl.hpp>
+#include <algorithm>
 #include <chrono>
 #include <complex>
 #include <forward_list>
+#include <fstream>
+#include <iomanip>
+#include <limits>
 #include <map>
+#include <numeric>
 #include <random>
 #include <set>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include "Matrix.hpp"
+#include "NodeArena.hpp"
+#include "Profiling.hpp"
+
+/// @brief YALE format with 8-bit indexes, to test the overflow checks.
+template <algebra::NumericOrComplex T, comparators::StorageOrder S>
+using YALE8 = algebra::YALE<T, S, std::uint8_t>;
+
+/// @brief Checks if `l * r` compiles, to test the rejected temporaries.
+template <typename L, typename R>
+concept Multipliable = requires(L&& l, R&& r) {
+    std::forward<L>(l) * std::forward<R>(r);
+};
+
+/// @brief Checks if `l + r` compiles.
+template <typename L, typename R>
+concept Addable = requires(L&& l, R&& r) {
+    std::forward<L>(l) + std::forward<R>(r);
+};
+
+/// @brief Checks if `l - r` compiles.
+template <typename L, typename R>
+concept Subtractable = requires(L&& l, R&& r) {
+    std::forward<L>(l) - std::forward<R>(r);
+};
 
 void run_tests() {
     test_concepts();
@@ -21,8 +66,36 @@ void run_tests() {
     test_norms();
     test_compress_uncompress();
     test_remove();
+    test_prune();
+    test_node_arena();
     test_matrixmarket_constructors();
     test_matrixvector();
+    test_multiply_into();
+    test_parallel_multiply();
+    test_sell();
+    test_coovec();
+    test_coohash();
+    test_concurrent_compress();
+    test_matrixmarket_reader();
+    test_snapshot();
+    test_index_width();
+    test_block_product();
+    test_assembly();
+    test_transpose();
+    test_spgemm();
+    test_symyale();
+    test_bsr();
+    test_krylov();
+    test_mixed_precision();
+    test_reordering();
+    test_cached_properties();
+    test_matrix_view();
+    test_line_access();
+    test_profiling();
+    test_expressions();
+    test_device();
+    test_streaming();
+    test_pattern_reuse();
     test_complex();
     test_dotproduct_timing();
 }
@@ -263,6 +336,125 @@ void test_remove() {
     std::cout << std::endl;
 }
 
+void test_prune() {
+    std::cout << "TESTING PRUNING" << std::endl;
+    using namespace algebra;
+
+    std::string s{"matrix.mtx"};
+    Matrix<double, YALE, COOmap, rowMajor> ref(UseCompressed{}, s);
+    auto const& cref = ref;
+
+    // Checks that exactly the elements satisfying the predicate were removed.
+    auto matches = [&](auto& mat, auto pred) {
+        size_t removed = mat.remove_if(pred);
+        auto const& cmat = mat;
+        size_t expected = 0;
+        bool equal = true;
+        for (size_t i = 0; i < 131; ++i) {
+            for (size_t j = 0; j < 131; ++j) {
+                double value = cref(i, j);
+                if (value != 0 && pred(i, j, value)) {
+                    ++expected;
+                    value = 0;
+                }
+                equal = equal && cmat(i, j) == value;
+            }
+        }
+        return equal && removed == expected &&
+               mat.get_num_elements() == ref.get_num_elements() - expected;
+    };
+    auto small = [](size_t, size_t, double value) {
+        return std::abs(value) <= 1.0;
+    };
+    auto diagonal = [](size_t i, size_t j, double) { return i == j; };
+
+    Matrix<double, YALE, COO, rowMajor> m(UseCompressed{}, s);
+    Matrix<double, YALE, COOmap, columnMajor> m1(UseCompressed{}, s);
+    Matrix<double, YALE, COO, columnMajor> m2(UseCompressed{}, s);
+    m2.uncompress();
+    Matrix<double, YALE, COOmap, rowMajor> m3(UseCompressed{}, s);
+    m3.uncompress();
+    Matrix<double, YALE, COOvec, rowMajor> m4(UseCompressed{}, s);
+    m4.uncompress();
+    std::cout << "Expected match removing small elements: 1, 1, 1, 1, 1,"
+              << "\tmatch: " << matches(m, small) << ", " << matches(m1, small)
+              << ", " << matches(m2, small) << ", " << matches(m3, small)
+              << ", " << matches(m4, small) << std::endl;
+
+    Matrix<double, YALE, COO, rowMajor> m5(UseCompressed{}, s);
+    Matrix<double, YALE, COOmap, columnMajor> m6(UseCompressed{}, s);
+    m6.uncompress();
+    std::cout << "Expected match removing the diagonal: 1, 1,\tmatch: "
+              << matches(m5, diagonal) << ", " << matches(m6, diagonal)
+              << std::endl;
+
+    Matrix<double, YALE, COOvec, columnMajor> m7(UseCompressed{}, s);
+    m7.prune(1.0);
+    m7.uncompress();
+    std::cout << "Expected elements after pruning: 125,\telements: "
+              << m7.get_num_elements() << std::endl;
+    std::cout << "Expected elements after pruning again: 125,\telements: "
+              << m7.get_num_elements() - m7.prune() << std::endl;
+
+    Matrix<double, YALE, COOmap, columnMajor> m8(UseCompressed{}, s);
+    size_t before = m8.get_num_elements();
+    bool removed = m8.remove(130, 130);
+    std::cout << "Expected removal of the last element: 1, 0, 0,\tremoval: "
+              << removed << ", " << m8.remove(130, 130) << ", "
+              << before - 1 - m8.get_num_elements() << std::endl;
+
+    std::cout << std::endl;
+}
+
+void test_node_arena() {
+    std::cout << "TESTING NODE ARENA" << std::endl;
+    using namespace algebra;
+
+    NodePool pool;
+    void* p1 = pool.allocate(40);
+    void* p2 = pool.allocate(40);
+    pool.deallocate(p1, 40);
+    void* p3 = pool.allocate(48);
+    std::cout << "Expected reuse of a freed block: 1, 0,\treuse: " << (p3 == p1)
+              << ", " << (p3 == p2) << std::endl;
+
+    std::string s{"matrix.mtx"};
+    Matrix<double, YALE, COO, rowMajor> ref(UseCompressed{}, s);
+    Matrix<double, YALE, COO, rowMajor> m(UseCompressed{}, s);
+    Matrix<double, YALE, COOmap, columnMajor> m1(UseCompressed{}, s);
+    auto const& cref = ref;
+    auto const& cm = m;
+    auto const& cm1 = m1;
+
+    // Cycles through the states, removing and inserting the same elements.
+    for (size_t cycle = 0; cycle < 3; ++cycle) {
+        m.uncompress();
+        m1.uncompress();
+        for (size_t i = 0; i < 131; ++i) {
+            double value = cm(i, i);
+            if (value == 0) continue;
+            m.remove(i, i);
+            m1.remove(i, i);
+            m(i, i) = value;
+            m1(i, i) = value;
+        }
+        m.compress();
+        m1.compress();
+    }
+
+    bool equal = m.get_num_elements() == ref.get_num_elements() &&
+                 m1.get_num_elements() == ref.get_num_elements();
+    for (size_t i = 0; i < 131; ++i) {
+        for (size_t j = 0; j < 131; ++j) {
+            equal = equal && cm(i, j) == cref(i, j) && cm1(i, j) == cref(i, j);
+        }
+    }
+    std::cout << "Expected match after the cycles: 1,\tmatch: " << equal
+              << std::endl;
+
+    std::cout << std::endl;
+}
+
 void test_matrixmarket_constructors() {
     std::cout << "TESTING MATRIX-MARKET-BASED CONSTRUCTOTS" << std::endl;
     using namespace algebra;
@@ -319,6 +511,2416 @@ void test_matrixvector() {
     std::cout << std::endl;
 }
 
+void test_multiply_into() {
+    std::cout << "TESTING MATRIX-VECTOR PRODUCT INTO A GIVEN BUFFER"
+              << std::endl;
+    using namespace algebra;
+    std::vector<std::pair<size_t, size_t>> i{{0, 0}, {0, 1}, {1, 0}};
+    std::vector<double> v{1, 2, 3};
+    Matrix<double, YALE, COO, rowMajor> m{UseDynamic{}, i, v};
+    Matrix<double, YALE, COOmap, columnMajor> m2{UseDynamic{}, i, v};
+    std::vector<double> x{1, 2};
+    std::vector<double> y(2);
+
+    for (size_t k = 0; k < 2; ++k) {
+        std::cout << "Expected result: 13, 9:" << std::endl;
+        y = {1, 1};
+        m.multiply_into(x, y, 2.0, 3.0);
+        for (auto const& el : y) std::cout << el << " ";
+        std::cout << std::endl;
+
+        std::cout << "Expected result: 5, 3:" << std::endl;
+        y = {-7, -7};
+        m2.multiply_into(x, y);
+        for (auto const& el : y) std::cout << el << " ";
+        std::cout << std::endl;
+
+        if (k == 0) {
+            std::cout << "Compressing..." << std::endl;
+            m.compress();
+            m2.compress();
+        }
+    }
+
+    std::cout << std::endl;
+}
+
+void test_parallel_multiply() {
+    std::cout << "TESTING MULTITHREADED MATRIX-VECTOR PRODUCT" << std::endl;
+    using namespace algebra;
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<size_t> col(0, 1999);
+    std::uniform_real_distribution<double> val(-1.0, 1.0);
+
+    // A few very long rows among many short ones.
+    std::map<std::pair<size_t, size_t>, double> entries;
+    for (size_t i = 0; i < 2000; ++i) {
+        size_t length = (i % 500 == 0) ? 1500 : 10;
+        for (size_t k = 0; k < length; ++k) entries[{i, col(gen)}] = val(gen);
+    }
+
+    Matrix<double, YALE, COO, rowMajor> m(UseDynamic{}, 2000, 2000, entries);
+    Matrix<double, YALE, COO, columnMajor> m1(UseDynamic{}, 2000, 2000,
+                                              entries);
+    m.compress();
+    m1.compress();
+
+    std::vector<double> x(2000), y(2000), y1(2000, 1.0), y2(2000, 1.0);
+    for (auto& el : x) el = val(gen);
+
+    for (unsigned threads : {2u, 4u, 0u}) {
+        m.multiply_into(x, y1, 2.0, 0.5);
+        m.multiply_into(x, y2, 2.0, 0.5, threads);
+        double diff = 0.0;
+        for (size_t i = 0; i < 2000; ++i)
+            diff = std::max(diff, std::abs(y1[i] - y2[i]));
+        std::cout << "Row-major with " << threads
+                  << " threads, expected difference: 0,\tdifference: " << diff
+                  << std::endl;
+
+        m1.multiply_into(x, y);
+        m1.multiply_into(x, y1, 1.0, 0.0, threads);
+        diff = 0.0;
+        for (size_t i = 0; i < 2000; ++i)
+            diff = std::max(diff, std::abs(y[i] - y1[i]));
+        std::cout << "Column-major with " << threads
+                  << " threads, expected difference: ~0,\tdifference: " << diff
+                  << std::endl;
+        y1.assign(2000, 1.0);
+        y2.assign(2000, 1.0);
+    }
+
+    std::cout << std::endl;
+}
+
+void test_sell() {
+    std::cout << "TESTING SELL FORMAT" << std::endl;
+    using namespace algebra;
+
+    std::string s{"matrix.mtx"};
+    Matrix<double, YALE, COO, rowMajor> m(s);
+    Matrix<double, SELL, COO, rowMajor> m1(s);
+    Matrix<double, SELL, COOmap, columnMajor> m2(s);
+    m.compress();
+    m1.compress();
+    m2.compress();
+
+    std::vector<double> x(m.get_columns());
+    for (size_t i = 0; i < x.size(); ++i) x[i] = 1.0 / (i + 1);
+
+    std::vector<double> y = m * x, y1 = m1 * x, y2 = m2 * x;
+    double diff1 = 0.0, diff2 = 0.0;
+    for (size_t i = 0; i < y.size(); ++i) {
+        diff1 = std::max(diff1, std::abs(y[i] - y1[i]));
+        diff2 = std::max(diff2, std::abs(y[i] - y2[i]));
+    }
+    std::cout << "Expected difference from YALE: ~0,\tdifference: " << diff1
+              << ", " << diff2 << std::endl;
+
+    std::cout << "Expected norms: " << m.norm<One>() << ", "
+              << m.norm<Infinity>() << ", " << m.norm<Frobenius>()
+              << ",\tcomputed norms: " << m1.norm<One>() << ", "
+              << m2.norm<Infinity>() << ", " << m1.norm<Frobenius>()
+              << std::endl;
+
+    std::cout << "Expected number of elements: " << m.get_num_elements()
+              << ",\tnumber of elements: " << m2.get_num_elements()
+              << std::endl;
+
+    std::vector<size_t> c{0, 1, 1, 3, 2, 3, 4, 5};
+    std::vector<size_t> r{0, 2, 4, 7, 8};
+    std::vector<int> v{1, 2, 3, 4, 5, 6, 7, 8};
+    Matrix<int, SELL, COO, rowMajor> m3(UseCompressed{}, c, r, v);
+
+    std::cout << "Expected element (2, 3): 6,\telement: " << m3(2, 3)
+              << std::endl;
+    m3(0, 4) = 9;
+    m3(3, 0) = 10;
+    m3.remove(2, 2);
+    std::cout << "Expected element (0, 4), (3, 0), (2, 2): 9, 10, 0,"
+              << "\telements: " << m3(0, 4) << ", " << m3(3, 0) << ", "
+              << m3(2, 2) << std::endl;
+
+    std::cout << "Uncompressing..." << std::endl;
+    m3.uncompress();
+    std::cout << "Expected matrix:" << std::endl
+              << "1 2 0 0 9 0 " << std::endl
+              << "0 3 0 4 0 0 " << std::endl
+              << "0 0 0 6 7 0 " << std::endl
+              << "10 0 0 0 0 8 " << std::endl;
+    m3.print();
+
+    // Padding is masked out, so an infinite v[0] only reaches the lines
+    // storing an element in the column 0, also after removing it.
+    std::vector<size_t> c4{0, 1, 1, 2};
+    std::vector<size_t> r4{0, 2, 3, 4};
+    std::vector<double> v4{1, 2, 3, 4};
+    Matrix<double, SELL, COO, rowMajor> m4(UseCompressed{}, c4, r4, v4);
+    std::vector<double> x4{std::numeric_limits<double>::infinity(), 1, 2};
+    std::cout << "Expected products: inf 3 8, 2 3 8,\tproducts:";
+    for (double el : std::vector<double>(m4 * x4)) std::cout << " " << el;
+    m4.remove(0, 0);
+    std::cout << ",";
+    for (double el : std::vector<double>(m4 * x4)) std::cout << " " << el;
+    std::cout << std::endl;
+
+    std::cout << std::endl;
+}
+
+void test_coovec() {
+    std::cout << "TESTING THE CONTIGUOUS COO FORMAT" << std::endl;
+    using namespace algebra;
+
+    std::vector<std::pair<size_t, size_t>> ind{{3, 3}};
+    std::vector<double> val{8};
+    Matrix<double, YALE, COOvec, rowMajor> m(UseDynamic{}, 4, 4, ind, val);
+    m(0, 1) = 2;
+    m(2, 0) = 5;
+    m(0, 0) = 1;
+    m(1, 2) = 4;
+
+    std::cout << "Expected number of elements: 5,\tcomputed: "
+              << m.get_num_elements() << std::endl;
+    auto const& cm = m;
+    std::cout << "Expected element: 4,\tcomputed: " << cm(1, 2) << std::endl;
+    std::cout << "Expected element: 0,\tcomputed: " << cm(1, 1) << std::endl;
+    std::cout << "Expected norm: 8,\tcomputed norm: " << m.norm<Infinity>()
+              << std::endl;
+    std::cout << "Expected norm: 8,\tcomputed norm: " << m.norm<One>()
+              << std::endl;
+
+    std::vector<double> v{1, 1, 1, 1};
+    std::cout << "Expected result: 3 4 5 8,\tcomputed result: ";
+    for (auto const& el : std::vector<double>(m * v)) {
+        std::cout << el << " ";
+    }
+    std::cout << std::endl;
+
+    m.remove(0, 1);
+    m(1, 3) = 3;
+    std::cout << "Expected number of elements: 5,\tcomputed: "
+              << m.get_num_elements() << std::endl;
+
+    m.compress();
+    std::cout << "Expected result: 1 7 5 8,\tcomputed result: ";
+    for (auto const& el : std::vector<double>(m * v)) {
+        std::cout << el << " ";
+    }
+    std::cout << std::endl;
+
+    m.uncompress();
+    m(3, 0) = 2;
+    std::cout << "Expected print:" << std::endl
+              << "1 0 0 0 " << std::endl
+              << "0 0 4 3 " << std::endl
+              << "5 0 0 0 " << std::endl
+              << "2 0 0 8 " << std::endl;
+    m.print();
+
+    std::vector<std::pair<size_t, size_t>> i{{2, 1}, {0, 0}, {1, 2}};
+    std::vector<double> val1{3, 1, 2};
+    Matrix<double, YALE, COOvec, columnMajor> m1{UseDynamic{}, i, val1};
+    m1.compress();
+    std::vector<double> ones{1, 1, 1};
+    std::cout << "Expected result: 1 2 3,\tcomputed result: ";
+    for (auto const& el : std::vector<double>(m1 * ones)) {
+        std::cout << el << " ";
+    }
+    std::cout << std::endl;
+
+    std::cout << std::endl;
+}
+
+void test_coohash() {
+    std::cout << "TESTING THE HASHED COO FORMAT" << std::endl;
+    using namespace algebra;
+
+    std::vector<std::pair<size_t, size_t>> ind{{3, 3}};
+    std::vector<double> val{8};
+    Matrix<double, YALE, COOhash, rowMajor> m(UseDynamic{}, 4, 4, ind, val);
+    m(0, 1) = 2;
+    m(2, 0) = 5;
+    m(0, 0) = 1;
+    m(1, 2) = 4;
+
+    std::cout << "Expected number of elements: 5,\tcomputed: "
+              << m.get_num_elements() << std::endl;
+    auto const& cm = m;
+    std::cout << "Expected element: 4,\tcomputed: " << cm(1, 2) << std::endl;
+    std::cout << "Expected element: 0,\tcomputed: " << cm(1, 1) << std::endl;
+    std::cout << "Expected norm: 8,\tcomputed norm: " << m.norm<Infinity>()
+              << std::endl;
+    std::cout << "Expected norm: 8,\tcomputed norm: " << m.norm<One>()
+              << std::endl;
+
+    std::vector<double> v{1, 1, 1, 1};
+    std::cout << "Expected result: 3 4 5 8,\tcomputed result: ";
+    for (auto const& el : std::vector<double>(m * v)) {
+        std::cout << el << " ";
+    }
+    std::cout << std::endl;
+
+    m.remove(0, 1);
+    m(1, 3) = 3;
+    std::cout << "Expected number of elements: 5,\tcomputed: "
+              << m.get_num_elements() << std::endl;
+
+    m.compress();
+    std::cout << "Expected result: 1 7 5 8,\tcomputed result: ";
+    for (auto const& el : std::vector<double>(m * v)) {
+        std::cout << el << " ";
+    }
+    std::cout << std::endl;
+
+    m.uncompress();
+    m(3, 0) = 2;
+    std::cout << "Expected print:" << std::endl
+              << "1 0 0 0 " << std::endl
+              << "0 0 4 3 " << std::endl
+              << "5 0 0 0 " << std::endl
+              << "2 0 0 8 " << std::endl;
+    m.print();
+
+    // Random insertions and removals, growing the table several times,
+    // checked against COOmap.
+    std::mt19937 generator(7);
+    std::uniform_int_distribution<size_t> index(0, 199);
+    Matrix<double, YALE, COOhash, columnMajor> m1(UseDynamic{}, 200, 200,
+                                                  ind, val);
+    Matrix<double, YALE, COOmap, columnMajor> ref(UseDynamic{}, 200, 200, ind,
+                                                  val);
+    for (size_t k = 0; k < 20000; ++k) {
+        size_t i = index(generator);
+        size_t j = index(generator);
+        if (k % 3 == 2) {
+            m1.remove(i, j);
+            ref.remove(i, j);
+        }
+        else {
+            m1(i, j) += static_cast<double>(k);
+            ref(i, j) += static_cast<double>(k);
+        }
+    }
+    auto equal = [&]() {
+        auto const& cm1 = m1;
+        auto const& cref = ref;
+        bool result = m1.get_num_elements() == ref.get_num_elements();
+        for (size_t i = 0; i < 200; ++i) {
+            for (size_t j = 0; j < 200; ++j) {
+                result = result && cm1(i, j) == cref(i, j);
+            }
+        }
+        return result;
+    };
+    std::cout << "Expected match with COOmap: 1,\tmatch: " << equal()
+              << std::endl;
+    m1.compress();
+    ref.compress();
+    std::cout << "Expected match after compressing: 1,\tmatch: " << equal()
+              << std::endl;
+    m1.uncompress();
+    ref.uncompress();
+    m1.prune(10000.0);
+    ref.prune(10000.0);
+    std::cout << "Expected match after pruning: 1,\tmatch: " << equal()
+              << std::endl;
+
+    // Positions that don't fit in a key are rejected in every build, both
+    // when building and when inserting after a resize.
+    const size_t huge = size_t{1} << 32;
+    auto rejected = [](auto&& f) {
+        try {
+            f();
+        } catch (std::overflow_error const&) {
+            return true;
+        }
+        return false;
+    };
+    Matrix<double, YALE, COOhash, rowMajor> m2(UseDynamic{}, 4, 4, ind, val);
+    std::cout << "Expected rejected (build, insertion): 1 1,\trejected: "
+              << rejected([&] {
+                     Matrix<double, YALE, COOhash, rowMajor> big(
+                         UseDynamic{}, huge, 4, ind, val);
+                 })
+              << " " << rejected([&] {
+                     m2.resize(huge + 1, 4);
+                     m2(huge, 0) = 1;
+                 })
+              << std::endl;
+
+    std::cout << std::endl;
+}
+
+void test_concurrent_compress() {
+    std::cout << "TESTING CONCURRENT COMPRESSION" << std::endl;
+    using namespace algebra;
+
+    std::vector<std::pair<size_t, size_t>> ind;
+    std::vector<double> val;
+    for (size_t i = 0; i < 500; ++i) {
+        for (size_t j = i % 3; j < 500; j += 7) {
+            ind.push_back({i, j});
+            val.push_back(static_cast<double>(i + j));
+        }
+    }
+
+    Matrix<double, YALE, COO, rowMajor> m1(UseDynamic{}, ind, val);
+    Matrix<double, YALE, COO, rowMajor> m2(UseDynamic{}, ind, val);
+    Matrix<double, YALE, COO, rowMajor> m3(UseDynamic{}, ind, val);
+    std::vector<double> v(500, 1.0);
+    std::vector<double> expected = m3 * v;
+
+    {
+        std::jthread t1([&]() {
+            for (int k = 0; k < 20; ++k) {
+                m1.compress();
+                m1.uncompress();
+            }
+            m1.compress();
+        });
+        std::jthread t2([&]() {
+            for (int k = 0; k < 20; ++k) {
+                m2.compress();
+                m2.uncompress();
+            }
+        });
+    }
+
+    double diff = 0;
+    std::vector<double> r1 = m1 * v;
+    std::vector<double> r2 = m2 * v;
+    for (size_t i = 0; i < expected.size(); ++i) {
+        diff = std::max(diff, std::abs(r1[i] - expected[i]));
+        diff = std::max(diff, std::abs(r2[i] - expected[i]));
+    }
+    std::cout << "Expected difference: 0,\tdifference: " << diff << std::endl;
+    std::cout << "Expected number of elements: " << ind.size()
+              << ", " << ind.size() << ",\tnumber of elements: "
+              << m1.get_num_elements() << ", " << m2.get_num_elements()
+              << std::endl;
+
+    std::cout << std::endl;
+}
+
+void test_matrixmarket_reader() {
+    std::cout << "TESTING THE PARALLEL MATRIX MARKET READER" << std::endl;
+    using namespace algebra;
+
+    std::string s{"matrix.mtx"};
+    Matrix<double, YALE, COO, rowMajor> m(s);
+    Matrix<double, YALE, COO, rowMajor> m1(UseCompressed{}, s, 4u);
+    m.compress();
+    std::vector<double> v(m.get_columns(), 1.0);
+    std::vector<double> r = m * v;
+    std::vector<double> r1 = m1 * v;
+    double diff = 0;
+    for (size_t i = 0; i < r.size(); ++i) {
+        diff = std::max(diff, std::abs(r[i] - r1[i]));
+    }
+    std::cout << "Expected difference from the dynamic reader: 0,\tdifference: "
+              << diff << std::endl;
+    std::cout << "Expected number of elements: " << m.get_num_elements()
+              << ",\tnumber of elements: " << m1.get_num_elements()
+              << std::endl;
+
+    std::string s1{"test_symmetric.mtx"};
+    {
+        std::ofstream file(s1);
+        file << "%%MatrixMarket matrix coordinate integer symmetric\n"
+             << "% a comment\n"
+             << "3 3 4\n"
+             << "1 1 1\n"
+             << "3 1 2\n"
+             << "\n"
+             << "2 2 3\n"
+             << "3 2 -4\n";
+    }
+    Matrix<double, YALE, COOmap, columnMajor> m2(UseCompressed{}, s1);
+    m2.uncompress();
+    std::cout << "Expected print:" << std::endl
+              << "Printing the transpose matrix (since it is stored "
+                 "column-wise)."
+              << std::endl
+              << "1 0 2 " << std::endl
+              << "0 3 -4 " << std::endl
+              << "2 -4 0 " << std::endl;
+    m2.print();
+
+    Matrix<double, YALE, COOvec, rowMajor> m3(s1);
+    std::cout << "Expected number of elements: 6,\tnumber of elements: "
+              << m3.get_num_elements() << std::endl;
+
+    std::string s2{"test_pattern.mtx"};
+    {
+        std::ofstream file(s2);
+        file << "%%MatrixMarket matrix coordinate pattern skew-symmetric\n"
+             << "2 2 1\n"
+             << "2 1\n";
+    }
+    Matrix<double, YALE, COO, rowMajor> m4(UseCompressed{}, s2);
+    std::cout << "Expected elements (0, 1), (1, 0): -1, 1,\telements: "
+              << m4(0, 1) << ", " << m4(1, 0) << std::endl;
+
+    std::string s3{"test_hermitian.mtx"};
+    {
+        std::ofstream file(s3);
+        file << "%%MatrixMarket matrix coordinate complex hermitian\n"
+             << "2 2 2\n"
+             << "1 1 2.0 0.0\n"
+             << "2 1 1.5 -1\n";
+    }
+    Matrix<std::complex<double>, YALE, COO, rowMajor> m5(UseCompressed{}, s3);
+    std::cout << "Expected elements (0, 1), (1, 0): (1.5,1), (1.5,-1),"
+              << "\telements: " << m5(0, 1) << ", " << m5(1, 0) << std::endl;
+
+    // Malformed entries are rejected in every build, also when they are
+    // parsed by a thread other than the calling one.
+    auto rejected = [&](std::string const& content) {
+        {
+            std::ofstream file(s1);
+            file << content;
+        }
+        try {
+            Matrix<double, YALE, COO, rowMajor> bad(UseCompressed{}, s1, 4u);
+        } catch (std::invalid_argument const&) {
+            return true;
+        }
+        return false;
+    };
+    std::string header{"%%MatrixMarket matrix coordinate real general\n"};
+    std::string large = header + "20000 20000 20000\n";
+    for (size_t k = 1; k < 20000; ++k) {
+        large += std::to_string(k) + " " + std::to_string(k) + " 1\n";
+    }
+    std::cout << "Expected rejected (index 0, index too big, malformed "
+                 "value, parsed by a worker): 1 1 1 1,\trejected: "
+              << rejected(header + "2 2 1\n0 1 1\n") << " "
+              << rejected(header + "2 2 1\n1 3 1\n") << " "
+              << rejected(header + "2 2 1\n1 1 x\n") << " "
+              << rejected(large + "20001 1 1\n") << std::endl;
+
+    std::remove(s1.c_str());
+    std::remove(s2.c_str());
+    std::remove(s3.c_str());
+
+    std::cout << std::endl;
+}
+
+void test_snapshot() {
+    std::cout << "TESTING BINARY SNAPSHOTS" << std::endl;
+    using namespace algebra;
+
+    std::string s{"matrix.mtx"};
+    std::string s1{"test_snapshot.yale"};
+    Matrix<double, YALE, COO, columnMajor> m(UseCompressed{}, s);
+    m.save_snapshot(s1);
+
+    MappedYALE<double, columnMajor> m1(s1);
+    std::cout << "Expected valid snapshot: 1,\tvalid: " << m1.is_valid()
+              << std::endl;
+    std::cout << "Expected dimensions: " << m.get_rows() << "x"
+              << m.get_columns() << ",\tdimensions: " << m1.get_rows() << "x"
+              << m1.get_columns() << std::endl;
+    std::cout << "Expected number of elements: " << m.get_num_elements()
+              << ",\tnumber of elements: " << m1.get_num_elements()
+              << std::endl;
+    std::cout << "Expected norms: " << m.norm<One>() << ", "
+              << m.norm<Infinity>() << ", " << m.norm<Frobenius>()
+              << ",\tnorms: " << m1.norm<One>() << ", " << m1.norm<Infinity>()
+              << ", " << m1.norm<Frobenius>() << std::endl;
+    std::cout << "Expected element (0, 0): " << m(0, 0)
+              << ",\telement: " << m1(0, 0) << std::endl;
+
+    std::vector<double> v(m.get_columns());
+    for (size_t i = 0; i < v.size(); ++i) v[i] = static_cast<double>(i % 7);
+    std::vector<double> r = m * v;
+    std::vector<double> r1 = m1 * v;
+    double diff = 0;
+    for (size_t i = 0; i < r.size(); ++i) {
+        diff = std::max(diff, std::abs(r[i] - r1[i]));
+    }
+    std::cout << "Expected difference: 0,\tdifference: " << diff << std::endl;
+
+    // The inner indexes of a mapped snapshot are checked against its header
+    // before being used.
+    std::vector<size_t> lines(m.get_inner_indexes().begin(),
+                              m.get_inner_indexes().end());
+    size_t nnz = m.get_num_elements();
+    bool whole = check_snapshot_lines<size_t>(lines, nnz);
+    bool truncated = check_snapshot_lines<size_t>(lines, nnz + 1);
+    std::swap(lines[1], lines[lines.size() - 2]);
+    bool decreasing = check_snapshot_lines<size_t>(lines, nnz);
+    std::cout << "Expected accepted (whole, truncated, decreasing): 1 0 0,"
+              << "\taccepted: " << whole << " " << truncated << " "
+              << decreasing << std::endl;
+
+    std::remove(s1.c_str());
+
+    std::cout << std::endl;
+}
+
+void test_index_width() {
+    std::cout << "TESTING INDEX WIDTH" << std::endl;
+    using namespace algebra;
+
+    std::string s{"matrix.mtx"};
+    std::string s1{"test_index_width.yale"};
+    Matrix<double, YALE, COO, rowMajor> m(UseCompressed{}, s);
+    Matrix<double, YALE32, COO, rowMajor> m32(UseCompressed{}, s);
+    Matrix<double, YALE32x64, COOmap, columnMajor> mixed(UseCompressed{}, s);
+    mixed.uncompress();
+    mixed.compress();
+
+    std::cout << "Expected index sizes: 4, 4, 4, 8,\tindex sizes: "
+              << sizeof(m32.get_outer_indexes()[0]) << ", "
+              << sizeof(m32.get_inner_indexes()[0]) << ", "
+              << sizeof(mixed.get_outer_indexes()[0]) << ", "
+              << sizeof(mixed.get_inner_indexes()[0]) << std::endl;
+    std::cout << "Expected number of elements: " << m.get_num_elements()
+              << ",\tnumber of elements: " << m32.get_num_elements() << ", "
+              << mixed.get_num_elements() << std::endl;
+    std::cout << "Expected norms: " << m.norm<One>() << ", "
+              << m.norm<Infinity>() << ",\tnorms: " << m32.norm<One>() << ", "
+              << m32.norm<Infinity>() << ", " << mixed.norm<One>() << ", "
+              << mixed.norm<Infinity>() << std::endl;
+
+    std::vector<double> v(m.get_columns());
+    for (size_t i = 0; i < v.size(); ++i) v[i] = static_cast<double>(i % 5);
+    std::vector<double> r = m * v;
+    std::vector<double> r32 = m32 * v;
+    std::vector<double> rmixed = mixed * v;
+    double diff = 0;
+    for (size_t i = 0; i < r.size(); ++i) {
+        diff = std::max(diff, std::abs(r[i] - r32[i]));
+        diff = std::max(diff, std::abs(r[i] - rmixed[i]));
+    }
+    std::cout << "Expected difference: 0,\tdifference: " << diff << std::endl;
+
+    m32(0, 1) = 1.5;
+    m32.uncompress();
+    m32.compress();
+    auto const& cm32 = m32;
+    std::cout << "Expected element (0, 1): 1.5,\telement: " << cm32(0, 1)
+              << std::endl;
+
+    m32.save_snapshot(s1);
+    MappedYALE<double, rowMajor, std::uint32_t> m1(s1);
+    std::cout << "Expected valid snapshot: 1,\tvalid: " << m1.is_valid()
+              << std::endl;
+    std::cout << "Expected element (0, 1): 1.5,\telement: " << m1(0, 1)
+              << std::endl;
+    std::remove(s1.c_str());
+
+    // Indexes that don't fit are rejected in every build, the matrix is left
+    // in dynamic state with its elements.
+    std::vector<std::pair<size_t, size_t>> wide{{0, 299}, {1, 3}};
+    std::vector<double> wide_values{1, 2};
+    Matrix<double, YALE8, COO, rowMajor> m8(UseDynamic{}, 2, 300, wide,
+                                            wide_values);
+    bool overflow = false;
+    try {
+        m8.compress();
+    } catch (std::overflow_error const&) {
+        overflow = true;
+    }
+    std::cout << "Expected overflow: 1, compressed: 0, element: 1,"
+              << "\toverflow: " << overflow
+              << ", compressed: " << m8.is_compressed()
+              << ", element: " << std::as_const(m8)(0, 299) << std::endl;
+
+    std::cout << std::endl;
+}
+
+void test_block_product() {
+    std::cout << "TESTING BLOCK PRODUCT" << std::endl;
+    using namespace algebra;
+
+    std::string s{"matrix.mtx"};
+    Matrix<double, YALE, COO, rowMajor> m(UseCompressed{}, s);
+    Matrix<double, YALE, COOmap, columnMajor> m1(UseCompressed{}, s);
+    Matrix<double, YALE, COO, columnMajor> m2(UseCompressed{}, s);
+    m2.uncompress();
+    Matrix<double, YALE, COOmap, rowMajor> m3(UseCompressed{}, s);
+    m3.uncompress();
+
+    auto matches = [](auto const& mat, size_t k) {
+        size_t rows = mat.get_rows();
+        size_t columns = mat.get_columns();
+        std::vector<double> x(columns * k);
+        for (size_t l = 0; l < x.size(); ++l) {
+            x[l] = static_cast<double>(l % 11) - 5;
+        }
+        std::vector<double> y(rows * k, 1.0);
+        mat.multiply_block(x, y, k, 2.0, 0.5);
+
+        double diff = 0;
+        double scale = 0;
+        std::vector<double> v(columns);
+        for (size_t c = 0; c < k; ++c) {
+            for (size_t j = 0; j < columns; ++j) v[j] = x[j * k + c];
+            std::vector<double> r = mat * v;
+            for (size_t i = 0; i < rows; ++i) {
+                double expected = 2.0 * r[i] + 0.5;
+                diff = std::max(diff, std::abs(y[i * k + c] - expected));
+                scale = std::max(scale, std::abs(expected));
+            }
+        }
+        return diff <= 1e-12 * scale;
+    };
+
+    for (size_t k : {1, 3, 4, 7, 8, 16, 20}) {
+        std::cout << "Expected match with " << k
+                  << " vectors: 1, 1, 1, 1,\tmatch: " << matches(m, k) << ", "
+                  << matches(m1, k) << ", " << matches(m2, k) << ", "
+                  << matches(m3, k) << std::endl;
+    }
+
+    std::cout << std::endl;
+}
+
+void test_assembly() {
+    std::cout << "TESTING BATCHED ASSEMBLY" << std::endl;
+    using namespace algebra;
+
+    std::string s{"matrix.mtx"};
+
+    // Two-node elements along the diagonal, as in a 1D finite-element mesh,
+    // skipping the nodes from 60 to 69; every element is inserted twice.
+    std::vector<std::pair<size_t, size_t>> indexes;
+    std::vector<double> values;
+    for (size_t repeat = 0; repeat < 2; ++repeat) {
+        for (size_t e = 0; e + 1 < 131; ++e) {
+            if (e >= 59 && e < 70) continue;
+            for (size_t a = 0; a < 2; ++a) {
+                for (size_t b = 0; b < 2; ++b) {
+                    indexes.push_back({e + a, e + b});
+                    values.push_back(a == b ? 1.0 + repeat : -1.0 - e);
+                }
+            }
+        }
+    }
+
+    auto matches = [&](auto& mat, InsertMode mode) {
+        Matrix<double, YALE, COOmap, rowMajor> ref(UseCompressed{}, s);
+        ref.uncompress();
+        for (size_t l = 0; l < indexes.size(); ++l) {
+            auto [i, j] = indexes[l];
+            if (mode == Add) {
+                ref(i, j) += values[l];
+            }
+            else {
+                ref(i, j) = values[l];
+            }
+        }
+
+        size_t half = indexes.size() / 2;
+        std::vector<std::pair<size_t, size_t>> first(
+            indexes.begin(), indexes.begin() + half);
+        std::vector<std::pair<size_t, size_t>> second(
+            indexes.begin() + half, indexes.end());
+        mat.assembly_begin(mode);
+        mat.insert_batch(first, std::vector<double>(values.begin(),
+                                                    values.begin() + half));
+        mat.insert_batch(second, std::vector<double>(values.begin() + half,
+                                                     values.end()));
+        mat.assembly_end();
+
+        auto const& cref = ref;
+        auto const& cmat = mat;
+        bool equal = mat.get_num_elements() == ref.get_num_elements();
+        for (size_t i = 0; i < 131; ++i) {
+            for (size_t j = 0; j < 131; ++j) {
+                equal = equal && cmat(i, j) == cref(i, j);
+            }
+        }
+        return equal;
+    };
+
+    Matrix<double, YALE, COO, rowMajor> m(UseCompressed{}, s);
+    Matrix<double, YALE, COOmap, columnMajor> m1(UseCompressed{}, s);
+    Matrix<double, YALE32, COOvec, rowMajor> m2(UseCompressed{}, s);
+    Matrix<double, YALE, COO, columnMajor> m3(UseCompressed{}, s);
+    std::cout << "Expected match adding: 1, 1, 1, 1,\tmatch: "
+              << matches(m, Add) << ", " << matches(m1, Add) << ", "
+              << matches(m2, Add) << ", " << matches(m3, Add) << std::endl;
+
+    Matrix<double, YALE, COO, rowMajor> m4(UseCompressed{}, s);
+    Matrix<double, YALE, COOmap, columnMajor> m5(UseCompressed{}, s);
+    Matrix<double, YALE, COOmap, rowMajor> m6(UseCompressed{}, s);
+    m6.uncompress();
+    std::cout << "Expected match overwriting: 1, 1, 1,\tmatch: "
+              << matches(m4, Overwrite) << ", " << matches(m5, Overwrite)
+              << ", " << matches(m6, Overwrite) << std::endl;
+
+    auto const& cm = m4;
+    std::cout << "Expected values: 2, -101,\tvalues: " << cm(100, 100) << ", "
+              << cm(100, 101) << std::endl;
+    std::cout << "Expected compressed state: 1,\tstate: "
+              << m.is_compressed() << std::endl;
+
+    std::cout << std::endl;
+}
+
+void test_transpose() {
+    std::cout << "TESTING THE TRANSPOSE" << std::endl;
+    using namespace algebra;
+
+    std::vector<std::pair<size_t, size_t>> ind{
+        {0, 0}, {0, 3}, {1, 1}, {2, 0}, {2, 2}};
+    std::vector<double> val{1, 2, 3, 4, 5};
+    Matrix<double, YALE, COO, rowMajor> m(UseDynamic{}, 3, 4, ind, val);
+
+    std::vector<double> x{1, 2, 3};
+    std::vector<double> y(4, 1);
+    m.multiply_transpose(x, y);
+    std::cout << "Expected result: 13 6 15 2,\tcomputed result: ";
+    for (auto const& el : y) std::cout << el << " ";
+    std::cout << std::endl;
+
+    m.compress();
+    std::fill(y.begin(), y.end(), 1);
+    m.multiply_transpose(x, y, 2.0, 1.0);
+    std::cout << "Expected result: 27 13 31 5,\tcomputed result: ";
+    for (auto const& el : y) std::cout << el << " ";
+    std::cout << std::endl;
+
+    auto t = m.transpose();
+    std::cout << "Expected dimensions: 4 3,\tcomputed: " << t.get_rows() << " "
+              << t.get_columns() << std::endl;
+    std::cout << "Expected compressed: 1,\tcomputed: " << t.is_compressed()
+              << std::endl;
+    std::cout << "Expected print:" << std::endl
+              << "1 0 4 " << std::endl
+              << "0 3 0 " << std::endl
+              << "0 0 5 " << std::endl
+              << "2 0 0 " << std::endl;
+    t.uncompress();
+    t.print();
+
+    // Random rectangular matrices: the transpose product must match the
+    // product of the transpose, in both states and in both storage orders.
+    std::mt19937 generator(11);
+    std::uniform_int_distribution<size_t> row(0, 36), column(0, 52);
+    std::uniform_real_distribution<double> value(-1, 1);
+    std::map<std::pair<size_t, size_t>, double> elements;
+    for (size_t k = 0; k < 400; ++k) {
+        elements[{row(generator), column(generator)}] = value(generator);
+    }
+    std::vector<std::pair<size_t, size_t>> rind;
+    std::vector<double> rval;
+    for (auto const& [key, v] : elements) {
+        rind.push_back(key);
+        rval.push_back(v);
+    }
+    std::vector<double> rx(37);
+    for (auto& el : rx) el = value(generator);
+
+    auto check = [&]<typename M>(M& a, std::string const& name) {
+        auto match = [&]() {
+            auto at = a.transpose();
+            auto const& ca = a;
+            auto const& cat = at;
+            bool result = at.get_rows() == 53 && at.get_columns() == 37 &&
+                          at.get_num_elements() == a.get_num_elements() &&
+                          at.is_compressed() == a.is_compressed();
+            for (size_t i = 0; i < 37; ++i) {
+                for (size_t j = 0; j < 53; ++j) {
+                    result = result && ca(i, j) == cat(j, i);
+                }
+            }
+
+            std::vector<double> y1(53, 1), y2(53, 1), y3(53, 1);
+            a.multiply_transpose(rx, y1, 2.0, 0.5);
+            a.multiply_transpose(rx, y2, 2.0, 0.5, 4);
+            at.multiply_into(rx, y3, 2.0, 0.5);
+            for (size_t j = 0; j < 53; ++j) {
+                result = result && std::abs(y1[j] - y3[j]) < 1e-12 &&
+                         std::abs(y2[j] - y3[j]) < 1e-12;
+            }
+
+            auto att = at.transpose();
+            auto const& catt = att;
+            for (auto const& [key, v] : elements) {
+                result = result && catt(key.first, key.second) == v;
+            }
+            return result && att.get_num_elements() == elements.size();
+        };
+
+        std::cout << "Expected match for " << name << ": 1,\tmatch: "
+                  << match();
+        a.compress();
+        std::cout << " " << match() << std::endl;
+    };
+
+    Matrix<double, YALE, COO, rowMajor> a1(UseDynamic{}, 37, 53, rind, rval);
+    Matrix<double, YALE, COOmap, columnMajor> a2(UseDynamic{}, 37, 53, rind,
+                                                 rval);
+    Matrix<double, YALE, COOvec, rowMajor> a3(UseDynamic{}, 37, 53, rind,
+                                              rval);
+    Matrix<double, YALE, COOhash, columnMajor> a4(UseDynamic{}, 37, 53, rind,
+                                                  rval);
+    // Elements inserted after the construction stay in the unsorted buffer
+    // of COOvec until they are needed in order.
+    a3(36, 52) = 1;
+    a3(0, 1) = -1;
+    elements[{36, 52}] = 1;
+    elements[{0, 1}] = -1;
+    check(a3, "COOvec, row-major");
+    elements.erase({36, 52});
+    elements.erase({0, 1});
+    check(a1, "COO, row-major");
+    check(a2, "COOmap, column-major");
+    check(a4, "COOhash, column-major");
+    std::cout << std::endl;
+}
+
+void test_spgemm() {
+    std::cout << "TESTING THE MATRIX-MATRIX PRODUCT" << std::endl;
+    using namespace algebra;
+
+    std::vector<std::pair<size_t, size_t>> ind1{{0, 0}, {0, 2}, {1, 1}};
+    std::vector<double> val1{1, 2, 3};
+    std::vector<std::pair<size_t, size_t>> ind2{{0, 1}, {1, 0}, {2, 1}};
+    std::vector<double> val2{4, 5, 6};
+    Matrix<double, YALE, COO, rowMajor> a(UseDynamic{}, 2, 3, ind1, val1);
+    Matrix<double, YALE, COO, rowMajor> b(UseDynamic{}, 3, 2, ind2, val2);
+    a.compress();
+    b.compress();
+
+    auto c = a * b;
+    std::cout << "Expected dimensions: 2 2,\tcomputed: " << c.get_rows() << " "
+              << c.get_columns() << std::endl;
+    std::cout << "Expected number of elements: 2,\tcomputed: "
+              << c.get_num_elements() << std::endl;
+    c.uncompress();
+    std::cout << "Expected print:" << std::endl
+              << "0 16 " << std::endl
+              << "15 0 " << std::endl;
+    c.print();
+
+    // Random matrices checked against a dense product, in all the
+    // combinations of storage orders. The wide rhs makes the short rows use
+    // the hash accumulator, the dense one the other rows.
+    std::mt19937 generator(5);
+    auto random = [&](size_t rows, size_t columns, size_t count,
+                      std::vector<std::pair<size_t, size_t>>& ind,
+                      std::vector<double>& val) {
+        std::uniform_int_distribution<size_t> row(0, rows - 1);
+        std::uniform_int_distribution<size_t> column(0, columns - 1);
+        std::uniform_int_distribution<int> value(-3, 3);
+        std::map<std::pair<size_t, size_t>, double> elements;
+        while (elements.size() < count) {
+            elements[{row(generator), column(generator)}] = value(generator);
+        }
+        ind.clear();
+        val.clear();
+        for (auto const& [key, v] : elements) {
+            ind.push_back(key);
+            val.push_back(v);
+        }
+    };
+
+    auto check = [&](size_t n, size_t k, size_t m, size_t nnz_a,
+                     size_t nnz_b, unsigned num_threads) {
+        std::vector<std::pair<size_t, size_t>> ia, ib;
+        std::vector<double> va, vb;
+        random(n, k, nnz_a, ia, va);
+        random(k, m, nnz_b, ib, vb);
+
+        std::vector<double> dense(n * m, 0);
+        for (size_t p = 0; p < ia.size(); ++p) {
+            for (size_t q = 0; q < ib.size(); ++q) {
+                if (ia[p].second == ib[q].first) {
+                    dense[ia[p].first * m + ib[q].second] += va[p] * vb[q];
+                }
+            }
+        }
+
+        auto matches = [&](auto const& product) {
+            bool result = product.get_rows() == n &&
+                          product.get_columns() == m &&
+                          product.is_compressed();
+            for (size_t i = 0; i < n; ++i) {
+                for (size_t j = 0; j < m; ++j) {
+                    result = result && product(i, j) == dense[i * m + j];
+                }
+            }
+            return result;
+        };
+
+        Matrix<double, YALE, COOmap, rowMajor> ar(UseDynamic{}, n, k, ia, va);
+        Matrix<double, YALE, COOmap, columnMajor> ac(UseDynamic{}, n, k, ia,
+                                                     va);
+        Matrix<double, YALE, COOmap, rowMajor> br(UseDynamic{}, k, m, ib, vb);
+        Matrix<double, YALE, COOmap, columnMajor> bc(UseDynamic{}, k, m, ib,
+                                                     vb);
+        ar.compress();
+        ac.compress();
+        br.compress();
+        bc.compress();
+
+        return matches(ar.multiply(br, num_threads)) &&
+               matches(ar.multiply(bc, num_threads)) &&
+               matches(ac.multiply(bc, num_threads)) &&
+               matches(ac.multiply(br, num_threads));
+    };
+
+    std::cout << "Expected match: 1,\tmatch: " << check(37, 53, 29, 300, 400, 1)
+              << std::endl;
+    std::cout << "Expected match (wide): 1,\tmatch: "
+              << check(60, 40, 5000, 200, 300, 1) << std::endl;
+    std::cout << "Expected match (4 threads): 1,\tmatch: "
+              << check(300, 300, 300, 3000, 3000, 4) << std::endl;
+
+    // The Galerkin product of a prolongation, as used by multigrid.
+    std::vector<std::pair<size_t, size_t>> ip{{0, 0}, {1, 0}, {2, 1}, {3, 1}};
+    std::vector<double> vp{1, 1, 1, 1};
+    std::vector<std::pair<size_t, size_t>> il;
+    std::vector<double> vl;
+    for (size_t i = 0; i < 4; ++i) {
+        il.push_back({i, i});
+        vl.push_back(2);
+        if (i > 0) {
+            il.push_back({i, i - 1});
+            vl.push_back(-1);
+        }
+        if (i < 3) {
+            il.push_back({i, i + 1});
+            vl.push_back(-1);
+        }
+    }
+    Matrix<double, YALE, COO, rowMajor> l(UseDynamic{}, 4, 4, il, vl);
+    Matrix<double, YALE, COO, rowMajor> pr(UseDynamic{}, 4, 2, ip, vp);
+    l.compress();
+    pr.compress();
+    auto coarse = pr.transpose() * l * pr;
+    coarse.uncompress();
+    std::cout << "Expected print:" << std::endl
+              << "2 -1 " << std::endl
+              << "-1 2 " << std::endl;
+    coarse.print();
+    std::cout << std::endl;
+}
+
+void test_symyale() {
+    std::cout << "TESTING THE SYMMETRIC STORAGE" << std::endl;
+    using namespace algebra;
+
+    // A random symmetric matrix, stored whole in YALE and halved in SymYALE.
+    const size_t n = 300;
+    std::mt19937 generator(11);
+    std::uniform_int_distribution<size_t> index(0, n - 1);
+    std::uniform_int_distribution<int> value(-5, 5);
+    std::map<std::pair<size_t, size_t>, double> elements;
+    while (elements.size() < 20000) {
+        size_t i = index(generator);
+        size_t j = index(generator);
+        double v = value(generator) + 0.5;
+        elements[{i, j}] = v;
+        elements[{j, i}] = v;
+    }
+    std::vector<std::pair<size_t, size_t>> ind;
+    std::vector<double> val;
+    for (auto const& [key, v] : elements) {
+        ind.push_back(key);
+        val.push_back(v);
+    }
+
+    std::vector<double> x(n);
+    for (auto& el : x) el = value(generator);
+
+    Matrix<double, YALE, COOmap, rowMajor> full(UseDynamic{}, n, n, ind, val);
+    Matrix<double, SymYALE, COOmap, rowMajor> lr(UseDynamic{}, n, n, ind, val);
+    Matrix<double, SymYALE, COOmap, columnMajor> lc(UseDynamic{}, n, n, ind,
+                                                    val);
+    full.compress();
+    lr.compress();
+    lc.compress();
+
+    auto difference = [&](auto const& m, unsigned num_threads) {
+        std::vector<double> expected = full * x;
+        std::vector<double> y(n, 1);
+        m.multiply_into(x, y, 2.0, 3.0, num_threads);
+        double diff = 0;
+        for (size_t i = 0; i < n; ++i) {
+            diff = std::max(diff, std::abs(y[i] - (2 * expected[i] + 3)));
+        }
+        return diff;
+    };
+    std::cout << "Expected differences from YALE: 0 0 0 0,\tdifferences: "
+              << difference(lr, 1) << " " << difference(lc, 1) << " "
+              << difference(lr, 4) << " " << difference(lc, 4) << std::endl;
+
+    std::cout << "Expected number of elements: " << full.get_num_elements()
+              << " " << full.get_num_elements()
+              << ",\tnumber of elements: " << lr.get_num_elements() << " "
+              << lc.get_num_elements() << std::endl;
+    size_t num_diagonal = 0;
+    for (size_t i = 0; i < n; ++i) num_diagonal += elements.count({i, i});
+    std::cout << "Expected stored elements: "
+              << (full.get_num_elements() + num_diagonal) / 2
+              << ",\tstored elements: " << lr.get_num_stored_elements()
+              << std::endl;
+    std::cout << "Expected norms: " << full.norm<One>() << " "
+              << full.norm<Infinity>() << " " << full.norm<Frobenius>()
+              << ",\tnorms: " << lc.norm<One>() << " " << lc.norm<Infinity>()
+              << " " << lr.norm<Frobenius>() << std::endl;
+
+    bool same = true;
+    for (auto const& [key, v] : elements) {
+        same = same && lr(key.first, key.second) == v &&
+               lc(key.first, key.second) == v;
+    }
+    std::cout << "Expected same elements: 1,\tsame: " << same << std::endl;
+
+    // Writing above the diagonal writes the mirrored element.
+    std::vector<std::pair<size_t, size_t>> ind1{{0, 0}, {1, 0}, {0, 1}};
+    std::vector<double> val1{1, 7, 7};
+    Matrix<double, SymYALE, COO, rowMajor> s(UseDynamic{}, 3, 3, ind1, val1);
+    s.compress();
+    s(1, 2) = 4;
+    s(2, 2) = 5;
+    std::cout << "Expected elements (2, 1), (0, 1): 4 7,\telements: "
+              << s(2, 1) << " " << s(0, 1) << std::endl;
+    std::cout << "Expected number of elements: 6,\tnumber of elements: "
+              << s.get_num_elements() << std::endl;
+    s.remove(0, 1);
+    std::cout << "Expected number of elements after the removal: 4,\tnumber "
+                 "of elements: "
+              << s.get_num_elements() << std::endl;
+    s.uncompress();
+    std::cout << "Expected print:" << std::endl
+              << "1 0 0 " << std::endl
+              << "0 0 4 " << std::endl
+              << "0 4 5 " << std::endl;
+    s.print();
+
+    // The uncompressed matrix holds both triangles again.
+    lc.uncompress();
+    std::cout << "Expected number of elements after the round trip: "
+              << elements.size()
+              << ",\tnumber of elements: " << lc.get_num_elements()
+              << std::endl;
+
+    // The Matrix Market loader keeps the lower triangle of symmetric files.
+    std::string s1{"test_symyale.mtx"};
+    {
+        std::ofstream file(s1);
+        file << "%%MatrixMarket matrix coordinate real symmetric\n"
+             << "3 3 4\n"
+             << "1 1 1\n"
+             << "3 1 2\n"
+             << "2 2 3\n"
+             << "2 3 -4\n";
+    }
+    Matrix<double, SymYALE, COOmap, columnMajor> m(UseCompressed{}, s1);
+    std::cout << "Expected stored elements: 4,\tstored elements: "
+              << m.get_num_stored_elements() << std::endl;
+    m.uncompress();
+    std::cout << "Expected print:" << std::endl
+              << "Printing the transpose matrix (since it is stored "
+                 "column-wise)."
+              << std::endl
+              << "1 0 2 " << std::endl
+              << "0 3 -4 " << std::endl
+              << "2 -4 0 " << std::endl;
+    m.print();
+
+    // A general file is kept only if it's symmetric, files whose mirrored
+    // elements differ from the stored ones are rejected in every build.
+    auto loads = [&](std::string const& content) {
+        {
+            std::ofstream file(s1);
+            file << content;
+        }
+        try {
+            Matrix<double, SymYALE, COO, rowMajor> g(UseCompressed{}, s1);
+            return g.get_num_stored_elements() == 2 && g(0, 1) == 2;
+        } catch (std::invalid_argument const&) {
+            return false;
+        }
+    };
+    std::string general{"%%MatrixMarket matrix coordinate real general\n"
+                        "2 2 3\n1 1 1\n1 2 2\n2 1 "};
+    std::cout << "Expected loaded (symmetric, non-symmetric, skew-symmetric, "
+                 "non-square): 1 0 0 0,\tloaded: "
+              << loads(general + "2\n") << " " << loads(general + "3\n")
+              << " "
+              << loads("%%MatrixMarket matrix coordinate real "
+                       "skew-symmetric\n2 2 1\n2 1 2\n")
+              << " "
+              << loads("%%MatrixMarket matrix coordinate real general\n"
+                       "2 3 1\n1 1 1\n")
+              << std::endl;
+    std::remove(s1.c_str());
+
+    // The same check is made when compressing a dynamic matrix, which stays
+    // dynamic if it's rejected.
+    auto compresses = [](double mirrored) {
+        std::vector<std::pair<size_t, size_t>> id{{0, 0}, {0, 1}, {1, 0}};
+        std::vector<double> vd{1, 2, mirrored};
+        Matrix<double, SymYALE, COO, rowMajor> d(UseDynamic{}, 2, 2, id, vd);
+        try {
+            d.compress();
+        } catch (std::invalid_argument const&) {
+            return !d.is_compressed() && d(1, 0) == mirrored ? 0 : -1;
+        }
+        return d.get_num_stored_elements() == 2 && d(0, 1) == 2 ? 1 : -1;
+    };
+    std::cout << "Expected compressed (symmetric, non-symmetric): 1 0,"
+              << "\tcompressed: " << compresses(2) << " " << compresses(3)
+              << std::endl;
+
+    std::cout << std::endl;
+}
+
+void test_bsr() {
+    std::cout << "TESTING THE BLOCK COMPRESSED FORMAT" << std::endl;
+    using namespace algebra;
+
+    // Two 2x2 blocks, the second one with a single element.
+    std::vector<size_t> out{0, 1};
+    std::vector<size_t> in{0, 1, 2};
+    std::vector<double> val{1, 2, 0, 3, 4, 0, 0, 0};
+    Matrix<double, BSR2, COO, rowMajor> b(UseCompressed{}, out, in, val);
+    std::cout << "Expected dimensions: 4 4,\tcomputed: " << b.get_rows() << " "
+              << b.get_columns() << std::endl;
+    std::cout << "Expected number of elements: 4,\tnumber of elements: "
+              << b.get_num_elements() << std::endl;
+    std::cout << "Expected fill ratio: 0.5,\tfill ratio: "
+              << b.get_fill_ratio() << std::endl;
+    b(3, 0) = 5;
+    b.remove(0, 1);
+    std::cout << "Expected blocks: 3,\tblocks: " << b.get_num_blocks()
+              << std::endl;
+    b.uncompress();
+    std::cout << "Expected print:" << std::endl
+              << "1 0 0 0 " << std::endl
+              << "0 3 0 0 " << std::endl
+              << "0 0 4 0 " << std::endl
+              << "5 0 0 0 " << std::endl;
+    b.print();
+
+    // A random matrix made of 3x3 blocks, some of them partially filled,
+    // checked against YALE.
+    const size_t n = 3 * 400;
+    std::mt19937 generator(17);
+    std::uniform_int_distribution<size_t> block(0, n / 3 - 1);
+    std::uniform_int_distribution<int> value(1, 9);
+    std::uniform_int_distribution<int> coin(0, 5);
+    std::map<std::pair<size_t, size_t>, double> elements;
+    for (size_t k = 0; k < 4000; ++k) {
+        size_t bi = block(generator);
+        size_t bj = block(generator);
+        for (size_t r = 0; r < 3; ++r) {
+            for (size_t c = 0; c < 3; ++c) {
+                if (coin(generator) == 0) continue;
+                elements[{3 * bi + r, 3 * bj + c}] = value(generator);
+            }
+        }
+    }
+    std::vector<std::pair<size_t, size_t>> ind;
+    std::vector<double> values;
+    for (auto const& [key, v] : elements) {
+        ind.push_back(key);
+        values.push_back(v);
+    }
+    std::vector<double> x(n);
+    for (auto& el : x) el = value(generator);
+
+    Matrix<double, YALE, COOmap, rowMajor> yale(UseDynamic{}, n, n, ind,
+                                                values);
+    Matrix<double, BSR3, COOmap, rowMajor> br(UseDynamic{}, n, n, ind, values);
+    Matrix<double, BSR3, COOvec, columnMajor> bc(UseDynamic{}, n, n, ind,
+                                                 values);
+    yale.compress();
+    br.compress();
+    bc.compress();
+
+    std::vector<double> expected(n), expected_t(n);
+    yale.multiply_into(x, expected, 2.0);
+    yale.multiply_transpose(x, expected_t, 2.0);
+    auto difference = [&](auto const& m, unsigned num_threads) {
+        std::vector<double> y(n, 1), z(n, 1);
+        m.multiply_into(x, y, 2.0, 3.0, num_threads);
+        m.multiply_transpose(x, z, 2.0, 3.0, num_threads);
+        double diff = 0;
+        for (size_t i = 0; i < n; ++i) {
+            diff = std::max(diff, std::abs(y[i] - expected[i] - 3));
+            diff = std::max(diff, std::abs(z[i] - expected_t[i] - 3));
+        }
+        return diff;
+    };
+    std::cout << "Expected differences from YALE: 0 0 0 0,\tdifferences: "
+              << difference(br, 1) << " " << difference(bc, 1) << " "
+              << difference(br, 4) << " " << difference(bc, 4) << std::endl;
+    std::cout << "Expected number of elements: " << yale.get_num_elements()
+              << " " << yale.get_num_elements()
+              << ",\tnumber of elements: " << br.get_num_elements() << " "
+              << bc.get_num_elements() << std::endl;
+    std::cout << "Expected norms: " << yale.norm<One>() << " "
+              << yale.norm<Infinity>() << " " << yale.norm<Frobenius>()
+              << ",\tnorms: " << bc.norm<One>() << " " << br.norm<Infinity>()
+              << " " << bc.norm<Frobenius>() << std::endl;
+    std::cout << "Expected norms: " << yale.norm<One>() << " "
+              << yale.norm<Infinity>() << ",\tnorms: " << br.norm<One>() << " "
+              << bc.norm<Infinity>() << std::endl;
+
+    bool same = true;
+    for (auto const& [key, v] : elements) {
+        same = same && br(key.first, key.second) == v &&
+               bc(key.first, key.second) == v;
+    }
+    std::cout << "Expected same elements: 1,\tsame: " << same << std::endl;
+
+    size_t removed = br.remove_if(
+        [](size_t i, size_t, double const&) { return i % 3 == 0; });
+    size_t expected_removed = yale.remove_if(
+        [](size_t i, size_t, double const&) { return i % 3 == 0; });
+    std::cout << "Expected removed elements: " << expected_removed
+              << ",\tremoved elements: " << removed << std::endl;
+    yale.multiply_into(x, expected, 2.0);
+    yale.multiply_transpose(x, expected_t, 2.0);
+    std::cout << "Expected difference after the removal: 0,\tdifference: "
+              << difference(br, 1) << std::endl;
+
+    bc.uncompress();
+    std::cout << "Expected number of elements after the round trip: "
+              << elements.size()
+              << ",\tnumber of elements: " << bc.get_num_elements()
+              << std::endl;
+
+    std::cout << std::endl;
+}
+
+void test_krylov() {
+    std::cout << "TESTING THE FUSED KERNELS AND THE KRYLOV SOLVERS"
+              << std::endl;
+    using namespace algebra;
+    using complex = std::complex<double>;
+
+    // The fused kernels against the separate product and vector operations,
+    // on a random square matrix large enough to use the threads.
+    const size_t n = 500;
+    std::mt19937 generator(23);
+    std::uniform_int_distribution<size_t> index(0, n - 1);
+    std::uniform_real_distribution<double> value(-1, 1);
+    std::map<std::pair<size_t, size_t>, complex> elements;
+    while (elements.size() < 20000) {
+        elements[{index(generator), index(generator)}] =
+            complex(value(generator), value(generator));
+    }
+    std::vector<std::pair<size_t, size_t>> ind;
+    std::vector<double> real_values;
+    std::vector<complex> complex_values;
+    for (auto const& [key, v] : elements) {
+        ind.push_back(key);
+        real_values.push_back(v.real());
+        complex_values.push_back(v);
+    }
+
+    auto fused_difference = [&](auto& m, auto const& x) {
+        using T = typename std::decay_t<decltype(x)>::value_type;
+        std::vector<T> y(n), r(n, T{1});
+        std::vector<T> expected(n), expected_r(n, T{1});
+        double diff = 0;
+
+        for (unsigned num_threads : {1u, 4u}) {
+            T d = m.multiply_dot(x, y, num_threads);
+            m.multiply_into(x, expected);
+            T expected_d{};
+            for (size_t i = 0; i < n; ++i) {
+                expected_d += conjugate(x[i]) * expected[i];
+                diff = std::max(diff, std::abs(y[i] - expected[i]));
+            }
+            diff = std::max(diff, std::abs(d - expected_d));
+
+            double rr = m.multiply_residual(x, r, T{2}, num_threads);
+            double expected_rr = 0;
+            for (size_t i = 0; i < n; ++i) {
+                expected_r[i] -= T{2} * expected[i];
+                expected_rr += std::norm(expected_r[i]);
+                diff = std::max(diff, std::abs(r[i] - expected_r[i]));
+            }
+            diff = std::max(diff, std::abs(rr - expected_rr));
+        }
+        return diff < 1e-9;
+    };
+
+    std::vector<double> xr(n);
+    std::vector<complex> xc(n);
+    for (size_t i = 0; i < n; ++i) {
+        xr[i] = value(generator);
+        xc[i] = complex(value(generator), value(generator));
+    }
+
+    Matrix<double, YALE, COOmap, rowMajor> ar(UseDynamic{}, n, n, ind,
+                                              real_values);
+    Matrix<complex, YALE, COOmap, columnMajor> ac(UseDynamic{}, n, n, ind,
+                                                  complex_values);
+    Matrix<double, SELL, COOmap, rowMajor> as(UseDynamic{}, n, n, ind,
+                                              real_values);
+    bool dynamic_ok = fused_difference(ar, xr) && fused_difference(ac, xc);
+    ar.compress();
+    ac.compress();
+    as.compress();
+    std::cout << "Expected matches (dynamic, row-major, column-major complex, "
+                 "fallback): 1 1 1 1,\tmatches: "
+              << dynamic_ok << " " << fused_difference(ar, xr) << " "
+              << fused_difference(ac, xc) << " " << fused_difference(as, xr)
+              << std::endl;
+
+    // A 2D Laplacian, shifted, plus a small skew-symmetric imaginary part:
+    // hermitian positive definite, and non-symmetric once the imaginary unit
+    // is dropped.
+    const size_t side = 30;
+    const size_t size = side * side;
+    std::vector<std::pair<size_t, size_t>> il;
+    std::vector<complex> vl;
+    for (size_t i = 0; i < side; ++i) {
+        for (size_t j = 0; j < side; ++j) {
+            size_t k = i * side + j;
+            il.push_back({k, k});
+            vl.push_back(5.0);
+            if (j > 0) {
+                il.push_back({k, k - 1});
+                vl.push_back(complex(-1, -0.1));
+            }
+            if (j + 1 < side) {
+                il.push_back({k, k + 1});
+                vl.push_back(complex(-1, 0.1));
+            }
+            if (i > 0) {
+                il.push_back({k, k - side});
+                vl.push_back(-1);
+            }
+            if (i + 1 < side) {
+                il.push_back({k, k + side});
+                vl.push_back(-1);
+            }
+        }
+    }
+    std::vector<double> vn;
+    for (auto const& el : vl) vn.push_back(el.real() + 4 * el.imag());
+
+    Matrix<complex, YALE, COO, rowMajor> hermitian(UseDynamic{}, size, size,
+                                                   il, vl);
+    Matrix<double, YALE, COO, columnMajor> laplacian(UseDynamic{}, size, size,
+                                                     il, vn);
+    hermitian.compress();
+
+    auto solves = [&](auto const& m, auto solver) {
+        using T = typename std::decay_t<decltype(m(0, 0))>;
+        std::vector<T> solution(size), b(size), x(size, T{});
+        for (size_t i = 0; i < size; ++i) {
+            if constexpr (std::is_same_v<T, complex>) {
+                solution[i] = complex(std::sin(i), std::cos(i));
+            }
+            else {
+                solution[i] = std::sin(i);
+            }
+        }
+        m.multiply_into(solution, b);
+
+        SolverResult result = solver(m, b, x);
+        double error = 0;
+        for (size_t i = 0; i < size; ++i) {
+            error = std::max(error, std::abs(x[i] - solution[i]));
+        }
+        return result.converged && result.residual <= 1e-10 &&
+               result.iterations > 0 && error < 1e-7;
+    };
+    auto cg = [](auto const& m, auto const& b, auto& x) {
+        return conjugate_gradient(m, b, x, 1e-12);
+    };
+    auto bicg = [](auto const& m, auto const& b, auto& x) {
+        return bicgstab(m, b, x, 1e-12, 0, 4);
+    };
+
+    bool dynamic_solves = solves(laplacian, bicg);
+    laplacian.compress();
+    std::cout << "Expected solved (CG hermitian, BiCGSTAB hermitian, BiCGSTAB "
+                 "non-symmetric dynamic and compressed): 1 1 1 1,\tsolved: "
+              << solves(hermitian, cg) << " " << solves(hermitian, bicg) << " "
+              << dynamic_solves << " " << solves(laplacian, bicg) << std::endl;
+
+    std::vector<double> zero(size, 0), x(size, 1);
+    SolverResult result = conjugate_gradient(laplacian, zero, x);
+    std::cout << "Expected iterations and solution with a null rhs: 0 0,"
+              << "\titerations and solution: " << result.iterations << " "
+              << x[0] << std::endl;
+
+    std::cout << std::endl;
+}
+
+void test_mixed_precision() {
+    std::cout << "TESTING THE MIXED PRECISION STORAGE" << std::endl;
+    using namespace algebra;
+
+    // Values exactly representable with 8 bits of precision, so the products
+    // on the rounded values match the ones in double precision.
+    const size_t n = 400;
+    std::mt19937 generator(31);
+    std::uniform_int_distribution<size_t> index(0, n - 1);
+    std::uniform_int_distribution<int> value(-8, 8);
+    std::map<std::pair<size_t, size_t>, double> elements;
+    while (elements.size() < 20000) {
+        elements[{index(generator), index(generator)}] =
+            value(generator) + 0.25;
+    }
+    std::vector<std::pair<size_t, size_t>> ind;
+    std::vector<double> val;
+    for (auto const& [key, v] : elements) {
+        ind.push_back(key);
+        val.push_back(v);
+    }
+    std::vector<double> x(n);
+    for (auto& el : x) el = value(generator);
+
+    Matrix<double, YALE, COOmap, rowMajor> full(UseDynamic{}, n, n, ind, val);
+    Matrix<double, FloatYALE, COOmap, rowMajor> fr(UseDynamic{}, n, n, ind,
+                                                   val);
+    Matrix<double, FloatYALE32, COOmap, columnMajor> fc(UseDynamic{}, n, n,
+                                                        ind, val);
+    Matrix<double, BF16YALE, COOmap, rowMajor> br(UseDynamic{}, n, n, ind,
+                                                  val);
+    full.compress();
+    fr.compress();
+    fc.compress();
+    br.compress();
+
+    auto difference = [&](auto const& m, unsigned num_threads) {
+        std::vector<double> expected(n), expected_t(n);
+        full.multiply_into(x, expected);
+        full.multiply_transpose(x, expected_t);
+        std::vector<double> y(n, 1), yt(n);
+        m.multiply_into(x, y, 2.0, 3.0, num_threads);
+        m.multiply_transpose(x, yt, 1.0, 0.0, num_threads);
+        double diff = 0;
+        for (size_t i = 0; i < n; ++i) {
+            diff = std::max(diff, std::abs(y[i] - (2 * expected[i] + 3)));
+            diff = std::max(diff, std::abs(yt[i] - expected_t[i]));
+        }
+        return diff;
+    };
+    std::cout << "Expected differences from YALE: 0 0 0 0 0 0,\tdifferences: "
+              << difference(fr, 1) << " " << difference(fc, 1) << " "
+              << difference(br, 1) << " " << difference(fr, 4) << " "
+              << difference(fc, 4) << " " << difference(br, 4) << std::endl;
+
+    std::cout << "Expected norms: " << full.norm<One>() << " "
+              << full.norm<Infinity>() << " " << full.norm<Frobenius>()
+              << ",\tnorms: " << fc.norm<One>() << " " << br.norm<Infinity>()
+              << " " << fr.norm<Frobenius>() << std::endl;
+    std::cout << "Expected number of elements: " << full.get_num_elements()
+              << ",\tnumber of elements: " << fc.get_num_elements()
+              << std::endl;
+
+    // The values are rounded when compressing and kept rounded afterwards.
+    std::vector<std::pair<size_t, size_t>> ind1{{0, 0}, {0, 1}, {1, 1}};
+    std::vector<double> val1{0.1, 1.0 / 3, 2};
+    Matrix<double, FloatYALE, COO, rowMajor> f(UseDynamic{}, ind1, val1);
+    Matrix<double, BF16YALE, COO, rowMajor> b(UseDynamic{}, ind1, val1);
+    f.compress();
+    b.compress();
+    auto const& fconst = f;
+    auto const& bconst = b;
+    std::cout << "Expected rounded elements: 1 1 0.333984,\telements: "
+              << (fconst(0, 0) == static_cast<float>(0.1)) << " "
+              << (fconst(0, 1) == static_cast<float>(1.0 / 3)) << " "
+              << bconst(0, 1) << std::endl;
+    b.remove_if([](size_t, size_t, double v) { return v < 0.2; });
+    b.uncompress();
+    std::cout << "Expected elements after the round trip: 0 0.333984 2,\t"
+                 "elements: "
+              << bconst(0, 0) << " " << bconst(0, 1) << " " << bconst(1, 1)
+              << std::endl;
+
+    // The values take half, or a quarter, of the bytes.
+    Matrix<double, YALE, COO, rowMajor> d(UseDynamic{}, ind1, val1);
+    d.compress();
+    b.compress();
+    std::cout << "Expected bytes per value: 8 4 2,\tbytes per value: "
+              << d.get_values().size_bytes() / 3 << " "
+              << f.get_values().size_bytes() / 3 << " "
+              << b.get_values().size_bytes() / 2 << std::endl;
+
+    // A 1D Laplacian, exactly representable, solved with the fused kernels
+    // on the single precision values.
+    const size_t size = 200;
+    std::vector<std::pair<size_t, size_t>> il;
+    std::vector<double> vl;
+    for (size_t i = 0; i < size; ++i) {
+        if (i > 0) {
+            il.push_back({i, i - 1});
+            vl.push_back(-1);
+        }
+        il.push_back({i, i});
+        vl.push_back(2);
+        if (i + 1 < size) {
+            il.push_back({i, i + 1});
+            vl.push_back(-1);
+        }
+    }
+    Matrix<double, FloatYALE32, COO, rowMajor> laplacian(UseDynamic{}, il, vl);
+    laplacian.compress();
+    std::vector<double> rhs(size, 1), solution(size, 0);
+    SolverResult result = conjugate_gradient(laplacian, rhs, solution);
+    std::cout << "Expected converged: 1,\tconverged: " << result.converged
+              << std::endl;
+    std::cout << std::endl;
+}
+
+void test_reordering() {
+    std::cout << "TESTING THE REVERSE CUTHILL-MCKEE REORDERING" << std::endl;
+    using namespace algebra;
+
+    // A 2D Laplacian with randomly numbered nodes, so that its bandwidth is
+    // close to the size.
+    const size_t side = 40;
+    const size_t n = side * side;
+    std::mt19937 generator(37);
+    std::vector<size_t> label(n);
+    std::iota(label.begin(), label.end(), 0);
+    std::shuffle(label.begin(), label.end(), generator);
+
+    std::vector<std::pair<size_t, size_t>> ind;
+    std::vector<double> val;
+    std::uniform_real_distribution<double> value(-1, 1);
+    for (size_t i = 0; i < side; ++i) {
+        for (size_t j = 0; j < side; ++j) {
+            size_t k = label[i * side + j];
+            ind.push_back({k, k});
+            val.push_back(4);
+            for (auto [di, dj] : {std::pair{1, 0}, {0, 1}}) {
+                if (i + di < side && j + dj < side) {
+                    size_t l = label[(i + di) * side + j + dj];
+                    double v = value(generator);
+                    ind.push_back({k, l});
+                    val.push_back(v);
+                    ind.push_back({l, k});
+                    val.push_back(v);
+                }
+            }
+        }
+    }
+
+    Matrix<double, YALE, COO, rowMajor> a(UseDynamic{}, n, n, ind, val);
+    Matrix<double, YALE, COO, columnMajor> ac(UseDynamic{}, n, n, ind, val);
+    a.compress();
+    ac.compress();
+
+    std::vector<size_t> perm = a.reverse_cuthill_mckee();
+    std::vector<size_t> sorted(perm);
+    std::sort(sorted.begin(), sorted.end());
+    bool is_permutation = sorted.size() == n;
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        is_permutation = is_permutation && sorted[i] == i;
+    }
+    std::cout << "Expected permutation: 1, same in both orders: 1,\t"
+                 "permutation: "
+              << is_permutation << ", same in both orders: "
+              << (perm == ac.reverse_cuthill_mckee()) << std::endl;
+
+    auto b = a.permute(perm);
+    auto bc = ac.permute(perm);
+    size_t before = compressed_bandwidth(a.get_inner_indexes(),
+                                         a.get_outer_indexes());
+    size_t after = compressed_bandwidth(b.get_inner_indexes(),
+                                        b.get_outer_indexes());
+    std::cout << "Expected bandwidth at most " << 2 * side
+              << " and reduced: 1,\tbandwidth at most " << 2 * side
+              << " and reduced: " << (after <= 2 * side && after < before)
+              << std::endl;
+    std::cout << "Expected number of elements: " << a.get_num_elements()
+              << " " << a.get_num_elements()
+              << ",\tnumber of elements: " << b.get_num_elements() << " "
+              << bc.get_num_elements() << std::endl;
+
+    // Permuting the vectors once outside the products gives the same result.
+    std::vector<double> x(n), y(n), yb(n), ybc(n);
+    for (auto& el : x) el = value(generator);
+    a.multiply_into(x, y);
+    std::vector<double> xp(x);
+    apply_permutation(xp, perm);
+    b.multiply_into(xp, yb);
+    bc.multiply_into(xp, ybc, 1.0, 0.0, 4);
+    apply_permutation(yb, invert_permutation(perm));
+    apply_permutation(ybc, invert_permutation(perm));
+    double diff = 0;
+    for (size_t i = 0; i < n; ++i) {
+        diff = std::max(diff, std::abs(yb[i] - y[i]));
+        diff = std::max(diff, std::abs(ybc[i] - y[i]));
+    }
+    std::cout << "Expected same permuted products: 1,\tsame: "
+              << (diff < 1e-12) << std::endl;
+
+    bool same = true;
+    for (size_t i = 0; i < n; i += 7) {
+        for (size_t j = 0; j < n; j += 5) {
+            same = same && b(i, j) == a(perm[i], perm[j]) &&
+                   bc(i, j) == a(perm[i], perm[j]);
+        }
+    }
+    std::cout << "Expected same elements: 1,\tsame: " << same << std::endl;
+
+    // A scrambled path and a non-symmetric pattern made of two components.
+    std::vector<std::pair<size_t, size_t>> ip{
+        {0, 3}, {3, 1}, {1, 4}, {4, 2}, {5, 6}, {6, 5}, {5, 5}};
+    std::vector<double> vp{1, 2, 3, 4, 5, 6, 7};
+    Matrix<double, YALE, COO, rowMajor> path(UseDynamic{}, 7, 7, ip, vp);
+    path.compress();
+    auto path_perm = path.reverse_cuthill_mckee();
+    auto permuted = path.permute(path_perm);
+    std::cout << "Expected bandwidth: 1,\tbandwidth: "
+              << compressed_bandwidth(permuted.get_inner_indexes(),
+                                      permuted.get_outer_indexes())
+              << std::endl;
+    std::cout << std::endl;
+}
+
+void test_cached_properties() {
+    std::cout << "TESTING THE CACHED PROPERTIES" << std::endl;
+    using namespace algebra;
+
+    std::vector<std::pair<size_t, size_t>> ind{
+        {0, 0}, {0, 4}, {1, 1}, {2, 0}, {3, 3}, {5, 1}};
+    std::vector<double> val{2, 1, 3, 4, -1, 7};
+    Matrix<double, YALE, COO, rowMajor> a(UseDynamic{}, 6, 5, ind, val);
+    Matrix<double, YALE, COOmap, columnMajor> ac(UseDynamic{}, 6, 5, ind,
+                                                 val);
+
+    auto print_stats = [](MatrixStats const& stats) {
+        std::cout << stats.num_elements << " [";
+        for (auto const& length : stats.row_lengths) std::cout << length;
+        std::cout << "] " << stats.max_row_length << " " << stats.bandwidth
+                  << " " << stats.num_diagonal;
+    };
+    auto print_diagonal = [](std::vector<double> const& diagonal) {
+        for (auto const& el : diagonal) std::cout << " " << el;
+    };
+
+    std::cout << "Expected stats: 6 [211101] 2 4 3,\tdynamic: ";
+    print_stats(a.stats());
+    a.compress();
+    ac.compress();
+    std::cout << ", compressed: ";
+    print_stats(a.stats());
+    std::cout << ", column-major: ";
+    print_stats(ac.stats());
+    std::cout << std::endl;
+
+    std::cout << "Expected diagonal: 2 3 0 -1 0,\tdiagonal:";
+    print_diagonal(a.diagonal());
+    std::cout << ", column-major:";
+    print_diagonal(ac.diagonal());
+    std::cout << std::endl;
+
+    // Every modification clears the cache.
+    double before = a.norm<Frobenius>();
+    a(2, 2) = 5;
+    double written = a.norm<Frobenius>();
+    std::cout << "Expected norm after writing: " << std::sqrt(80.0 + 25.0)
+              << ",\tnorm: " << written << ", diagonal:";
+    print_diagonal(a.diagonal());
+    std::cout << std::endl;
+    a.remove(2, 2);
+    std::cout << "Expected norm after removing: " << before
+              << ",\tnorm: " << a.norm<Frobenius>() << ", elements: "
+              << a.stats().num_elements << std::endl;
+    a.uncompress();
+    a.remove_if([](size_t i, size_t j, double) { return i == j; });
+    std::cout << "Expected stats: 3 0, diagonal: 0 0 0 0 0,\tstats: "
+              << a.stats().num_elements << " " << a.stats().num_diagonal
+              << ", diagonal:";
+    print_diagonal(a.diagonal());
+    std::cout << std::endl;
+
+    // The other formats give the same diagonal, found by operator().
+    std::vector<std::pair<size_t, size_t>> is{
+        {0, 0}, {0, 2}, {1, 1}, {2, 0}, {2, 2}, {3, 1}, {1, 3}};
+    std::vector<double> vs{1, 2, 3, 2, 4, 5, 5};
+    Matrix<double, SymYALE, COO, rowMajor> sym(UseDynamic{}, 4, 4, is, vs);
+    Matrix<double, SELL, COO, rowMajor> sell(UseDynamic{}, 4, 4, is, vs);
+    Matrix<double, BSR2, COO, columnMajor> bsr(UseDynamic{}, 4, 4, is, vs);
+    sym.compress();
+    sell.compress();
+    bsr.compress();
+    std::cout << "Expected diagonal: 1 3 4 0,\tSymYALE:";
+    print_diagonal(sym.diagonal());
+    std::cout << ", SELL:";
+    print_diagonal(sell.diagonal());
+    std::cout << ", BSR:";
+    print_diagonal(bsr.diagonal());
+    std::cout << std::endl;
+    std::cout << "Expected stats: 7 [2221] 2 2 3,\tSymYALE: ";
+    print_stats(sym.stats());
+    std::cout << ", BSR: ";
+    print_stats(bsr.stats());
+    std::cout << std::endl;
+
+    // A reference handed out by operator() can be written after a norm is
+    // computed, so the norms aren't cached while it may be.
+    Matrix<double, YALE, COO, rowMajor> b(UseDynamic{}, 6, 5, ind, val);
+    b.compress();
+    double& reference = b(0, 0);
+    double norm = b.norm<Infinity>();
+    reference = 10;
+    std::cout << "Expected norms: 7 11,\tnorms: " << norm << " "
+              << b.norm<Infinity>() << std::endl;
+
+    // Several threads fill the cache of the same matrix at once.
+    Matrix<double, YALE, COO, rowMajor> c(UseDynamic{}, 6, 5, ind, val);
+    c.compress();
+    auto const& cc = c;
+    std::vector<int> same(8, 0);
+    {
+        std::vector<std::jthread> threads;
+        for (size_t t = 0; t < same.size(); ++t) {
+            threads.emplace_back([&, t] {
+                same[t] = cc.norm<One>() == 10 &&
+                          cc.norm<Frobenius>() == std::sqrt(80.0) &&
+                          cc.stats().num_elements == 6 &&
+                          cc.diagonal()[1] == 3;
+            });
+        }
+    }
+    std::cout << "Expected same from every thread: 1,\tsame: "
+              << (std::count(same.begin(), same.end(), 1) == 8) << std::endl;
+    std::cout << std::endl;
+}
+
+void test_matrix_view() {
+    std::cout << "TESTING THE READ-ONLY VIEW" << std::endl;
+    using namespace algebra;
+
+    const size_t n = 500;
+    std::mt19937 generator(41);
+    std::uniform_int_distribution<size_t> index(0, n - 1);
+    std::uniform_real_distribution<double> value(-1, 1);
+    std::set<std::pair<size_t, size_t>> positions;
+    while (positions.size() < 5000) {
+        positions.insert({index(generator), index(generator)});
+    }
+    std::vector<std::pair<size_t, size_t>> ind(positions.begin(),
+                                               positions.end());
+    std::vector<double> val(ind.size());
+    for (auto& el : val) el = value(generator);
+    Matrix<double, YALE, COOmap, rowMajor> m(UseDynamic{}, n, n, ind, val);
+    m.compress();
+    const size_t stored = m.get_num_elements();
+
+    std::vector<double> x(n), y(n);
+    for (auto& el : x) el = value(generator);
+    m.multiply_into(x, y);
+
+    // Several threads read and multiply through copies of the same view.
+    auto view = m.freeze();
+    std::vector<int> same(8, 1);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < same.size(); ++t) {
+        threads.emplace_back([view, &x, &y, &same, t, n] {
+            std::vector<double> yt(n);
+            for (size_t k = 0; k < 20; ++k) {
+                view.multiply_into(x, yt);
+                same[t] = same[t] && yt == y;
+                for (size_t i = t; i < n; i += 7) {
+                    double sum = 0;
+                    for (size_t j = 0; j < n; ++j) sum += view(i, j) * x[j];
+                    same[t] = same[t] && std::abs(sum - y[i]) < 1e-12;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    std::cout << "Expected same products in every thread: 1,\tsame: "
+              << (std::count(same.begin(), same.end(), 1) == 8) << std::endl;
+    std::cout << "Expected elements after reading: " << stored
+              << ",\telements: " << view.get_num_elements() << std::endl;
+
+    size_t visited = 0, lines_sorted = 1, last_row = 0;
+    view.for_each([&](size_t i, size_t, double) {
+        lines_sorted = lines_sorted && i >= last_row;
+        last_row = i;
+        ++visited;
+    });
+    std::cout << "Expected visited: " << stored << ", sorted by row: 1,\t"
+              << "visited: " << visited << ", sorted by row: " << lines_sorted
+              << std::endl;
+
+    // Only the explicit insertions add elements.
+    size_t i = 0, j = 0;
+    while (std::as_const(m)(i, j) != 0) {
+        j = (j + 1) % n;
+        i += j == 0;
+    }
+    double read = m(i, j);
+    std::cout << "Expected elements after a non-const read of 0: "
+              << stored + 1 << ",\telements after reading " << read << ": "
+              << m.get_num_elements() << std::endl;
+    m.insert(i, (j + 1) % n, 2.5);
+    m.at_or_insert(i, (j + 1) % n) += 1;
+    std::cout << "Expected inserted: 3.5,\tinserted: "
+              << m.freeze()(i, (j + 1) % n) << std::endl;
+
+    Matrix<double, YALE, COOmap, columnMajor> d(UseDynamic{}, n, n, ind, val);
+    auto dynamic_view = d.freeze();
+    std::vector<double> yd(n);
+    dynamic_view.multiply_into(x, yd);
+    double diff = 0;
+    for (size_t k = 0; k < n; ++k) {
+        diff = std::max(diff, std::abs(yd[k] - y[k]));
+    }
+    std::cout << "Expected same dynamic product: 1,\tsame: " << (diff < 1e-12)
+              << ", elements: " << (dynamic_view.get_num_elements() == stored)
+              << std::endl;
+    std::cout << std::endl;
+}
+
+void test_line_access() {
+    std::cout << "TESTING THE LINE ACCESS" << std::endl;
+    using namespace algebra;
+
+    // Empty first and last rows, and an empty row in the middle.
+    std::vector<std::pair<size_t, size_t>> ind{
+        {1, 0}, {1, 3}, {2, 2}, {4, 1}, {4, 3}, {4, 4}};
+    std::vector<double> val{1, 2, 3, 4, 5, 6};
+    Matrix<double, YALE, COO, rowMajor> a(UseDynamic{}, 6, 5, ind, val);
+    Matrix<double, YALE, COO, columnMajor> ac(UseDynamic{}, 6, 5, ind, val);
+    Matrix<double, FloatYALE, COO, rowMajor> f(UseDynamic{}, 6, 5, ind, val);
+    a.compress();
+    ac.compress();
+    f.compress();
+
+    std::cout << "Expected row 4: (1,4) (3,5) (4,6),\trow 4:";
+    for (auto [j, v] : a.row(4)) std::cout << " (" << j << "," << v << ")";
+    std::cout << ", FloatYALE:";
+    for (auto [j, v] : f.row(4)) std::cout << " (" << j << "," << v << ")";
+    std::cout << std::endl;
+    std::cout << "Expected column 3: (1,2) (4,5),\tcolumn 3:";
+    for (auto [i, v] : ac.column(3)) std::cout << " (" << i << "," << v << ")";
+    std::cout << std::endl;
+    std::cout << "Expected row lengths: 0 2 1 0 3 0,\trow lengths:";
+    for (size_t i = 0; i < 6; ++i) std::cout << " " << a.row(i).size();
+    std::cout << std::endl;
+
+    auto print_nonzeros = [](auto const& m) {
+        for (auto [i, j, v] : m.nonzeros()) {
+            std::cout << " (" << i << "," << j << "," << v << ")";
+        }
+    };
+    std::cout << "Expected nonzeros: (1,0,1) (1,3,2) (2,2,3) (4,1,4) (4,3,5) "
+                 "(4,4,6),\tnonzeros:";
+    print_nonzeros(a);
+    std::cout << std::endl;
+    std::cout << "Expected nonzeros: (1,0,1) (4,1,4) (2,2,3) (1,3,2) (4,3,5) "
+                 "(4,4,6),\tcolumn-major:";
+    print_nonzeros(ac);
+    std::cout << std::endl;
+
+    // The ranges read the same elements as operator() on a bigger matrix.
+    const size_t n = 300;
+    std::mt19937 generator(43);
+    std::uniform_int_distribution<size_t> index(0, n - 1);
+    std::set<std::pair<size_t, size_t>> positions;
+    while (positions.size() < 3000) {
+        positions.insert({index(generator), index(generator)});
+    }
+    std::vector<std::pair<size_t, size_t>> ib(positions.begin(),
+                                              positions.end());
+    std::vector<double> vb(ib.size());
+    std::iota(vb.begin(), vb.end(), 1.0);
+    Matrix<double, YALE, COO, rowMajor> b(UseDynamic{}, n, n, ib, vb);
+    b.compress();
+    bool same = true;
+    size_t visited = 0;
+    for (size_t i = 0; i < n; ++i) {
+        auto line = b.row(i);
+        same = same && line.indexes().size() == line.values().size();
+        for (auto [j, v] : line) {
+            same = same && b(i, j) == v;
+            ++visited;
+        }
+    }
+    size_t counted = 0;
+    for (auto [i, j, v] : b.freeze().nonzeros()) {
+        same = same && b(i, j) == v;
+        ++counted;
+    }
+    std::cout << "Expected same elements: 1, visited: " << b.get_num_elements()
+              << " " << b.get_num_elements() << ",\tsame: " << same
+              << ", visited: " << visited << " " << counted << std::endl;
+    std::cout << std::endl;
+}
+
+void test_profiling() {
+    std::cout << "TESTING THE INSTRUMENTATION" << std::endl;
+    using namespace algebra;
+
+    // The counters can be fed directly, whether the library is instrumented
+    // or not.
+    auto& counter = profile_counter("test \"operation\"", "none");
+    {
+        ProfileScope scope(counter);
+        scope.add_bytes(64);
+    }
+    auto snapshot = profile_snapshot();
+    bool found = false;
+    for (auto const& entry : snapshot.entries) {
+        if (entry.operation == "test \"operation\"") {
+            found = entry.calls == 1 && entry.bytes == 64;
+        }
+    }
+    std::string json = snapshot.to_json();
+    std::cout << "Expected counted: 1, escaped: 1,\tcounted: " << found
+              << ", escaped: "
+              << (json.find("\"test \\\"operation\\\"\"") != std::string::npos)
+              << std::endl;
+
+    profile_reset();
+    std::vector<std::pair<size_t, size_t>> ind{{0, 0}, {1, 1}, {2, 2}};
+    std::vector<double> val{1, 2, 3};
+    Matrix<double, YALE, COO, rowMajor> m(UseDynamic{}, 3, 3, ind, val);
+    m(0, 1) = 4;
+    m.compress();
+    m(1, 0) = 5;
+    m(2, 1) = 6;
+    m(2, 2) = 7;
+    m.uncompress();
+
+    auto calls = [](std::string const& operation, std::string const& format) {
+        for (auto const& entry : profile_snapshot().entries) {
+            if (entry.operation == operation && entry.format == format) {
+                return entry.calls;
+            }
+        }
+        return std::uint64_t{0};
+    };
+#ifdef PROFILE
+    std::cout << "Expected calls: 1 1 2 1,\tcalls: ";
+#else
+    std::cout << "Expected calls without PROFILE: 0 0 0 0,\tcalls: ";
+#endif
+    std::cout << calls("find_dynamic", "COO") << " "
+              << calls("compress", "YALE") << " "
+              << calls("insert_compressed", "YALE") << " "
+              << calls("uncompress", "COO") << std::endl;
+    std::cout << std::endl;
+}
+
+void test_expressions() {
+    std::cout << "TESTING THE EXPRESSIONS" << std::endl;
+    using namespace algebra;
+
+    std::vector<std::pair<size_t, size_t>> ia{
+        {0, 0}, {0, 2}, {1, 1}, {2, 0}, {2, 2}};
+    std::vector<double> va{1, 2, 3, 4, 5};
+    std::vector<std::pair<size_t, size_t>> ib{{0, 1}, {1, 1}, {2, 2}};
+    std::vector<double> vb{1, 1, 2};
+    Matrix<double, YALE, COO, rowMajor> a(UseDynamic{}, 3, 3, ia, va);
+    Matrix<double, YALE, COO, rowMajor> b(UseDynamic{}, 3, 3, ib, vb);
+    Matrix<double, YALE, COO, columnMajor> bc(UseDynamic{}, 3, 3, ib, vb);
+    Matrix<double, FloatYALE, COO, rowMajor> f(UseDynamic{}, 3, 3, ia, va);
+    std::vector<double> x{1, 2, 3}, z{1, 1, 1}, w{1, 0, 1};
+
+    auto print = [](std::vector<double> const& y) {
+        for (auto const& el : y) std::cout << " " << el;
+    };
+
+    // Uncompressed, then compressed, i.e. through the fused loop, except for
+    // the column-major matrix.
+    static_assert(RowReadable<decltype(a)> && RowReadable<decltype(f)> &&
+                  !RowReadable<decltype(bc)>);
+    std::cout << "Expected y: 6 7 19,\tdynamic:";
+    print(a * x + b * z - 2.0 * w);
+    a.compress();
+    b.compress();
+    bc.compress();
+    f.compress();
+    std::cout << ", fused:";
+    print(a * x + b * z - 2.0 * w);
+    std::cout << ", FloatYALE:";
+    print(f * x + b * z - 2.0 * w);
+    std::cout << ", column-major:";
+    print(a * x + bc * z - 2.0 * w);
+    std::cout << std::endl;
+
+    std::cout << "Expected y: -6 -6 -18,\tcomputed:";
+    print(w - a * x);
+    std::cout << std::endl;
+    std::cout << "Expected y: -7 -6 -19,\tscaled:";
+    print(-0.5 * (2.0 * (a * x) + (b * z) * 0.0) + w - w);
+    std::cout << std::endl;
+
+    // Temporary matrices and vectors would dangle, so they are rejected.
+    using V = std::vector<double>;
+    using A = decltype(a) const&;
+    using E = decltype(a * x) const&;
+    static_assert(Multipliable<A, V const&> && !Multipliable<A, V> &&
+                  !Multipliable<decltype(a), V const&> &&
+                  !Multipliable<decltype(a), V> && !Multipliable<double, V> &&
+                  !Addable<E, V> && !Subtractable<V, E> &&
+                  Subtractable<V const&, E>);
+
+    // Kept in an `auto` variable, the product is evaluated once, when it's
+    // first read.
+    auto lazy = a * x;
+    std::cout << "Expected y: 7 6 19, 7 6 19, 106 6 19,\tindexed:";
+    for (size_t i = 0; i < lazy.size(); ++i) std::cout << " " << lazy[i];
+    a(0, 0) = 100;
+    std::cout << ", iterated after a change:";
+    for (double el : lazy) std::cout << " " << el;
+    std::cout << ", new product:";
+    print(a * x);
+    a(0, 0) = 1;
+    std::cout << std::endl;
+
+    // Evaluation into a buffer owned by the caller.
+    std::vector<double> y(3, -1);
+    (a * x + b * z).evaluate_into(y);
+    std::cout << "Expected y: 8 7 21,\tcomputed:";
+    print(y);
+    std::cout << std::endl;
+
+    auto print_elements = [](auto const& m) {
+        for (size_t i = 0; i < 3; ++i) {
+            for (size_t j = 0; j < 3; ++j) std::cout << " " << m(i, j);
+        }
+    };
+    std::cout << "Expected sum: 1 1 2 0 4 0 4 0 7,\tsum:";
+    print_elements(a + b);
+    std::cout << ", column-major rhs:";
+    print_elements(a + bc);
+    std::cout << std::endl;
+    std::cout << "Expected difference: 1 -1 2 0 2 0 4 0 3,\tdifference:";
+    print_elements(a - b);
+    std::cout << ", 2A - 3B:";
+    print_elements(a.add(b, 2.0, -3.0));
+    std::cout << std::endl;
+    // Cancelled elements are kept as explicit zeros.
+    std::cout << "Expected elements: 6 3,\tcomputed: "
+              << (a + b).get_num_elements() << " "
+              << bc.add(bc, 1.0, -1.0).get_num_elements() << std::endl;
+}
+
+#ifdef USE_MPI
+void test_distributed() {
+    using namespace algebra;
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    if (rank == 0) {
+        std::cout << "TESTING THE DISTRIBUTED MATRIX ON " << size
+                  << " PROCESSES" << std::endl;
+    }
+
+    // Compares the owned entries of the distributed product with the product
+    // of the whole matrix, computed by every process; the sums are split
+    // differently, so they can differ by rounding.
+    auto same_product = [&](auto& d, auto const& m) {
+        std::vector<double> x(m.get_columns());
+        for (size_t j = 0; j < x.size(); ++j) x[j] = 1.0 + j % 7;
+        std::vector<double> expected = m * x;
+
+        std::vector<double> y(d.get_row_end() - d.get_row_begin());
+        std::span<double const> owned(x.data() + d.get_column_begin(),
+                                      x.data() + d.get_column_end());
+        d.multiply_into(owned, y);
+        double diff = 0;
+        for (size_t i = 0; i < y.size(); ++i) {
+            double e = expected[d.get_row_begin() + i];
+            diff = std::max(diff,
+                            std::abs(y[i] - e) / std::max(1.0, std::abs(e)));
+        }
+        double total = 0;
+        MPI_Allreduce(&diff, &total, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+        return total < 1e-12;
+    };
+    auto num_elements = [](auto const& d) {
+        unsigned long long count =
+            d.get_diagonal_block().get_num_elements() +
+            d.get_off_diagonal_block().get_num_elements();
+        unsigned long long total = 0;
+        MPI_Allreduce(&count, &total, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM,
+                      MPI_COMM_WORLD);
+        return total;
+    };
+
+    // A band and a few far elements, each process giving the elements of
+    // the rows congruent to its rank, so they are all sent elsewhere.
+    const size_t n = 50;
+    std::vector<std::pair<size_t, size_t>> ind, own;
+    std::vector<double> val, own_val;
+    for (size_t i = 0; i < n; ++i) {
+        std::set<size_t> columns{i, (i + 1) % n, (i * 7 + 3) % n};
+        for (size_t j : columns) {
+            ind.push_back({i, j});
+            val.push_back(1.0 + (i + 2 * j) % 5);
+            if (i % size == static_cast<size_t>(rank)) {
+                own.push_back(ind.back());
+                own_val.push_back(val.back());
+            }
+        }
+    }
+    Matrix<double, YALE, COO, rowMajor> m(UseDynamic{}, n, n, ind, val);
+    m.compress();
+    DistributedMatrix<double, COO> d(MPI_COMM_WORLD, n, n, own, own_val);
+    bool same = same_product(d, m);
+    unsigned long long elements = num_elements(d);
+
+    // A Matrix Market file, each process parsing a part of it.
+    std::string s{"matrix.mtx"};
+    Matrix<double, YALE, COO, rowMajor> f(s);
+    f.compress();
+    DistributedMatrix<double, COO> df(MPI_COMM_WORLD, s);
+    bool same_file = same_product(df, f);
+
+    std::string s1{"test_distributed.mtx"};
+    if (rank == 0) {
+        std::ofstream file(s1);
+        file << "%%MatrixMarket matrix coordinate real symmetric\n"
+             << "5 5 7\n";
+        for (size_t i = 1; i <= 5; ++i) file << i << " " << i << " 2\n";
+        file << "5 1 -1\n"
+             << "4 2 3\n";
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+    Matrix<double, YALE, COO, rowMajor> g(s1);
+    g.compress();
+    DistributedMatrix<double, COO> dg(MPI_COMM_WORLD, s1);
+    bool same_symmetric = same_product(dg, g);
+    unsigned long long symmetric_elements = num_elements(dg);
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    if (rank == 0) {
+        std::remove(s1.c_str());
+        std::cout << "Expected elements: " << m.get_num_elements()
+                  << ",\tcomputed: " << elements << std::endl;
+        std::cout << "Expected same products: 1 1 1,\tsame: " << same << " "
+                  << same_file << " " << same_symmetric << std::endl;
+        std::cout << "Expected elements: 9,\tsymmetric file: "
+                  << symmetric_elements << std::endl;
+    }
+}
+#endif
+
+void test_device() {
+    std::cout << "TESTING THE DEVICE BACKEND" << std::endl;
+    using namespace algebra;
+
+    std::vector<std::pair<size_t, size_t>> ind{
+        {0, 0}, {0, 2}, {1, 1}, {2, 0}, {2, 2}, {3, 1}, {3, 3}};
+    std::vector<double> val{1, 2, 3, 4, 5, 6, 7};
+    Matrix<double, YALE, COO, rowMajor> m(UseDynamic{}, 4, 4, ind, val);
+    Matrix<double, YALE, COO, columnMajor> mc(UseDynamic{}, 4, 4, ind, val);
+    Matrix<double, FloatYALE32, COO, rowMajor> f(UseDynamic{}, 4, 4, ind, val);
+    m.compress();
+    mc.compress();
+    f.compress();
+
+    DeviceStream stream;
+    m.to_device(stream);
+    mc.to_device(stream);
+    f.to_device();
+    std::cout << "Expected on device: 1 1 1,\ton device: " << m.is_on_device()
+              << " " << mc.is_on_device() << " " << f.is_on_device()
+              << std::endl;
+
+    // The second product reads the output of the first one: the stream runs
+    // them in order.
+    std::vector<double> x{1, 1, 1, 1}, y(4), z(4, 1);
+    m.multiply_async(x, y);
+    auto done = mc.multiply_async(y, z, 1.0, 1.0);
+    done.get();
+    std::cout << "Expected y: 3 3 9 13,\ty:";
+    for (auto const& el : y) std::cout << " " << el;
+    std::cout << ", A * y + 1: 22 10 58 110,\tcomputed:";
+    for (auto const& el : z) std::cout << " " << el;
+    std::cout << std::endl;
+
+    std::vector<double> w(4);
+    f.multiply_async(x, w).get();
+    std::cout << "Expected FloatYALE32: 3 3 9 13,\tcomputed:";
+    for (auto const& el : w) std::cout << " " << el;
+    std::cout << std::endl;
+
+    // A block of two vectors, the second one twice the first.
+    std::vector<double> xb{1, 2, 1, 2, 1, 2, 1, 2}, yb(8), expected(8);
+    m.multiply_block(xb, expected, 2);
+    auto block = m.multiply_block_async(xb, yb, 2);
+    block.wait();
+    std::cout << "Expected same block: 1,\tsame: " << (yb == expected)
+              << std::endl;
+
+    // Any modification drops the copy on the device.
+    m(0, 1) = 8;
+    mc.uncompress();
+    std::cout << "Expected on device: 0 0 1,\ton device: " << m.is_on_device()
+              << " " << mc.is_on_device() << " " << f.is_on_device()
+              << std::endl;
+    f.release_device();
+    stream.synchronize();
+    std::cout << "Expected on device: 0,\ton device: " << f.is_on_device()
+              << std::endl;
+}
+
+void test_streaming() {
+    std::cout << "TESTING STREAMING PRODUCTS" << std::endl;
+    using namespace algebra;
+
+    std::string s{"matrix.mtx"};
+    std::string s1{"test_streaming.yale"};
+    Matrix<double, YALE, COO, rowMajor> m(UseCompressed{}, s);
+    m.save_snapshot(s1);
+
+    StreamingYALE<double> m1(s1, 7);
+    std::cout << "Expected valid snapshot: 1,\tvalid: " << m1.is_valid()
+              << std::endl;
+    std::cout << "Expected dimensions: " << m.get_rows() << "x"
+              << m.get_columns() << ",\tdimensions: " << m1.get_rows() << "x"
+              << m1.get_columns() << std::endl;
+    std::cout << "Expected number of elements: " << m.get_num_elements()
+              << ",\tnumber of elements: " << m1.get_num_elements()
+              << std::endl;
+    std::cout << "Expected number of panels: "
+              << (m.get_rows() + 6) / 7
+              << ",\tnumber of panels: " << m1.get_num_panels() << std::endl;
+
+    std::vector<double> v(m.get_columns());
+    for (size_t i = 0; i < v.size(); ++i) v[i] = static_cast<double>(i % 7);
+    std::vector<double> r(m.get_rows(), 1.0);
+    std::vector<double> r1(m.get_rows(), 1.0);
+    m.multiply_into(v, r, 2.0, 0.5);
+    m1.multiply_into(v, r1, 2.0, 0.5);
+    double diff = 0;
+    for (size_t i = 0; i < r.size(); ++i) {
+        diff = std::max(diff, std::abs(r[i] - r1[i]));
+    }
+    std::cout << "Expected difference: 0,\tdifference: " << diff << std::endl;
+
+    size_t full = m.get_num_elements() * (sizeof(size_t) + sizeof(double));
+    std::cout << "Expected resident panels smaller than the matrix: 1,"
+              << "\tsmaller: " << (m1.get_resident_bytes() < full)
+              << std::endl;
+
+    Matrix<double, YALE32, COO, rowMajor> m32(UseCompressed{}, s);
+    m32.save_snapshot(s1);
+    StreamingYALE<double, std::uint32_t> m2(s1, 1000);
+    std::vector<double> r2 = m * v;
+    std::vector<double> r3(m.get_rows());
+    m2.multiply_into(v, r3);
+    diff = 0;
+    for (size_t i = 0; i < r2.size(); ++i) {
+        diff = std::max(diff, std::abs(r2[i] - r3[i]));
+    }
+    std::cout << "Expected difference with one panel: 0,\tdifference: "
+              << diff << std::endl;
+
+    // A column out of bounds in the last panel is found while reading it.
+    m.save_snapshot(s1);
+    {
+        SnapshotHeader header{};
+        std::fstream file(s1, std::ios::binary | std::ios::in |
+                                  std::ios::out);
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        size_t wrong = m.get_columns();
+        file.seekp(static_cast<std::streamoff>(
+            header.outer_offset + (header.nnz - 1) * sizeof(size_t)));
+        file.write(reinterpret_cast<char const*>(&wrong), sizeof(wrong));
+    }
+    StreamingYALE<double> m3(s1, 7);
+    bool corrupted = false;
+    try {
+        m3.multiply_into(v, r1);
+    } catch (std::runtime_error const&) {
+        corrupted = true;
+    }
+    std::cout << "Expected corrupted: 1, valid: 0,\tcorrupted: " << corrupted
+              << ", valid: " << m3.is_valid() << std::endl;
+
+    std::remove(s1.c_str());
+
+    std::cout << std::endl;
+}
+
+void test_pattern_reuse() {
+    std::cout << "TESTING SPARSITY PATTERN REUSE" << std::endl;
+    using namespace algebra;
+
+    std::string s{"matrix.mtx"};
+    Matrix<double, YALE, COO, rowMajor> m(UseCompressed{}, s);
+    Matrix<double, YALE, COO, rowMajor> m1(UseCompressed{}, s);
+
+    std::vector<std::pair<size_t, size_t>> indexes;
+    std::vector<double> values;
+    for (auto [i, j, v] : m.nonzeros()) {
+        indexes.emplace_back(i, j);
+        values.push_back(v);
+    }
+    std::vector<size_t> positions = m1.value_positions(indexes);
+    std::vector<std::pair<size_t, size_t>> missing{{0, 130}};
+    std::cout << "Expected missing position: 1,\tmissing: "
+              << (m1.value_positions(missing)[0] == no_position)
+              << std::endl;
+
+    double const* data = m1.get_values().data();
+    double norm = m1.norm<Frobenius>();
+    m1.zero_values();
+    std::cout << "Expected norm after zeroing: 0,\tnorm: "
+              << m1.norm<Frobenius>() << std::endl;
+    m1.add_values(positions, values);
+    m1.add_values(positions, values);
+    std::cout << "Expected norm: " << 2 * norm << ",\tnorm: "
+              << m1.norm<Frobenius>() << std::endl;
+    std::cout << "Expected same arrays: 1,\tsame: "
+              << (m1.get_values().data() == data) << std::endl;
+
+    double diff = 0;
+    for (auto [i, j, v] : m.nonzeros()) {
+        diff = std::max(diff, std::abs(2 * v - m1(i, j)));
+    }
+    std::cout << "Expected difference: 0,\tdifference: " << diff << std::endl;
+
+    // Tridiagonal matrix assembled from the contributions of 1D elements,
+    // each interior node receiving contributions from two of them.
+    const size_t n = 20000;
+    std::vector<std::pair<size_t, size_t>> pattern;
+    for (size_t i = 0; i < n; ++i) {
+        pattern.emplace_back(i, i);
+        if (i + 1 < n) {
+            pattern.emplace_back(i, i + 1);
+            pattern.emplace_back(i + 1, i);
+        }
+    }
+    std::vector<double> ones(pattern.size(), 1.0);
+    Matrix<double, YALE, COOmap, rowMajor> a(UseDynamic{}, n, n, pattern,
+                                             ones);
+    a.compress();
+
+    std::vector<std::pair<size_t, size_t>> contributions;
+    for (size_t e = 0; e + 1 < n; ++e) {
+        contributions.emplace_back(e, e);
+        contributions.emplace_back(e, e + 1);
+        contributions.emplace_back(e + 1, e);
+        contributions.emplace_back(e + 1, e + 1);
+    }
+    std::vector<double> local(contributions.size(), 0.5);
+    std::vector<size_t> slots = a.value_positions(contributions);
+
+    a.zero_values();
+    a.add_values(slots, local, 4);
+    auto const& ca = a;
+    std::cout << "Expected elements: 0.5, 1, 0.5, 0.5,\telements: "
+              << ca(0, 0) << ", " << ca(1, 1) << ", " << ca(1, 2) << ", "
+              << ca(n - 1, n - 1) << std::endl;
+    double sum = 0;
+    for (double v : a.get_values()) sum += v;
+    std::cout << "Expected sum: " << 0.5 * static_cast<double>(local.size())
+              << ",\tsum: " << sum << std::endl;
+
+    std::cout << std::endl;
+}
+
 void test_complex() {
     std::cout << "TESTING WITH COMPLEX NUMBERS" << std::endl;
     using namespace algebra;
@@ -398,7 +3000,7 @@ void test_dotproduct_timing() {
 
     std::cout << std::setprecision(20);
 
-    std::chrono::duration<double, std::milli> duration1;
+    std::chrono::duration<double, std::milli> duration1{};
     for (size_t i = 0; i < 1000; ++i) {
         auto start = std::chrono::high_resolution_clock::now();
         std::vector<double> res1 = m * vec;
@@ -413,7 +3015,7 @@ void test_dotproduct_timing() {
 
     m.compress();
 
-    std::chrono::duration<double, std::milli> duration2;
+    std::chrono::duration<double, std::milli> duration2{};
     for (size_t i = 0; i < 1000; ++i) {
         auto start2 = std::chrono::high_resolution_clock::now();
         std::vector<double> res2 = m * vec;
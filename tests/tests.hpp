@@ -11,8 +11,39 @@ void test_constructors();
 void test_norms();
 void test_compress_uncompress();
 void test_remove();
+void test_prune();
+void test_node_arena();
 void test_matrixmarket_constructors();
 void test_matrixvector();
+void test_multiply_into();
+void test_parallel_multiply();
+void test_sell();
+void test_coovec();
+void test_coohash();
+void test_concurrent_compress();
+void test_matrixmarket_reader();
+void test_snapshot();
+void test_index_width();
+void test_block_product();
+void test_assembly();
+void test_transpose();
+void test_spgemm();
+void test_symyale();
+void test_bsr();
+void test_krylov();
+void test_mixed_precision();
+void test_reordering();
+void test_cached_properties();
+void test_matrix_view();
+void test_line_access();
+void test_profiling();
+void test_expressions();
+void test_device();
+void test_streaming();
+void test_pattern_reuse();
+#ifdef USE_MPI
+void test_distributed();
+#endif
 void test_complex();
 void test_dotproduct_timing();
 